@@ -0,0 +1,287 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Host-side correctness check for utils/Arm64XrefIndex.cc on hand assembled arm64 code.
+//
+// Usage: arm64_xref_check
+//
+// Every case is a short instruction sequence placed in the executable segment of a synthetic ELF file image,
+// the code and data references decoded from it must be exactly the expected ones.
+// The exit status is 1 if any case differs.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <elf.h>
+#include <sys/mman.h>
+
+#include "utils/Arm64XrefIndex.h"
+#include "utils/ElfImageLayout.h"
+#include "utils/MemoryUtils.h"
+
+namespace {
+
+constexpr uint64_t kCodeVaddr = 0x10000;
+constexpr uint64_t kDataVaddr = 0x40000;
+constexpr uint64_t kDataSize = 0x10000;
+constexpr uint64_t kImageSize = kDataVaddr + kDataSize;
+
+using Xref = utils::Arm64XrefIndex::Xref;
+
+// all addresses are RVAs, pc is the address of the instruction being encoded
+
+uint32_t Adrp(uint32_t rd, uint64_t pc, uint64_t target) {
+    const uint64_t imm = ((target >> 12) - (pc >> 12)) & 0x1fffff;
+    return 0x90000000u | uint32_t((imm & 3) << 29) | uint32_t((imm >> 2) << 5) | rd;
+}
+
+uint32_t AddImm(uint32_t rd, uint32_t rn, uint32_t imm12) {
+    return 0x91000000u | (imm12 << 10) | (rn << 5) | rd;
+}
+
+uint32_t LdrX(uint32_t rt, uint32_t rn, uint32_t offset) {
+    return 0xf9400000u | ((offset / 8) << 10) | (rn << 5) | rt;
+}
+
+uint32_t LdrW(uint32_t rt, uint32_t rn, uint32_t offset) {
+    return 0xb9400000u | ((offset / 4) << 10) | (rn << 5) | rt;
+}
+
+uint32_t StrX(uint32_t rt, uint32_t rn, uint32_t offset) {
+    return 0xf9000000u | ((offset / 8) << 10) | (rn << 5) | rt;
+}
+
+// ldr xt, [xn], #imm9
+uint32_t LdrXPostIndex(uint32_t rt, uint32_t rn, uint32_t imm9) {
+    return 0xf8400400u | ((imm9 & 0x1ff) << 12) | (rn << 5) | rt;
+}
+
+// ldp xt, xt2, [xn, #offset]
+uint32_t LdpX(uint32_t rt, uint32_t rt2, uint32_t rn, uint32_t offset) {
+    return 0xa9400000u | (((offset / 8) & 0x7f) << 15) | (rt2 << 10) | (rn << 5) | rt;
+}
+
+uint32_t MovzX(uint32_t rd, uint32_t imm16) {
+    return 0xd2800000u | (imm16 << 5) | rd;
+}
+
+uint32_t CbzX(uint32_t rt, uint64_t pc, uint64_t target) {
+    return 0xb4000000u | uint32_t((((target - pc) / 4) & 0x7ffff) << 5) | rt;
+}
+
+uint32_t B(uint64_t pc, uint64_t target) {
+    return 0x14000000u | uint32_t(((target - pc) / 4) & 0x3ffffff);
+}
+
+uint32_t Bl(uint64_t pc, uint64_t target) {
+    return 0x94000000u | uint32_t(((target - pc) / 4) & 0x3ffffff);
+}
+
+constexpr uint32_t kNop = 0xd503201fu;
+constexpr uint32_t kRet = 0xd65f03c0u;
+// blr x9
+constexpr uint32_t kBlrX9 = 0xd63f0120u;
+// mrs x8, tpidr_el0
+constexpr uint32_t kMrsX8TpidrEl0 = 0xd53bd048u;
+// stp x29, x30, [sp, #-16]!
+constexpr uint32_t kStpX29X30SpPre = 0xa9bf7bfdu;
+
+struct CheckCase {
+    const char* name;
+    std::vector<uint32_t> code;
+    std::vector<Xref> codeRefs;
+    std::vector<Xref> dataRefs;
+};
+
+uint64_t Pc(size_t index) {
+    return kCodeVaddr + index * 4;
+}
+
+std::vector<CheckCase> MakeCases() {
+    const uint64_t str = kDataVaddr + 0x1234;
+    const uint64_t far = kDataVaddr + 0x5008;
+    std::vector<CheckCase> cases;
+    cases.push_back({"b and bl", {
+            Bl(Pc(0), kCodeVaddr + 0x100), B(Pc(1), kCodeVaddr - 0x40), kRet,
+    }, {{uint32_t(kCodeVaddr - 0x40), uint32_t(Pc(1))}, {uint32_t(kCodeVaddr + 0x100), uint32_t(Pc(0))}}, {}});
+    cases.push_back({"adrp add", {
+            Adrp(0, Pc(0), str), AddImm(0, 0, str & 0xfff), kRet,
+    }, {}, {{uint32_t(str), uint32_t(Pc(0))}}});
+    cases.push_back({"adrp ldr x and ldr w on the same page", {
+            Adrp(8, Pc(0), far), LdrX(0, 8, far & 0xfff), LdrW(1, 8, (far & 0xfff) + 8), kRet,
+    }, {}, {{uint32_t(far), uint32_t(Pc(0))}, {uint32_t(far + 8), uint32_t(Pc(0))}}});
+    cases.push_back({"adrp with unrelated instructions in between", {
+            Adrp(8, Pc(0), str), MovzX(0, 1), StrX(8, 31, 16), CbzX(8, Pc(3), Pc(6)), kStpX29X30SpPre, AddImm(1, 8, str & 0xfff), kRet,
+    }, {}, {{uint32_t(str), uint32_t(Pc(0))}}});
+    cases.push_back({"ldr into the base register ends the pair", {
+            Adrp(8, Pc(0), far), LdrX(8, 8, far & 0xfff), AddImm(0, 8, 0x10), kRet,
+    }, {}, {{uint32_t(far), uint32_t(Pc(0))}}});
+    cases.push_back({"mov clobbers the register", {
+            Adrp(8, Pc(0), str), MovzX(8, 0x40), AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    cases.push_back({"ldp clobbers the second register", {
+            Adrp(8, Pc(0), str), LdpX(0, 8, 31, 16), AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    cases.push_back({"post-indexed load writes back the base register", {
+            Adrp(8, Pc(0), str), LdrXPostIndex(0, 8, 8), AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    cases.push_back({"mrs clobbers the register", {
+            Adrp(8, Pc(0), str), kMrsX8TpidrEl0, AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    cases.push_back({"another adrp redefines the register", {
+            Adrp(8, Pc(0), str), Adrp(8, Pc(1), far), AddImm(0, 8, far & 0xfff), kRet,
+    }, {}, {{uint32_t(far), uint32_t(Pc(1))}}});
+    cases.push_back({"blr ends the basic block", {
+            Adrp(8, Pc(0), str), kBlrX9, AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    cases.push_back({"use beyond the pair window", {
+            Adrp(8, Pc(0), str), kNop, kNop, kNop, kNop, kNop, kNop, kNop, kNop, AddImm(0, 8, str & 0xfff), kRet,
+    }, {}, {}});
+    return cases;
+}
+
+/**
+ * A page aligned file image with an R+X segment holding the code and an R segment for the data it refers to.
+ */
+class CodeImage {
+public:
+    explicit CodeImage(const std::vector<uint32_t>& code) {
+        // IsMemoryReadable(ptr, length) also probes the page right after the range, keep one more page mapped
+        mMapLength = kImageSize + utils::GetPageSize();
+        mAddress = mmap(nullptr, mMapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mAddress == MAP_FAILED) {
+            mAddress = nullptr;
+            return;
+        }
+        auto* base = static_cast<uint8_t*>(mAddress);
+        Elf64_Ehdr ehdr = {};
+        memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+        ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+        ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+        ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+        ehdr.e_type = ET_DYN;
+        ehdr.e_machine = EM_AARCH64;
+        ehdr.e_version = EV_CURRENT;
+        ehdr.e_phoff = sizeof(Elf64_Ehdr);
+        ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+        ehdr.e_phentsize = sizeof(Elf64_Phdr);
+        ehdr.e_phnum = 2;
+        Elf64_Phdr phdrs[2] = {};
+        phdrs[0].p_type = PT_LOAD;
+        phdrs[0].p_flags = PF_R | PF_X;
+        phdrs[0].p_offset = kCodeVaddr;
+        phdrs[0].p_vaddr = kCodeVaddr;
+        phdrs[0].p_filesz = code.size() * 4;
+        phdrs[0].p_memsz = code.size() * 4;
+        phdrs[0].p_align = 0x1000;
+        phdrs[1].p_type = PT_LOAD;
+        phdrs[1].p_flags = PF_R;
+        phdrs[1].p_offset = kDataVaddr;
+        phdrs[1].p_vaddr = kDataVaddr;
+        phdrs[1].p_filesz = kDataSize;
+        phdrs[1].p_memsz = kDataSize;
+        phdrs[1].p_align = 0x1000;
+        memcpy(base, &ehdr, sizeof(ehdr));
+        memcpy(base + sizeof(ehdr), phdrs, sizeof(phdrs));
+        memcpy(base + kCodeVaddr, code.data(), code.size() * 4);
+        mprotect(mAddress, mMapLength, PROT_READ);
+    }
+
+    ~CodeImage() noexcept {
+        if (mAddress != nullptr) {
+            munmap(mAddress, mMapLength);
+        }
+    }
+
+    CodeImage(const CodeImage&) = delete;
+
+    CodeImage& operator=(const CodeImage&) = delete;
+
+    [[nodiscard]] const void* GetAddress() const noexcept {
+        return mAddress;
+    }
+
+private:
+    void* mAddress = nullptr;
+    size_t mMapLength = 0;
+};
+
+std::string FormatXrefs(const std::vector<Xref>& refs) {
+    std::string s;
+    for (const auto& x: refs) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), " %" PRIx32 "<-%" PRIx32, x.target, x.site);
+        s += buf;
+    }
+    return s.empty() ? " (none)" : s;
+}
+
+bool Expect(const char* name, const char* kind, std::vector<Xref> expected, const std::vector<Xref>& actual) {
+    std::sort(expected.begin(), expected.end(), [](const Xref& a, const Xref& b) {
+        return a.target < b.target || (a.target == b.target && a.site < b.site);
+    });
+    const bool same = expected.size() == actual.size() && std::equal(expected.begin(), expected.end(), actual.begin(),
+                                                                     [](const Xref& a, const Xref& b) {
+                                                                         return a.target == b.target && a.site == b.site;
+                                                                     });
+    if (!same) {
+        fprintf(stderr, "%s: %s refs got%s expected%s\n", name, kind, FormatXrefs(actual).c_str(), FormatXrefs(expected).c_str());
+    }
+    return same;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        fprintf(stderr, "unknown argument: %s\n", argv[1]);
+        return 2;
+    }
+    int mismatches = 0;
+    const auto cases = MakeCases();
+    for (const auto& c: cases) {
+        CodeImage image(c.code);
+        utils::ElfImageLayout layout;
+        utils::Arm64XrefIndex index;
+        std::string err = image.GetAddress() == nullptr ? "mmap failed" : layout.Parse(image.GetAddress(), false);
+        if (err.empty()) {
+            err = index.Build(layout, 1);
+        }
+        bool ok;
+        if (!err.empty()) {
+            fprintf(stderr, "%s: %s\n", c.name, err.c_str());
+            ok = false;
+        } else {
+            ok = Expect(c.name, "code", c.codeRefs, index.GetCodeReferences());
+            ok = Expect(c.name, "data", c.dataRefs, index.GetDataReferences()) && ok;
+        }
+        printf("%-52s %s\n", c.name, ok ? "ok" : "MISMATCH");
+        mismatches += ok ? 0 : 1;
+    }
+    {
+        // only the references made from [Pc(2), Pc(4)) are decoded
+        const char* name = "build for a range";
+        CodeImage image({Bl(Pc(0), Pc(8)), kNop, B(Pc(2), Pc(1)), Bl(Pc(3), Pc(6)), B(Pc(4), Pc(0)), kRet});
+        utils::ElfImageLayout layout;
+        utils::Arm64XrefIndex index;
+        std::string err = image.GetAddress() == nullptr ? "mmap failed" : layout.Parse(image.GetAddress(), false);
+        if (err.empty()) {
+            err = index.BuildForRange(layout, Pc(2), Pc(4));
+        }
+        bool ok;
+        if (!err.empty()) {
+            fprintf(stderr, "%s: %s\n", name, err.c_str());
+            ok = false;
+        } else {
+            ok = Expect(name, "code", {{uint32_t(Pc(1)), uint32_t(Pc(2))}, {uint32_t(Pc(6)), uint32_t(Pc(3))}}, index.GetCodeReferences());
+        }
+        printf("%-52s %s\n", name, ok ? "ok" : "MISMATCH");
+        mismatches += ok ? 0 : 1;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Host-side correctness check for utils/Checksum.cc against zlib adler32() and crc32().
+//
+// Usage: checksum_check [options]
+//   --seed N              seed of the random lengths, alignments, initial values and chunk splits, default 1
+//   --rounds N            number of random cases per group in addition to the fixed ones, default 2000
+//
+// Every case is checked one-shot and split into random chunks, starting at every alignment
+// within a cache line, so that the SIMD head/tail handling and the zlib fallback are all covered.
+// The exit status is 1 if any case differs from zlib.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include "utils/Checksum.h"
+
+namespace {
+
+constexpr size_t kMaxAlignment = 64;
+constexpr size_t kMaxRandomLength = 1u << 20;
+// around the SIMD block sizes and the zlib NMAX of 5552 bytes, after which Adler-32 sums must be reduced
+constexpr size_t kFixedLengths[] = {
+        0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256, 257,
+        1023, 1024, 1025, 4095, 4096, 4097, 5551, 5552, 5553, 11104, 11105, 65535, 65536, 65537,
+        kMaxRandomLength - 1, kMaxRandomLength,
+};
+constexpr int kMaxReportedMismatches = 10;
+
+struct Checksum {
+    const char* name;
+    uint32_t (* update)(uint32_t, const void*, size_t) noexcept;
+    uint32_t (* reference)(uint32_t, const uint8_t*, size_t);
+};
+
+uint32_t ZlibAdler32(uint32_t adler, const uint8_t* data, size_t length) {
+    return uint32_t(adler32_z(adler, data, length));
+}
+
+uint32_t ZlibCrc32(uint32_t crc, const uint8_t* data, size_t length) {
+    return uint32_t(crc32_z(crc, data, length));
+}
+
+const Checksum kChecksums[] = {
+        {"adler32", utils::UpdateAdler32, ZlibAdler32},
+        {"crc32", utils::UpdateCrc32, ZlibCrc32},
+};
+
+struct CheckCase {
+    size_t length;
+    size_t alignment;
+    uint32_t initial;
+};
+
+class Checker {
+public:
+    Checker(const Checksum& checksum, std::mt19937_64& rng, const std::vector<uint8_t>& buffer)
+            : mChecksum(checksum), mRng(rng), mBuffer(buffer) {}
+
+    void Run(const CheckCase& c) {
+        const uint8_t* data = mBuffer.data() + c.alignment;
+        const uint32_t expected = mChecksum.reference(c.initial, data, c.length);
+        Expect(c, "one-shot", mChecksum.update(c.initial, data, c.length), expected);
+        uint32_t chunked = c.initial;
+        for (size_t offset = 0; offset < c.length;) {
+            const size_t n = std::min(c.length - offset, size_t(mRng() % (c.length + 1)));
+            chunked = mChecksum.update(chunked, data + offset, n);
+            offset += n;
+        }
+        Expect(c, "chunked", chunked, expected);
+        mCases++;
+    }
+
+    [[nodiscard]] int GetCases() const noexcept {
+        return mCases;
+    }
+
+    [[nodiscard]] int GetMismatches() const noexcept {
+        return mMismatches;
+    }
+
+private:
+    void Expect(const CheckCase& c, const char* mode, uint32_t actual, uint32_t expected) {
+        if (actual == expected) {
+            return;
+        }
+        if (mMismatches++ < kMaxReportedMismatches) {
+            fprintf(stderr, "%s %s: length=%zu alignment=%zu initial=%08" PRIx32 " got %08" PRIx32 " expected %08" PRIx32 "\n",
+                    mChecksum.name, mode, c.length, c.alignment, c.initial, actual, expected);
+        }
+    }
+
+    const Checksum& mChecksum;
+    std::mt19937_64& mRng;
+    const std::vector<uint8_t>& mBuffer;
+    int mCases = 0;
+    int mMismatches = 0;
+};
+
+/**
+ * A value the checksum can continue from: the initial value, or the checksum of some random bytes,
+ * which for Adler-32 keeps both sums below the modulus like every real checksum.
+ */
+uint32_t RandomInitial(const Checksum& checksum, std::mt19937_64& rng, const std::vector<uint8_t>& buffer) {
+    const uint32_t init = checksum.reference(0, nullptr, 0);
+    if (rng() % 4 == 0) {
+        return init;
+    }
+    return checksum.reference(init, buffer.data() + rng() % kMaxAlignment, size_t(rng() % 100000));
+}
+
+/**
+ * Log-uniform, so that short inputs, which take the most code paths, are as likely as long ones.
+ */
+size_t RandomLength(std::mt19937_64& rng) {
+    const int bits = int(rng() % 21);
+    return std::min(size_t(rng() & ((uint64_t(1) << bits) - 1u)), kMaxRandomLength);
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint64_t seed = 1;
+    int rounds = 2000;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--rounds" && hasValue) {
+            rounds = std::max(0, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> buffer(kMaxRandomLength + kMaxAlignment);
+    for (auto& b: buffer) {
+        b = uint8_t(rng());
+    }
+    printf("%s, seed %" PRIu64 "\n", utils::GetChecksumImplementation(), seed);
+    printf("%-10s %8s  %s\n", "checksum", "cases", "zlib");
+    int mismatches = 0;
+    for (const auto& checksum: kChecksums) {
+        Checker checker(checksum, rng, buffer);
+        for (size_t length: kFixedLengths) {
+            for (size_t alignment = 0; alignment < kMaxAlignment; alignment++) {
+                checker.Run({length, alignment, RandomInitial(checksum, rng, buffer)});
+            }
+        }
+        for (int i = 0; i < rounds; i++) {
+            checker.Run({RandomLength(rng), size_t(rng() % kMaxAlignment), RandomInitial(checksum, rng, buffer)});
+        }
+        printf("%-10s %8d  %s\n", checksum.name, checker.GetCases(), checker.GetMismatches() == 0 ? "ok" : "MISMATCH");
+        mismatches += checker.GetMismatches();
+    }
+    return mismatches == 0 ? 0 : 1;
+}
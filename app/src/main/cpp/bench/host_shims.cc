@@ -0,0 +1,42 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Replacements for the Android-only symbols used by the native code, so that it can run on the host.
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "utils/Log.h"
+
+static const char* PriorityToString(int prio) {
+    switch (prio) {
+        case ANDROID_LOG_VERBOSE:
+            return "V";
+        case ANDROID_LOG_DEBUG:
+            return "D";
+        case ANDROID_LOG_INFO:
+            return "I";
+        case ANDROID_LOG_WARN:
+            return "W";
+        case ANDROID_LOG_ERROR:
+            return "E";
+        case ANDROID_LOG_FATAL:
+            return "F";
+        default:
+            return "?";
+    }
+}
+
+int __android_log_write(int prio, const char* tag, const char* text) {
+    return fprintf(stderr, "%s/%s: %s\n", PriorityToString(prio), tag, text);
+}
+
+int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    char buf[1024];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return __android_log_write(prio, tag, buf);
+}
@@ -0,0 +1,36 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Host replacement for the parts of MMKV.h used outside of MMKV itself, so that the bench does not need
+// the MMKV submodule. Only mmkv::KeyHasher and mmkv::KeyEqualer are provided.
+
+#ifndef QAUXV_BENCH_SHIMS_MMKV_H
+#define QAUXV_BENCH_SHIMS_MMKV_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace mmkv {
+
+struct KeyHasher {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const noexcept {
+        return std::hash<std::string_view>()(key);
+    }
+};
+
+struct KeyEqualer {
+    using is_transparent = void;
+
+    bool operator()(std::string_view lhs, std::string_view rhs) const noexcept {
+        return lhs == rhs;
+    }
+};
+
+}
+
+#endif //QAUXV_BENCH_SHIMS_MMKV_H
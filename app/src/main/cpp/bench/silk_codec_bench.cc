@@ -0,0 +1,324 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Host-side benchmark and bit-exactness check for the Silk encoder used by SilkEncodeUtils
+// and the streaming decoder used by SilkDecodeSession.
+//
+// Usage: silk_codec_bench [options]
+//   --iterations N        encode/decode every case N times and report the fastest run, default 3
+//   --input FILE          benchmark mono PCM16LE from FILE instead of the synthetic signal
+//   --input-rate HZ       sample rate of FILE, it is resampled to every tested rate
+//   --golden FILE         golden file, default silk_golden.txt next to this source
+//   --update-golden       write the hashes of this run to the golden file instead of checking them
+//
+// The golden check only runs for the built-in synthetic signal. The SILK code is fixed-point,
+// so the encoded stream and the decoded PCM must be identical on every architecture.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "qauxv_core/SilkDecoder.h"
+#include "qauxv_core/SilkEncoder.h"
+
+using namespace qauxv::audio;
+
+namespace {
+
+constexpr int kSyntheticSeconds = 10;
+constexpr int kSampleRates[] = {8000, 12000, 16000, 24000};
+constexpr int kBitRates[] = {10000, 24000};
+constexpr int kComplexities[] = {0, 1, 2};
+// input rates fed through PcmFrontend to 24000 Hz, 88200 Hz goes through the SILK pre-downsampler
+constexpr int kResampledInputRates[] = {44100, 88200};
+constexpr int kResampledOutputRate = 24000;
+
+struct BenchCase {
+    int sampleRate;
+    int bitRate;
+    int complexity;
+    // the rate of the synthetic signal before PcmFrontend, 0 if it is generated at sampleRate
+    int inputRate = 0;
+
+    [[nodiscard]] std::string Name() const {
+        if (inputRate != 0) {
+            return fmt::format("in{}_fs{}_br{}_c{}", inputRate, sampleRate, bitRate, complexity);
+        }
+        return fmt::format("fs{}_br{}_c{}", sampleRate, bitRate, complexity);
+    }
+};
+
+struct BenchResult {
+    double encodeSeconds = 0;
+    double decodeSeconds = 0;
+    size_t encodedBytes = 0;
+    uint64_t encodedHash = 0;
+    uint64_t decodedHash = 0;
+};
+
+uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * A speech-like test signal: syllables of a gliding pulse train with formant-ish harmonics and some noise,
+ * separated by pauses. Integer-only, so it is the same on every host.
+ */
+std::vector<int16_t> GenerateSyntheticSpeech(int sampleRate, int seconds) {
+    std::vector<int16_t> out(size_t(sampleRate) * size_t(seconds));
+    uint32_t lcg = 12345;
+    uint32_t phase = 0;
+    const int syllableLength = sampleRate / 4;
+    for (size_t i = 0; i < out.size(); i++) {
+        int syllable = int(i / size_t(syllableLength));
+        int posInSyllable = int(i % size_t(syllableLength));
+        // every 4th syllable is a pause
+        bool voiced = (syllable % 4) != 3;
+        // pitch glides between 120 and 220 Hz, phase is Q32
+        uint32_t pitchHz = 120 + uint32_t((syllable * 37 + posInSyllable / 64) % 100);
+        phase += uint32_t((uint64_t(pitchHz) << 32) / uint32_t(sampleRate));
+        // triangle envelope over the syllable, Q15
+        int env = posInSyllable < syllableLength / 2 ? posInSyllable : syllableLength - posInSyllable;
+        env = int((int64_t(env) << 15) / (syllableLength / 2));
+        // sawtooth plus its 3rd and 7th harmonics
+        int32_t saw = int32_t(phase >> 17) - 16384;
+        int32_t h3 = int32_t((phase * 3u) >> 17) - 16384;
+        int32_t h7 = int32_t((phase * 7u) >> 17) - 16384;
+        int32_t voice = (saw / 2 + h3 / 4 + h7 / 8) * (voiced ? 1 : 0);
+        lcg = lcg * 1664525u + 1013904223u;
+        int32_t noise = int32_t(lcg >> 20) - 2048;
+        int32_t s = int32_t((int64_t(voice) * env) >> 15) + noise / (voiced ? 2 : 16);
+        out[i] = int16_t(std::clamp(s, -32768, 32767));
+    }
+    return out;
+}
+
+std::vector<int16_t> ReadPcmFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "unable to open %s\n", path);
+        exit(2);
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<int16_t> samples(bytes.size() / 2);
+    memcpy(samples.data(), bytes.data(), samples.size() * 2);
+    return samples;
+}
+
+std::vector<int16_t> Resample(const std::vector<int16_t>& input, int inputRate, int outputRate) {
+    std::vector<int16_t> out;
+    PcmFrontend frontend;
+    if (auto err = frontend.Init({PcmSampleFormat::kInt16, 1, inputRate}, outputRate); !err.empty()) {
+        fprintf(stderr, "resampler: %s\n", err.c_str());
+        exit(2);
+    }
+    frontend.Process({reinterpret_cast<const uint8_t*>(input.data()), input.size() * 2}, out);
+    frontend.Flush(out);
+    return out;
+}
+
+/**
+ * Decode a stream written by SilkEncoder with SilkStreamDecoder, fed in small chunks like a network stream.
+ * @return empty string on success, or an error message
+ */
+std::string DecodeSilk(const std::vector<uint8_t>& stream, int sampleRate, std::vector<int16_t>& pcm, SilkStreamDecoder& decoder) {
+    constexpr size_t kChunkSize = 256;
+    if (auto err = decoder.Init(sampleRate); !err.empty()) {
+        return err;
+    }
+    PcmRingBuffer ring(decoder.GetFrameSamples() * 4);
+    std::vector<int16_t> drained(ring.GetCapacity());
+    pcm.clear();
+    size_t offset = 0;
+    while (!decoder.IsFinished()) {
+        if (decoder.NeedsInput()) {
+            const size_t chunk = std::min(kChunkSize, stream.size() - offset);
+            decoder.Feed({stream.data() + offset, chunk});
+            offset += chunk;
+            if (offset == stream.size()) {
+                decoder.EndOfInput();
+            }
+        }
+        if (auto err = decoder.Decode(ring); !err.empty()) {
+            return err;
+        }
+        const size_t n = ring.Read(drained.data(), drained.size());
+        pcm.insert(pcm.end(), drained.begin(), drained.begin() + ptrdiff_t(n));
+    }
+    if (decoder.GetStats().corruptPackets != 0) {
+        return fmt::format("{} corrupt packets", decoder.GetStats().corruptPackets);
+    }
+    return {};
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+BenchResult RunCase(const BenchCase& c, const std::vector<int16_t>& pcm, int iterations, SilkEncoder& encoder,
+                    SilkStreamDecoder& decoder) {
+    BenchResult result;
+    result.encodeSeconds = 1e30;
+    result.decodeSeconds = 1e30;
+    SilkEncoderOptions options;
+    options.sampleRate = c.sampleRate;
+    options.bitRate = c.bitRate;
+    options.packetSize = c.sampleRate * 20 / 1000;
+    options.complexity = c.complexity;
+    options.tencent = true;
+    std::span<const uint8_t> input(reinterpret_cast<const uint8_t*>(pcm.data()), pcm.size() * 2);
+    std::vector<uint8_t> encoded;
+    std::vector<int16_t> decoded;
+    for (int i = 0; i < iterations; i++) {
+        encoded.clear();
+        auto start = std::chrono::steady_clock::now();
+        std::string err = encoder.Encode(input, options, [&encoded](const void* data, size_t size) {
+            encoded.insert(encoded.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+            return 0;
+        });
+        result.encodeSeconds = std::min(result.encodeSeconds, SecondsSince(start));
+        if (!err.empty()) {
+            fprintf(stderr, "%s: encode: %s\n", c.Name().c_str(), err.c_str());
+            exit(2);
+        }
+        start = std::chrono::steady_clock::now();
+        err = DecodeSilk(encoded, c.sampleRate, decoded, decoder);
+        result.decodeSeconds = std::min(result.decodeSeconds, SecondsSince(start));
+        if (!err.empty()) {
+            fprintf(stderr, "%s: decode: %s\n", c.Name().c_str(), err.c_str());
+            exit(2);
+        }
+    }
+    result.encodedBytes = encoded.size();
+    result.encodedHash = Fnv1a64(encoded.data(), encoded.size());
+    result.decodedHash = Fnv1a64(decoded.data(), decoded.size() * sizeof(int16_t));
+    return result;
+}
+
+std::map<std::string, std::pair<uint64_t, uint64_t>> LoadGolden(const std::string& path) {
+    std::map<std::string, std::pair<uint64_t, uint64_t>> golden;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream ss(line);
+        std::string name;
+        std::string enc;
+        std::string dec;
+        if (ss >> name >> enc >> dec) {
+            golden[name] = {strtoull(enc.c_str(), nullptr, 16), strtoull(dec.c_str(), nullptr, 16)};
+        }
+    }
+    return golden;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int iterations = 3;
+    const char* inputPath = nullptr;
+    int inputRate = 0;
+    std::string goldenPath = std::string(QAUXV_BENCH_SOURCE_DIR) + "/silk_golden.txt";
+    bool updateGolden = false;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--iterations" && hasValue) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--input" && hasValue) {
+            inputPath = argv[++i];
+        } else if (arg == "--input-rate" && hasValue) {
+            inputRate = atoi(argv[++i]);
+        } else if (arg == "--golden" && hasValue) {
+            goldenPath = argv[++i];
+        } else if (arg == "--update-golden") {
+            updateGolden = true;
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (inputPath != nullptr && inputRate == 0) {
+        fprintf(stderr, "--input requires --input-rate\n");
+        return 2;
+    }
+    const bool checkGolden = inputPath == nullptr && !updateGolden;
+    auto golden = checkGolden ? LoadGolden(goldenPath) : decltype(LoadGolden(goldenPath)) {};
+    std::vector<int16_t> fileInput = inputPath != nullptr ? ReadPcmFile(inputPath) : std::vector<int16_t>();
+    std::string goldenOut = "# generated by silk_codec_bench --update-golden\n# case encoded_fnv1a64 decoded_fnv1a64\n";
+    int mismatches = 0;
+    SilkEncoder encoder;
+    SilkStreamDecoder decoder;
+    auto runCase = [&](const BenchCase& c, const std::vector<int16_t>& pcm) {
+        const double audioSeconds = double(pcm.size()) / c.sampleRate;
+        BenchResult r = RunCase(c, pcm, iterations, encoder, decoder);
+        std::string name = c.Name();
+        const char* status = "-";
+        if (checkGolden) {
+            auto it = golden.find(name);
+            if (it == golden.end()) {
+                status = "missing";
+            } else if (it->second.first != r.encodedHash || it->second.second != r.decodedHash) {
+                status = "MISMATCH";
+                mismatches++;
+            } else {
+                status = "ok";
+            }
+        }
+        goldenOut += fmt::format("{} {:016x} {:016x}\n", name, r.encodedHash, r.decodedHash);
+        printf("%-26s %10.2f %9.4f %10.2f %9.4f %9zu  %s\n", name.c_str(),
+               r.encodeSeconds * 1000, r.encodeSeconds / audioSeconds,
+               r.decodeSeconds * 1000, r.decodeSeconds / audioSeconds,
+               r.encodedBytes, status);
+    };
+    printf("%-26s %10s %9s %10s %9s %9s  %s\n", "case", "enc_ms", "enc_rtf", "dec_ms", "dec_rtf", "bytes", "golden");
+    for (int sampleRate: kSampleRates) {
+        std::vector<int16_t> pcm = inputPath != nullptr ? Resample(fileInput, inputRate, sampleRate)
+                                                        : GenerateSyntheticSpeech(sampleRate, kSyntheticSeconds);
+        for (int bitRate: kBitRates) {
+            for (int complexity: kComplexities) {
+                runCase({sampleRate, bitRate, complexity}, pcm);
+            }
+        }
+    }
+    if (inputPath == nullptr) {
+        // the front-end must produce exactly the proportional number of samples, a dropped sample per batch
+        // would also change the hashes, but this points at the cause
+        for (int rate: kResampledInputRates) {
+            std::vector<int16_t> pcm = Resample(GenerateSyntheticSpeech(rate, kSyntheticSeconds), rate, kResampledOutputRate);
+            if (pcm.size() != size_t(kResampledOutputRate) * kSyntheticSeconds) {
+                printf("in%d: resampled to %zu samples, expected %d\n", rate, pcm.size(), kResampledOutputRate * kSyntheticSeconds);
+                mismatches++;
+            }
+            runCase({kResampledOutputRate, 24000, 1, rate}, pcm);
+        }
+    }
+    if (updateGolden) {
+        std::ofstream out(goldenPath, std::ios::trunc);
+        out << goldenOut;
+        printf("golden written to %s\n", goldenPath.c_str());
+    }
+    if (mismatches != 0) {
+        printf("%d case(s) differ from %s\n", mismatches, goldenPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,588 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Host-side benchmarks for the utilities in utils/ and misc/.
+//
+// Real ELF files are taken from the shared objects loaded into this process (libc, libstdc++, ...),
+// extra ones may be listed in QAUXV_BENCH_ELF_FILES, separated by ':'.
+// Use --benchmark_format=json or --benchmark_out=<file> --benchmark_out_format=json to get results
+// which can be compared across commits with google-benchmark's tools/compare.py.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+#include <zlib.h>
+
+#ifdef QAUXV_BENCH_HAVE_XZ
+#include <lzma.h>
+#endif
+
+#include "misc/apk_signing_block.h"
+#include "misc/md5.h"
+#include "misc/md5_batch.h"
+#include "utils/Arm64XrefIndex.h"
+#include "utils/Checksum.h"
+#include "utils/ElfImageLayout.h"
+#include "utils/ElfScan.h"
+#include "utils/ElfView.h"
+#include "utils/FileMemMap.h"
+#include "utils/MemoryUtils.h"
+#include "utils/TextUtils.h"
+#include "utils/byte_array_output_stream.h"
+#include "utils/xz_decoder.h"
+
+namespace {
+
+uint64_t NextRandom(uint64_t& state) noexcept {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+std::vector<uint8_t> MakeRandomBytes(size_t size, uint64_t seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t v = NextRandom(seed);
+        memcpy(data.data() + i, &v, std::min<size_t>(8, size - i));
+    }
+    return data;
+}
+
+/**
+ * A page aligned ELF64 file image with a single R+X PT_LOAD segment covering the whole image,
+ * filled with random bytes. It is what FindByteSequenceImpl sees for a large stripped library.
+ */
+class SyntheticElfImage {
+public:
+    explicit SyntheticElfImage(size_t size) : mSize(size) {
+        // IsMemoryReadable(ptr, length) also probes the page right after the range when the range ends
+        // on a page boundary, so keep one more readable page mapped, like the tail of a real file mapping
+        mMapLength = size + utils::GetPageSize();
+        mAddress = mmap(nullptr, mMapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mAddress == MAP_FAILED) {
+            mAddress = nullptr;
+            return;
+        }
+        auto* base = static_cast<uint8_t*>(mAddress);
+        uint64_t seed = 0x9e3779b97f4a7c15ULL ^ size;
+        for (size_t i = 0; i < size; i += 8) {
+            uint64_t v = NextRandom(seed);
+            memcpy(base + i, &v, 8);
+        }
+        Elf64_Ehdr ehdr = {};
+        memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+        ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+        ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+        ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+        ehdr.e_type = ET_DYN;
+        ehdr.e_machine = EM_AARCH64;
+        ehdr.e_version = EV_CURRENT;
+        ehdr.e_phoff = sizeof(Elf64_Ehdr);
+        ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+        ehdr.e_phentsize = sizeof(Elf64_Phdr);
+        ehdr.e_phnum = 1;
+        Elf64_Phdr phdr = {};
+        phdr.p_type = PT_LOAD;
+        phdr.p_flags = PF_R | PF_X;
+        phdr.p_filesz = size;
+        phdr.p_memsz = size;
+        phdr.p_align = 0x4000;
+        memcpy(base, &ehdr, sizeof(ehdr));
+        memcpy(base + sizeof(ehdr), &phdr, sizeof(phdr));
+        mprotect(mAddress, mMapLength, PROT_READ);
+    }
+
+    ~SyntheticElfImage() noexcept {
+        if (mAddress != nullptr) {
+            munmap(mAddress, mMapLength);
+        }
+    }
+
+    SyntheticElfImage(const SyntheticElfImage&) = delete;
+
+    SyntheticElfImage& operator=(const SyntheticElfImage&) = delete;
+
+    [[nodiscard]] const void* GetAddress() const noexcept {
+        return mAddress;
+    }
+
+    [[nodiscard]] size_t GetSize() const noexcept {
+        return mSize;
+    }
+
+private:
+    void* mAddress = nullptr;
+    size_t mSize = 0;
+    size_t mMapLength = 0;
+};
+
+std::vector<std::string> FindHostElfFiles() {
+    std::vector<std::string> files;
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) -> int {
+        auto* out = static_cast<std::vector<std::string>*>(data);
+        if (info->dlpi_name != nullptr && info->dlpi_name[0] == '/') {
+            out->emplace_back(info->dlpi_name);
+        }
+        return 0;
+    }, &files);
+    if (const char* extra = getenv("QAUXV_BENCH_ELF_FILES"); extra != nullptr) {
+        for (auto& path: utils::SplitString(extra, ":")) {
+            if (!path.empty()) {
+                files.push_back(path);
+            }
+        }
+    }
+    return files;
+}
+
+std::string BaseName(const std::string& path) {
+    return utils::LastPartOf(path, "/");
+}
+
+// an aarch64 function prologue, "stp x29, x30, [sp, #-0x?0]!" followed by "mov x29, sp"
+constexpr uint8_t kPrologueSequence[] = {0xfd, 0x7b, 0xbf, 0xa9, 0xfd, 0x03, 0x00, 0x91};
+constexpr uint8_t kPrologueMask[] = {0xff, 0xff, 0xc0, 0xff, 0xff, 0xff, 0xff, 0xff};
+// not expected to be present anywhere, so that the whole image is scanned
+constexpr uint8_t kAbsentSequence[] = {0xde, 0xc0, 0xad, 0x0b, 0x0d, 0xf0, 0xfe, 0xca};
+
+void BM_ElfViewAttachFile(benchmark::State& state, const std::string& path) {
+    FileMemMap map;
+    if (int err = map.mapFilePath(path.c_str()); err != 0) {
+        state.SkipWithError(strerror(err));
+        return;
+    }
+    for (auto _: state) {
+        utils::ElfView view;
+        view.AttachFileMemMapping(map.getAddress(), map.getLength());
+        benchmark::DoNotOptimize(view.IsValid());
+    }
+    state.counters["file_bytes"] = double(map.getLength());
+}
+
+void BM_ElfViewGetSymbolOffset(benchmark::State& state, const std::string& path) {
+    FileMemMap map;
+    if (int err = map.mapFilePath(path.c_str()); err != 0) {
+        state.SkipWithError(strerror(err));
+        return;
+    }
+    utils::ElfView view;
+    view.AttachFileMemMapping(map.getAddress(), map.getLength());
+    if (!view.IsValid()) {
+        state.SkipWithError("invalid ELF");
+        return;
+    }
+    for (auto _: state) {
+        benchmark::DoNotOptimize(view.GetSymbolOffset("malloc"));
+        benchmark::DoNotOptimize(view.GetSymbolOffset("qauxv_bench_no_such_symbol"));
+    }
+}
+
+void BM_FindByteSequenceFileImage(benchmark::State& state, const std::string& path) {
+    FileMemMap map;
+    if (int err = map.mapFilePath(path.c_str()); err != 0) {
+        state.SkipWithError(strerror(err));
+        return;
+    }
+    for (auto _: state) {
+        auto result = utils::FindByteSequenceImpl(map.getAddress(), false, kAbsentSequence, {}, true, 4, std::nullopt);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(map.getLength()));
+}
+
+// range(0): image size in MiB, range(1): step, range(2): 1 to use the mask
+void BM_FindByteSequenceSynthetic(benchmark::State& state) {
+    SyntheticElfImage image(size_t(state.range(0)) << 20);
+    if (image.GetAddress() == nullptr) {
+        state.SkipWithError("mmap failed");
+        return;
+    }
+    const int step = int(state.range(1));
+    const bool masked = state.range(2) != 0;
+    std::span<const uint8_t> sequence = masked ? std::span<const uint8_t>(kPrologueSequence) : std::span<const uint8_t>(kAbsentSequence);
+    std::span<const uint8_t> mask = masked ? std::span<const uint8_t>(kPrologueMask) : std::span<const uint8_t>();
+    for (auto _: state) {
+        auto result = utils::FindByteSequenceImpl(image.GetAddress(), false, sequence, mask, true, step, std::nullopt);
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(image.GetSize()));
+}
+
+BENCHMARK(BM_FindByteSequenceSynthetic)
+        ->ArgNames({"MiB", "step", "masked"})
+        ->ArgsProduct({{16, 128}, {1, 4}, {0, 1}})
+        ->Unit(benchmark::kMillisecond);
+
+// range(0): image size in MiB, range(1): threads; random bytes decode to a B, BL or ADRP every few instructions
+void BM_Arm64XrefIndexBuild(benchmark::State& state) {
+    SyntheticElfImage image(size_t(state.range(0)) << 20);
+    utils::ElfImageLayout layout;
+    if (image.GetAddress() == nullptr || !layout.Parse(image.GetAddress(), false).empty()) {
+        state.SkipWithError("unable to create the image");
+        return;
+    }
+    size_t refCount = 0;
+    for (auto _: state) {
+        utils::Arm64XrefIndex index;
+        if (std::string err = index.Build(layout, unsigned(state.range(1))); !err.empty()) {
+            state.SkipWithError(err.c_str());
+            break;
+        }
+        refCount = index.GetCodeReferences().size() + index.GetDataReferences().size();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(image.GetSize()));
+    state.counters["refs"] = double(refCount);
+}
+
+BENCHMARK(BM_Arm64XrefIndexBuild)->ArgNames({"MiB", "threads"})->ArgsProduct({{16}, {1, 4}})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_GetProcessMemoryMaps(benchmark::State& state) {
+    size_t count = 0;
+    for (auto _: state) {
+        auto maps = utils::GetProcessMemoryMaps();
+        count = maps.size();
+        benchmark::DoNotOptimize(maps.data());
+    }
+    state.counters["entries"] = double(count);
+}
+
+BENCHMARK(BM_GetProcessMemoryMaps)->Unit(benchmark::kMicrosecond);
+
+#ifdef QAUXV_BENCH_HAVE_XZ
+
+// range(0): uncompressed size in KiB
+void BM_DecodeXzData(benchmark::State& state) {
+    // half text-like, half random, so that it compresses like a symbol table
+    const size_t size = size_t(state.range(0)) << 10;
+    std::vector<uint8_t> plain = MakeRandomBytes(size, 42);
+    for (size_t i = 0; i < size / 2; i++) {
+        plain[i] = uint8_t('a' + plain[i] % 16);
+    }
+    std::vector<uint8_t> compressed(lzma_stream_buffer_bound(size));
+    size_t compressedSize = 0;
+    if (lzma_easy_buffer_encode(6, LZMA_CHECK_CRC64, nullptr, plain.data(), plain.size(),
+                                compressed.data(), &compressedSize, compressed.size()) != LZMA_OK) {
+        state.SkipWithError("lzma_easy_buffer_encode failed");
+        return;
+    }
+    compressed.resize(compressedSize);
+    for (auto _: state) {
+        bool success = false;
+        auto out = util::DecodeXzData(compressed, &success, nullptr);
+        if (!success || out.size() != size) {
+            state.SkipWithError("DecodeXzData failed");
+            break;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(size));
+    state.counters["ratio"] = double(size) / double(compressedSize);
+}
+
+BENCHMARK(BM_DecodeXzData)->ArgName("KiB")->Arg(64)->Arg(1024)->Arg(8192)->Unit(benchmark::kMillisecond);
+
+#endif
+
+// range(0): size of each write, 4 MiB in total
+void BM_ByteArrayOutputStreamWrite(benchmark::State& state) {
+    const size_t chunkSize = size_t(state.range(0));
+    const size_t totalSize = 4u << 20;
+    std::vector<uint8_t> chunk = MakeRandomBytes(chunkSize, 7);
+    for (auto _: state) {
+        util::ByteArrayOutputStream out;
+        for (size_t written = 0; written < totalSize; written += chunkSize) {
+            out.Write(chunk.data(), int64_t(chunkSize));
+        }
+        auto bytes = out.GetBytes();
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(totalSize));
+}
+
+BENCHMARK(BM_ByteArrayOutputStreamWrite)->ArgName("chunk")->Arg(16)->Arg(1000)->Arg(4096)->Arg(65536)
+        ->Unit(benchmark::kMillisecond);
+
+// range(0): message size in bytes
+void BM_MD5(benchmark::State& state) {
+    std::vector<uint8_t> bytes = MakeRandomBytes(size_t(state.range(0)), 3);
+    std::string message(bytes.begin(), bytes.end());
+    for (auto _: state) {
+        MD5 md5(message);
+        benchmark::DoNotOptimize(md5.getDigest());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+// the typical inputs are uin strings, which are shorter than one block
+BENCHMARK(BM_MD5)->ArgName("bytes")->Arg(10)->Arg(64)->Arg(4096)->Arg(65536);
+
+// range(0): number of 10 digit uins, hashed one by one with MD5 vs. in one ComputeMd5Batch call
+void BM_Md5UinsSingle(benchmark::State& state) {
+    std::vector<std::string> uins;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        uins.push_back(std::to_string(1000000000 + i * 7919));
+    }
+    for (auto _: state) {
+        for (const auto& uin: uins) {
+            MD5 md5(uin);
+            benchmark::DoNotOptimize(md5.getDigest());
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_Md5UinsSingle)->ArgName("uins")->Arg(8)->Arg(4096);
+
+void BM_Md5UinsBatch(benchmark::State& state) {
+    std::vector<std::string> uins;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        uins.push_back(std::to_string(1000000000 + i * 7919));
+    }
+    std::vector<std::string_view> messages(uins.begin(), uins.end());
+    std::vector<misc::Md5Digest> digests(messages.size());
+    for (auto _: state) {
+        misc::ComputeMd5Batch(messages, digests);
+        benchmark::DoNotOptimize(digests.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_Md5UinsBatch)->ArgName("uins")->Arg(8)->Arg(4096);
+
+// range(0): message size in bytes, compare with BM_Adler32Zlib and BM_Crc32Zlib
+void BM_Adler32(benchmark::State& state) {
+    std::vector<uint8_t> bytes = MakeRandomBytes(size_t(state.range(0)), 4);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(utils::UpdateAdler32(utils::kAdler32Init, bytes.data(), bytes.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+    state.SetLabel(utils::GetChecksumImplementation());
+}
+
+void BM_Adler32Zlib(benchmark::State& state) {
+    std::vector<uint8_t> bytes = MakeRandomBytes(size_t(state.range(0)), 4);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(adler32(1, bytes.data(), uInt(bytes.size())));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+void BM_Crc32(benchmark::State& state) {
+    std::vector<uint8_t> bytes = MakeRandomBytes(size_t(state.range(0)), 4);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(utils::UpdateCrc32(utils::kCrc32Init, bytes.data(), bytes.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+    state.SetLabel(utils::GetChecksumImplementation());
+}
+
+void BM_Crc32Zlib(benchmark::State& state) {
+    std::vector<uint8_t> bytes = MakeRandomBytes(size_t(state.range(0)), 4);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(crc32(0, bytes.data(), uInt(bytes.size())));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BM_Adler32)->ArgName("bytes")->Arg(76)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Adler32Zlib)->ArgName("bytes")->Arg(76)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Crc32)->ArgName("bytes")->Arg(76)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_Crc32Zlib)->ArgName("bytes")->Arg(76)->Arg(4096)->Arg(1 << 20);
+
+// a minimal APK: range(0) MiB of entry data, a signing block with a v2 signer, an empty central directory and the EOCD
+std::vector<uint8_t> MakeSignedApk(size_t dataSize) {
+    auto putLe = [](std::vector<uint8_t>& out, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            out.push_back(uint8_t(value >> (i * 8)));
+        }
+    };
+    auto lengthPrefixed = [](const std::vector<uint8_t>& body) {
+        std::vector<uint8_t> out(4 + body.size());
+        for (size_t i = 0; i < 4; i++) {
+            out[i] = uint8_t(body.size() >> (i * 8));
+        }
+        std::copy(body.begin(), body.end(), out.begin() + 4);
+        return out;
+    };
+    std::vector<uint8_t> certificate = MakeRandomBytes(700, 5);
+    std::vector<uint8_t> certificates = lengthPrefixed(certificate);
+    std::vector<uint8_t> signedData = lengthPrefixed({});
+    auto certificatesBlock = lengthPrefixed(certificates);
+    signedData.insert(signedData.end(), certificatesBlock.begin(), certificatesBlock.end());
+    std::vector<uint8_t> v2Block = lengthPrefixed(lengthPrefixed(lengthPrefixed(signedData)));
+    std::vector<uint8_t> pairs;
+    putLe(pairs, v2Block.size() + 4, 8);
+    putLe(pairs, misc::kApkSignatureSchemeV2BlockId, 4);
+    pairs.insert(pairs.end(), v2Block.begin(), v2Block.end());
+    std::vector<uint8_t> apk = MakeRandomBytes(dataSize, 6);
+    const uint64_t blockSize = pairs.size() + 24;
+    putLe(apk, blockSize, 8);
+    apk.insert(apk.end(), pairs.begin(), pairs.end());
+    putLe(apk, blockSize, 8);
+    const char* magic = "APK Sig Block 42";
+    apk.insert(apk.end(), magic, magic + 16);
+    const size_t centralDirOffset = apk.size();
+    putLe(apk, 0x06054b50u, 4);
+    putLe(apk, 0, 8);
+    putLe(apk, 0, 4);
+    putLe(apk, centralDirOffset, 4);
+    putLe(apk, 0, 2);
+    return apk;
+}
+
+// range(0): APK size in MiB, the lookup goes through the EOCD so it should not depend on it
+void BM_FindApkV2Certificate(benchmark::State& state) {
+    std::vector<uint8_t> apk = MakeSignedApk(size_t(state.range(0)) << 20);
+    for (auto _: state) {
+        auto block = misc::FindApkSigningBlock(utils::BinarySpan(apk.data(), apk.size()));
+        auto v2Block = misc::FindApkSigningBlockValue(*block, misc::kApkSignatureSchemeV2BlockId);
+        auto certificate = misc::GetV2FirstSignerCertificate(*v2Block);
+        if (!certificate || certificate->size() != 700) {
+            state.SkipWithError("bad certificate");
+            break;
+        }
+        benchmark::DoNotOptimize(certificate->data());
+    }
+}
+
+BENCHMARK(BM_FindApkV2Certificate)->ArgName("MiB")->Arg(1)->Arg(64);
+
+// a 64 MiB temporary file, created on first use and removed by RemoveColdScanFile
+// it must not be on tmpfs for the page cache to be dropped, hence /var/tmp unless TMPDIR says otherwise
+std::string gColdScanFilePath;
+
+const std::string& GetColdScanFilePath() {
+    if (!gColdScanFilePath.empty()) {
+        return gColdScanFilePath;
+    }
+    const char* tmpDir = getenv("TMPDIR");
+    std::string p = std::string(tmpDir != nullptr && tmpDir[0] != '\0' ? tmpDir : "/var/tmp") + "/qauxv_bench_cold_scan.XXXXXX";
+    int fd = mkostemp(p.data(), O_CLOEXEC);
+    if (fd < 0) {
+        return gColdScanFilePath;
+    }
+    gColdScanFilePath = std::move(p);
+    std::vector<uint8_t> chunk = MakeRandomBytes(1u << 20, 9);
+    for (int i = 0; i < 64; i++) {
+        if (write(fd, chunk.data(), chunk.size()) != ssize_t(chunk.size())) {
+            break;
+        }
+    }
+    fsync(fd);
+    close(fd);
+    return gColdScanFilePath;
+}
+
+void RemoveColdScanFile() {
+    if (!gColdScanFilePath.empty()) {
+        unlink(gColdScanFilePath.c_str());
+        gColdScanFilePath.clear();
+    }
+}
+
+// range(0): the FileMemMap::AccessHint, or -1 for kNormal followed by prefetch()
+// every iteration drops the file from the page cache, then maps it and reads one byte per cache line
+void BM_ScanColdFile(benchmark::State& state) {
+    const std::string& path = GetColdScanFilePath();
+    if (path.empty()) {
+        state.SkipWithError("unable to create the temporary file");
+        return;
+    }
+    const auto hintArg = state.range(0);
+    const auto hint = hintArg < 0 ? FileMemMap::AccessHint::kNormal : FileMemMap::AccessHint(hintArg);
+    for (auto _: state) {
+        state.PauseTiming();
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0) {
+            state.SkipWithError("unable to drop the page cache");
+            break;
+        }
+        close(fd);
+        state.ResumeTiming();
+        FileMemMap map;
+        if (int err = map.mapFilePath(path.c_str(), true, 0, hint); err != 0) {
+            state.SkipWithError(strerror(err));
+            break;
+        }
+        if (hintArg < 0) {
+            (void) map.prefetch();
+        }
+        const auto* p = static_cast<const volatile uint8_t*>(map.getAddress());
+        uint32_t sum = 0;
+        for (size_t i = 0; i < map.getLength(); i += 64) {
+            sum += p[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) << 26);
+}
+
+BENCHMARK(BM_ScanColdFile)->ArgName("hint")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(-1)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// range(0): number of /proc/self/maps copies
+void BM_SplitString(benchmark::State& state) {
+    std::string maps;
+    {
+        FILE* fp = fopen("/proc/self/maps", "r");
+        char buf[4096];
+        size_t n;
+        while (fp != nullptr && (n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+            maps.append(buf, n);
+        }
+        if (fp != nullptr) {
+            fclose(fp);
+        }
+    }
+    std::string text;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        text += maps;
+    }
+    for (auto _: state) {
+        auto lines = utils::SplitString(text, "\n");
+        benchmark::DoNotOptimize(lines.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(BM_SplitString)->ArgName("copies")->Arg(1)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+void RegisterHostElfBenchmarks() {
+    for (const auto& path: FindHostElfFiles()) {
+        std::string name = BaseName(path);
+        benchmark::RegisterBenchmark(("BM_ElfViewAttachFile/" + name).c_str(), BM_ElfViewAttachFile, path)
+                ->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("BM_ElfViewGetSymbolOffset/" + name).c_str(), BM_ElfViewGetSymbolOffset, path);
+        benchmark::RegisterBenchmark(("BM_FindByteSequenceFileImage/" + name).c_str(), BM_FindByteSequenceFileImage, path)
+                ->Unit(benchmark::kMillisecond);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    RegisterHostElfBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    RemoveColdScanFile();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,18 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+// Used instead of utils/xz_decoder.cc when the LZMA SDK sources are not available on the host.
+// ElfView then simply skips MiniDebugInfo, like it does for a corrupted .gnu_debugdata section.
+
+#include "utils/xz_decoder.h"
+
+std::vector<uint8_t> util::DecodeXzData(std::span<const uint8_t>, bool* isSuccess, std::string* errorMsg) {
+    if (isSuccess) {
+        *isSuccess = false;
+    }
+    if (errorMsg) {
+        *errorMsg = "xz decoder is not available in this build";
+    }
+    return {};
+}
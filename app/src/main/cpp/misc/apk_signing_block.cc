@@ -0,0 +1,100 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "apk_signing_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/ZipArchive.h"
+
+namespace misc {
+
+using utils::BinaryCursor;
+using utils::BinarySpan;
+
+static constexpr char kApkSigningBlockMagic[16] = {'A', 'P', 'K', ' ', 'S', 'i', 'g', ' ', 'B', 'l', 'o', 'c', 'k', ' ', '4', '2'};
+// the size field and the magic after the pairs
+static constexpr size_t kApkSigningBlockFooterSize = 8 + sizeof(kApkSigningBlockMagic);
+
+static std::optional<uint32_t> FindCentralDirectoryOffset(BinarySpan apk) noexcept {
+    const auto eocd = utils::FindZipEndOfCentralDirectory(apk);
+    // the central directory comes before the record
+    if (!eocd || eocd->centralDirOffset > eocd->recordOffset) {
+        return std::nullopt;
+    }
+    return eocd->centralDirOffset;
+}
+
+std::optional<BinarySpan> FindApkSigningBlock(BinarySpan apk) noexcept {
+    const auto centralDirOffset = FindCentralDirectoryOffset(apk);
+    if (!centralDirOffset || *centralDirOffset < kApkSigningBlockFooterSize + 8) {
+        return std::nullopt;
+    }
+    const size_t footerOffset = *centralDirOffset - kApkSigningBlockFooterSize;
+    uint64_t sizeInFooter = 0;
+    if (!apk.ReadLe(footerOffset, sizeInFooter)
+            || memcmp(apk.data() + footerOffset + 8, kApkSigningBlockMagic, sizeof(kApkSigningBlockMagic)) != 0) {
+        return std::nullopt;
+    }
+    // the size counts everything but the leading size field
+    if (sizeInFooter < kApkSigningBlockFooterSize || sizeInFooter > *centralDirOffset - 8) {
+        return std::nullopt;
+    }
+    const size_t blockOffset = *centralDirOffset - size_t(sizeInFooter) - 8;
+    uint64_t sizeInHeader = 0;
+    if (!apk.ReadLe(blockOffset, sizeInHeader) || sizeInHeader != sizeInFooter) {
+        return std::nullopt;
+    }
+    return apk.Slice(blockOffset + 8, size_t(sizeInFooter) - kApkSigningBlockFooterSize);
+}
+
+std::optional<BinarySpan> FindApkSigningBlockValue(BinarySpan pairs, uint32_t id) noexcept {
+    BinaryCursor cursor(pairs);
+    while (!cursor.AtEnd()) {
+        BinarySpan pair;
+        uint32_t pairId = 0;
+        if (!cursor.ReadLengthPrefixedLe<uint64_t>(pair) || !pair.ReadLe(0, pairId)) {
+            return std::nullopt;
+        }
+        if (pairId == id) {
+            return pair.SliceFrom(4);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<BinarySpan> GetV2FirstSignerCertificate(BinarySpan v2Block) noexcept {
+    // signers, signer, signed data, digests, certificates and certificate are all uint32 length-prefixed
+    BinarySpan signers;
+    BinarySpan signer;
+    BinarySpan signedData;
+    BinarySpan digests;
+    BinarySpan certificates;
+    BinarySpan certificate;
+    BinaryCursor blockCursor(v2Block);
+    if (!blockCursor.ReadLengthPrefixedLe<uint32_t>(signers)) {
+        return std::nullopt;
+    }
+    BinaryCursor signersCursor(signers);
+    if (!signersCursor.ReadLengthPrefixedLe<uint32_t>(signer)) {
+        return std::nullopt;
+    }
+    BinaryCursor signerCursor(signer);
+    if (!signerCursor.ReadLengthPrefixedLe<uint32_t>(signedData)) {
+        return std::nullopt;
+    }
+    BinaryCursor signedDataCursor(signedData);
+    if (!signedDataCursor.ReadLengthPrefixedLe<uint32_t>(digests)
+            || !signedDataCursor.ReadLengthPrefixedLe<uint32_t>(certificates)) {
+        return std::nullopt;
+    }
+    BinaryCursor certificatesCursor(certificates);
+    if (!certificatesCursor.ReadLengthPrefixedLe<uint32_t>(certificate)) {
+        return std::nullopt;
+    }
+    return certificate;
+}
+
+}
@@ -0,0 +1,43 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_APK_SIGNING_BLOCK_H
+#define QAUXV_APK_SIGNING_BLOCK_H
+
+#include <cstdint>
+#include <optional>
+
+#include "utils/BinaryCursor.h"
+
+namespace misc {
+
+// see https://source.android.com/docs/security/features/apksigning/v2
+constexpr uint32_t kApkSignatureSchemeV2BlockId = 0x7109871a;
+
+/**
+ * Locate the APK Signing Block, which sits right before the central directory.
+ * The central directory is found through the end of central directory record, no local file header is read.
+ * @param apk the whole APK file
+ * @return the ID-value pairs of the block, without the size fields and the magic, or nullopt if there is none
+ */
+[[nodiscard]] std::optional<utils::BinarySpan> FindApkSigningBlock(utils::BinarySpan apk) noexcept;
+
+/**
+ * Find the value of an ID-value pair of an APK Signing Block.
+ * @param pairs the pairs, see FindApkSigningBlock
+ * @param id the block id, e.g. kApkSignatureSchemeV2BlockId
+ * @return the value, or nullopt if not found or the pairs are malformed
+ */
+[[nodiscard]] std::optional<utils::BinarySpan> FindApkSigningBlockValue(utils::BinarySpan pairs, uint32_t id) noexcept;
+
+/**
+ * Get the first certificate of the first signer of an APK Signature Scheme v2 block.
+ * @param v2Block the value of the v2 pair
+ * @return the DER encoded X.509 certificate, or nullopt if the block is malformed
+ */
+[[nodiscard]] std::optional<utils::BinarySpan> GetV2FirstSignerCertificate(utils::BinarySpan v2Block) noexcept;
+
+}
+
+#endif //QAUXV_APK_SIGNING_BLOCK_H
@@ -0,0 +1,209 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "md5_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace misc {
+
+namespace {
+
+// 8 lanes of 32 bits, two q registers on arm64, one ymm register with AVX2, two xmm registers with SSE2
+using LaneVector = uint32_t __attribute__((vector_size(32)));
+constexpr size_t kLaneCount = sizeof(LaneVector) / sizeof(uint32_t);
+
+constexpr std::array<uint32_t, 64> kSineTable = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+constexpr std::array<int, 64> kShifts = {
+        7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+        5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+        4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+        6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+};
+
+constexpr std::array<uint32_t, 4> kInitialState = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+// in place, a LaneVector passed or returned by value changes the ABI with the vector extensions enabled (-Wpsabi)
+template<typename T>
+inline void RotateLeft(T& x, int s) noexcept {
+    x = (x << s) | (x >> (32 - s));
+}
+
+/**
+ * One MD5 block transform. T is uint32_t for the scalar core or LaneVector for the multi-lane core,
+ * the loop is fully unrolled by the compiler since all indices are constant.
+ */
+template<typename T>
+inline void TransformBlock(T (& state)[4], const T (& w)[16]) noexcept {
+    T a = state[0];
+    T b = state[1];
+    T c = state[2];
+    T d = state[3];
+#pragma GCC unroll 64
+    for (int i = 0; i < 64; i++) {
+        T f;
+        int g;
+        if (i < 16) {
+            f = d ^ (b & (c ^ d));
+            g = i;
+        } else if (i < 32) {
+            f = c ^ (d & (b ^ c));
+            g = (5 * i + 1) & 15;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) & 15;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) & 15;
+        }
+        const T tmp = d;
+        d = c;
+        c = b;
+        T sum = a + f + kSineTable[i] + w[g];
+        RotateLeft(sum, kShifts[i]);
+        b = b + sum;
+        a = tmp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+inline uint32_t LoadLe32(const uint8_t* p) noexcept {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+inline void StoreDigest(const uint32_t (& state)[4], Md5Digest& digest) noexcept {
+    for (int i = 0; i < 4; i++) {
+        digest[i * 4 + 0] = uint8_t(state[i]);
+        digest[i * 4 + 1] = uint8_t(state[i] >> 8);
+        digest[i * 4 + 2] = uint8_t(state[i] >> 16);
+        digest[i * 4 + 3] = uint8_t(state[i] >> 24);
+    }
+}
+
+/**
+ * Build the padded single block of a message no longer than kMd5BatchMaxSingleBlockMessage.
+ */
+inline void BuildSingleBlock(std::string_view message, uint8_t (& block)[64]) noexcept {
+    memset(block, 0, sizeof(block));
+    memcpy(block, message.data(), message.size());
+    block[message.size()] = 0x80;
+    const uint64_t bits = uint64_t(message.size()) * 8;
+    for (int i = 0; i < 8; i++) {
+        block[56 + i] = uint8_t(bits >> (8 * i));
+    }
+}
+
+/**
+ * Hash up to kLaneCount single-block messages, unused lanes hash an empty message and are discarded.
+ */
+void ComputeSingleBlockLanes(const std::string_view* messages, Md5Digest* digests, size_t count) noexcept {
+    LaneVector w[16];
+    uint8_t block[64];
+    for (size_t lane = 0; lane < kLaneCount; lane++) {
+        BuildSingleBlock(lane < count ? messages[lane] : std::string_view(), block);
+        for (int j = 0; j < 16; j++) {
+            w[j][lane] = LoadLe32(block + j * 4);
+        }
+    }
+    LaneVector state[4];
+    for (int i = 0; i < 4; i++) {
+        state[i] = LaneVector{} + kInitialState[i];
+    }
+    TransformBlock(state, w);
+    for (size_t lane = 0; lane < count; lane++) {
+        const uint32_t laneState[4] = {state[0][lane], state[1][lane], state[2][lane], state[3][lane]};
+        StoreDigest(laneState, digests[lane]);
+    }
+}
+
+}
+
+Md5Digest ComputeMd5(std::string_view message) noexcept {
+    uint32_t state[4] = {kInitialState[0], kInitialState[1], kInitialState[2], kInitialState[3]};
+    uint32_t w[16];
+    const auto* data = reinterpret_cast<const uint8_t*>(message.data());
+    size_t remaining = message.size();
+    while (remaining >= 64) {
+        for (int j = 0; j < 16; j++) {
+            w[j] = LoadLe32(data + j * 4);
+        }
+        TransformBlock(state, w);
+        data += 64;
+        remaining -= 64;
+    }
+    // the tail, the 0x80 marker and the length take one or two more blocks
+    uint8_t tail[128] = {};
+    memcpy(tail, data, remaining);
+    tail[remaining] = 0x80;
+    const size_t tailSize = remaining <= kMd5BatchMaxSingleBlockMessage ? 64 : 128;
+    const uint64_t bits = uint64_t(message.size()) * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[tailSize - 8 + i] = uint8_t(bits >> (8 * i));
+    }
+    for (size_t offset = 0; offset < tailSize; offset += 64) {
+        for (int j = 0; j < 16; j++) {
+            w[j] = LoadLe32(tail + offset + j * 4);
+        }
+        TransformBlock(state, w);
+    }
+    Md5Digest digest;
+    StoreDigest(state, digest);
+    return digest;
+}
+
+void ComputeMd5Batch(std::span<const std::string_view> messages, std::span<Md5Digest> digests) noexcept {
+    const size_t count = std::min(messages.size(), digests.size());
+    // gather the short messages so that full lane groups can be formed regardless of their position
+    std::string_view pending[kLaneCount];
+    size_t pendingIndex[kLaneCount];
+    Md5Digest pendingDigest[kLaneCount];
+    size_t pendingCount = 0;
+    const auto flush = [&] {
+        ComputeSingleBlockLanes(pending, pendingDigest, pendingCount);
+        for (size_t i = 0; i < pendingCount; i++) {
+            digests[pendingIndex[i]] = pendingDigest[i];
+        }
+        pendingCount = 0;
+    };
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i].size() > kMd5BatchMaxSingleBlockMessage) {
+            digests[i] = ComputeMd5(messages[i]);
+            continue;
+        }
+        pending[pendingCount] = messages[i];
+        pendingIndex[pendingCount] = i;
+        if (++pendingCount == kLaneCount) {
+            flush();
+        }
+    }
+    if (pendingCount != 0) {
+        flush();
+    }
+}
+
+std::string Md5DigestToHex(const Md5Digest& digest, bool upperCase) {
+    const char* digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+    std::string hex(32, '0');
+    for (size_t i = 0; i < digest.size(); i++) {
+        hex[i * 2] = digits[digest[i] >> 4];
+        hex[i * 2 + 1] = digits[digest[i] & 0xf];
+    }
+    return hex;
+}
+
+}
@@ -0,0 +1,43 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_MD5_BATCH_H
+#define QAUXV_MD5_BATCH_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace misc {
+
+using Md5Digest = std::array<uint8_t, 16>;
+
+// messages up to this size fit in a single MD5 block and go through the multi-lane core
+constexpr size_t kMd5BatchMaxSingleBlockMessage = 55;
+
+/**
+ * Compute the MD5 of one message.
+ */
+[[nodiscard]] Md5Digest ComputeMd5(std::string_view message) noexcept;
+
+/**
+ * Compute the MD5 of many messages at once.
+ * Single-block messages, e.g. uin strings, are hashed 8 at a time with interleaved lanes, which the compiler maps
+ * to NEON or SSE/AVX2 registers. Longer messages fall back to the scalar core.
+ * @param messages the messages
+ * @param digests receives one digest per message, must be as long as messages
+ */
+void ComputeMd5Batch(std::span<const std::string_view> messages, std::span<Md5Digest> digests) noexcept;
+
+/**
+ * Format a digest as 32 hex digits.
+ * @param upperCase whether to use upper case letters, as the table names of QQ do
+ */
+[[nodiscard]] std::string Md5DigestToHex(const Md5Digest& digest, bool upperCase);
+
+}
+
+#endif //QAUXV_MD5_BATCH_H
@@ -11,7 +11,7 @@
 #include <linux_syscall_support.h>
 
 #include "utils/Log.h"
-#include "zip_helper.h"
+#include "apk_signing_block.h"
 #include "md5.h"
 
 #define PKG_NAME "io.github.qauxv"
@@ -65,15 +65,6 @@ int dumpMemory(int fd, const void *address, size_t size) {
 }
 
 namespace teble::v2sign {
-    const char magic[16]{
-            0x32, 0x34, 0x20, 0x6b, 0x63, 0x6f, 0x6c, 0x42,
-            0x20, 0x67, 0x69, 0x53, 0x20, 0x4b, 0x50, 0x41,
-    };
-
-    const uint64_t revertMagikFirst = 0x3234206b636f6c42LL;
-    const uint64_t revertMagikSecond = 0x20676953204b5041LL;
-    const uint32_t v2Id = 0x7109871a;
-
     std::string getModulePath(JNIEnv *env) {
         jclass cMainHook = env->FindClass("io/github/qauxv/core/MainHook");
         jclass cClass = env->FindClass("java/lang/Class");
@@ -137,77 +128,21 @@ namespace teble::v2sign {
         return -1;
     }
 
-    std::string getSignBlock(uint8_t *base, size_t size) {
-        zip_helper::MemMap memMap(base, size);
-        auto zip_file = zip_helper::ZipFile::Open(memMap);
-        if (!zip_file || zip_file->entries.size() == 0) return {};
-        auto last_entry = zip_file->entries.back();
-        auto zip_entries_end_ptr = reinterpret_cast<uint8_t *>(last_entry->record) + last_entry->getEntrySize();
-        auto apk_end_ptr = memMap.addr() + memMap.len();
-        uint64_t curr = 0;
-        uint8_t *ptr = apk_end_ptr - 1;
-        std::string signBlock;
-        while (ptr >= zip_entries_end_ptr) {
-            curr = (curr << 8) | *ptr--;
-            if (curr == revertMagikFirst) {
-                uint64_t tmp = 0;
-                for (int i = 0; i < 8; ++i) {
-                    tmp = (tmp << 8) | *(ptr - i);
-                }
-                if (tmp == revertMagikSecond) {
-                    for (int i = 8; i < 16; ++i) {
-                        tmp = (tmp << 8) | *(ptr - i);
-                    }
-                    // TODO 只判断魔数“APK Sig Block 42”可能存在误判
-                    ptr -= 16;
-                    tmp -= 24;
-                    for (int i = 0; i < tmp; ++i) {
-                        signBlock.push_back(*ptr--);
-                    }
-                    break;
-                }
-            }
-        }
-        std::reverse(signBlock.begin(), signBlock.end());
-        return signBlock;
-    }
-
     std::string getBlockMd5(const std::string &block) {
         return MD5(block).getDigest();
     }
 
-    std::string getV2Signature(std::string_view block) {
-        std::string signature;
-        const char *p = block.data();
-        const char *last = block.data() + block.size();
-        while (p < last) {
-            uint64_t blockSize = 0;
-            for (int i = 0; i < 8; ++i) {
-                blockSize = (blockSize >> 8) | (((uint64_t) *p++) << (8 * 7));
-            }
-            uint32_t id = 0;
-            for (int i = 0; i < 4; ++i) {
-                id = (id >> 8) | (((uint32_t) *p++) << (8 * 3));
-            }
-            if (id != v2Id) {
-                p += blockSize - 12;
-                continue;
-            }
-            p += 12;
-            uint32_t size = 0;
-            for (int i = 0; i < 4; ++i) {
-                size = (size >> 8) | (((uint32_t) *p++) << (8 * 3));
-            }
-            p += size + 4;
-            for (int i = 0; i < 4; ++i) {
-                size = (size >> 8) | (((uint32_t) *p++) << (8 * 3));
-            }
-            for (int i = 0; i < size; ++i) {
-                signature.push_back(*p++);
-            }
-            break;
+    // the first certificate of the first v2 signer, or empty if there is none
+    std::string getV2Signature(utils::BinarySpan block) {
+        auto v2Block = misc::FindApkSigningBlockValue(block, misc::kApkSignatureSchemeV2BlockId);
+        if (!v2Block) {
+            return {};
+        }
+        auto certificate = misc::GetV2FirstSignerCertificate(*v2Block);
+        if (!certificate) {
+            return {};
         }
-        return signature;
+        return std::string(certificate->AsStringView());
     }
 
     bool checkSignature(JNIEnv *env, bool isInHostAsModule) {
@@ -274,15 +209,16 @@ namespace teble::v2sign {
             }
         }
         // __android_log_print(ANDROID_LOG_INFO, "QAuxv", "isModule: %d, path: %s", isModule, path.c_str());
-        std::string block = getSignBlock(reinterpret_cast<uint8_t *>(baseAddress), fileSize);
+        // the signing block is used in place, the APK is neither copied nor walked entry by entry
+        auto block = misc::FindApkSigningBlock(utils::BinarySpan(baseAddress, fileSize));
 
         bool match;
-        if (block.empty()) {
+        if (!block) {
             sys_munmap(const_cast<void *>(baseAddress), fileSize);
             LOGE("sign block is empty");
             return false;
         } else {
-            std::string currSignature = getV2Signature(block);
+            std::string currSignature = getV2Signature(*block);
             std::string md5 = getBlockMd5(currSignature);
             std::string str(STRING(MODULE_SIGNATURE));
             sys_munmap(const_cast<void *>(baseAddress), fileSize);
@@ -18,10 +18,11 @@
 #include <ucontext.h>
 #include <dlfcn.h>
 #include <type_traits>
-//#include <chrono>
+#include <chrono>
 #include <unordered_map>
 #include <memory>
 #include <unordered_set>
+#include <future>
 #include <fmt/format.h>
 
 #include "qauxv_core/NativeCoreBridge.h"
@@ -31,6 +32,8 @@
 #include "utils/ThreadUtils.h"
 #include "utils/TextUtils.h"
 #include "utils/AobScanUtils.h"
+#include "utils/HookProbe.h"
+#include "utils/LibraryFileImage.h"
 #include "utils/MemoryUtils.h"
 #include "utils/arch_utils.h"
 #include "utils/endian.h"
@@ -59,12 +62,14 @@ jmethodID handleRecallSysMsgFromNtKernel = nullptr;
 void (* sOriginHandleGroupRecallSysMsgCallback)(void*, void*, void*) = nullptr;
 
 void HandleGroupRecallSysMsgCallback([[maybe_unused]] void* x0, void* x1, [[maybe_unused]] void* x2, [[maybe_unused]] int x3) {
+    QAUXV_HOOK_PROBE("native:HandleGroupRecallSysMsgCallback");
     // LOGD("HandleGroupRecallSysMsgCallback start p1={:p}, p2={:p}, p3={:p}", x0, x1, x2);
 }
 
 void (* sOriginHandleC2cRecallSysMsgCallback)(void*, void*, void*) = nullptr;
 
 void HandleC2cRecallSysMsgCallback([[maybe_unused]] void* p1, [[maybe_unused]] void* p2, void* p3, [[maybe_unused]] int x3) {
+    QAUXV_HOOK_PROBE("native:HandleC2cRecallSysMsgCallback");
     if (p3 == nullptr || *(void**) p3 == nullptr) {
         LOGE("HandleC2cGroupSysMsgCallback BUG !!! *p3 = null, this should not happen!!!");
         return;
@@ -72,40 +77,101 @@ void HandleC2cRecallSysMsgCallback([[maybe_unused]] void* p1, [[maybe_unused]] v
     // LOGD("HandleC2cRecallSysMsgCallback start p1={:p}, p2={:p}, p3={:p}", p1, p2, p3);
 }
 
-// Nobody uses PaiYiPai, right?
-bool PerformNtRecallMsgHook(uint64_t baseAddress) {
-    if (sIsHooked) {
-        return false;
-    }
-    sIsHooked = true;
-    gLibkernelBaseAddress = reinterpret_cast<void*>(baseAddress);
-
+static std::vector<AobScanTarget> CreateRecallMsgAobScanTargets() {
+    std::vector<AobScanTarget> targets;
     //@formatter:off
-    // RecallC2cSysMsg 09 8d 40 f8 f5 03 00 aa 21 00 80 52 f3 03 02 aa 29 ?? 40 f9
-    auto targetRecallC2cSysMsg = AobScanTarget()
+    targets.emplace_back(AobScanTarget()
             .WithName("RecallC2cSysMsg")
-            .WithSequence({0x09, 0x8d, 0x40, 0xf8, 0xf5, 0x03, 0x00, 0xaa, 0x21, 0x00, 0x80, 0x52, 0xf3, 0x03, 0x02, 0xaa, 0x29, 0x00, 0x40, 0xf9})
-            .WithMask(    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0xff, 0xff})
-            .WithStep(4)
+            .WithPattern(MakeAobPattern<"09 8d 40 f8 f5 03 00 aa 21 00 80 52 f3 03 02 aa 29 ?? 40 f9", 4>())
             .WithExecMemOnly(true)
+            .WithFunctionIndex(true)
             .WithOffsetsForResult({-0x20, -0x24, -0x28})
-            .WithResultValidator(CommonAobScanValidator::kArm64StpX29X30SpImm);
+            .WithResultValidator(CommonAobScanValidator::kArm64StpX29X30SpImm));
 
-    // RecallGroupSysMsg 28 00 40 f9 61 00 80 52 09 8d 40 f8 29 !! 40 f9
-    auto targetRecallGroupSysMsg = AobScanTarget()
+    targets.emplace_back(AobScanTarget()
             .WithName("RecallGroupSysMsg")
-            .WithSequence({0x28, 0x00, 0x40, 0xf9, 0x61, 0x00, 0x80, 0x52, 0x09, 0x8d, 0x40, 0xf8, 0x29, 0x00, 0x40, 0xf9})
-            .WithMask(    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0xff, 0xff})
-            .WithStep(4)
+            .WithPattern(MakeAobPattern<"28 00 40 f9 61 00 80 52 09 8d 40 f8 29 ?? 40 f9", 4>())
             .WithExecMemOnly(true)
+            .WithFunctionIndex(true)
             .WithOffsetsForResult({-0x18, -0x24, -0x28})
-            .WithResultValidator(CommonAobScanValidator::kArm64StpX29X30SpImm);
+            .WithResultValidator(CommonAobScanValidator::kArm64StpX29X30SpImm));
 
     //@formatter:on
+    return targets;
+}
+
+struct LibkernelPrescanResult {
+    // raw results of RecallC2cSysMsg and RecallGroupSysMsg found in the libkernel.so file
+    std::unordered_map<std::string, uint64_t> rawResults;
+    // built from the file, so that the load library callback does not have to walk the unwind tables
+    FunctionIndex functionIndex;
+};
+
+// see StartLibkernelPrescan
+static std::shared_future<LibkernelPrescanResult> sLibkernelPrescan;
+
+/**
+ * Scan libkernel.so from its file on a background thread, before the host loads it.
+ * When it is loaded, the load library callback only has to verify the results, instead of blocking
+ * the thread which is loading the library with a full scan.
+ */
+static void StartLibkernelPrescan() {
+    if (sLibkernelPrescan.valid()) {
+        return;
+    }
+    std::string packageName = HostInfo::GetPackageName();
+    sLibkernelPrescan = std::async(std::launch::async, [packageName]() -> LibkernelPrescanResult {
+        LibraryFileImage image;
+        std::string location;
+        // the pre-scan reads every segment front to back
+        if (int err = OpenHostNativeLibraryFile(packageName, "libkernel.so", image, location,
+                                                FileMemMap::AccessHint::kSequential); err != 0) {
+            LOGW("StartLibkernelPrescan: libkernel.so file not found, err={}", err);
+            return {};
+        }
+        LibkernelPrescanResult result;
+        result.rawResults = PrescanAobScanTargetsInFileImage(CreateRecallMsgAobScanTargets(), image.GetAddress(),
+                                                             &result.functionIndex);
+        LOGD("StartLibkernelPrescan: {} of 2 targets found in {}, {} functions indexed", result.rawResults.size(), location,
+             result.functionIndex.GetFunctions().size());
+        return result;
+    }).share();
+}
+
+// Nobody uses PaiYiPai, right?
+bool PerformNtRecallMsgHook(uint64_t baseAddress) {
+    if (sIsHooked) {
+        return false;
+    }
+    sIsHooked = true;
+    gLibkernelBaseAddress = reinterpret_cast<void*>(baseAddress);
+
+    auto targets = CreateRecallMsgAobScanTargets();
+    AobScanTarget& targetRecallC2cSysMsg = targets[0];
+    AobScanTarget& targetRecallGroupSysMsg = targets[1];
+
+    const FunctionIndex* functionIndex = nullptr;
+    // the pre-scan is usually done long before the host loads libkernel.so, if not, do not hold up the thread
+    // which is loading the library waiting for it, the search below scans the loaded image on its own then
+    if (sLibkernelPrescan.valid() && sLibkernelPrescan.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        LOGD("PerformNtRecallMsgHook: libkernel.so pre-scan is not finished yet, scanning the loaded image");
+    } else if (sLibkernelPrescan.valid()) {
+        const auto& prescan = sLibkernelPrescan.get();
+        for (auto& target: targets) {
+            if (auto it = prescan.rawResults.find(target.name); it != prescan.rawResults.end()) {
+                target.WithHint(it->second);
+            }
+        }
+        // an empty index means the file was not found or has no unwind table, let the search decide on its own then
+        if (!prescan.functionIndex.IsEmpty()) {
+            functionIndex = &prescan.functionIndex;
+        }
+    }
 
     std::vector<std::string> errorMsgList;
     // auto start = std::chrono::steady_clock::now();
-    if (!SearchForAllAobScanTargets({&targetRecallC2cSysMsg, &targetRecallGroupSysMsg}, gLibkernelBaseAddress, true, errorMsgList)) {
+    if (!SearchForAllAobScanTargets({&targetRecallC2cSysMsg, &targetRecallGroupSysMsg}, gLibkernelBaseAddress, true, errorMsgList,
+                                    functionIndex)) {
         LOGE("InitInitNtKernelRecallMsgHook SearchForAllAobScanTargets failed");
         // sth went wrong
         for (const auto& msg: errorMsgList) {
@@ -173,6 +239,7 @@ bool InitInitNtKernelRecallMsgHook() {
         // hook now
         return fnHookProc(libkernel->baseAddress);
     } else {
+        StartLibkernelPrescan();
         int rc = RegisterLoadLibraryCallback([fnHookProc](const char* name, void* handle) {
             if (name == nullptr) {
                 return;
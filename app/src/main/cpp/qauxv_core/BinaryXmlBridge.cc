@@ -0,0 +1,188 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include <jni.h>
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/AxmlReader.h"
+#include "qauxv_core/jni_method_registry.h"
+
+namespace {
+
+struct BinaryXmlCursorHandle {
+    utils::AxmlDocument document;
+    // constructed once the document is open, it starts at the first node of the document
+    std::optional<utils::AxmlCursor> cursor;
+};
+
+// keep in sync with BinaryXmlCursor.STATE_*
+constexpr jsize kStateDepth = 0;
+constexpr jsize kStateLineNumber = 1;
+constexpr jsize kStateComment = 2;
+constexpr jsize kStateNamespace = 3;
+constexpr jsize kStateName = 4;
+constexpr jsize kStateTextDataType = 5;
+constexpr jsize kStateTextData = 6;
+constexpr jsize kStateSize = 7;
+
+// keep in sync with BinaryXmlCursor.ATTRIBUTE_*
+constexpr size_t kAttributeInts = 6;
+
+// keep in sync with BinaryXmlCursor, the same values as XmlPullParser
+constexpr jint kEventEndDocument = 1;
+constexpr jint kEventStartTag = 2;
+constexpr jint kEventEndTag = 3;
+constexpr jint kEventText = 4;
+
+BinaryXmlCursorHandle* GetHandle(JNIEnv* env, jlong handle) {
+    if (handle == 0) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), "cursor is closed");
+        return nullptr;
+    }
+    return reinterpret_cast<BinaryXmlCursorHandle*>(handle);
+}
+
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeOpen(JNIEnv* env, jclass, jstring path) {
+    if (path == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "path is null");
+        return 0;
+    }
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    auto handle = std::make_unique<BinaryXmlCursorHandle>();
+    std::string error = handle->document.OpenFile(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    if (!error.empty()) {
+        env->ThrowNew(env->FindClass("java/io/IOException"), error.c_str());
+        return 0;
+    }
+    handle->cursor.emplace(handle->document);
+    return reinterpret_cast<jlong>(handle.release());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeClose(JNIEnv*, jclass, jlong handle) {
+    delete reinterpret_cast<BinaryXmlCursorHandle*>(handle);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeNext(JNIEnv* env, jclass, jlong handle, jintArray state) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return -1;
+    }
+    if (state == nullptr || env->GetArrayLength(state) < kStateSize) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "invalid state array");
+        return -1;
+    }
+    auto& cursor = *h->cursor;
+    // namespace events are not reported, the element namespace is resolved to the uri already
+    utils::AxmlEvent event;
+    do {
+        event = cursor.Next();
+    } while (event == utils::AxmlEvent::kStartNamespace || event == utils::AxmlEvent::kEndNamespace);
+    jint result;
+    switch (event) {
+        case utils::AxmlEvent::kStartElement:
+            result = kEventStartTag;
+            break;
+        case utils::AxmlEvent::kEndElement:
+            result = kEventEndTag;
+            break;
+        case utils::AxmlEvent::kText:
+            result = kEventText;
+            break;
+        case utils::AxmlEvent::kEndDocument:
+            result = kEventEndDocument;
+            break;
+        default:
+            env->ThrowNew(env->FindClass("java/io/IOException"), cursor.GetError());
+            return -1;
+    }
+    std::array<jint, kStateSize> values = {};
+    values[kStateDepth] = jint(cursor.GetDepth());
+    values[kStateLineNumber] = jint(cursor.GetLineNumber());
+    values[kStateComment] = jint(cursor.GetComment());
+    values[kStateNamespace] = jint(cursor.GetNamespace());
+    values[kStateName] = jint(cursor.GetName());
+    values[kStateTextDataType] = jint(cursor.GetTextValue().dataType);
+    values[kStateTextData] = jint(cursor.GetTextValue().data);
+    env->SetIntArrayRegion(state, 0, kStateSize, values.data());
+    return result;
+}
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeGetAttributes(JNIEnv* env, jclass, jlong handle) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return nullptr;
+    }
+    const auto& cursor = *h->cursor;
+    const uint32_t count = cursor.GetAttributeCount();
+    std::vector<jint> values;
+    values.reserve(count * kAttributeInts);
+    utils::AxmlAttribute attribute;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!cursor.GetAttribute(i, attribute)) {
+            break;
+        }
+        values.insert(values.end(), {jint(attribute.ns), jint(attribute.name), jint(attribute.rawValue), jint(attribute.dataType),
+                                     jint(attribute.data), jint(h->document.GetResourceId(attribute.name))});
+    }
+    jintArray result = env->NewIntArray(jsize(values.size()));
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetIntArrayRegion(result, 0, jsize(values.size()), values.data());
+    return result;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeFindAttribute(JNIEnv* env, jclass, jlong handle, jstring name) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return -1;
+    }
+    if (name == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "name is null");
+        return -1;
+    }
+    const char* nameChars = env->GetStringUTFChars(name, nullptr);
+    // modified UTF-8 only differs from UTF-8 for NUL and supplementary characters, which attribute names do not have
+    int index = h->cursor->FindAttribute(nameChars);
+    env->ReleaseStringUTFChars(name, nameChars);
+    return index;
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_cc_ioctl_util_BinaryXmlCursor_nativeGetString(JNIEnv* env, jclass, jlong handle, jint index) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return nullptr;
+    }
+    std::u16string value;
+    if (!h->document.GetStringPool().GetStringUtf16(uint32_t(index), value)) {
+        return nullptr;
+    }
+    return env->NewString(reinterpret_cast<const jchar*>(value.data()), jsize(value.size()));
+}
+
+//@formatter:off
+static JNINativeMethod gMethods[] = {
+        {"nativeClose", "(J)V", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeClose)},
+        {"nativeFindAttribute", "(JLjava/lang/String;)I", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeFindAttribute)},
+        {"nativeGetAttributes", "(J)[I", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeGetAttributes)},
+        {"nativeGetString", "(JI)Ljava/lang/String;", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeGetString)},
+        {"nativeNext", "(J[I)I", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeNext)},
+        {"nativeOpen", "(Ljava/lang/String;)J", reinterpret_cast<void*>(Java_cc_ioctl_util_BinaryXmlCursor_nativeOpen)},
+};
+//@formatter:on
+REGISTER_PRIMARY_PRE_INIT_NATIVE_METHODS("cc/ioctl/util/BinaryXmlCursor", gMethods);
@@ -4,6 +4,7 @@
 
 #include "LsplantBridge.h"
 
+#include <initializer_list>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -111,6 +112,110 @@ Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeDeoptimizeMethod(
     return ::lsplant::Deoptimize(env, target);
 }
 
+// status codes of the batch variants, keep in sync with LsplantBridge.java
+static constexpr jint kBatchStatusSuccess = 0;
+static constexpr jint kBatchStatusInvalidArgument = 1;
+static constexpr jint kBatchStatusFailed = 2;
+static constexpr jint kBatchStatusException = 3;
+
+static bool CheckBatchArguments(JNIEnv* env, jobjectArray targets, std::initializer_list<jobjectArray> others) {
+    if (!sLsplantInitSuccess) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalAccessException"), "lsplant not initialized");
+        return false;
+    }
+    if (targets == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "targets is null");
+        return false;
+    }
+    const jsize count = env->GetArrayLength(targets);
+    for (jobjectArray array: others) {
+        if (array == nullptr) {
+            env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "array is null");
+            return false;
+        }
+        if (env->GetArrayLength(array) != count) {
+            env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "array length mismatch");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Run op on every target in a single JNI transition, one failing entry does not stop the others.
+ * Each entry gets its own local frame, so the batch size is not limited by the local reference table.
+ * @param op returns kBatchStatusSuccess or kBatchStatusFailed, it may leave a pending exception
+ * @return the status array, or nullptr with a pending exception
+ */
+template<typename Op>
+static jintArray RunBatch(JNIEnv* env, jobjectArray targets, const char* what, Op&& op) {
+    const jsize count = env->GetArrayLength(targets);
+    std::vector<jint> statuses(size_t(count), kBatchStatusInvalidArgument);
+    for (jsize i = 0; i < count; i++) {
+        if (env->PushLocalFrame(8) != JNI_OK) {
+            return nullptr;
+        }
+        jobject target = env->GetObjectArrayElement(targets, i);
+        if (target != nullptr) {
+            statuses[i] = op(i, target);
+            if (env->ExceptionCheck()) {
+                // do not let one entry abort the whole batch, the caller gets the status instead
+                env->ExceptionDescribe();
+                env->ExceptionClear();
+                statuses[i] = kBatchStatusException;
+            }
+        }
+        env->PopLocalFrame(nullptr);
+    }
+    int failed = 0;
+    for (jint status: statuses) {
+        failed += status != kBatchStatusSuccess;
+    }
+    if (failed != 0) {
+        __android_log_print(ANDROID_LOG_WARN, "QAuxv", "LsplantBridge: %s: %d of %d entries failed", what, failed, int(count));
+    }
+    jintArray result = env->NewIntArray(count);
+    if (result != nullptr) {
+        env->SetIntArrayRegion(result, 0, count, statuses.data());
+    }
+    return result;
+}
+
+// static native int[] nativeHookMethods(Member[] targets, Member[] callbacks, Object[] contexts, Method[] outBackups)
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeHookMethods(JNIEnv* env, jclass clazz, jobjectArray targets,
+                                                                            jobjectArray callbacks, jobjectArray contexts, jobjectArray outBackups) {
+    if (!CheckBatchArguments(env, targets, {callbacks, contexts, outBackups})) {
+        return nullptr;
+    }
+    return RunBatch(env, targets, "hook", [&](jsize i, jobject target) {
+        jobject callback = env->GetObjectArrayElement(callbacks, i);
+        jobject context = env->GetObjectArrayElement(contexts, i);
+        if (callback == nullptr || context == nullptr) {
+            return kBatchStatusInvalidArgument;
+        }
+        jobject backup = ::lsplant::Hook(env, target, context, callback);
+        if (backup == nullptr) {
+            return kBatchStatusFailed;
+        }
+        env->SetObjectArrayElement(outBackups, i, backup);
+        return kBatchStatusSuccess;
+    });
+}
+
+// static native int[] nativeUnhookMethods(Member[] targets)
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeUnhookMethods(JNIEnv* env, jclass clazz, jobjectArray targets) {
+    if (!CheckBatchArguments(env, targets, {})) {
+        return nullptr;
+    }
+    return RunBatch(env, targets, "unhook", [&](jsize, jobject target) {
+        return ::lsplant::UnHook(env, target) ? kBatchStatusSuccess : kBatchStatusFailed;
+    });
+}
+
 // @formatter:off
 static JNINativeMethod gMethods[] = {
     {"nativeInitializeLsplant", "()V", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeInitializeLsplant)},
@@ -118,6 +223,8 @@ static JNINativeMethod gMethods[] = {
     {"nativeIsMethodHooked", "(Ljava/lang/reflect/Member;)Z", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeIsMethodHooked)},
     {"nativeUnhookMethod", "(Ljava/lang/reflect/Member;)Z", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeUnhookMethod)},
     {"nativeDeoptimizeMethod", "(Ljava/lang/reflect/Member;)Z", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeDeoptimizeMethod)},
+    {"nativeHookMethods", "([Ljava/lang/reflect/Member;[Ljava/lang/reflect/Member;[Ljava/lang/Object;[Ljava/lang/reflect/Method;)[I", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeHookMethods)},
+    {"nativeUnhookMethods", "([Ljava/lang/reflect/Member;)[I", reinterpret_cast<void*>(Java_io_github_qauxv_util_hookimpl_lsplant_LsplantBridge_nativeUnhookMethods)},
 };
 // @formatter:on
 
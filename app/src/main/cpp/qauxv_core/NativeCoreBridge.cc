@@ -44,6 +44,8 @@
 #include "utils/ProcessView.h"
 #include "utils/ElfView.h"
 #include "utils/ConfigManager.h"
+#include "utils/ThreadUtils.h"
+#include "utils/HookProbe.h"
 
 #include "natives_utils.h"
 
@@ -70,6 +72,7 @@ std::mutex sCallbacksMutex;
 bool sHandleLoadLibraryCallbackInitialized = false;
 
 void HandleLoadLibrary(const char* name, void* handle) {
+    ::utils::InvalidateLocalUnwinderMaps();
     std::vector<LoadLibraryCallback> callbacks;
     {
         std::scoped_lock lock(sCallbacksMutex);
@@ -112,6 +115,7 @@ int DestroyInlineHook(void* func) {
 void* backup_do_dlopen = nullptr;
 
 void* fake_do_dlopen_24(const char* name, int flags, const void* extinfo, const void* caller) {
+    QAUXV_HOOK_PROBE("native:do_dlopen");
     auto* backup = (void* (*)(const char* name, int flags, const void* extinfo, const void* caller)) backup_do_dlopen;
     auto handle = backup(name, flags, extinfo, caller);
     HandleLoadLibrary(name, handle);
@@ -119,6 +123,7 @@ void* fake_do_dlopen_24(const char* name, int flags, const void* extinfo, const
 }
 
 void* fake_do_dlopen_23(const char* name, int flags, const void* extinfo) {
+    QAUXV_HOOK_PROBE("native:do_dlopen");
     // below Android 7.0, the caller address is not passed to do_dlopen,
     // because there is no linker namespace concept before Android 7.0
     auto* backup = (void* (*)(const char* name, int flags, const void* extinfo)) backup_do_dlopen;
@@ -157,7 +162,8 @@ void HookLoadLibrary() {
         return;
     }
     FileMemMap linkerFileMap;
-    if ((rc = linkerFileMap.mapFilePath(linkerPath.c_str())) != 0) {
+    // only the headers, the symbol tables and a few strings are read
+    if ((rc = linkerFileMap.mapFilePath(linkerPath.c_str(), true, 0, FileMemMap::AccessHint::kRandom)) != 0) {
         LOGE("HookLoadLibrary: failed to map linker file, rc = {}", rc);
         return;
     }
@@ -11,6 +11,7 @@
 #include "natives_utils.h"
 #include <android/log.h>
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,14 @@
 #include "utils/shared_memory.h"
 #include "misc/v2sign.h"
 #include "qauxv_core/jni_method_registry.h"
+#include "utils/SamplingProfiler.h"
+#include "utils/HookProbe.h"
+#include "utils/AobScanUtils.h"
+#include "utils/SqliteSpaceAnalyzer.h"
+#include "misc/md5_batch.h"
+#include "utils/DexClassIndex.h"
+#include "utils/Checksum.h"
+#include "utils/Log.h"
 
 static bool throwIfNull(JNIEnv* env, jobject obj, const char* msg) {
     if (obj == nullptr) {
@@ -254,25 +263,6 @@ EXPORT extern "C" jlong Java_io_github_qauxv_util_Natives_call__JJ
     return (jlong) ret;
 }
 
-uint32_t update_adler32(unsigned adler, const uint8_t* data, uint32_t len) {
-    unsigned s1 = adler & 0xffffu;
-    unsigned s2 = (adler >> 16u) & 0xffffu;
-
-    while (len > 0) {
-        /*at least 5550 sums can be done before the sums overflow, saving a lot of module divisions*/
-        unsigned amount = len > 5550 ? 5550 : len;
-        len -= amount;
-        while (amount > 0) {
-            s1 += (*data++);
-            s2 += s1;
-            --amount;
-        }
-        s1 %= 65521;
-        s2 %= 65521;
-    }
-    return (s2 << 16u) | s1;
-}
-
 EXPORT extern "C" jint JNI_OnLoad(JavaVM* vm, void* reserved) {
     JNIEnv* env = nullptr;
     if (vm->GetEnv((void**) &env, JNI_VERSION_1_6) != JNI_OK) {
@@ -737,6 +727,338 @@ Java_io_github_qauxv_util_Natives_setProcessDumpableState(JNIEnv* env, jclass, j
     }
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_startSamplingProfiler(JNIEnv* env, jclass, jintArray tids, jint intervalMillis) {
+    if (intervalMillis <= 0) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                      (std::string("intervalMillis must be positive: ") + std::to_string(intervalMillis)).c_str());
+        return;
+    }
+    std::vector<uint32_t> tidList;
+    if (tids != nullptr) {
+        jsize count = env->GetArrayLength(tids);
+        tidList.resize(count);
+        env->GetIntArrayRegion(tids, 0, count, reinterpret_cast<jint*>(tidList.data()));
+    }
+    std::string err = utils::SamplingProfiler::GetInstance().Start(std::move(tidList), uint32_t(intervalMillis));
+    if (!err.empty()) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), err.c_str());
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_stopSamplingProfiler(JNIEnv*, jclass) {
+    utils::SamplingProfiler::GetInstance().Stop();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_io_github_qauxv_util_Natives_isSamplingProfilerRunning(JNIEnv*, jclass) {
+    return utils::SamplingProfiler::GetInstance().IsRunning();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_dumpSamplingProfile(JNIEnv* env, jclass, jstring path) {
+    if (path == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "path is null");
+        return;
+    }
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    std::string pathStr = pathChars;
+    env->ReleaseStringUTFChars(path, pathChars);
+    int err = utils::SamplingProfiler::GetInstance().DumpFoldedStacks(pathStr);
+    if (err != 0) {
+        env->ThrowNew(env->FindClass("java/io/IOException"), strerror(err));
+    }
+}
+
+// the layout is documented in Natives.analyzeSqliteSpace
+static constexpr int kSqliteSpaceReportHeaderLongs = 4;
+static constexpr int kSqliteSpaceReportLongsPerBtree = 9;
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_io_github_qauxv_util_Natives_analyzeSqliteSpace(JNIEnv* env, jclass, jstring path) {
+    if (path == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "path is null");
+        return nullptr;
+    }
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    std::string pathStr = pathChars;
+    env->ReleaseStringUTFChars(path, pathChars);
+    utils::SqliteSpaceReport report;
+    if (auto error = utils::AnalyzeSqliteSpace(pathStr, report); !error.empty()) {
+        env->ThrowNew(env->FindClass("java/io/IOException"), error.c_str());
+        return nullptr;
+    }
+    const auto btreeCount = jsize(report.btrees.size());
+    jclass kString = env->FindClass("java/lang/String");
+    jobjectArray names = env->NewObjectArray(btreeCount, kString, nullptr);
+    jobjectArray tableNames = env->NewObjectArray(btreeCount, kString, nullptr);
+    if (names == nullptr || tableNames == nullptr) {
+        return nullptr;
+    }
+    std::vector<jlong> values;
+    values.reserve(kSqliteSpaceReportHeaderLongs + size_t(btreeCount) * kSqliteSpaceReportLongsPerBtree);
+    values.insert(values.end(), {jlong(report.pageSize), jlong(report.pageCount), jlong(report.freelistPages), jlong(report.otherPages)});
+    for (jsize i = 0; i < btreeCount; i++) {
+        const auto& btree = report.btrees[size_t(i)];
+        jstring name = env->NewStringUTF(btree.name.c_str());
+        jstring tableName = env->NewStringUTF(btree.tableName.c_str());
+        if (env->ExceptionCheck()) {
+            return nullptr;
+        }
+        env->SetObjectArrayElement(names, i, name);
+        env->SetObjectArrayElement(tableNames, i, tableName);
+        env->DeleteLocalRef(name);
+        env->DeleteLocalRef(tableName);
+        values.insert(values.end(), {jlong(btree.isIndex), jlong(btree.rootPage), jlong(btree.leafPages), jlong(btree.interiorPages),
+                                     jlong(btree.overflowPages), jlong(btree.overflowChains), jlong(btree.entries),
+                                     jlong(btree.payloadBytes), jlong(btree.unusedBytes)});
+    }
+    jlongArray numbers = env->NewLongArray(jsize(values.size()));
+    if (numbers == nullptr) {
+        return nullptr;
+    }
+    env->SetLongArrayRegion(numbers, 0, jsize(values.size()), values.data());
+    jobjectArray result = env->NewObjectArray(3, env->FindClass("java/lang/Object"), nullptr);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetObjectArrayElement(result, 0, names);
+    env->SetObjectArrayElement(result, 1, tableNames);
+    env->SetObjectArrayElement(result, 2, numbers);
+    return result;
+}
+
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_io_github_qauxv_util_Natives_uinToMd5HexBatch(JNIEnv* env, jclass, jlongArray uins) {
+    if (uins == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "uins is null");
+        return nullptr;
+    }
+    const jsize count = env->GetArrayLength(uins);
+    const auto size = size_t(count);
+    std::vector<jlong> values(size);
+    env->GetLongArrayRegion(uins, 0, count, values.data());
+    // the decimal strings, at most 20 characters and the terminator each, are kept in one buffer so the views stay valid
+    constexpr size_t kStride = 21;
+    std::vector<char> text(size * kStride);
+    std::vector<std::string_view> messages(size);
+    for (size_t i = 0; i < size; i++) {
+        char* begin = text.data() + i * kStride;
+        const int length = snprintf(begin, kStride, "%lld", static_cast<long long>(values[i]));
+        messages[i] = std::string_view(begin, size_t(length));
+    }
+    std::vector<misc::Md5Digest> digests(size);
+    misc::ComputeMd5Batch(messages, digests);
+    jobjectArray result = env->NewObjectArray(count, env->FindClass("java/lang/String"), nullptr);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    for (jsize i = 0; i < count; i++) {
+        jstring hex = env->NewStringUTF(misc::Md5DigestToHex(digests[size_t(i)], true).c_str());
+        if (hex == nullptr) {
+            return nullptr;
+        }
+        env->SetObjectArrayElement(result, i, hex);
+        env->DeleteLocalRef(hex);
+    }
+    return result;
+}
+
+// throws IndexOutOfBoundsException and returns false if [offset, offset + len) is not within size bytes
+static bool checkChecksumRange(JNIEnv* env, jint offset, jint len, jlong size) {
+    if (offset < 0 || len < 0 || jlong(offset) + len > size) {
+        env->ThrowNew(env->FindClass("java/lang/IndexOutOfBoundsException"),
+                      (std::string("offset or len is out of bounds: ") + std::to_string(offset)
+                              + " " + std::to_string(len) + " " + std::to_string(size)).c_str());
+        return false;
+    }
+    return true;
+}
+
+// returns the address of the direct buffer, or throws and returns nullptr
+static const uint8_t* getChecksumDirectBuffer(JNIEnv* env, jobject buf, jint offset, jint len) {
+    auto* address = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buf));
+    if (address == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "buf is not a direct buffer");
+        return nullptr;
+    }
+    if (!checkChecksumRange(env, offset, len, env->GetDirectBufferCapacity(buf))) {
+        return nullptr;
+    }
+    return address + offset;
+}
+
+template<uint32_t (*Update)(uint32_t, const void*, size_t) noexcept>
+static jint updateChecksumArray(JNIEnv* env, jint value, jbyteArray buf, jint offset, jint len) {
+    requiresNonNullZ(buf, "buf is null");
+    if (!checkChecksumRange(env, offset, len, env->GetArrayLength(buf))) {
+        return 0;
+    }
+    if (len == 0) {
+        return value;
+    }
+    // the checksum neither blocks nor calls back into the VM, so the array is not copied
+    auto* bytes = static_cast<const uint8_t*>(env->GetPrimitiveArrayCritical(buf, nullptr));
+    if (bytes == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/OutOfMemoryError"), "failed to access buf");
+        return 0;
+    }
+    auto result = Update(uint32_t(value), bytes + offset, size_t(len));
+    env->ReleasePrimitiveArrayCritical(buf, const_cast<uint8_t*>(bytes), JNI_ABORT);
+    return jint(result);
+}
+
+template<uint32_t (*Update)(uint32_t, const void*, size_t) noexcept>
+static jint updateChecksumDirect(JNIEnv* env, jint value, jobject buf, jint offset, jint len) {
+    requiresNonNullZ(buf, "buf is null");
+    const uint8_t* bytes = getChecksumDirectBuffer(env, buf, offset, len);
+    if (bytes == nullptr) {
+        return 0;
+    }
+    return jint(Update(uint32_t(value), bytes, size_t(len)));
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_Natives_updateAdler32(JNIEnv* env, jclass, jint adler, jbyteArray buf, jint offset, jint len) {
+    return updateChecksumArray<utils::UpdateAdler32>(env, adler, buf, offset, len);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_Natives_updateAdler32Direct(JNIEnv* env, jclass, jint adler, jobject buf, jint offset, jint len) {
+    return updateChecksumDirect<utils::UpdateAdler32>(env, adler, buf, offset, len);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_Natives_updateCrc32(JNIEnv* env, jclass, jint crc, jbyteArray buf, jint offset, jint len) {
+    return updateChecksumArray<utils::UpdateCrc32>(env, crc, buf, offset, len);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_Natives_updateCrc32Direct(JNIEnv* env, jclass, jint crc, jobject buf, jint offset, jint len) {
+    return updateChecksumDirect<utils::UpdateCrc32>(env, crc, buf, offset, len);
+}
+
+// the index of the host APK is kept after the first lookup, it is revalidated by stat only
+static std::mutex sDexClassIndexMutex;
+static utils::DexClassIndex sDexClassIndex;
+static std::string sDexClassIndexApkPath;
+static struct stat sDexClassIndexApkStat = {};
+
+static std::string EnsureDexClassIndexLocked(const std::string& apkPath, const std::string& indexPath) {
+    struct stat st = {};
+    if (stat(apkPath.c_str(), &st) != 0) {
+        return fmt::format("unable to stat {}: {}", apkPath, strerror(errno));
+    }
+    if (sDexClassIndex.GetClassCount() != 0 && sDexClassIndexApkPath == apkPath
+            && st.st_size == sDexClassIndexApkStat.st_size
+            && st.st_mtim.tv_sec == sDexClassIndexApkStat.st_mtim.tv_sec
+            && st.st_mtim.tv_nsec == sDexClassIndexApkStat.st_mtim.tv_nsec) {
+        return {};
+    }
+    uint64_t key = 0;
+    if (int err = utils::DexClassIndex::ComputeApkKey(apkPath.c_str(), key); err != 0) {
+        return fmt::format("unable to read {}: {}", apkPath, strerror(err));
+    }
+    if (sDexClassIndex.LoadFromFile(indexPath, key) != 0) {
+        if (auto error = sDexClassIndex.Build(apkPath.c_str()); !error.empty()) {
+            return error;
+        }
+        if (int err = sDexClassIndex.SaveToFile(indexPath); err != 0) {
+            LOGW("unable to save dex class index to {}: {}", indexPath, strerror(err));
+        }
+    }
+    sDexClassIndexApkPath = apkPath;
+    sDexClassIndexApkStat = st;
+    return {};
+}
+
+extern "C" JNIEXPORT jintArray JNICALL
+Java_io_github_qauxv_util_Natives_findClassesInDexIndex(JNIEnv* env, jclass, jstring apkPath, jstring indexPath,
+                                                        jobjectArray descriptors) {
+    if (apkPath == nullptr || indexPath == nullptr || descriptors == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "apkPath, indexPath or descriptors is null");
+        return nullptr;
+    }
+    const char* apkPathChars = env->GetStringUTFChars(apkPath, nullptr);
+    std::string apkPathStr = apkPathChars;
+    env->ReleaseStringUTFChars(apkPath, apkPathChars);
+    const char* indexPathChars = env->GetStringUTFChars(indexPath, nullptr);
+    std::string indexPathStr = indexPathChars;
+    env->ReleaseStringUTFChars(indexPath, indexPathChars);
+    const jsize count = env->GetArrayLength(descriptors);
+    std::vector<jint> values(size_t(count) * 2);
+    {
+        std::scoped_lock lock(sDexClassIndexMutex);
+        if (auto error = EnsureDexClassIndexLocked(apkPathStr, indexPathStr); !error.empty()) {
+            env->ThrowNew(env->FindClass("java/io/IOException"), error.c_str());
+            return nullptr;
+        }
+        for (jsize i = 0; i < count; i++) {
+            auto descriptor = static_cast<jstring>(env->GetObjectArrayElement(descriptors, i));
+            std::optional<utils::DexClassIndex::Location> location;
+            if (descriptor != nullptr) {
+                const char* chars = env->GetStringUTFChars(descriptor, nullptr);
+                location = sDexClassIndex.Find(chars);
+                env->ReleaseStringUTFChars(descriptor, chars);
+                env->DeleteLocalRef(descriptor);
+            }
+            values[size_t(i) * 2] = location ? jint(location->dexIndex) : -1;
+            values[size_t(i) * 2 + 1] = location ? jint(location->classDefIndex) : -1;
+        }
+    }
+    jintArray result = env->NewIntArray(count * 2);
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetIntArrayRegion(result, 0, count * 2, values.data());
+    return result;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_setHookProbesEnabledImpl(JNIEnv*, jclass, jboolean enabled) {
+    utils::SetHookProbesEnabled(enabled);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_Natives_registerHookProbe(JNIEnv* env, jclass, jstring name) {
+    if (name == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "name is null");
+        return -1;
+    }
+    const char* nameChars = env->GetStringUTFChars(name, nullptr);
+    uint32_t id = utils::RegisterHookProbe(nameChars);
+    env->ReleaseStringUTFChars(name, nameChars);
+    return id == utils::kInvalidHookProbeId ? -1 : jint(id);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_recordHookProbe(JNIEnv*, jclass, jint id, jlong nanos) {
+    if (id >= 0 && nanos >= 0) {
+        utils::RecordHookProbe(uint32_t(id), uint64_t(nanos));
+    }
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_io_github_qauxv_util_Natives_getHookProbeReport(JNIEnv* env, jclass) {
+    return env->NewStringUTF(utils::FormatHookProbeReport().c_str());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_resetHookProbes(JNIEnv*, jclass) {
+    utils::ResetHookProbes();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_Natives_dumpHookProbesToLogcat(JNIEnv*, jclass) {
+    utils::DumpHookProbesToLogcat(ANDROID_LOG_INFO);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_io_github_qauxv_util_Natives_getAobScanStatsReport(JNIEnv* env, jclass) {
+    return env->NewStringUTF(utils::FormatAobScanStatsReport().c_str());
+}
+
 extern "C" JNIEXPORT jlong JNICALL
 Java_io_github_qauxv_util_Natives_lseek(JNIEnv* env, jclass, jint fd, jlong offset, jint whence) {
     if (fd < 0) {
@@ -763,7 +1085,7 @@ Java_cc_ioctl_util_JunkCodeUtils_getJunkCode(JNIEnv*, jclass, jint jtc) {
     auto tc = uint32_t(jtc);
     const char* magic = "mIplOkwgxe3bzGc6g9K1BNJlXbuNmM+kYGWuoFGDOAZD1vHBEROCj+AN2TmBKXc0wEDLXgE+XgxL";
     auto magic_len = strlen(magic);
-    uint32_t a32 = update_adler32(tc, reinterpret_cast<const uint8_t*>(magic), magic_len);
+    uint32_t a32 = utils::UpdateAdler32(tc, magic, magic_len);
     uint32_t o = a32 & 0xf;
     // code should be in the range [0, 999999]
     uint32_t code = (a32 >> o) % 1000000;
@@ -932,6 +1254,7 @@ Java_io_github_qauxv_util_Natives_invokeNonVirtualArtMethodImpl(JNIEnv* env,
 //@formatter:off
 static JNINativeMethod gMethods[] = {
     {"allocateInstanceImpl", "(Ljava/lang/Class;)Ljava/lang/Object;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_allocateInstanceImpl)},
+    {"analyzeSqliteSpace", "(Ljava/lang/String;)[Ljava/lang/Object;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_analyzeSqliteSpace)},
     {"call", "(J)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_call__J)},
     {"call", "(JJ)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_call__JJ)},
     {"close", "(I)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_close)},
@@ -941,12 +1264,18 @@ static JNINativeMethod gMethods[] = {
     {"dlsym", "(JLjava/lang/String;)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dlsym)},
     {"dup", "(I)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dup)},
     {"dup2", "(II)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dup2)},
+    {"dumpHookProbesToLogcat", "()V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dumpHookProbesToLogcat)},
+    {"dumpSamplingProfile", "(Ljava/lang/String;)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dumpSamplingProfile)},
     {"dup3", "(III)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_dup3)},
+    {"findClassesInDexIndex", "(Ljava/lang/String;Ljava/lang/String;[Ljava/lang/String;)[I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_findClassesInDexIndex)},
     {"free", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_free)},
+    {"getAobScanStatsReport", "()Ljava/lang/String;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_getAobScanStatsReport)},
+    {"getHookProbeReport", "()Ljava/lang/String;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_getHookProbeReport)},
     {"getProcessDumpableState", "()I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_getProcessDumpableState)},
     {"getpagesize", "()I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_getpagesize)},
     {"invokeNonVirtualArtMethodImpl", "(Ljava/lang/reflect/Member;Ljava/lang/String;Ljava/lang/Class;ZLjava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_invokeNonVirtualArtMethodImpl)},
     {"invokeNonVirtualImpl", "(Ljava/lang/Class;Ljava/lang/String;Ljava/lang/String;Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_invokeNonVirtualImpl)},
+    {"isSamplingProfilerRunning", "()Z", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_isSamplingProfilerRunning)},
     {"lseek", "(IJI)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_lseek)},
     {"malloc", "(I)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_malloc)},
     {"memcpy", "(JJI)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_memcpy)},
@@ -956,8 +1285,19 @@ static JNINativeMethod gMethods[] = {
     {"mwrite", "(JI[BI)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_mwrite)},
     {"open", "(Ljava/lang/String;II)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_open)},
     {"read", "(I[BII)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_read)},
+    {"recordHookProbe", "(IJ)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_recordHookProbe)},
+    {"registerHookProbe", "(Ljava/lang/String;)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_registerHookProbe)},
+    {"resetHookProbes", "()V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_resetHookProbes)},
+    {"setHookProbesEnabledImpl", "(Z)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_setHookProbesEnabledImpl)},
     {"setProcessDumpableState", "(I)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_setProcessDumpableState)},
     {"sizeofptr", "()I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_sizeofptr)},
+    {"startSamplingProfiler", "([II)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_startSamplingProfiler)},
+    {"stopSamplingProfiler", "()V", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_stopSamplingProfiler)},
+    {"uinToMd5HexBatch", "([J)[Ljava/lang/String;", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_uinToMd5HexBatch)},
+    {"updateAdler32", "(I[BII)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_updateAdler32)},
+    {"updateAdler32Direct", "(ILjava/nio/ByteBuffer;II)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_updateAdler32Direct)},
+    {"updateCrc32", "(I[BII)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_updateCrc32)},
+    {"updateCrc32Direct", "(ILjava/nio/ByteBuffer;II)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_updateCrc32Direct)},
     {"write", "(I[BII)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_Natives_write)},
 };
 //@formatter:on
@@ -0,0 +1,340 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "PcmFrontend.h"
+
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+#include <fmt/format.h>
+
+#include "SKP_Silk_SigProc_FIX.h"
+#include "utils/BinaryCursor.h"
+
+namespace qauxv::audio {
+
+using utils::BinaryCursor;
+using utils::BinarySpan;
+
+static constexpr uint16_t kWaveFormatPcm = 0x0001;
+static constexpr uint16_t kWaveFormatIeeeFloat = 0x0003;
+static constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+// keep each resampler call below RESAMPLER_MAX_BATCH_SIZE_IN, the SILK resampler restarts its phase on every batch
+static constexpr int kMaxResamplerBatchIn = 480;
+// the highest input rate the SILK resampler handles without its pre-downsampler
+static constexpr int kMaxDirectResamplerRate = 48000;
+
+int PcmFormat::GetBytesPerSample() const noexcept {
+    switch (sampleFormat) {
+        case PcmSampleFormat::kUInt8:
+            return 1;
+        case PcmSampleFormat::kInt16:
+            return 2;
+        case PcmSampleFormat::kInt24:
+            return 3;
+        case PcmSampleFormat::kInt32:
+        case PcmSampleFormat::kFloat32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+bool IsWavFile(std::span<const uint8_t> file) noexcept {
+    return file.size() >= 12 && memcmp(file.data(), "RIFF", 4) == 0 && memcmp(file.data() + 8, "WAVE", 4) == 0;
+}
+
+std::string ParseWavHeader(std::span<const uint8_t> file, WavInfo& info) {
+    if (!IsWavFile(file)) {
+        return "not a RIFF/WAVE file";
+    }
+    const BinarySpan fileSpan(file);
+    BinaryCursor cursor(fileSpan);
+    // the RIFF header, checked by IsWavFile
+    (void) cursor.Skip(12);
+    bool hasFormat = false;
+    BinarySpan chunkId;
+    uint32_t chunkSize = 0;
+    while (cursor.ReadSpan(4, chunkId) && cursor.ReadLe(chunkSize)) {
+        const size_t payloadOffset = cursor.Position();
+        if (chunkId.AsStringView() == "fmt ") {
+            uint16_t formatTag = 0;
+            uint16_t channels = 0;
+            uint32_t sampleRate = 0;
+            uint16_t bitsPerSample = 0;
+            const auto format = fileSpan.Slice(payloadOffset, chunkSize);
+            if (chunkSize < 16 || !format || !format->ReadLe(0, formatTag) || !format->ReadLe(2, channels)
+                    || !format->ReadLe(4, sampleRate) || !format->ReadLe(14, bitsPerSample)) {
+                return fmt::format("invalid fmt chunk size {}", chunkSize);
+            }
+            if (formatTag == kWaveFormatExtensible) {
+                // the first 2 bytes of the sub-format GUID are the format tag
+                if (chunkSize < 40 || !format->ReadLe(24, formatTag)) {
+                    return fmt::format("invalid WAVE_FORMAT_EXTENSIBLE fmt chunk size {}", chunkSize);
+                }
+            }
+            if (formatTag == kWaveFormatPcm) {
+                switch (bitsPerSample) {
+                    case 8:
+                        info.format.sampleFormat = PcmSampleFormat::kUInt8;
+                        break;
+                    case 16:
+                        info.format.sampleFormat = PcmSampleFormat::kInt16;
+                        break;
+                    case 24:
+                        info.format.sampleFormat = PcmSampleFormat::kInt24;
+                        break;
+                    case 32:
+                        info.format.sampleFormat = PcmSampleFormat::kInt32;
+                        break;
+                    default:
+                        return fmt::format("unsupported PCM bits per sample {}", bitsPerSample);
+                }
+            } else if (formatTag == kWaveFormatIeeeFloat) {
+                if (bitsPerSample != 32) {
+                    return fmt::format("unsupported float bits per sample {}", bitsPerSample);
+                }
+                info.format.sampleFormat = PcmSampleFormat::kFloat32;
+            } else {
+                return fmt::format("unsupported wave format tag 0x{:x}", formatTag);
+            }
+            if (channels == 0 || channels > 8) {
+                return fmt::format("unsupported channel count {}", channels);
+            }
+            if (sampleRate == 0) {
+                return "invalid sample rate 0";
+            }
+            info.format.channels = channels;
+            info.format.sampleRate = int(sampleRate);
+            hasFormat = true;
+        } else if (chunkId.AsStringView() == "data") {
+            if (!hasFormat) {
+                return "data chunk before fmt chunk";
+            }
+            info.dataOffset = payloadOffset;
+            info.dataLength = std::min<size_t>(chunkSize, file.size() - payloadOffset);
+            // drop the trailing partial frame
+            info.dataLength -= info.dataLength % info.format.GetBytesPerFrame();
+            return {};
+        }
+        // chunks are padded to even size
+        if (!cursor.Skip(chunkSize) || !cursor.Skip(chunkSize & 1u)) {
+            break;
+        }
+    }
+    return hasFormat ? "data chunk not found" : "fmt chunk not found";
+}
+
+class PcmFrontend::ResamplerState {
+public:
+    SKP_Silk_resampler_state_struct state = {};
+};
+
+PcmFrontend::PcmFrontend() = default;
+
+PcmFrontend::~PcmFrontend() noexcept = default;
+
+std::string PcmFrontend::Init(const PcmFormat& input, int outputSampleRate) {
+    if (input.GetBytesPerSample() == 0) {
+        return fmt::format("invalid sample format {}", int(input.sampleFormat));
+    }
+    if (input.channels <= 0) {
+        return fmt::format("invalid channel count {}", input.channels);
+    }
+    if (input.sampleRate < 8000 || input.sampleRate > 192000) {
+        return fmt::format("input sample rate {} out of range, valid range 8000 - 192000", input.sampleRate);
+    }
+    if (outputSampleRate < 8000 || outputSampleRate > 48000) {
+        return fmt::format("output sample rate {} out of range, valid range 8000 - 48000", outputSampleRate);
+    }
+    mInput = input;
+    mOutputSampleRate = outputSampleRate;
+    mPartialFrame.clear();
+    mMono.clear();
+    mIsPassThrough = input.sampleRate == outputSampleRate;
+    if (mIsPassThrough) {
+        mResampler.reset();
+        mCycleIn = 1;
+        mCycleOut = 1;
+        return {};
+    }
+    if (input.sampleRate > kMaxDirectResamplerRate) {
+        // Above 48 kHz the SILK resampler halves (or quarters) the input first, in 10 ms batches of its own whose
+        // lengths it assumes to be whole. Feed it whole 10 ms batches only, the rest is carried over to the next call.
+        const int preDownsample = input.sampleRate > 2 * kMaxDirectResamplerRate ? 4 : 2;
+        if (input.sampleRate % (100 * preDownsample) != 0 || outputSampleRate % 100 != 0) {
+            return fmt::format("unsupported resampling ratio {}:{}, resample above 48000 Hz to a multiple of {} Hz first",
+                               input.sampleRate, outputSampleRate, 100 * preDownsample);
+        }
+        mCycleIn = input.sampleRate / 100;
+        mCycleOut = outputSampleRate / 100;
+    } else {
+        int gcd = std::gcd(input.sampleRate, outputSampleRate);
+        mCycleIn = input.sampleRate / gcd;
+        mCycleOut = outputSampleRate / gcd;
+        if (mCycleIn > kMaxResamplerBatchIn) {
+            return fmt::format("unsupported resampling ratio {}:{}", input.sampleRate, outputSampleRate);
+        }
+    }
+    if (!mResampler) {
+        mResampler = std::make_unique<ResamplerState>();
+    }
+    if (SKP_Silk_resampler_init(&mResampler->state, input.sampleRate, outputSampleRate) != 0) {
+        return fmt::format("SKP_Silk_resampler_init({}, {}) failed", input.sampleRate, outputSampleRate);
+    }
+    return {};
+}
+
+void PcmFrontend::ConvertToMono(const uint8_t* input, size_t frameCount, int16_t* out) const noexcept {
+    // The loops below are kept branch-free per sample so that the compiler can vectorize them.
+    const int channels = mInput.channels;
+    switch (mInput.sampleFormat) {
+        case PcmSampleFormat::kInt16: {
+            if (channels == 1) {
+                memcpy(out, input, frameCount * sizeof(int16_t));
+                return;
+            }
+            for (size_t i = 0; i < frameCount; i++) {
+                int32_t sum = 0;
+                for (int c = 0; c < channels; c++) {
+                    int16_t s;
+                    memcpy(&s, input + (i * channels + c) * 2, 2);
+                    sum += s;
+                }
+                out[i] = int16_t(sum / channels);
+            }
+            return;
+        }
+        case PcmSampleFormat::kUInt8: {
+            for (size_t i = 0; i < frameCount; i++) {
+                int32_t sum = 0;
+                for (int c = 0; c < channels; c++) {
+                    sum += (int32_t(input[i * channels + c]) - 128) << 8;
+                }
+                out[i] = int16_t(sum / channels);
+            }
+            return;
+        }
+        case PcmSampleFormat::kInt24: {
+            for (size_t i = 0; i < frameCount; i++) {
+                int32_t sum = 0;
+                for (int c = 0; c < channels; c++) {
+                    const uint8_t* p = input + (i * channels + c) * 3;
+                    // sign-extend the 24-bit sample, then keep the upper 16 bits
+                    int32_t s = int32_t((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 16;
+                    sum += s;
+                }
+                out[i] = int16_t(sum / channels);
+            }
+            return;
+        }
+        case PcmSampleFormat::kInt32: {
+            for (size_t i = 0; i < frameCount; i++) {
+                int32_t sum = 0;
+                for (int c = 0; c < channels; c++) {
+                    int32_t s;
+                    memcpy(&s, input + (i * channels + c) * 4, 4);
+                    sum += s >> 16;
+                }
+                out[i] = int16_t(sum / channels);
+            }
+            return;
+        }
+        case PcmSampleFormat::kFloat32: {
+            const float scale = 32768.0f / float(channels);
+            for (size_t i = 0; i < frameCount; i++) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; c++) {
+                    float s;
+                    memcpy(&s, input + (i * channels + c) * 4, 4);
+                    sum += s;
+                }
+                float v = std::clamp(sum * scale, -32768.0f, 32767.0f);
+                out[i] = int16_t(v);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+void PcmFrontend::Process(std::span<const uint8_t> input, std::vector<int16_t>& out) {
+    const size_t bytesPerFrame = mInput.GetBytesPerFrame();
+    if (bytesPerFrame == 0) {
+        return;
+    }
+    // the output goes straight to out if no resampling is required
+    std::vector<int16_t>& mono = mIsPassThrough ? out : mMono;
+    // complete the partial frame left by the previous call
+    if (!mPartialFrame.empty()) {
+        size_t need = std::min(bytesPerFrame - mPartialFrame.size(), input.size());
+        mPartialFrame.insert(mPartialFrame.end(), input.begin(), input.begin() + ptrdiff_t(need));
+        input = input.subspan(need);
+        if (mPartialFrame.size() == bytesPerFrame) {
+            size_t pos = mono.size();
+            mono.resize(pos + 1);
+            ConvertToMono(mPartialFrame.data(), 1, mono.data() + pos);
+            mPartialFrame.clear();
+        }
+    }
+    size_t frameCount = input.size() / bytesPerFrame;
+    if (frameCount != 0) {
+        size_t pos = mono.size();
+        mono.resize(pos + frameCount);
+        ConvertToMono(input.data(), frameCount, mono.data() + pos);
+    }
+    size_t tail = input.size() - frameCount * bytesPerFrame;
+    if (tail != 0) {
+        mPartialFrame.assign(input.end() - ptrdiff_t(tail), input.end());
+    }
+    if (!mIsPassThrough) {
+        Resample(out, false);
+    }
+}
+
+void PcmFrontend::Flush(std::vector<int16_t>& out) {
+    mPartialFrame.clear();
+    if (!mIsPassThrough) {
+        Resample(out, true);
+    }
+}
+
+void PcmFrontend::Resample(std::vector<int16_t>& out, bool flush) {
+    size_t available = mMono.size();
+    size_t keep = available % size_t(mCycleIn);
+    bool hasPaddedTail = false;
+    size_t expectedTailOut = 0;
+    if (flush && keep != 0) {
+        // pad the last incomplete cycle with silence and only keep the proportional part of its output
+        expectedTailOut = keep * size_t(mCycleOut) / size_t(mCycleIn);
+        mMono.resize(available + size_t(mCycleIn) - keep, 0);
+        available = mMono.size();
+        keep = 0;
+        hasPaddedTail = true;
+    }
+    size_t usable = available - keep;
+    if (usable == 0) {
+        return;
+    }
+    const size_t batchIn = size_t(mCycleIn) * std::max(1, kMaxResamplerBatchIn / mCycleIn);
+    const size_t batchOut = batchIn / size_t(mCycleIn) * size_t(mCycleOut);
+    size_t pos = out.size();
+    out.resize(pos + usable / size_t(mCycleIn) * size_t(mCycleOut));
+    size_t consumed = 0;
+    while (consumed < usable) {
+        size_t nIn = std::min(batchIn, usable - consumed);
+        SKP_Silk_resampler(&mResampler->state, out.data() + pos, mMono.data() + consumed, SKP_int32(nIn));
+        consumed += nIn;
+        pos += nIn == batchIn ? batchOut : nIn / size_t(mCycleIn) * size_t(mCycleOut);
+    }
+    if (hasPaddedTail) {
+        out.resize(out.size() - size_t(mCycleOut) + expectedTailOut);
+    }
+    mMono.erase(mMono.begin(), mMono.begin() + ptrdiff_t(usable));
+}
+
+}
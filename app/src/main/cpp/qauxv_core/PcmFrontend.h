@@ -0,0 +1,119 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_PCMFRONTEND_H
+#define QAUXV_PCMFRONTEND_H
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace qauxv::audio {
+
+enum class PcmSampleFormat : int {
+    kUInt8 = 1,
+    kInt16 = 2,
+    kInt24 = 3,
+    kInt32 = 4,
+    kFloat32 = 5,
+};
+
+struct PcmFormat {
+    PcmSampleFormat sampleFormat = PcmSampleFormat::kInt16;
+    int channels = 1;
+    int sampleRate = 0;
+
+    [[nodiscard]] int GetBytesPerSample() const noexcept;
+
+    [[nodiscard]] inline int GetBytesPerFrame() const noexcept {
+        return GetBytesPerSample() * channels;
+    }
+};
+
+struct WavInfo {
+    PcmFormat format;
+    // offset and length of the "data" chunk payload in the file
+    size_t dataOffset = 0;
+    size_t dataLength = 0;
+};
+
+/**
+ * Check whether the buffer starts with a RIFF/WAVE header.
+ */
+[[nodiscard]] bool IsWavFile(std::span<const uint8_t> file) noexcept;
+
+/**
+ * Parse the RIFF/WAVE header of a file.
+ * Supports WAVE_FORMAT_PCM (8/16/24/32 bits), WAVE_FORMAT_IEEE_FLOAT (32 bits) and WAVE_FORMAT_EXTENSIBLE with one of them as sub-format.
+ * A truncated data chunk, e.g. written by a recorder that has not finalized the header yet, is clamped to the file size.
+ * @param file the whole file content
+ * @param info the result
+ * @return empty string on success, or an error message
+ */
+[[nodiscard]] std::string ParseWavHeader(std::span<const uint8_t> file, WavInfo& info);
+
+/**
+ * Converts interleaved PCM in any of the supported sample formats into mono PCM16 at the given output sample rate.
+ * Multiple channels are averaged, resampling is done with the SILK resampler.
+ * The input may be fed in chunks of any size, including partial frames.
+ */
+class PcmFrontend {
+public:
+    PcmFrontend();
+
+    ~PcmFrontend() noexcept;
+
+    PcmFrontend(const PcmFrontend&) = delete;
+
+    PcmFrontend& operator=(const PcmFrontend&) = delete;
+
+    /**
+     * Initialize or re-initialize the front-end.
+     * @param input the format of the input, 8000 - 192000 Hz, rates above 48000 Hz must be a multiple of 200 Hz
+     * (400 Hz above 96000 Hz) and need an output rate which is a multiple of 100 Hz
+     * @param outputSampleRate output sample rate in Hz, 8000 - 48000
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Init(const PcmFormat& input, int outputSampleRate);
+
+    /**
+     * Convert a chunk of input, the produced samples are appended to out.
+     * Trailing bytes which do not form a whole frame, and input samples which do not yet form a whole resampler cycle,
+     * are kept until the next call.
+     */
+    void Process(std::span<const uint8_t> input, std::vector<int16_t>& out);
+
+    /**
+     * Drain the samples kept in the resampler, the produced samples are appended to out.
+     */
+    void Flush(std::vector<int16_t>& out);
+
+    [[nodiscard]] inline bool IsPassThrough() const noexcept {
+        return mIsPassThrough;
+    }
+
+private:
+    void ConvertToMono(const uint8_t* input, size_t frameCount, int16_t* out) const noexcept;
+
+    void Resample(std::vector<int16_t>& out, bool flush);
+
+    class ResamplerState;
+
+    PcmFormat mInput;
+    int mOutputSampleRate = 0;
+    bool mIsPassThrough = false;
+    // samples per resampler cycle, input and output side
+    int mCycleIn = 1;
+    int mCycleOut = 1;
+    std::unique_ptr<ResamplerState> mResampler;
+    std::vector<uint8_t> mPartialFrame;
+    std::vector<int16_t> mMono;
+};
+
+}
+
+#endif //QAUXV_PCMFRONTEND_H
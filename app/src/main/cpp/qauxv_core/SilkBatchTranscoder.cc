@@ -0,0 +1,169 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "SilkBatchTranscoder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "utils/FileIo.h"
+#include "utils/FileMemMap.h"
+#include "utils/auto_close_fd.h"
+
+namespace qauxv::audio {
+
+// the encoder writes a few bytes at a time, they are collected to save system calls
+static constexpr size_t kOutputBufferSize = 64 * 1024;
+
+static SilkBatchEvent MakeEvent(SilkBatchEvent::Type type, size_t index) {
+    SilkBatchEvent event;
+    event.type = type;
+    event.index = index;
+    return event;
+}
+
+SilkBatchTranscoder::~SilkBatchTranscoder() {
+    Cancel();
+    for (auto& worker: mWorkers) {
+        worker.join();
+    }
+}
+
+std::string SilkBatchTranscoder::Start(std::vector<SilkBatchFile> files, const SilkEncoderOptions& options, int workerCount) {
+    if (!mWorkers.empty()) {
+        return "Error: the job has already been started";
+    }
+    mFiles = std::move(files);
+    mOptions = options;
+    if (mFiles.empty()) {
+        return {};
+    }
+    const int cpuCount = int(std::max(1u, std::thread::hardware_concurrency()));
+    workerCount = std::clamp(workerCount, 1, int(std::min(size_t(cpuCount), mFiles.size())));
+    mWorkers.reserve(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        mWorkers.emplace_back(&SilkBatchTranscoder::RunWorker, this);
+    }
+    return {};
+}
+
+void SilkBatchTranscoder::Cancel() noexcept {
+    mCancelled.store(true, std::memory_order_relaxed);
+}
+
+void SilkBatchTranscoder::PostEvent(SilkBatchEvent&& event) {
+    {
+        std::lock_guard lock(mEventMutex);
+        if (event.type != SilkBatchEvent::Type::kStarted) {
+            mFinishedFiles++;
+        }
+        mEvents.push_back(std::move(event));
+    }
+    mEventCondition.notify_one();
+}
+
+bool SilkBatchTranscoder::WaitEvent(SilkBatchEvent& event, int timeoutMs) {
+    std::unique_lock lock(mEventMutex);
+    auto ready = [this] {
+        return !mEvents.empty() || mFinishedFiles == mFiles.size();
+    };
+    if (timeoutMs < 0) {
+        mEventCondition.wait(lock, ready);
+    } else if (!mEventCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+        return false;
+    }
+    if (mEvents.empty()) {
+        return false;
+    }
+    event = std::move(mEvents.front());
+    mEvents.pop_front();
+    return true;
+}
+
+bool SilkBatchTranscoder::IsDone() {
+    std::lock_guard lock(mEventMutex);
+    return mEvents.empty() && mFinishedFiles == mFiles.size();
+}
+
+void SilkBatchTranscoder::RunWorker() {
+    // the encoder state is allocated once per worker
+    SilkEncoder encoder;
+    while (true) {
+        const size_t index = mNextFile.fetch_add(1, std::memory_order_relaxed);
+        if (index >= mFiles.size()) {
+            return;
+        }
+        if (mCancelled.load(std::memory_order_relaxed)) {
+            PostEvent(MakeEvent(SilkBatchEvent::Type::kCancelled, index));
+            continue;
+        }
+        PostEvent(MakeEvent(SilkBatchEvent::Type::kStarted, index));
+        PostEvent(ConvertFile(encoder, index));
+    }
+}
+
+SilkBatchEvent SilkBatchTranscoder::ConvertFile(SilkEncoder& encoder, size_t index) {
+    const auto& file = mFiles[index];
+    SilkBatchEvent result = MakeEvent(SilkBatchEvent::Type::kFailed, index);
+    FileMemMap input;
+    if (int err = input.mapFilePath(file.inputPath.c_str(), true, 0, FileMemMap::AccessHint::kSequential); err != 0) {
+        result.error = fmt::format("map {} failed: {}", file.inputPath, strerror(err));
+        return result;
+    }
+    auto_close_fd output(open(file.outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (!output.valid()) {
+        result.error = fmt::format("open {} failed: {}", file.outputPath, strerror(errno));
+        return result;
+    }
+    std::vector<uint8_t> buffer;
+    buffer.reserve(kOutputBufferSize);
+    auto flush = [&buffer, &output, &result]() -> int {
+        int err = utils::WriteFully(output.get(), buffer.data(), buffer.size());
+        result.outputBytes += buffer.size();
+        buffer.clear();
+        return err;
+    };
+    std::string err = encoder.Encode({static_cast<const uint8_t*>(input.getAddress()), input.getLength()}, mOptions,
+                                     [this, &buffer, &flush](const void* data, size_t size) -> int {
+                                         // checked for every packet, so that a running encode stops within 20 ms of audio
+                                         if (mCancelled.load(std::memory_order_relaxed)) {
+                                             return -ECANCELED;
+                                         }
+                                         if (buffer.size() + size > kOutputBufferSize) {
+                                             if (int ret = flush(); ret != 0) {
+                                                 return -ret;
+                                             }
+                                         }
+                                         const auto* p = static_cast<const uint8_t*>(data);
+                                         buffer.insert(buffer.end(), p, p + size);
+                                         return 0;
+                                     });
+    if (err.empty()) {
+        if (int ret = flush(); ret != 0) {
+            err = fmt::format("write failed: {}", strerror(ret));
+        }
+    }
+    if (err.empty()) {
+        result.type = SilkBatchEvent::Type::kSucceeded;
+        return result;
+    }
+    // do not leave a truncated stream behind, it would look like a valid but short clip
+    output.close();
+    unlink(file.outputPath.c_str());
+    result.outputBytes = 0;
+    if (mCancelled.load(std::memory_order_relaxed)) {
+        result.type = SilkBatchEvent::Type::kCancelled;
+    } else {
+        result.error = fmt::format("{}: {}", file.inputPath, err);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,121 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_SILKBATCHTRANSCODER_H
+#define QAUXV_SILKBATCHTRANSCODER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "qauxv_core/SilkEncoder.h"
+
+namespace qauxv::audio {
+
+struct SilkBatchFile {
+    std::string inputPath;
+    std::string outputPath;
+};
+
+struct SilkBatchEvent {
+    enum class Type {
+        // a worker has picked up the file
+        kStarted = 0,
+        kSucceeded = 1,
+        // the file could not be converted, see error, the other files are not affected
+        kFailed = 2,
+        // the job was cancelled before or while the file was converted, no output is left behind
+        kCancelled = 3,
+    };
+    Type type = Type::kStarted;
+    // the index of the file in the list given to Start
+    size_t index = 0;
+    // the error message of kFailed
+    std::string error;
+    // the size of the output of kSucceeded
+    size_t outputBytes = 0;
+};
+
+/**
+ * Converts a list of files to Silk v3 on a bounded pool of worker threads.
+ *
+ * Every worker takes the next pending file, maps its input and encodes it with its own SilkEncoder, which is reused
+ * for all the files of that worker. All progress is reported through one queue of events, which is drained by
+ * a single consumer with WaitEvent, so the caller needs no synchronization of its own.
+ * Every file gets exactly one kStarted event, except cancelled pending ones, and exactly one final event.
+ *
+ * Cancel stops the job as soon as possible: pending files are not started and running encodes are aborted at
+ * their next packet, their partial output is deleted.
+ */
+class SilkBatchTranscoder {
+public:
+    SilkBatchTranscoder() = default;
+
+    SilkBatchTranscoder(const SilkBatchTranscoder&) = delete;
+
+    SilkBatchTranscoder& operator=(const SilkBatchTranscoder&) = delete;
+
+    // cancels the job and waits for the workers
+    ~SilkBatchTranscoder();
+
+    /**
+     * Start converting the files in the background, may only be called once.
+     * @param files the input and output paths, an existing output is replaced
+     * @param options the encoder options for every file
+     * @param workerCount the maximum number of workers, it is limited to the number of CPUs and files, at least 1
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Start(std::vector<SilkBatchFile> files, const SilkEncoderOptions& options, int workerCount);
+
+    /**
+     * Stop the job, this returns without waiting for the workers. The cancellation is reported by the events.
+     */
+    void Cancel() noexcept;
+
+    /**
+     * Wait for the next event.
+     * @param event receives the event
+     * @param timeoutMs the maximum time to wait, or a negative value to wait without limit
+     * @return true if an event was taken, false on timeout or if every file has been reported already
+     */
+    [[nodiscard]] bool WaitEvent(SilkBatchEvent& event, int timeoutMs);
+
+    // whether every file has got its final event and the events have all been taken
+    [[nodiscard]] bool IsDone();
+
+    [[nodiscard]] inline size_t GetFileCount() const noexcept {
+        return mFiles.size();
+    }
+
+    [[nodiscard]] inline int GetWorkerCount() const noexcept {
+        return int(mWorkers.size());
+    }
+
+private:
+    void RunWorker();
+
+    SilkBatchEvent ConvertFile(SilkEncoder& encoder, size_t index);
+
+    void PostEvent(SilkBatchEvent&& event);
+
+    std::vector<SilkBatchFile> mFiles;
+    SilkEncoderOptions mOptions;
+    std::vector<std::thread> mWorkers;
+    std::atomic<size_t> mNextFile = 0;
+    std::atomic<bool> mCancelled = false;
+    std::mutex mEventMutex;
+    std::condition_variable mEventCondition;
+    std::deque<SilkBatchEvent> mEvents;
+    // the number of final events posted, guarded by mEventMutex
+    size_t mFinishedFiles = 0;
+};
+
+}
+
+#endif //QAUXV_SILKBATCHTRANSCODER_H
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <span>
+#include <memory>
 #include <vector>
 #include <malloc.h>
 #include <cerrno>
@@ -11,14 +13,12 @@
 #include <android/log.h>
 
 #include "utils/auto_close_fd.h"
-#include "SKP_Silk_SDK_API.h"
+#include "utils/FileIo.h"
 #include "qauxv_core/jni_method_registry.h"
+#include "qauxv_core/SilkEncoder.h"
+#include "qauxv_core/SilkBatchTranscoder.h"
 
-/* Define codec specific settings */
-#define MAX_BYTES_PER_FRAME     250 // Equals peak bitrate of 100 kbps
-#define MAX_INPUT_FRAMES        5
-#define FRAME_LENGTH_MS         20
-#define MAX_API_FS_KHZ          48
+using namespace qauxv::audio;
 
 void throwIOException(JNIEnv *env, const char *msg) {
     jclass exceptionClass = env->FindClass("java/io/IOException");
@@ -44,35 +44,11 @@ void __attribute__((format(printf, 2, 3))) throwIOExceptionF(JNIEnv *env, const
     throwIOException(env, msg);
 }
 
-int writeFully(int fd, const void *buf, size_t count) {
-    const auto *p = (const uint8_t *) buf;
-    while (count > 0) {
-        ssize_t n = write(fd, p, count);
-        if (n < 0) {
-            return -errno;
-        }
-        p += n;
-        count -= n;
-    }
-    return 0;
-}
-
-int writeOrThrow(JNIEnv *env, int fd, const void *buf, size_t count) {
-    int ret = writeFully(fd, buf, count);
-    if (ret < 0) {
-        throwIOExceptionF(env, "write(%d, %p, %zu) failed: %s", fd, buf, count, strerror(-ret));
-    }
-    return ret;
-}
-
 void convertPcm16leToSilk(
         JNIEnv *env,
         jint input_fd,
         jint output_fd,
-        jint sample_rate,
-        jint bit_rate,
-        jint packet_size,
-        jboolean tencent
+        const SilkEncoderOptions &options
 ) {
     auto_close_fd _input(input_fd);
     auto_close_fd _output(output_fd);
@@ -95,53 +71,6 @@ void convertPcm16leToSilk(
         throwIOExceptionF(env, "ftruncate(output_fd, 0) failed: %s", strerror(errno));
         return;
     }
-    /* Add Silk header to stream */
-    {
-        if (tencent) {
-            static const char Tencent_break[] = {2};
-            if (writeOrThrow(env, output_fd, Tencent_break, 1) < 0) {
-                return;
-            }
-        }
-        static const char Silk_header[] = "#!SILK_V3";
-        if (writeOrThrow(env, output_fd, Silk_header, sizeof(Silk_header) - 1) < 0) {
-            return;
-        }
-    }
-    SKP_int32 encSizeBytes;
-    /* Create Encoder */
-    int ret = SKP_Silk_SDK_Get_Encoder_Size(&encSizeBytes);
-    if (ret) {
-        throwIOExceptionF(env, "SKP_Silk_SDK_Get_Encoder_Size returned %d\n", ret);
-        return;
-    }
-    std::vector<uint8_t> encoder_state;
-    encoder_state.resize(encSizeBytes);
-    void *psEnc = encoder_state.data();
-
-    SKP_SILK_SDK_EncControlStruct encControl = {}; // Struct for input to encoder
-    SKP_SILK_SDK_EncControlStruct encStatus = {};  // Struct for status of encoder
-    /* Reset Encoder */
-    ret = SKP_Silk_SDK_InitEncoder(psEnc, &encStatus);
-    if (ret) {
-        throwIOExceptionF(env, "SKP_Silk_SDK_InitEncoder returned %d\n", ret);
-        return;
-    }
-
-    /* Set Encoder parameters */
-    encControl.API_sampleRate = sample_rate;
-    encControl.maxInternalSampleRate = sample_rate;
-    encControl.packetSize = packet_size;
-    encControl.packetLossPercentage = 0;
-    encControl.useInBandFEC = 0;
-    encControl.useDTX = 0;
-    encControl.complexity = 2;
-    encControl.bitRate = bit_rate;
-
-    if (sample_rate > MAX_API_FS_KHZ * 1000 || sample_rate < 0) {
-        throwIOExceptionF(env, "Error: API sampling rate = %d out of range, valid range 8000 - 48000", sample_rate);
-        return;
-    }
     class UnmapHelper {
      private:
       void *addr;
@@ -167,61 +96,24 @@ void convertPcm16leToSilk(
         return;
     }
     UnmapHelper _input_addr(input_addr, input_size);
-    int frameSizeReadFromFile_ms = 20;
-    auto *inputBase = reinterpret_cast<SKP_int16 *> (input_addr);
-    int totalSampleCount = (int) (input_size / sizeof(SKP_int16));
-    int offset = 0;
-    constexpr auto outputBufferSize = MAX_BYTES_PER_FRAME * MAX_INPUT_FRAMES;
-    SKP_uint8 outputBuffer[outputBufferSize];
-    int outputBufferOffset = 0;
-    int smplsSinceLastPacket = 0;
-    while (true) {
-        /* Read input from file */
-        int count = (frameSizeReadFromFile_ms * sample_rate) / 1000;
-        if (offset + count > totalSampleCount) {
-            break;
-        }
-        auto nBytes = (SKP_int16) (outputBufferSize - outputBufferOffset);
-        /* Silk Encoder */
-        ret = SKP_Silk_SDK_Encode(psEnc, &encControl,
-                                  inputBase + offset, (SKP_int16) count,
-                                  outputBuffer + outputBufferOffset, &nBytes);
-        if (ret) {
-            throwIOExceptionF(env, "SKP_Silk_Encode returned %d", ret);
-            return;
-        }
-        offset += count;
-        outputBufferOffset += nBytes;
-        /* Get packet size */
-        auto packetSize_ms = (SKP_int) ((1000 * (SKP_int32) encControl.packetSize) / encControl.API_sampleRate);
-        smplsSinceLastPacket += (SKP_int) count;
-        if (((1000 * smplsSinceLastPacket) / sample_rate) == packetSize_ms) {
-            /* Sends a dummy zero size packet in case of DTX period  */
-            /* to make it work with the decoder test program.        */
-            /* In practice should be handled by RTP sequence numbers */
-            /* Write payload size */
-            nBytes = (SKP_int16) outputBufferOffset;
-            if (writeOrThrow(env, output_fd, &nBytes, sizeof(SKP_int16)) < 0) {
-                return;
-            }
-            /* Write payload */
-            if (writeOrThrow(env, output_fd, outputBuffer, outputBufferOffset) < 0) {
-                return;
-            }
-            smplsSinceLastPacket = 0;
-            outputBufferOffset = 0;
-        }
-    }
-    /* Write dummy because it can not end with 0 bytes */
-    SKP_int16 nBytes = -1;
-
-    /* Write payload size */
-    if (!tencent) {
-        if (writeOrThrow(env, output_fd, &nBytes, sizeof(SKP_int16)) < 0) {
-            return;
-        }
+    SilkEncoder encoder;
+    std::string err = encoder.Encode(std::span<const uint8_t>(static_cast<const uint8_t *>(input_addr), size_t(input_size)), options,
+                                     [output_fd](const void *data, size_t size) {
+                                         return -utils::WriteFully(output_fd, data, size);
+                                     });
+    if (!err.empty()) {
+        throwIOException(env, err.c_str());
     }
+}
 
+static SilkEncoderOptions makeDefaultEncoderOptions(jint sample_rate, jint bit_rate, jint packet_size, jboolean tencent) {
+    SilkEncoderOptions options;
+    options.sampleRate = sample_rate;
+    options.bitRate = bit_rate;
+    options.packetSize = packet_size;
+    options.tencent = tencent;
+    options.complexity = kSilkComplexityMax;
+    return options;
 }
 
 extern "C"
@@ -243,7 +135,7 @@ Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkII(JNIEnv *env,
                         bit_rate,
                         packet_size,
                         tencent);
-    convertPcm16leToSilk(env, input_fd, output_fd, sample_rate, bit_rate, packet_size, tencent);
+    convertPcm16leToSilk(env, input_fd, output_fd, makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent));
 }
 
 extern "C"
@@ -266,7 +158,7 @@ Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkIS(JNIEnv *env,
         throwIOExceptionF(env, "open(output_path_str) failed: %s", strerror(errno));
         return;
     }
-    convertPcm16leToSilk(env, input_fd, output_fd, sample_rate, bit_rate, packet_size, tencent);
+    convertPcm16leToSilk(env, input_fd, output_fd, makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent));
 }
 
 extern "C"
@@ -300,7 +192,7 @@ Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkSS(JNIEnv *env,
         throwIOExceptionF(env, "open(output_path_str) failed: %s", strerror(errno));
         return;
     }
-    convertPcm16leToSilk(env, input_fd, output_fd, sample_rate, bit_rate, packet_size, tencent);
+    convertPcm16leToSilk(env, input_fd, output_fd, makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent));
 }
 
 extern "C"
@@ -325,7 +217,165 @@ Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkSI(JNIEnv *env,
         close(output_fd);
         return;
     }
-    convertPcm16leToSilk(env, input_fd, output_fd, sample_rate, bit_rate, packet_size, tencent);
+    convertPcm16leToSilk(env, input_fd, output_fd, makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent));
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkWithOptions(JNIEnv *env,
+                                                                             jclass,
+                                                                             jint input_fd,
+                                                                             jint output_fd,
+                                                                             jint sample_rate,
+                                                                             jint bit_rate,
+                                                                             jint packet_size,
+                                                                             jboolean tencent,
+                                                                             jint complexity,
+                                                                             jboolean use_dtx,
+                                                                             jboolean use_in_band_fec,
+                                                                             jint packet_loss_percentage,
+                                                                             jfloat target_real_time_factor) {
+    SilkEncoderOptions options = makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent);
+    options.complexity = complexity;
+    options.useDTX = use_dtx;
+    options.useInBandFEC = use_in_band_fec;
+    options.packetLossPercentage = packet_loss_percentage;
+    if (target_real_time_factor > 0.0f) {
+        options.targetRealTimeFactor = target_real_time_factor;
+    }
+    convertPcm16leToSilk(env, input_fd, output_fd, options);
+}
+
+static SilkEncoderOptions makeAudioEncoderOptions(jint input_format,
+                                                  jint input_channels,
+                                                  jint input_sample_rate,
+                                                  jint sample_rate,
+                                                  jint bit_rate,
+                                                  jint packet_size,
+                                                  jboolean tencent,
+                                                  jint complexity,
+                                                  jboolean use_dtx,
+                                                  jint preprocess_flags) {
+    SilkEncoderOptions options = makeDefaultEncoderOptions(sample_rate, bit_rate, packet_size, tencent);
+    options.complexity = complexity;
+    options.useDTX = use_dtx;
+    // keep in sync with SilkEncodeUtils.PREPROCESS_*
+    options.preprocessOptions.trimSilence = (preprocess_flags & 1) != 0;
+    options.preprocessOptions.normalize = (preprocess_flags & 2) != 0;
+    options.preprocess = options.preprocessOptions.trimSilence || options.preprocessOptions.normalize;
+    // keep in sync with SilkEncodeUtils.INPUT_FORMAT_*
+    if (input_format == 0) {
+        options.inputType = SilkInputType::kWav;
+    } else {
+        options.inputType = SilkInputType::kRawPcm;
+        options.inputFormat.sampleFormat = static_cast<PcmSampleFormat>(input_format);
+        options.inputFormat.channels = input_channels;
+        options.inputFormat.sampleRate = input_sample_rate;
+    }
+    return options;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeAudioToSilk(JNIEnv *env,
+                                                                jclass,
+                                                                jint input_fd,
+                                                                jint output_fd,
+                                                                jint input_format,
+                                                                jint input_channels,
+                                                                jint input_sample_rate,
+                                                                jint sample_rate,
+                                                                jint bit_rate,
+                                                                jint packet_size,
+                                                                jboolean tencent,
+                                                                jint complexity,
+                                                                jboolean use_dtx,
+                                                                jint preprocess_flags) {
+    SilkEncoderOptions options = makeAudioEncoderOptions(input_format, input_channels, input_sample_rate, sample_rate, bit_rate,
+                                                         packet_size, tencent, complexity, use_dtx, preprocess_flags);
+    convertPcm16leToSilk(env, input_fd, output_fd, options);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchStart(JNIEnv *env,
+                                                               jclass,
+                                                               jobjectArray input_paths,
+                                                               jobjectArray output_paths,
+                                                               jint input_format,
+                                                               jint input_channels,
+                                                               jint input_sample_rate,
+                                                               jint sample_rate,
+                                                               jint bit_rate,
+                                                               jint packet_size,
+                                                               jboolean tencent,
+                                                               jint complexity,
+                                                               jboolean use_dtx,
+                                                               jint preprocess_flags,
+                                                               jint worker_count) {
+    if (input_paths == nullptr || output_paths == nullptr) {
+        env->ThrowNew(env->FindClass("java/lang/NullPointerException"), "paths are null");
+        return 0;
+    }
+    const jsize count = env->GetArrayLength(input_paths);
+    if (env->GetArrayLength(output_paths) != count) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "input and output counts differ");
+        return 0;
+    }
+    std::vector<SilkBatchFile> files(count);
+    for (jsize i = 0; i < count; i++) {
+        auto input = reinterpret_cast<jstring>(env->GetObjectArrayElement(input_paths, i));
+        auto output = reinterpret_cast<jstring>(env->GetObjectArrayElement(output_paths, i));
+        files[i].inputPath = jstring2string(env, input);
+        files[i].outputPath = jstring2string(env, output);
+        env->DeleteLocalRef(input);
+        env->DeleteLocalRef(output);
+        if (files[i].inputPath.empty() || files[i].outputPath.empty()) {
+            throwIOExceptionF(env, "path %d is empty", i);
+            return 0;
+        }
+    }
+    SilkEncoderOptions options = makeAudioEncoderOptions(input_format, input_channels, input_sample_rate, sample_rate, bit_rate,
+                                                         packet_size, tencent, complexity, use_dtx, preprocess_flags);
+    auto job = std::make_unique<SilkBatchTranscoder>();
+    std::string err = job->Start(std::move(files), options, worker_count);
+    if (!err.empty()) {
+        throwIOException(env, err.c_str());
+        return 0;
+    }
+    return reinterpret_cast<jlong>(job.release());
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchWaitEvent(JNIEnv *env,
+                                                                   jclass,
+                                                                   jlong handle,
+                                                                   jint timeout_ms,
+                                                                   jlongArray event_out) {
+    // keep in sync with SilkBatchTranscodeJob.EVENT_*
+    jlong values[3] = {-1, -1, 0};
+    SilkBatchEvent event;
+    if (reinterpret_cast<SilkBatchTranscoder *>(handle)->WaitEvent(event, timeout_ms)) {
+        values[0] = jlong(event.type);
+        values[1] = jlong(event.index);
+        values[2] = jlong(event.outputBytes);
+    }
+    env->SetLongArrayRegion(event_out, 0, 3, values);
+    return event.error.empty() ? nullptr : env->NewStringUTF(event.error.c_str());
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchCancel(JNIEnv *, jclass, jlong handle) {
+    reinterpret_cast<SilkBatchTranscoder *>(handle)->Cancel();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchClose(JNIEnv *, jclass, jlong handle) {
+    // cancels the job and waits for the workers
+    delete reinterpret_cast<SilkBatchTranscoder *>(handle);
 }
 
 //@formatter:off
@@ -334,6 +384,12 @@ static JNINativeMethod gMethods[] = {
         {"nativePcm16leToSilkIS", "(ILjava/lang/String;IIIZ)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkIS)},
         {"nativePcm16leToSilkSI", "(Ljava/lang/String;IIIIZ)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkSI)},
         {"nativePcm16leToSilkSS", "(Ljava/lang/String;Ljava/lang/String;IIIZ)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkSS)},
+        {"nativePcm16leToSilkWithOptions", "(IIIIIZIZZIF)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativePcm16leToSilkWithOptions)},
+        {"nativeAudioToSilk", "(IIIIIIIIZIZI)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeAudioToSilk)},
+        {"nativeBatchStart", "([Ljava/lang/String;[Ljava/lang/String;IIIIIIZIZII)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchStart)},
+        {"nativeBatchWaitEvent", "(JI[J)Ljava/lang/String;", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchWaitEvent)},
+        {"nativeBatchCancel", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchCancel)},
+        {"nativeBatchClose", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkEncodeUtils_nativeBatchClose)},
 };
 //@formatter:on
 REGISTER_PRIMARY_PRE_INIT_NATIVE_METHODS("io/github/qauxv/util/ptt/SilkEncodeUtils", gMethods);
@@ -0,0 +1,269 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "SilkDecoder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "SKP_Silk_SDK_API.h"
+
+namespace qauxv::audio {
+
+static constexpr int kMaxApiFsKHz = 48;
+static constexpr int kMinApiFsHz = 8000;
+static constexpr size_t kMaxFrameSamples = kMaxApiFsKHz * SilkStreamDecoder::kFrameLengthMs;
+// the range decoder can not take more, a longer length means the stream is out of sync
+static constexpr int kMaxPacketBytes = 1024;
+static constexpr uint8_t kTencentHeaderByte = 2;
+static constexpr char kSilkHeader[] = "#!SILK_V3";
+static constexpr size_t kSilkHeaderSize = sizeof(kSilkHeader) - 1;
+
+PcmRingBuffer::PcmRingBuffer(size_t capacity) {
+    const size_t size = std::bit_ceil(std::max<size_t>(capacity, 1));
+    mSamples = std::make_unique<int16_t[]>(size);
+    mMask = size - 1;
+}
+
+size_t PcmRingBuffer::GetReadable() const noexcept {
+    return mWritePosition.load(std::memory_order_acquire) - mReadPosition.load(std::memory_order_acquire);
+}
+
+size_t PcmRingBuffer::GetWritable() const noexcept {
+    return GetCapacity() - GetReadable();
+}
+
+size_t PcmRingBuffer::Write(const int16_t* samples, size_t count) noexcept {
+    const size_t write = mWritePosition.load(std::memory_order_relaxed);
+    const size_t read = mReadPosition.load(std::memory_order_acquire);
+    count = std::min(count, GetCapacity() - (write - read));
+    const size_t index = write & mMask;
+    const size_t first = std::min(count, GetCapacity() - index);
+    memcpy(mSamples.get() + index, samples, first * sizeof(int16_t));
+    memcpy(mSamples.get(), samples + first, (count - first) * sizeof(int16_t));
+    mWritePosition.store(write + count, std::memory_order_release);
+    return count;
+}
+
+size_t PcmRingBuffer::Read(int16_t* samples, size_t count) noexcept {
+    const size_t read = mReadPosition.load(std::memory_order_relaxed);
+    const size_t write = mWritePosition.load(std::memory_order_acquire);
+    count = std::min(count, write - read);
+    const size_t index = read & mMask;
+    const size_t first = std::min(count, GetCapacity() - index);
+    memcpy(samples, mSamples.get() + index, first * sizeof(int16_t));
+    memcpy(samples + first, mSamples.get(), (count - first) * sizeof(int16_t));
+    mReadPosition.store(read + count, std::memory_order_release);
+    return count;
+}
+
+void PcmRingBuffer::Clear() noexcept {
+    mReadPosition.store(0, std::memory_order_relaxed);
+    mWritePosition.store(0, std::memory_order_relaxed);
+}
+
+std::string SilkStreamDecoder::Init(int sampleRate) {
+    if (sampleRate < kMinApiFsHz || sampleRate > kMaxApiFsKHz * 1000) {
+        return fmt::format("Error: API sampling rate = {} out of range, valid range 8000 - 48000", sampleRate);
+    }
+    SKP_int32 decSizeBytes = 0;
+    int ret = SKP_Silk_SDK_Get_Decoder_Size(&decSizeBytes);
+    if (ret) {
+        return fmt::format("SKP_Silk_SDK_Get_Decoder_Size returned {}", ret);
+    }
+    // the state is re-initialized below, the allocation is kept between streams
+    mDecoderState.resize(decSizeBytes);
+    ret = SKP_Silk_SDK_InitDecoder(mDecoderState.data());
+    if (ret) {
+        return fmt::format("SKP_Silk_SDK_InitDecoder returned {}", ret);
+    }
+    mState = State::kHeader;
+    mError.clear();
+    mSampleRate = sampleRate;
+    mInputEnded = false;
+    // one frame per packet, for proper concealment before the first packet arrives
+    mFramesPerPacket = 1;
+    mInput.clear();
+    mInputOffset = 0;
+    mFramesInCurrentPacket = 0;
+    mPendingLostFrames = 0;
+    mStats = {};
+    return {};
+}
+
+void SilkStreamDecoder::CompactInput() {
+    // only move the rest when it is not longer than what is dropped, so that feeding stays linear
+    if (mInputOffset > 0 && mInputOffset >= mInput.size() - mInputOffset) {
+        mInput.erase(mInput.begin(), mInput.begin() + ptrdiff_t(mInputOffset));
+        mInputOffset = 0;
+    }
+}
+
+void SilkStreamDecoder::Feed(std::span<const uint8_t> data) {
+    CompactInput();
+    mInput.insert(mInput.end(), data.begin(), data.end());
+}
+
+std::span<uint8_t> SilkStreamDecoder::AppendInput(size_t count) {
+    CompactInput();
+    const size_t oldSize = mInput.size();
+    mInput.resize(oldSize + count);
+    return {mInput.data() + oldSize, count};
+}
+
+ssize_t SilkStreamDecoder::FeedFromFd(int fd, size_t maxBytes) {
+    CompactInput();
+    const size_t oldSize = mInput.size();
+    mInput.resize(oldSize + maxBytes);
+    ssize_t n;
+    do {
+        n = read(fd, mInput.data() + oldSize, maxBytes);
+    } while (n < 0 && errno == EINTR);
+    const int err = errno;
+    mInput.resize(oldSize + size_t(std::max<ssize_t>(n, 0)));
+    if (n < 0) {
+        return -err;
+    }
+    if (n == 0) {
+        EndOfInput();
+    }
+    return n;
+}
+
+void SilkStreamDecoder::MarkPacketLost() {
+    mPendingLostFrames += mFramesPerPacket;
+}
+
+void SilkStreamDecoder::EndOfInput() {
+    mInputEnded = true;
+}
+
+bool SilkStreamDecoder::HasCompletePacket() const noexcept {
+    const size_t remaining = mInput.size() - mInputOffset;
+    if (remaining < sizeof(SKP_int16)) {
+        return false;
+    }
+    int16_t length;
+    memcpy(&length, mInput.data() + mInputOffset, sizeof(length));
+    // the end marker and a broken length are handled by Decode as well
+    return length < 0 || length > kMaxPacketBytes || remaining - sizeof(SKP_int16) >= size_t(length);
+}
+
+bool SilkStreamDecoder::NeedsInput() const noexcept {
+    if (mInputEnded) {
+        return false;
+    }
+    if (mState == State::kHeader) {
+        return true;
+    }
+    return mState == State::kPackets && mPendingLostFrames == 0 && !HasCompletePacket();
+}
+
+std::string SilkStreamDecoder::ParseHeader() {
+    const uint8_t* p = mInput.data() + mInputOffset;
+    const size_t remaining = mInput.size() - mInputOffset;
+    const size_t start = (remaining > 0 && p[0] == kTencentHeaderByte) ? 1 : 0;
+    const size_t available = std::min(remaining - start, kSilkHeaderSize);
+    // fail early for something which is obviously not a Silk stream
+    if (memcmp(p + start, kSilkHeader, available) != 0) {
+        return "Error: invalid Silk v3 header";
+    }
+    if (available < kSilkHeaderSize) {
+        return mInputEnded ? "Error: truncated Silk v3 header" : "";
+    }
+    mInputOffset += start + kSilkHeaderSize;
+    mState = State::kPackets;
+    return {};
+}
+
+std::string SilkStreamDecoder::Decode(PcmRingBuffer& output) {
+    if (mState == State::kUninitialized) {
+        return "Error: decoder is not initialized";
+    }
+    if (mState == State::kFailed) {
+        return mError;
+    }
+    if (mState == State::kHeader) {
+        mError = ParseHeader();
+        if (!mError.empty()) {
+            mState = State::kFailed;
+            return mError;
+        }
+    }
+    const size_t frameSamples = GetFrameSamples();
+    if (output.GetCapacity() < frameSamples) {
+        return fmt::format("Error: output capacity {} is less than one frame of {} samples", output.GetCapacity(), frameSamples);
+    }
+    SKP_SILK_SDK_DecControlStruct decControl = {};
+    decControl.API_sampleRate = mSampleRate;
+    SKP_int16 samples[kMaxFrameSamples];
+    while (mState == State::kPackets && output.GetWritable() >= frameSamples) {
+        SKP_int16 sampleCount = kMaxFrameSamples;
+        // a packet is finished before any concealment, the decoder keeps the rest of it in its state
+        if (mPendingLostFrames > 0 && mFramesInCurrentPacket == 0) {
+            SKP_Silk_SDK_Decode(mDecoderState.data(), &decControl, 1, nullptr, 0, samples, &sampleCount);
+            output.Write(samples, size_t(sampleCount));
+            mPendingLostFrames--;
+            mStats.concealedFrames++;
+            continue;
+        }
+        if (!HasCompletePacket()) {
+            if (mInputEnded) {
+                // nothing or a truncated packet is left, e.g. a Tencent stream, which has no end marker
+                mInputOffset = mInput.size();
+                mState = State::kFinished;
+            }
+            break;
+        }
+        int16_t length;
+        memcpy(&length, mInput.data() + mInputOffset, sizeof(length));
+        if (length < 0) {
+            // the end marker written by SilkEncoder
+            mInputOffset = mInput.size();
+            mState = State::kFinished;
+            break;
+        }
+        if (length > kMaxPacketBytes) {
+            mError = fmt::format("Error: packet length {} out of range, the stream is corrupt", length);
+            mState = State::kFailed;
+            return mError;
+        }
+        if (length == 0) {
+            // a DTX period or a dropped packet
+            mInputOffset += sizeof(SKP_int16);
+            mPendingLostFrames += mFramesPerPacket;
+            continue;
+        }
+        const uint8_t* payload = mInput.data() + mInputOffset + sizeof(SKP_int16);
+        int ret = SKP_Silk_SDK_Decode(mDecoderState.data(), &decControl, 0, payload, length, samples, &sampleCount);
+        output.Write(samples, size_t(sampleCount));
+        mFramesInCurrentPacket++;
+        bool packetDone;
+        if (ret != 0) {
+            // the decoder has concealed this frame, the rest of the packet is concealed with the duration of the previous one
+            mStats.corruptPackets++;
+            mStats.concealedFrames++;
+            mPendingLostFrames += std::max(0, mFramesPerPacket - mFramesInCurrentPacket);
+            packetDone = true;
+        } else {
+            mStats.decodedFrames++;
+            packetDone = decControl.moreInternalDecoderFrames == 0;
+            if (packetDone) {
+                mFramesPerPacket = std::max(1, decControl.framesPerPacket);
+            }
+        }
+        if (packetDone) {
+            mInputOffset += sizeof(SKP_int16) + size_t(length);
+            mFramesInCurrentPacket = 0;
+        }
+    }
+    return {};
+}
+
+}
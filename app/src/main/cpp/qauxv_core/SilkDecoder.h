@@ -0,0 +1,200 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_SILKDECODER_H
+#define QAUXV_SILKDECODER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace qauxv::audio {
+
+/**
+ * A single-producer single-consumer ring buffer of PCM16 samples.
+ * One thread may write, e.g. a SilkStreamDecoder, while another one reads, e.g. an audio track callback.
+ * No lock is taken, the read and write positions are published with acquire/release ordering.
+ */
+class PcmRingBuffer {
+public:
+    /**
+     * @param capacity the minimum number of samples the buffer can hold, it is rounded up to a power of two
+     */
+    explicit PcmRingBuffer(size_t capacity);
+
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    [[nodiscard]] inline size_t GetCapacity() const noexcept {
+        return mMask + 1;
+    }
+
+    // the number of samples which can be read, only exact on the reader thread
+    [[nodiscard]] size_t GetReadable() const noexcept;
+
+    // the number of samples which can be written, only exact on the writer thread
+    [[nodiscard]] size_t GetWritable() const noexcept;
+
+    /**
+     * Append samples, writer thread only.
+     * @return the number of samples written, less than count if the buffer is full
+     */
+    size_t Write(const int16_t* samples, size_t count) noexcept;
+
+    /**
+     * Take samples, reader thread only.
+     * @return the number of samples read, less than count if the buffer runs empty
+     */
+    size_t Read(int16_t* samples, size_t count) noexcept;
+
+    /**
+     * Drop all samples, neither thread may access the buffer concurrently.
+     */
+    void Clear() noexcept;
+
+private:
+    std::unique_ptr<int16_t[]> mSamples;
+    size_t mMask;
+    // both positions increase monotonically, the index is position & mMask
+    std::atomic<size_t> mReadPosition = 0;
+    std::atomic<size_t> mWritePosition = 0;
+};
+
+struct SilkDecoderStats {
+    // frames decoded from a valid payload
+    uint64_t decodedFrames = 0;
+    // frames generated by the packet loss concealment, for lost, empty and corrupt packets
+    uint64_t concealedFrames = 0;
+    // packets which could not be decoded, their frames are concealed
+    uint64_t corruptPackets = 0;
+};
+
+/**
+ * Decodes a Silk v3 stream incrementally, as written by SilkEncoder: an optional Tencent header byte,
+ * the "#!SILK_V3" magic, then packets prefixed by their int16 little-endian length.
+ *
+ * Input is fed in chunks of any size and each 20 ms frame is written to the output as soon as it is decoded,
+ * so the first samples are available after the first packet rather than after the whole file.
+ * Empty packets, packets reported lost with MarkPacketLost and packets with a corrupt payload are replaced by
+ * the concealment of the SILK decoder, so the output keeps its timing.
+ *
+ * The decoder never blocks: Decode stops when the output has no room for a whole frame and continues where it
+ * left off on the next call, even inside a packet. It is NOT thread-safe, only the output may be read concurrently.
+ */
+class SilkStreamDecoder {
+public:
+    static constexpr int kFrameLengthMs = 20;
+
+    SilkStreamDecoder() = default;
+
+    SilkStreamDecoder(const SilkStreamDecoder&) = delete;
+
+    SilkStreamDecoder& operator=(const SilkStreamDecoder&) = delete;
+
+    /**
+     * Start a new stream, any buffered input and decoder state are discarded.
+     * @param sampleRate the output sample rate, 8000 - 48000, the decoder resamples if the stream differs
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Init(int sampleRate);
+
+    /**
+     * Append stream bytes, nothing is decoded until Decode is called.
+     */
+    void Feed(std::span<const uint8_t> data);
+
+    /**
+     * Append count uninitialized stream bytes, which the caller fills before calling anything else,
+     * e.g. with JNI GetByteArrayRegion, so that the bytes are copied only once.
+     * @return the appended bytes
+     */
+    [[nodiscard]] std::span<uint8_t> AppendInput(size_t count);
+
+    /**
+     * Read at most maxBytes from a file descriptor and feed them. EndOfInput is called when the end of file is reached.
+     * @return the number of bytes read, 0 at the end of file, or a negative errno
+     */
+    [[nodiscard]] ssize_t FeedFromFd(int fd, size_t maxBytes);
+
+    /**
+     * Report that the next packet is missing, e.g. by a jitter buffer which gave up waiting for it.
+     * One packet duration is concealed before the next buffered packet is decoded.
+     */
+    void MarkPacketLost();
+
+    /**
+     * Report that no more input will be fed. A truncated packet at the end is dropped.
+     */
+    void EndOfInput();
+
+    /**
+     * Decode buffered packets into the output until it has no room for another frame or the input runs out.
+     * @param output receives mono PCM16 at the sample rate given to Init
+     * @return empty string on success, or an error message if the stream is malformed, the decoder stops then
+     */
+    [[nodiscard]] std::string Decode(PcmRingBuffer& output);
+
+    // whether Decode needs more input to make progress, i.e. no complete packet is buffered and the input has not ended
+    [[nodiscard]] bool NeedsInput() const noexcept;
+
+    // whether the whole stream has been decoded, or decoding failed
+    [[nodiscard]] inline bool IsFinished() const noexcept {
+        return mState == State::kFinished || mState == State::kFailed;
+    }
+
+    // the number of samples of one frame at the output sample rate
+    [[nodiscard]] inline size_t GetFrameSamples() const noexcept {
+        return size_t(mSampleRate) * kFrameLengthMs / 1000;
+    }
+
+    [[nodiscard]] inline const SilkDecoderStats& GetStats() const noexcept {
+        return mStats;
+    }
+
+private:
+    enum class State {
+        kUninitialized,
+        kHeader,
+        kPackets,
+        kFinished,
+        kFailed,
+    };
+
+    // whether a whole packet, or the end marker, is buffered
+    [[nodiscard]] bool HasCompletePacket() const noexcept;
+
+    [[nodiscard]] std::string ParseHeader();
+
+    void CompactInput();
+
+    State mState = State::kUninitialized;
+    // the reason of kFailed
+    std::string mError;
+    int mSampleRate = 0;
+    bool mInputEnded = false;
+    std::vector<uint8_t> mDecoderState;
+    // reported by the decoder for the last packet, the duration a lost packet is concealed with
+    int mFramesPerPacket = 1;
+    // whether the decoder is in the middle of the current packet
+    bool mMoreInternalFrames = false;
+    std::vector<uint8_t> mInput;
+    // the bytes before this offset have been consumed
+    size_t mInputOffset = 0;
+    // the frames of the current packet which have been written, the packet stays buffered until it is done
+    int mFramesInCurrentPacket = 0;
+    // frames to conceal before the next packet, for lost packets and the rest of a corrupt one
+    int mPendingLostFrames = 0;
+    SilkDecoderStats mStats;
+};
+
+}
+
+#endif //QAUXV_SILKDECODER_H
@@ -0,0 +1,204 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "utils/auto_close_fd.h"
+#include "qauxv_core/jni_method_registry.h"
+#include "qauxv_core/SilkDecoder.h"
+
+using namespace qauxv::audio;
+
+namespace {
+
+// small enough that the first frame is decoded right after the first read
+constexpr size_t kReadChunkSize = 4096;
+
+// keep in sync with SilkDecodeSession.STATS_*
+constexpr jsize kStatsDecodedFrames = 0;
+constexpr jsize kStatsConcealedFrames = 1;
+constexpr jsize kStatsCorruptPackets = 2;
+constexpr jsize kStatsSize = 3;
+
+struct SilkDecodeSessionHandle {
+    SilkStreamDecoder decoder;
+    PcmRingBuffer output;
+    // the input the session reads by itself, invalid if the stream is fed in chunks
+    auto_close_fd input;
+
+    SilkDecodeSessionHandle(size_t outputCapacity, int inputFd) : output(outputCapacity), input(inputFd) {}
+};
+
+SilkDecodeSessionHandle* GetHandle(JNIEnv* env, jlong handle) {
+    if (handle == 0) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), "session is closed");
+        return nullptr;
+    }
+    return reinterpret_cast<SilkDecodeSessionHandle*>(handle);
+}
+
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeOpen(JNIEnv* env, jclass, jint sampleRate, jint bufferSamples,
+                                                           jstring path, jint fd) {
+    if (path != nullptr) {
+        const char* pathChars = env->GetStringUTFChars(path, nullptr);
+        fd = open(pathChars, O_RDONLY | O_CLOEXEC);
+        int err = errno;
+        env->ReleaseStringUTFChars(path, pathChars);
+        if (fd < 0) {
+            env->ThrowNew(env->FindClass("java/io/IOException"), fmt::format("open failed: {}", strerror(err)).c_str());
+            return 0;
+        }
+    }
+    // the handle owns the fd from here on, also if the decoder rejects the sample rate
+    auto handle = std::make_unique<SilkDecodeSessionHandle>(size_t(std::max(bufferSamples, 0)), fd);
+    std::string error = handle->decoder.Init(sampleRate);
+    if (error.empty() && handle->output.GetCapacity() < handle->decoder.GetFrameSamples()) {
+        error = fmt::format("buffer of {} samples is less than one frame", bufferSamples);
+    }
+    if (!error.empty()) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), error.c_str());
+        return 0;
+    }
+    return reinterpret_cast<jlong>(handle.release());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeClose(JNIEnv*, jclass, jlong handle) {
+    delete reinterpret_cast<SilkDecodeSessionHandle*>(handle);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeFeed(JNIEnv* env, jclass, jlong handle, jbyteArray data, jint offset,
+                                                           jint length) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return;
+    }
+    // bounds are checked by the Java side
+    // not a critical region, growing the input buffer may allocate, which must not happen while the GC is held off
+    auto input = h->decoder.AppendInput(size_t(length));
+    env->GetByteArrayRegion(data, offset, length, reinterpret_cast<jbyte*>(input.data()));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeMarkPacketLost(JNIEnv* env, jclass, jlong handle) {
+    if (auto* h = GetHandle(env, handle); h != nullptr) {
+        h->decoder.MarkPacketLost();
+    }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeEndOfInput(JNIEnv* env, jclass, jlong handle) {
+    if (auto* h = GetHandle(env, handle); h != nullptr) {
+        h->decoder.EndOfInput();
+    }
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeDecode(JNIEnv* env, jclass, jlong handle, jint targetSamples) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return -1;
+    }
+    auto& decoder = h->decoder;
+    const size_t frameSamples = decoder.GetFrameSamples();
+    const size_t target = targetSamples > 0 ? size_t(targetSamples) : h->output.GetCapacity();
+    while (!decoder.IsFinished() && h->output.GetReadable() < target) {
+        if (decoder.NeedsInput()) {
+            if (!h->input.valid()) {
+                // wait for the next chunk
+                break;
+            }
+            ssize_t n = decoder.FeedFromFd(h->input.get(), kReadChunkSize);
+            if (n < 0) {
+                env->ThrowNew(env->FindClass("java/io/IOException"), fmt::format("read failed: {}", strerror(int(-n))).c_str());
+                return -1;
+            }
+        }
+        std::string error = decoder.Decode(h->output);
+        if (!error.empty()) {
+            env->ThrowNew(env->FindClass("java/io/IOException"), error.c_str());
+            return -1;
+        }
+        if (h->output.GetWritable() < frameSamples) {
+            break;
+        }
+    }
+    return jint(h->output.GetReadable());
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeRead(JNIEnv* env, jclass, jlong handle, jshortArray buffer, jint offset,
+                                                           jint length) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return -1;
+    }
+    // bounds are checked by the Java side
+    auto* samples = static_cast<int16_t*>(env->GetPrimitiveArrayCritical(buffer, nullptr));
+    if (samples == nullptr) {
+        return -1;
+    }
+    size_t n = h->output.Read(samples + offset, size_t(length));
+    env->ReleasePrimitiveArrayCritical(buffer, samples, 0);
+    return jint(n);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeAvailable(JNIEnv* env, jclass, jlong handle) {
+    auto* h = GetHandle(env, handle);
+    return h == nullptr ? -1 : jint(h->output.GetReadable());
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeIsFinished(JNIEnv* env, jclass, jlong handle) {
+    auto* h = GetHandle(env, handle);
+    return h != nullptr && h->decoder.IsFinished();
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeGetStats(JNIEnv* env, jclass, jlong handle, jlongArray stats) {
+    auto* h = GetHandle(env, handle);
+    if (h == nullptr) {
+        return;
+    }
+    if (stats == nullptr || env->GetArrayLength(stats) < kStatsSize) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "invalid stats array");
+        return;
+    }
+    const auto& s = h->decoder.GetStats();
+    jlong values[kStatsSize] = {};
+    values[kStatsDecodedFrames] = jlong(s.decodedFrames);
+    values[kStatsConcealedFrames] = jlong(s.concealedFrames);
+    values[kStatsCorruptPackets] = jlong(s.corruptPackets);
+    env->SetLongArrayRegion(stats, 0, kStatsSize, values);
+}
+
+//@formatter:off
+static JNINativeMethod gMethods[] = {
+        {"nativeAvailable", "(J)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeAvailable)},
+        {"nativeClose", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeClose)},
+        {"nativeDecode", "(JI)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeDecode)},
+        {"nativeEndOfInput", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeEndOfInput)},
+        {"nativeFeed", "(J[BII)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeFeed)},
+        {"nativeGetStats", "(J[J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeGetStats)},
+        {"nativeIsFinished", "(J)Z", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeIsFinished)},
+        {"nativeMarkPacketLost", "(J)V", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeMarkPacketLost)},
+        {"nativeOpen", "(IILjava/lang/String;I)J", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeOpen)},
+        {"nativeRead", "(J[SII)I", reinterpret_cast<void*>(Java_io_github_qauxv_util_ptt_SilkDecodeSession_nativeRead)},
+};
+//@formatter:on
+REGISTER_PRIMARY_PRE_INIT_NATIVE_METHODS("io/github/qauxv/util/ptt/SilkDecodeSession", gMethods);
@@ -0,0 +1,322 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "SilkEncoder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "SKP_Silk_SDK_API.h"
+#include "utils/Log.h"
+
+namespace qauxv::audio {
+
+/* Define codec specific settings */
+static constexpr int kMaxBytesPerFrame = 250; // Equals peak bitrate of 100 kbps
+static constexpr int kMaxInputFrames = 5;
+static constexpr int kFrameLengthMs = 20;
+static constexpr int kMaxApiFsKHz = 48;
+
+/**
+ * Measures the real-time factor of the first few frames and lowers the complexity
+ * when the encoder can not keep up with the target real-time factor.
+ * After the probe phase the complexity stays unchanged for the rest of the stream.
+ */
+class SilkAutoComplexityController {
+public:
+    static constexpr int kFramesPerWindow = 5;
+    static constexpr int kMaxProbeWindows = 4;
+
+    SilkAutoComplexityController(float targetRealTimeFactor, int frameDurationMs)
+            : mTargetRealTimeFactor(targetRealTimeFactor), mFrameDurationNs(int64_t(frameDurationMs) * 1000000LL) {}
+
+    [[nodiscard]] inline bool IsProbing() const noexcept {
+        return mProbeWindows < kMaxProbeWindows;
+    }
+
+    void BeginFrame() noexcept {
+        if (IsProbing()) {
+            mFrameStartNs = CurrentTimeNanos();
+        }
+    }
+
+    /**
+     * Account the frame that was just encoded.
+     * @param complexity the complexity in use, may be lowered on return.
+     */
+    void EndFrame(SKP_int& complexity) noexcept {
+        if (!IsProbing()) {
+            return;
+        }
+        mWindowEncodeNs += CurrentTimeNanos() - mFrameStartNs;
+        if (++mWindowFrames < kFramesPerWindow) {
+            return;
+        }
+        float rtf = float(mWindowEncodeNs) / float(mFrameDurationNs * mWindowFrames);
+        mWindowFrames = 0;
+        mWindowEncodeNs = 0;
+        mProbeWindows++;
+        if (rtf > mTargetRealTimeFactor && complexity > 0) {
+            complexity--;
+            LOGI("silk encoder rtf {:.3f} > {:.3f}, complexity lowered to {}", rtf, mTargetRealTimeFactor, complexity);
+            // give the new complexity a chance to be measured
+            if (complexity > 0) {
+                mProbeWindows = std::min(mProbeWindows, kMaxProbeWindows - 1);
+            }
+        }
+    }
+
+private:
+    static int64_t CurrentTimeNanos() noexcept {
+        timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    float mTargetRealTimeFactor;
+    int64_t mFrameDurationNs;
+    int64_t mFrameStartNs = 0;
+    int64_t mWindowEncodeNs = 0;
+    int mWindowFrames = 0;
+    int mProbeWindows = 0;
+};
+
+/**
+ * Provides the encoder with 20 ms frames of mono PCM16 at the encoder sample rate.
+ * Input which is already in that format is read from the mapping directly,
+ * everything else goes through the PCM front-end chunk by chunk, so no intermediate file is needed.
+ */
+class SilkInputFrameReader {
+public:
+    void AttachMonoPcm16(const SKP_int16* base, size_t sampleCount) noexcept {
+        mMonoBase = base;
+        mMonoCount = sampleCount;
+        mMonoOffset = 0;
+        mUseFrontend = false;
+    }
+
+    [[nodiscard]] std::string AttachFrontend(std::span<const uint8_t> input, const PcmFormat& format, int sampleRate) {
+        mUseFrontend = true;
+        mInput = input;
+        mFlushed = false;
+        mConverted.clear();
+        mConvertedOffset = 0;
+        return mFrontend.Init(format, sampleRate);
+    }
+
+    /**
+     * Get the next frame.
+     * @param count number of samples in the frame
+     * @return pointer to the samples, valid until the next call, or nullptr if less than count samples are left
+     */
+    const SKP_int16* Next(size_t count) {
+        if (!mUseFrontend) {
+            if (mMonoOffset + count > mMonoCount) {
+                return nullptr;
+            }
+            const SKP_int16* p = mMonoBase + mMonoOffset;
+            mMonoOffset += count;
+            return p;
+        }
+        while (mConverted.size() - mConvertedOffset < count) {
+            if (mFlushed) {
+                return nullptr;
+            }
+            // drop the samples which have already been encoded
+            mConverted.erase(mConverted.begin(), mConverted.begin() + ptrdiff_t(mConvertedOffset));
+            mConvertedOffset = 0;
+            if (!mInput.empty()) {
+                size_t chunk = std::min(mInput.size(), kFrontendChunkSize);
+                mFrontend.Process(mInput.subspan(0, chunk), mConverted);
+                mInput = mInput.subspan(chunk);
+            } else {
+                mFrontend.Flush(mConverted);
+                mFlushed = true;
+            }
+        }
+        const SKP_int16* p = mConverted.data() + mConvertedOffset;
+        mConvertedOffset += count;
+        return p;
+    }
+
+private:
+    static constexpr size_t kFrontendChunkSize = 64 * 1024;
+
+    bool mUseFrontend = false;
+    const SKP_int16* mMonoBase = nullptr;
+    size_t mMonoCount = 0;
+    size_t mMonoOffset = 0;
+    PcmFrontend mFrontend;
+    std::span<const uint8_t> mInput;
+    bool mFlushed = false;
+    std::vector<SKP_int16> mConverted;
+    size_t mConvertedOffset = 0;
+};
+
+std::string SilkEncoder::Encode(std::span<const uint8_t> input, const SilkEncoderOptions& options, const Writer& writer) {
+    const int sampleRate = options.sampleRate;
+    if (sampleRate > kMaxApiFsKHz * 1000 || sampleRate < 0) {
+        return fmt::format("Error: API sampling rate = {} out of range, valid range 8000 - 48000", sampleRate);
+    }
+    if (options.complexity != kSilkComplexityAuto && (options.complexity < 0 || options.complexity > kSilkComplexityMax)) {
+        return fmt::format("Error: complexity = {} out of range, valid range 0 - 2 or -1 for auto", options.complexity);
+    }
+    if (options.packetLossPercentage < 0 || options.packetLossPercentage > 100) {
+        return fmt::format("Error: packet loss percentage = {} out of range, valid range 0 - 100", options.packetLossPercentage);
+    }
+    auto writeOrError = [&writer](const void* data, size_t size, std::string& err) -> bool {
+        int ret = writer(data, size);
+        if (ret < 0) {
+            err = fmt::format("write({}) failed: {}", size, strerror(-ret));
+            return false;
+        }
+        return true;
+    };
+    std::string err;
+    /* Add Silk header to stream */
+    {
+        if (options.tencent) {
+            static const char Tencent_break[] = {2};
+            if (!writeOrError(Tencent_break, 1, err)) {
+                return err;
+            }
+        }
+        static const char Silk_header[] = "#!SILK_V3";
+        if (!writeOrError(Silk_header, sizeof(Silk_header) - 1, err)) {
+            return err;
+        }
+    }
+    SKP_int32 encSizeBytes;
+    /* Create Encoder */
+    int ret = SKP_Silk_SDK_Get_Encoder_Size(&encSizeBytes);
+    if (ret) {
+        return fmt::format("SKP_Silk_SDK_Get_Encoder_Size returned {}", ret);
+    }
+    // the state is re-initialized below, the allocation is kept between clips
+    mEncoderState.resize(encSizeBytes);
+    void* psEnc = mEncoderState.data();
+
+    SKP_SILK_SDK_EncControlStruct encControl = {}; // Struct for input to encoder
+    SKP_SILK_SDK_EncControlStruct encStatus = {};  // Struct for status of encoder
+    /* Reset Encoder */
+    ret = SKP_Silk_SDK_InitEncoder(psEnc, &encStatus);
+    if (ret) {
+        return fmt::format("SKP_Silk_SDK_InitEncoder returned {}", ret);
+    }
+
+    /* Set Encoder parameters */
+    encControl.API_sampleRate = sampleRate;
+    encControl.maxInternalSampleRate = sampleRate;
+    encControl.packetSize = options.packetSize;
+    encControl.packetLossPercentage = options.packetLossPercentage;
+    encControl.useInBandFEC = options.useInBandFEC ? 1 : 0;
+    encControl.useDTX = options.useDTX ? 1 : 0;
+    encControl.complexity = options.complexity == kSilkComplexityAuto ? kSilkComplexityMax : options.complexity;
+    encControl.bitRate = options.bitRate;
+
+    SilkInputFrameReader reader;
+    {
+        PcmFormat inputFormat = options.inputFormat;
+        if (options.inputType == SilkInputType::kRawPcm16Mono) {
+            inputFormat = {PcmSampleFormat::kInt16, 1, sampleRate};
+        } else if (options.inputType == SilkInputType::kWav) {
+            WavInfo wavInfo;
+            err = ParseWavHeader(input, wavInfo);
+            if (!err.empty()) {
+                return fmt::format("Error: invalid wav file: {}", err);
+            }
+            inputFormat = wavInfo.format;
+            input = input.subspan(wavInfo.dataOffset, wavInfo.dataLength);
+        }
+        if (inputFormat.sampleFormat == PcmSampleFormat::kInt16 && inputFormat.channels == 1
+                && inputFormat.sampleRate == sampleRate && (uintptr_t(input.data()) % alignof(SKP_int16)) == 0) {
+            reader.AttachMonoPcm16(reinterpret_cast<const SKP_int16*>(input.data()), input.size() / sizeof(SKP_int16));
+        } else {
+            err = reader.AttachFrontend(input, inputFormat, sampleRate);
+            if (!err.empty()) {
+                return fmt::format("Error: unsupported input: {}", err);
+            }
+        }
+    }
+    const int count = (kFrameLengthMs * sampleRate) / 1000;
+    // the whole clip in mono PCM16, only used by the pre-pass which needs to look ahead for trailing silence and the peak
+    std::vector<SKP_int16> preprocessed;
+    if (options.preprocess) {
+        while (const SKP_int16* frame = reader.Next(count)) {
+            preprocessed.insert(preprocessed.end(), frame, frame + count);
+        }
+        VoicePreprocessStats stats;
+        err = PreprocessVoice(preprocessed, sampleRate, options.preprocessOptions, &stats);
+        if (!err.empty()) {
+            return fmt::format("Error: voice pre-processing failed: {}", err);
+        }
+        LOGI("silk pre-pass: frames {} -> {}, peak {}, gain {:.2f}",
+             stats.inputFrames, stats.outputFrames, stats.peakBefore, double(stats.gainQ16) / 65536.0);
+        reader.AttachMonoPcm16(preprocessed.data(), preprocessed.size());
+    }
+    SilkAutoComplexityController autoComplexity(options.targetRealTimeFactor, kFrameLengthMs);
+    const bool isAutoComplexity = options.complexity == kSilkComplexityAuto;
+    constexpr auto outputBufferSize = kMaxBytesPerFrame * kMaxInputFrames;
+    SKP_uint8 outputBuffer[outputBufferSize];
+    int outputBufferOffset = 0;
+    int smplsSinceLastPacket = 0;
+    while (true) {
+        /* Read input from file */
+        const SKP_int16* frame = reader.Next(count);
+        if (frame == nullptr) {
+            break;
+        }
+        auto nBytes = (SKP_int16) (outputBufferSize - outputBufferOffset);
+        /* Silk Encoder */
+        if (isAutoComplexity) {
+            autoComplexity.BeginFrame();
+        }
+        ret = SKP_Silk_SDK_Encode(psEnc, &encControl,
+                                  frame, (SKP_int16) count,
+                                  outputBuffer + outputBufferOffset, &nBytes);
+        if (isAutoComplexity) {
+            autoComplexity.EndFrame(encControl.complexity);
+        }
+        if (ret) {
+            return fmt::format("SKP_Silk_Encode returned {}", ret);
+        }
+        outputBufferOffset += nBytes;
+        /* Get packet size */
+        auto packetSize_ms = (SKP_int) ((1000 * (SKP_int32) encControl.packetSize) / encControl.API_sampleRate);
+        smplsSinceLastPacket += (SKP_int) count;
+        if (((1000 * smplsSinceLastPacket) / sampleRate) == packetSize_ms) {
+            /* Sends a dummy zero size packet in case of DTX period  */
+            /* to make it work with the decoder test program.        */
+            /* In practice should be handled by RTP sequence numbers */
+            /* Write payload size */
+            nBytes = (SKP_int16) outputBufferOffset;
+            if (!writeOrError(&nBytes, sizeof(SKP_int16), err)) {
+                return err;
+            }
+            /* Write payload */
+            if (!writeOrError(outputBuffer, outputBufferOffset, err)) {
+                return err;
+            }
+            smplsSinceLastPacket = 0;
+            outputBufferOffset = 0;
+        }
+    }
+    /* Write dummy because it can not end with 0 bytes */
+    SKP_int16 nBytes = -1;
+
+    /* Write payload size */
+    if (!options.tencent) {
+        if (!writeOrError(&nBytes, sizeof(SKP_int16), err)) {
+            return err;
+        }
+    }
+    return {};
+}
+
+}
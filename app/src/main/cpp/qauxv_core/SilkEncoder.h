@@ -0,0 +1,88 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_SILKENCODER_H
+#define QAUXV_SILKENCODER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "qauxv_core/PcmFrontend.h"
+#include "qauxv_core/VoicePreprocess.h"
+
+namespace qauxv::audio {
+
+// complexity value which makes the encoder pick the complexity itself, see SilkAutoComplexityController
+constexpr int kSilkComplexityAuto = -1;
+constexpr int kSilkComplexityMax = 2;
+
+enum class SilkInputType {
+    // mono PCM16LE at the encoder sample rate, fed to the encoder without any copy
+    kRawPcm16Mono = 0,
+    // raw PCM described by SilkEncoderOptions::inputFormat
+    kRawPcm = 1,
+    // RIFF/WAVE file, the format is read from the header
+    kWav = 2,
+};
+
+struct SilkEncoderOptions {
+    SilkInputType inputType = SilkInputType::kRawPcm16Mono;
+    PcmFormat inputFormat;
+    // the sample rate of the encoder, the input is resampled to this rate if required
+    int sampleRate = 0;
+    int bitRate = 0;
+    int packetSize = 0;
+    bool tencent = false;
+    // 0 is lowest; 1 is medium and 2 is highest complexity, or kSilkComplexityAuto
+    int complexity = kSilkComplexityMax;
+    bool useDTX = false;
+    bool useInBandFEC = false;
+    int packetLossPercentage = 0;
+    // encode time / audio duration, only used with kSilkComplexityAuto
+    float targetRealTimeFactor = 0.5f;
+    // run the VAD silence trimming / normalization pre-pass, see VoicePreprocess.h
+    bool preprocess = false;
+    VoicePreprocessOptions preprocessOptions;
+};
+
+/**
+ * Encodes PCM into a Silk v3 stream, optionally with the Tencent header byte.
+ * This class does not depend on JNI, so that it can be used by the host side benchmark as well.
+ * An instance may be reused for multiple clips, which avoids re-allocating the encoder state.
+ * It is NOT thread-safe.
+ */
+class SilkEncoder {
+public:
+    /**
+     * Receives the encoded stream.
+     * @return 0 on success, or a negative errno
+     */
+    using Writer = std::function<int(const void* data, size_t size)>;
+
+    SilkEncoder() = default;
+
+    SilkEncoder(const SilkEncoder&) = delete;
+
+    SilkEncoder& operator=(const SilkEncoder&) = delete;
+
+    /**
+     * Encode a whole clip.
+     * @param input the input file content, interpreted according to options.inputType
+     * @param options the encoder options
+     * @param writer receives the encoded stream
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Encode(std::span<const uint8_t> input, const SilkEncoderOptions& options, const Writer& writer);
+
+private:
+    std::vector<uint8_t> mEncoderState;
+};
+
+}
+
+#endif //QAUXV_SILKENCODER_H
@@ -0,0 +1,153 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "VoicePreprocess.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "SKP_Silk_main.h"
+
+namespace qauxv::audio {
+
+static constexpr int kFrameLengthMs = 20;
+
+static int FramePeak(const int16_t* frame, size_t length) noexcept {
+    int peak = 0;
+    for (size_t i = 0; i < length; i++) {
+        int v = frame[i];
+        peak = std::max(peak, v < 0 ? -v : v);
+    }
+    return peak;
+}
+
+/**
+ * Classify every frame as speech or silence.
+ */
+static std::string DetectSpeechFrames(const std::vector<int16_t>& samples, int frameLength,
+                                      const VoicePreprocessOptions& options, std::vector<bool>& isSpeech) {
+    SKP_Silk_VAD_state vad = {};
+    if (SKP_Silk_VAD_Init(&vad) != 0) {
+        return "SKP_Silk_VAD_Init failed";
+    }
+    size_t frameCount = samples.size() / size_t(frameLength);
+    isSpeech.assign(frameCount, false);
+    for (size_t i = 0; i < frameCount; i++) {
+        const int16_t* frame = samples.data() + i * size_t(frameLength);
+        SKP_int speechActivityQ8 = 0;
+        SKP_int snrDbQ7 = 0;
+        SKP_int qualityQ15[VAD_N_BANDS] = {};
+        SKP_int tiltQ15 = 0;
+        if (SKP_Silk_VAD_GetSA_Q8(&vad, &speechActivityQ8, &snrDbQ7, qualityQ15, &tiltQ15, frame, frameLength) != 0) {
+            return fmt::format("SKP_Silk_VAD_GetSA_Q8 failed at frame {}", i);
+        }
+        isSpeech[i] = speechActivityQ8 >= options.speechActivityThresholdQ8
+                && FramePeak(frame, size_t(frameLength)) >= options.silencePeakFloor;
+    }
+    return {};
+}
+
+/**
+ * Select the frames to keep: speech, padding around speech and internal silence up to the limit.
+ * @return false if there is no speech at all
+ */
+static bool SelectFrames(const std::vector<bool>& isSpeech, const VoicePreprocessOptions& options, std::vector<bool>& keep) {
+    const size_t frameCount = isSpeech.size();
+    const size_t paddingFrames = size_t(std::max(0, options.paddingMs) / kFrameLengthMs);
+    const size_t maxSilenceFrames = std::max(size_t(std::max(0, options.maxInternalSilenceMs) / kFrameLengthMs), 2 * paddingFrames);
+    keep.assign(frameCount, false);
+    auto firstSpeech = std::find(isSpeech.begin(), isSpeech.end(), true);
+    if (firstSpeech == isSpeech.end()) {
+        return false;
+    }
+    size_t first = size_t(firstSpeech - isSpeech.begin());
+    size_t last = frameCount - 1 - size_t(std::find(isSpeech.rbegin(), isSpeech.rend(), true) - isSpeech.rbegin());
+    size_t begin = first > paddingFrames ? first - paddingFrames : 0;
+    size_t end = std::min(frameCount, last + 1 + paddingFrames);
+    size_t i = begin;
+    while (i < end) {
+        if (isSpeech[i] || i < first || i > last) {
+            keep[i] = true;
+            i++;
+            continue;
+        }
+        // internal silence run [i, runEnd)
+        size_t runEnd = i;
+        while (runEnd < end && !isSpeech[runEnd]) {
+            runEnd++;
+        }
+        size_t runLength = runEnd - i;
+        if (runLength <= maxSilenceFrames) {
+            std::fill(keep.begin() + ptrdiff_t(i), keep.begin() + ptrdiff_t(runEnd), true);
+        } else {
+            // keep the decay of the previous speech and the lead-in of the next one, drop the middle
+            size_t head = maxSilenceFrames / 2;
+            size_t tail = maxSilenceFrames - head;
+            std::fill(keep.begin() + ptrdiff_t(i), keep.begin() + ptrdiff_t(i + head), true);
+            std::fill(keep.begin() + ptrdiff_t(runEnd - tail), keep.begin() + ptrdiff_t(runEnd), true);
+        }
+        i = runEnd;
+    }
+    return true;
+}
+
+std::string PreprocessVoice(std::vector<int16_t>& samples, int sampleRate,
+                            const VoicePreprocessOptions& options, VoicePreprocessStats* stats) {
+    const int frameLength = sampleRate * kFrameLengthMs / 1000;
+    if (stats != nullptr) {
+        *stats = {};
+        stats->inputFrames = frameLength > 0 ? samples.size() / size_t(frameLength) : 0;
+        stats->outputFrames = stats->inputFrames;
+    }
+    if (options.trimSilence) {
+        if (sampleRate != 8000 && sampleRate != 12000 && sampleRate != 16000 && sampleRate != 24000) {
+            return fmt::format("silence trimming is not supported at sample rate {}", sampleRate);
+        }
+        std::vector<bool> isSpeech;
+        if (auto err = DetectSpeechFrames(samples, frameLength, options, isSpeech); !err.empty()) {
+            return err;
+        }
+        std::vector<bool> keep;
+        if (SelectFrames(isSpeech, options, keep)) {
+            // compact the kept frames in place, frames only move towards the front
+            size_t outFrames = 0;
+            for (size_t i = 0; i < keep.size(); i++) {
+                if (!keep[i]) {
+                    continue;
+                }
+                if (outFrames != i) {
+                    memmove(samples.data() + outFrames * size_t(frameLength), samples.data() + i * size_t(frameLength),
+                            size_t(frameLength) * sizeof(int16_t));
+                }
+                outFrames++;
+            }
+            samples.resize(outFrames * size_t(frameLength));
+            if (stats != nullptr) {
+                stats->outputFrames = outFrames;
+            }
+        }
+    }
+    int peak = FramePeak(samples.data(), samples.size());
+    if (stats != nullptr) {
+        stats->peakBefore = peak;
+    }
+    if (options.normalize && peak > 0) {
+        int32_t gainQ16 = int32_t((int64_t(options.targetPeak) << 16) / peak);
+        gainQ16 = std::min(gainQ16, options.maxGainQ16);
+        if (gainQ16 != (1 << 16)) {
+            for (auto& s: samples) {
+                int64_t v = (int64_t(s) * gainQ16 + (1 << 15)) >> 16;
+                s = int16_t(std::clamp<int64_t>(v, INT16_MIN, INT16_MAX));
+            }
+        }
+        if (stats != nullptr) {
+            stats->gainQ16 = gainQ16;
+        }
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,55 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_VOICEPREPROCESS_H
+#define QAUXV_VOICEPREPROCESS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qauxv::audio {
+
+struct VoicePreprocessOptions {
+    // drop leading and trailing silence and shorten long internal silence
+    bool trimSilence = true;
+    // frames with a SILK VAD speech activity below this value are silence, 0 - 255
+    int speechActivityThresholdQ8 = 26;
+    // frames whose absolute peak is below this value are silence regardless of the VAD
+    int silencePeakFloor = 64;
+    // silence kept before and after speech, so that onsets and decays are not cut
+    int paddingMs = 100;
+    // internal silence longer than this is shortened to this length
+    int maxInternalSilenceMs = 600;
+    // scale the samples so that the absolute peak reaches targetPeak
+    bool normalize = false;
+    int targetPeak = 29204; // -1 dBFS
+    // upper bound of the normalization gain in Q16, 4.0 is +12 dB
+    int32_t maxGainQ16 = 4 << 16;
+};
+
+struct VoicePreprocessStats {
+    size_t inputFrames = 0;
+    size_t outputFrames = 0;
+    int peakBefore = 0;
+    int32_t gainQ16 = 1 << 16;
+};
+
+/**
+ * Pre-pass over a whole voice clip before it is encoded.
+ * Silence detection uses the SILK VAD on 20 ms frames, so it is only available at 8, 12, 16 and 24 kHz,
+ * the same rates the SILK encoder runs at internally. Normalization works at any rate.
+ * If the clip contains no speech at all, it is left as it is, so that the result is never empty.
+ * @param samples mono PCM16, modified in place, the length is truncated to whole frames if silence is trimmed
+ * @param sampleRate sample rate in Hz
+ * @param options the options
+ * @param stats optional, receives statistics of the pass
+ * @return empty string on success, or an error message
+ */
+[[nodiscard]] std::string PreprocessVoice(std::vector<int16_t>& samples, int sampleRate,
+                                          const VoicePreprocessOptions& options, VoicePreprocessStats* stats);
+
+}
+
+#endif //QAUXV_VOICEPREPROCESS_H
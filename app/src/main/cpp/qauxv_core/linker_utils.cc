@@ -78,7 +78,8 @@ void* loader_android_dlopen_ext(const char* filename,
             return nullptr;
         }
         FileMemMap linkerFileMap;
-        if ((rc = linkerFileMap.mapFilePath(linkerPath.c_str())) != 0) {
+        // only the headers, the symbol tables and a few strings are read
+        if ((rc = linkerFileMap.mapFilePath(linkerPath.c_str(), true, 0, FileMemMap::AccessHint::kRandom)) != 0) {
             LOGE("HookLoadLibrary: failed to map linker file, rc = {}", rc);
             return nullptr;
         }
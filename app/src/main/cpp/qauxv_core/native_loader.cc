@@ -24,6 +24,7 @@
 #include "utils/Log.h"
 #include "natives_utils.h"
 #include "utils/art_symbol_resolver.h"
+#include "utils/BinaryCursor.h"
 #include "nativebridge/native_bridge.h"
 
 #include "MMKV.h"
@@ -41,10 +42,8 @@ qauxv::nativeloader::LibraryIsa qauxv::nativeloader::GetLibraryIsaWithElfHeader(
     if (klass != 1 && klass != 2) {
         return LibraryIsa::kUnknown;
     }
-    int offsetMachine = 16 + 2;
-    uint32_t m0 = elf_header[offsetMachine];
-    uint32_t m1 = elf_header[offsetMachine + 1];
-    uint32_t machine = ((m1 << 8) & 0xff00u) | (m0 & 0xffu);
+    // e_machine, the span is known to be large enough
+    uint16_t machine = ::utils::BinarySpan::LoadLe<uint16_t>(elf_header.data() + 16 + 2);
     return LibraryIsa((uint32_t(klass) << 16u) | machine);
 }
 
@@ -86,6 +85,7 @@ Java_io_github_qauxv_util_soloader_NativeLoader_nativePrimaryNativeLibraryPreIni
         sModuleMainClassLoader = env->NewGlobalRef(env->CallObjectMethod(clazz, kGetClassLoader));
     }
     qauxv::HostInfo::PreInitHostInfo(vm, dataDir);
+    // the linker hook must be in place before anything else runs, so that no library loaded meanwhile misses it
     qauxv::InitializeNativeHookApi(allow_hook_linker);
     if (!sPrimaryPreInitMethodsRegistered) {
         qauxv::jniutil::RegisterJniLateInitMethodsToClassLoader(env, qauxv::jniutil::JniMethodInitType::kPrimaryPreInit, sModuleMainClassLoader);
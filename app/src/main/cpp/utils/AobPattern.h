@@ -0,0 +1,155 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_AOBPATTERN_H
+#define QAUXV_AOBPATTERN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace utils {
+
+/**
+ * A string literal usable as a template argument, see MakeAobPattern.
+ */
+template<size_t N>
+struct AobPatternString {
+    char chars[N] = {};
+
+    consteval AobPatternString(const char (& str)[N]) {
+        for (size_t i = 0; i < N; i++) {
+            chars[i] = str[i];
+        }
+    }
+};
+
+/**
+ * A byte pattern with a mask, parsed at compile time, see MakeAobPattern.
+ * The sequence is already masked, i.e. (sequence & mask) == sequence.
+ */
+template<size_t N>
+struct AobPattern {
+    std::array<uint8_t, N> sequence = {};
+    std::array<uint8_t, N> mask = {};
+    // the alignment of a match, 1/2/4/8
+    int step = 1;
+    // false if every mask byte is 0xff, the mask is not needed then
+    bool hasWildcard = false;
+
+    [[nodiscard]] constexpr size_t size() const noexcept {
+        return N;
+    }
+
+    [[nodiscard]] constexpr std::span<const uint8_t> GetSequence() const noexcept {
+        return sequence;
+    }
+
+    // empty if there is no wildcard
+    [[nodiscard]] constexpr std::span<const uint8_t> GetMask() const noexcept {
+        return hasWildcard ? std::span<const uint8_t>(mask) : std::span<const uint8_t>();
+    }
+};
+
+namespace aob_pattern_detail {
+
+// not constexpr on purpose: reaching it during constant evaluation makes the pattern a compile error
+void InvalidAobPattern(const char* reason);
+
+consteval bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+consteval int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c == '?') {
+        return -1;
+    }
+    InvalidAobPattern("invalid character, expect hex digit or '?'");
+    return 0;
+}
+
+/**
+ * Parse the pattern, or only count the bytes if sequence and mask are null.
+ * A byte is two hex digits, any digit may be '?' which matches any nibble, and a single '?' matches any byte.
+ * Bytes are separated by whitespace.
+ * @return the number of bytes
+ */
+consteval size_t ParsePattern(const char* str, uint8_t* sequence, uint8_t* mask) {
+    size_t count = 0;
+    size_t i = 0;
+    while (str[i] != '\0') {
+        if (IsSpace(str[i])) {
+            i++;
+            continue;
+        }
+        size_t len = 0;
+        while (str[i + len] != '\0' && !IsSpace(str[i + len])) {
+            len++;
+        }
+        uint8_t value = 0;
+        uint8_t valueMask = 0;
+        if (len == 1 && str[i] == '?') {
+            // any byte
+        } else if (len == 2) {
+            int hi = HexValue(str[i]);
+            int lo = HexValue(str[i + 1]);
+            if (hi >= 0) {
+                value |= uint8_t(hi << 4);
+                valueMask |= 0xf0;
+            }
+            if (lo >= 0) {
+                value |= uint8_t(lo);
+                valueMask |= 0x0f;
+            }
+        } else {
+            InvalidAobPattern("a byte must be 2 hex digits or '?'");
+        }
+        if (sequence != nullptr) {
+            sequence[count] = value;
+            mask[count] = valueMask;
+        }
+        count++;
+        i += len;
+    }
+    if (count == 0) {
+        InvalidAobPattern("empty pattern");
+    }
+    return count;
+}
+
+}
+
+/**
+ * Parse an AOB pattern at compile time, e.g.
+ * MakeAobPattern<"09 8d 40 f8 ?? ?? 40 f9", 4>() or MakeAobPattern<"29 ?? 4? f9", 4>().
+ * A malformed pattern, or a pattern whose size is not a multiple of the step, does not compile.
+ * @tparam kPattern hex bytes separated by whitespace, '?' for a wildcard nibble, a lone '?' for a wildcard byte
+ * @tparam kStep the alignment of a match, 1/2/4/8
+ */
+template<AobPatternString kPattern, int kStep = 1>
+consteval auto MakeAobPattern() {
+    static_assert(kStep == 1 || kStep == 2 || kStep == 4 || kStep == 8, "step must be 1/2/4/8");
+    constexpr size_t kSize = aob_pattern_detail::ParsePattern(kPattern.chars, nullptr, nullptr);
+    static_assert(kSize % kStep == 0, "pattern size must be a multiple of the step");
+    AobPattern<kSize> pattern;
+    (void) aob_pattern_detail::ParsePattern(kPattern.chars, pattern.sequence.data(), pattern.mask.data());
+    pattern.step = kStep;
+    for (size_t i = 0; i < kSize; i++) {
+        if (pattern.mask[i] != 0xff) {
+            pattern.hasWildcard = true;
+        }
+    }
+    return pattern;
+}
+
+}
+
+#endif //QAUXV_AOBPATTERN_H
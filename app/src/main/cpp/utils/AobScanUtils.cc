@@ -4,9 +4,16 @@
 
 #include "AobScanUtils.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include <fmt/format.h>
 
 #include "ElfScan.h"
+#include "ElfImageLayout.h"
+#include "FunctionIndex.h"
+#include "Log.h"
 #include "TextUtils.h"
 #include "ConfigManager.h"
 #include "qauxv_core/HostInfo.h"
@@ -17,19 +24,199 @@ namespace utils {
 
 using Validator = AobScanTarget::Validator;
 
+static std::optional<uint64_t> GetCachedValue(const std::string& cacheValueKey, const std::string& cacheVersionKey,
+                                              uint64_t currentVersion) {
+    auto& cache = qauxv::ConfigManager::GetCache();
+    auto lastValue = cache.GetUInt64(cacheValueKey);
+    auto lastVersion = cache.GetUInt64(cacheVersionKey);
+    if (lastValue.has_value() && lastVersion.has_value() && lastVersion.value() == currentVersion) {
+        return lastValue.value();
+    }
+    return std::nullopt;
+}
+
+/**
+ * Get the raw result of the previous run, whatever host version it was found in.
+ * After a host update it is only a hint for the tiered search, the search around it still has to find the sequence.
+ */
+static std::optional<uint64_t> GetLastRawResult(const std::string& cacheValueKey) {
+    return qauxv::ConfigManager::GetCache().GetUInt64(cacheValueKey);
+}
+
+static std::string GetStatsKey(std::string_view name, AobScanTier tier) {
+    return fmt::format("{}.stats.{}", name, int(tier));
+}
+
+/**
+ * Counts the tiers of a batch of searches in memory, so that the cache is written once per batch
+ * and per counter, instead of a read and a write for every search.
+ */
+class AobScanTierRecorder {
+public:
+    AobScanTierRecorder() = default;
+
+    AobScanTierRecorder(const AobScanTierRecorder&) = delete;
+
+    AobScanTierRecorder& operator=(const AobScanTierRecorder&) = delete;
+
+    ~AobScanTierRecorder() {
+        Flush();
+    }
+
+    void Record(std::string_view name, AobScanTier tier) {
+        mCounts[GetStatsKey(name, tier)]++;
+    }
+
+    void Flush() {
+        if (mCounts.empty()) {
+            return;
+        }
+        auto& cache = qauxv::ConfigManager::GetCache();
+        for (const auto& [key, count]: mCounts) {
+            cache.PutUInt32(key, cache.GetUInt32(key, 0) + count);
+        }
+        mCounts.clear();
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> mCounts;
+};
+
+AobScanStats GetAobScanStats(std::string_view name) {
+    AobScanStats stats;
+    auto& cache = qauxv::ConfigManager::GetCache();
+    for (int i = 0; i < kAobScanTierCount; i++) {
+        stats.tierCounts[i] = cache.GetUInt32(GetStatsKey(name, AobScanTier(i)), 0);
+    }
+    return stats;
+}
+
+std::string FormatAobScanStatsReport() {
+    static constexpr std::string_view kStatsInfix = ".stats.";
+    // the targets are only known by the names of their counters
+    std::vector<std::string> names;
+    for (const auto& key: qauxv::ConfigManager::GetCache().GetAllKeys()) {
+        auto pos = key.rfind(kStatsInfix);
+        if (pos != std::string::npos && pos != 0) {
+            names.emplace_back(key.substr(0, pos));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    std::string report = "name, exact hint, near hint, wide hint, batch delta, full scan, not found\n";
+    for (const auto& name: names) {
+        report += name;
+        for (uint32_t count: GetAobScanStats(name).tierCounts) {
+            report += fmt::format(", {}", count);
+        }
+        report += '\n';
+    }
+    return report;
+}
+
+static constexpr uint64_t kNearHintRadius = 64 * 1024;
+static constexpr uint64_t kWideHintRadius = 1024 * 1024;
+
+static inline uint64_t SaturatingSub(uint64_t a, uint64_t b) noexcept {
+    return a > b ? a - b : 0;
+}
+
+/**
+ * Find the raw results of a target, trying the cheap tiers around the hint before scanning the whole image.
+ * Minor host updates usually move code by a few hundred bytes, so a unique match near the hint is taken as the result.
+ * If a window around the hint contains more than one match, the whole image is scanned, so that the ambiguity is reported.
+ * @param hint the raw result of the previous run, if any
+ * @param batchDeltas how far the other targets of the same batch have moved since the previous run
+ * @param tier receives the tier which produced the result
+ */
+static std::vector<uint64_t> FindRawResultsTiered(const AobScanTarget& target, const void* imageBase, bool isLoadedImage,
+                                                  std::optional<uint64_t> hint, std::span<const int64_t> batchDeltas,
+                                                  AobScanTier& tier) {
+    const auto fnSearch = [&](uint64_t rvaBegin, uint64_t rvaEnd) {
+        return FindByteSequenceInRange(imageBase, isLoadedImage, target.sequence, target.mask, target.execMemOnly, target.step,
+                                       rvaBegin, rvaEnd);
+    };
+    if (hint.has_value()) {
+        const uint64_t h = hint.value();
+        if (IsByteSequenceAt(imageBase, isLoadedImage, target.sequence, target.mask, target.execMemOnly, target.step, h)) {
+            tier = AobScanTier::kExactHint;
+            return {h};
+        }
+        auto nearResults = fnSearch(SaturatingSub(h, kNearHintRadius), h + kNearHintRadius);
+        if (nearResults.size() == 1) {
+            tier = AobScanTier::kNearHint;
+            return nearResults;
+        }
+        bool isAmbiguous = nearResults.size() > 1;
+        if (!isAmbiguous) {
+            // the near window is known to have no match, only scan the rest of the wide window
+            auto below = fnSearch(SaturatingSub(h, kWideHintRadius), SaturatingSub(h, kNearHintRadius));
+            auto above = fnSearch(h + kNearHintRadius, h + kWideHintRadius);
+            if (below.size() + above.size() == 1) {
+                tier = AobScanTier::kWideHint;
+                return below.empty() ? above : below;
+            }
+            isAmbiguous = below.size() + above.size() > 1;
+        }
+        for (size_t i = 0; i < batchDeltas.size() && !isAmbiguous; i++) {
+            const uint64_t moved = uint64_t(int64_t(h) + batchDeltas[i]);
+            auto r = fnSearch(SaturatingSub(moved, kNearHintRadius), moved + kNearHintRadius);
+            if (r.size() == 1) {
+                tier = AobScanTier::kBatchDelta;
+                return r;
+            }
+            isAmbiguous = r.size() > 1;
+        }
+    }
+    auto results = FindByteSequenceImpl(imageBase, isLoadedImage, target.sequence, target.mask, target.execMemOnly, target.step,
+                                        std::nullopt);
+    tier = results.empty() ? AobScanTier::kNotFound : AobScanTier::kFullScan;
+    return results;
+}
+
 bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets,
                                 const void* imageBase, bool isLoadedImage,
-                                std::vector<std::string>& errors) {
+                                std::vector<std::string>& errors,
+                                const FunctionIndex* functionIndex) {
     bool hasFailed = false;
     const uint64_t currentVersion = qauxv::HostInfo::GetLongVersionCode();
+    std::vector<int64_t> batchDeltas;
+    AobScanTierRecorder tierRecorder;
+    // parsed on the first target which needs the segment mapping
+    std::optional<ElfImageLayout> layout;
+    const auto fnGetLayout = [&]() -> const ElfImageLayout& {
+        if (!layout.has_value()) {
+            layout.emplace();
+            if (std::string err = layout->Parse(imageBase, isLoadedImage); !err.empty()) {
+                LOGW("AobScanUtils: failed to parse the image layout: {}", err);
+            }
+        }
+        return layout.value();
+    };
+    // built on the first target which asks for it, unless the caller has one
+    std::optional<FunctionIndex> builtFunctionIndex;
+    const auto fnGetFunctionIndex = [&]() -> const FunctionIndex& {
+        if (functionIndex != nullptr) {
+            return *functionIndex;
+        }
+        if (!builtFunctionIndex.has_value()) {
+            builtFunctionIndex.emplace();
+            std::string err = builtFunctionIndex->Build(fnGetLayout());
+            if (!err.empty()) {
+                LOGW("AobScanUtils: function index is unavailable, fall back to raw results: {}", err);
+            } else {
+                LOGD("AobScanUtils: function index has {} functions", builtFunctionIndex->GetFunctions().size());
+            }
+        }
+        return builtFunctionIndex.value();
+    };
     for (auto* target: targets) {
         std::string_view name = target->name;
         std::span<const uint8_t> sequence = target->sequence;
         std::span<const uint8_t> mask = target->mask;
-        int step = target->step;
-        bool execMemOnly = target->execMemOnly;
         const auto cacheValueKey = name + ".value";
         const auto cacheVersionKey = name + ".version";
+        const auto cacheResultKey = name + ".result";
         auto offsetsForResult = target->offsetsForResult;
         auto validator = target->resultValidator;
         if (mask.size() != sequence.size() && !mask.empty()) {
@@ -38,16 +225,52 @@ bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets,
             hasFailed = true;
             continue;
         }
-        std::optional<uint64_t> lastResult;
-        {
-            auto& cache = qauxv::ConfigManager::GetCache();
-            auto lastValue = cache.GetUInt64(cacheValueKey);
-            auto lastVersion = cache.GetUInt64(cacheVersionKey);
-            if (lastValue.has_value() && lastVersion.has_value() && lastVersion.value() == currentVersion) {
-                lastResult = lastValue.value();
+        std::optional<uint64_t> lastResult = target->hint;
+        const bool isHintFromCache = !lastResult.has_value();
+        if (isHintFromCache) {
+            lastResult = GetLastRawResult(cacheValueKey);
+        }
+        AobScanTier tier = AobScanTier::kFullScan;
+        auto rawResultSet = FindRawResultsTiered(*target, imageBase, isLoadedImage, lastResult, batchDeltas, tier);
+        target->resultTier = tier;
+        if (isHintFromCache) {
+            tierRecorder.Record(name, tier);
+        }
+        if (tier != AobScanTier::kExactHint) {
+            LOGD("AobScanUtils: target '{}' resolved by tier {}, {} result(s)", name, int(tier), rawResultSet.size());
+        }
+        if (lastResult.has_value() && rawResultSet.size() == 1 && rawResultSet[0] != lastResult.value()) {
+            int64_t delta = int64_t(rawResultSet[0]) - int64_t(lastResult.value());
+            if (std::find(batchDeltas.begin(), batchDeltas.end(), delta) == batchDeltas.end()) {
+                batchDeltas.push_back(delta);
+            }
+        }
+        // If the raw result is the cached one, the result derived from it last time still holds, and the function index,
+        // which takes a walk over all unwind entries to build, is not needed to pick it again. The validator still runs.
+        std::optional<uint64_t> cachedResult;
+        if (tier == AobScanTier::kExactHint && rawResultSet.size() == 1
+                && GetCachedValue(cacheValueKey, cacheVersionKey, currentVersion) == rawResultSet[0]) {
+            cachedResult = GetCachedValue(cacheResultKey, cacheVersionKey, currentVersion);
+        }
+        std::optional<FunctionIndex::Function> hitFunction;
+        if (target->useFunctionIndex && !cachedResult.has_value() && !rawResultSet.empty() && !fnGetFunctionIndex().IsEmpty()) {
+            const auto& index = fnGetFunctionIndex();
+            // matches in padding, literal pools or data can not be the code we are looking for
+            std::vector<uint64_t> inFunctions;
+            std::copy_if(rawResultSet.begin(), rawResultSet.end(), std::back_inserter(inFunctions), [&index](uint64_t rva) {
+                return index.FindFunction(rva).has_value();
+            });
+            if (!inFunctions.empty()) {
+                rawResultSet = std::move(inFunctions);
+                if (rawResultSet.size() == 1) {
+                    hitFunction = index.FindFunction(rawResultSet[0]);
+                }
+            } else {
+                // e.g. the function has no FDE, the raw results and offsetsForResult are all we have then
+                LOGD("AobScanUtils: no function covers the {} result(s) of target '{}', ignoring the function index",
+                     rawResultSet.size(), name);
             }
         }
-        auto rawResultSet = FindByteSequenceImpl(imageBase, isLoadedImage, sequence, mask, execMemOnly, step, lastResult);
         if (rawResultSet.empty()) {
             errors.emplace_back(fmt::format("AobScanUtils: failed to find target '{}' with sequence '{}' mask '{}'",
                                             name, bytes2hex(sequence), bytes2hex(mask)));
@@ -65,15 +288,33 @@ bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets,
             continue;
         }
         std::vector<uint64_t> resultCandidates;
+        if (cachedResult.has_value()) {
+            resultCandidates.emplace_back(cachedResult.value());
+            offsetsForResult.clear();
+        } else if (hitFunction.has_value() && offsetsForResult.empty()) {
+            resultCandidates.emplace_back(hitFunction->start);
+        }
         for (auto offsetForResult: offsetsForResult) {
-            resultCandidates.emplace_back(uint64_t(int64_t(rawResultSet[0]) + offsetForResult));
+            uint64_t candidate = uint64_t(int64_t(rawResultSet[0]) + offsetForResult);
+            if (hitFunction.has_value() && (candidate < hitFunction->start || candidate >= hitFunction->end)) {
+                continue;
+            }
+            resultCandidates.emplace_back(candidate);
         }
         std::vector<uint64_t> results;
         // run validator for each result candidate
         if (validator.has_value()) {
             for (auto resultCandidate: resultCandidates) {
-                // TODO: 2023-07-14 if the image is a mmaped file, the offset in file is not provided, currently we just set it to 0
-                if (!validator.value()(imageBase, isLoadedImage, resultCandidate, 0)) {
+                uint64_t offsetInFile = 0;
+                if (!isLoadedImage) {
+                    auto offset = fnGetLayout().GetFileOffset(resultCandidate);
+                    if (!offset.has_value()) {
+                        // not backed by the file, e.g. .bss or out of the image
+                        continue;
+                    }
+                    offsetInFile = offset.value();
+                }
+                if (!validator.value()(imageBase, isLoadedImage, resultCandidate, offsetInFile)) {
                     continue;
                 }
                 results.emplace_back(resultCandidate);
@@ -105,25 +346,65 @@ bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets,
             // because the offsetForResult is not applied to the cache value
             // nor does the FindByteSequenceImpl know about it
             cache.PutUInt64(cacheValueKey, rawResultSet[0]);
+            cache.PutUInt64(cacheResultKey, results[0]);
             cache.PutUInt64(cacheVersionKey, currentVersion);
         }
     }
     return !hasFailed;
 }
 
+std::unordered_map<std::string, uint64_t> PrescanAobScanTargetsInFileImage(const std::vector<AobScanTarget>& targets,
+                                                                           const void* fileImageBase,
+                                                                           FunctionIndex* functionIndex) {
+    std::unordered_map<std::string, uint64_t> rawResults;
+    if (functionIndex != nullptr && std::any_of(targets.begin(), targets.end(), [](const auto& t) { return t.useFunctionIndex; })) {
+        // the unwind tables are keyed by RVA, so the index of the file is valid for the loaded image as well
+        ElfImageLayout layout;
+        std::string err = layout.Parse(fileImageBase, false);
+        if (err.empty()) {
+            err = functionIndex->Build(layout);
+        }
+        if (!err.empty()) {
+            LOGW("AobScanUtils: pre-scan function index is unavailable: {}", err);
+        }
+    }
+    std::vector<int64_t> batchDeltas;
+    AobScanTierRecorder tierRecorder;
+    for (const auto& target: targets) {
+        std::optional<uint64_t> lastResult = target.hint;
+        const bool isHintFromCache = !lastResult.has_value();
+        if (isHintFromCache) {
+            lastResult = GetLastRawResult(target.name + ".value");
+        }
+        AobScanTier tier = AobScanTier::kFullScan;
+        auto rawResultSet = FindRawResultsTiered(target, fileImageBase, false, lastResult, batchDeltas, tier);
+        if (isHintFromCache) {
+            tierRecorder.Record(target.name, tier);
+        }
+        if (rawResultSet.size() == 1) {
+            rawResults.emplace(target.name, rawResultSet[0]);
+            if (lastResult.has_value() && rawResultSet[0] != lastResult.value()) {
+                int64_t delta = int64_t(rawResultSet[0]) - int64_t(lastResult.value());
+                if (std::find(batchDeltas.begin(), batchDeltas.end(), delta) == batchDeltas.end()) {
+                    batchDeltas.push_back(delta);
+                }
+            }
+        } else {
+            LOGW("AobScanUtils: pre-scan found {} results for target '{}'", rawResultSet.size(), target.name);
+        }
+    }
+    return rawResults;
+}
+
 const Validator CommonAobScanValidator::kArm64StpX29X30SpImm = [](const void* base, bool isLoaded,
                                                                   uint64_t rva, uint64_t optOffsetInFile) -> bool {
-    if (!isLoaded) {
-        // TODO: 2023-07-14 if the image is a mmaped file, the offset in file is not provided, currently we just set it to 0
-        // currently we only support loaded image
-        return false;
-    }
     if (base == nullptr) {
         return false;
     }
-    const uint8_t* va = reinterpret_cast<const uint8_t*>(base) + rva;
-    const uint32_t* p = reinterpret_cast<const uint32_t*>(va);
-    uint32_t inst = *p;
+    // a mmap-ed file is laid out by file offset, not by RVA
+    const uint8_t* va = reinterpret_cast<const uint8_t*>(base) + (isLoaded ? rva : optOffsetInFile);
+    uint32_t inst;
+    memcpy(&inst, va, sizeof(inst));
     // expect  fd 7b ba a9     stp        x29,x30,[sp, #???]!
     if ((inst & ((0b11111111u << 24) | (0b11000000u << 16u) | (0b01111111u << 8u) | 0xFF))
             == ((0b10101001u << 24u) | (0b10000000u << 16u) | (0x7b << 8u) | 0xfd)) {
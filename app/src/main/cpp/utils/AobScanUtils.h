@@ -13,9 +13,38 @@
 #include <span>
 #include <optional>
 #include <functional>
+#include <unordered_map>
+
+#include "utils/AobPattern.h"
+#include "utils/FunctionIndex.h"
 
 namespace utils {
 
+/**
+ * How the raw result of an AOB scan target was found, from the cheapest to the most expensive.
+ */
+enum class AobScanTier : int {
+    // the hint, i.e. the cached result of the previous run, possibly of an older host version, is still valid
+    kExactHint = 0,
+    // found within 64 KiB around the hint
+    kNearHint = 1,
+    // found within 1 MiB around the hint
+    kWideHint = 2,
+    // found within 64 KiB around the hint moved by the delta of another target in the same batch
+    kBatchDelta = 3,
+    // the whole image was scanned
+    kFullScan = 4,
+    // the whole image was scanned and nothing was found
+    kNotFound = 5,
+};
+
+constexpr int kAobScanTierCount = 6;
+
+struct AobScanStats {
+    // the number of searches resolved by each tier, indexed by AobScanTier, accumulated across runs
+    std::array<uint32_t, kAobScanTierCount> tierCounts = {};
+};
+
 class AobScanTarget {
 public:
     /**
@@ -23,7 +52,8 @@ public:
      * @param base the base address of the ELF image
      * @param isLoaded true if the image is loaded in memory by a linker, false if it's a mmap-ed file
      * @param rva the relative virtual address of the result, this is real result of the AOB scan
-     * @param optOffsetInFile the offset in the file, if the image is loaded in memory, this value is 0
+     * @param optOffsetInFile the offset of the result in the file if the image is a mmap-ed file, the data of the result
+     *                        is at base + optOffsetInFile then; if the image is loaded in memory, this value is 0
      */
     using Validator = std::function<bool(const void* base, bool isLoaded, uint64_t rva, uint64_t optOffsetInFile)>;
 
@@ -34,8 +64,18 @@ public:
     bool execMemOnly = false;
     std::vector<int64_t> offsetsForResult;
     std::optional<Validator> resultValidator;
+    // optional, the raw result RVA if it is already known, e.g. from a scan of the file image, see FindByteSequenceImpl hint
+    // if present, it takes precedence over the cached result of the previous run
+    std::optional<uint64_t> hint;
+    // if true, raw results outside any function in the unwind tables are dropped, see FunctionIndex,
+    // and the result is the start of the function containing the raw result when offsetsForResult is empty,
+    // otherwise only the offsets that stay in that function are tried;
+    // if no raw result is inside a function, they are all kept and offsetsForResult is applied as without the index
+    bool useFunctionIndex = false;
 
     std::vector<uint64_t> results;
+    // how the raw result was found in the last search
+    std::optional<AobScanTier> resultTier;
 
     AobScanTarget() = default;
 
@@ -59,6 +99,19 @@ public:
         return *this;
     }
 
+    /**
+     * Set the sequence, the mask and the step from a pattern made by MakeAobPattern.
+     */
+    template<size_t N>
+    inline AobScanTarget& WithPattern(const AobPattern<N>& pattern) {
+        auto newSequence = pattern.GetSequence();
+        auto newMask = pattern.GetMask();
+        this->sequence.assign(newSequence.begin(), newSequence.end());
+        this->mask.assign(newMask.begin(), newMask.end());
+        this->step = pattern.step;
+        return *this;
+    }
+
     inline AobScanTarget& WithStep(int newStep) {
         this->step = newStep;
         return *this;
@@ -84,6 +137,16 @@ public:
         return *this;
     }
 
+    inline AobScanTarget& WithHint(std::optional<uint64_t> newHint) {
+        this->hint = newHint;
+        return *this;
+    }
+
+    inline AobScanTarget& WithFunctionIndex(bool newUseFunctionIndex) {
+        this->useFunctionIndex = newUseFunctionIndex;
+        return *this;
+    }
+
     inline uint64_t GetResultOffset() const noexcept {
         if (results.size() != 1) {
             return 0;
@@ -111,9 +174,44 @@ public:
  * @param imageBase the base address of the ELF image
  * @param isLoadedImage true if the image is loaded in memory by a linker, false if it's a mmap-ed file
  * @param errors a vector of error messages
+ * @param functionIndex optional, the function index of the image, e.g. built by PrescanAobScanTargetsInFileImage;
+ *                      if null, it is built from the image when a target with useFunctionIndex needs it
  * @return true if and only if every AOB scan target has one result
  */
-bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets, const void* imageBase, bool isLoadedImage, std::vector<std::string>& errors);
+bool SearchForAllAobScanTargets(std::vector<AobScanTarget*> targets, const void* imageBase, bool isLoadedImage, std::vector<std::string>& errors,
+                                const FunctionIndex* functionIndex = nullptr);
+
+/**
+ * Get the search statistics of an AOB scan target, which are persisted in the cache once per batch of targets.
+ * Searches are counted where they run, i.e. SearchForAllAobScanTargets only counts targets
+ * whose hint comes from the cache, not from a pre-scan.
+ * @param name the name of the target
+ * @return the statistics, all zero if the target was never searched
+ */
+AobScanStats GetAobScanStats(std::string_view name);
+
+/**
+ * Get the search statistics of all AOB scan targets found in the cache as a human-readable table,
+ * one line per target with the count of each tier, see AobScanTier.
+ */
+std::string FormatAobScanStatsReport();
+
+/**
+ * Search for the raw results of the AOB scan targets in an ELF file image which is not loaded yet.
+ * Neither offsetsForResult nor the validators are applied, and the cached results are only read, not updated,
+ * the search statistics of the targets whose hint comes from the cache are recorded though, see GetAobScanStats.
+ * The results are meant to be passed to AobScanTarget::WithHint once the image is loaded,
+ * so that SearchForAllAobScanTargets only has to verify them instead of scanning the whole image.
+ * This function may be called from any thread.
+ * @param targets an array of AOB scan targets
+ * @param fileImageBase the page aligned base address of the mmap-ed file
+ * @param functionIndex optional, if any target uses the function index, it receives the function index of the image,
+ *                      which is keyed by RVA and can be passed to SearchForAllAobScanTargets for the loaded image
+ * @return target name to raw result RVA, targets without exactly one result are absent
+ */
+std::unordered_map<std::string, uint64_t> PrescanAobScanTargetsInFileImage(const std::vector<AobScanTarget>& targets,
+                                                                           const void* fileImageBase,
+                                                                           FunctionIndex* functionIndex = nullptr);
 
 }
 
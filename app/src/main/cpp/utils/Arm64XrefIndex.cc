@@ -0,0 +1,440 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "Arm64XrefIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+#include <elf.h>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "utils/FileIo.h"
+#include "utils/Log.h"
+
+namespace utils {
+
+// instructions per work item
+static constexpr size_t kChunkInstructionCount = 64 * 1024;
+// how many instructions after an ADRP may use its register
+static constexpr size_t kAdrpPairWindow = 8;
+
+static constexpr uint32_t kFileMagic = 0x46525851; // "QXRF"
+static constexpr uint32_t kFileVersion = 1;
+
+struct XrefFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t codeRefCount;
+    uint64_t dataRefCount;
+};
+
+static inline bool IsBOrBl(uint32_t inst) noexcept {
+    // B: 000101 imm26, BL: 100101 imm26
+    return (inst & 0x7c000000u) == 0x14000000u;
+}
+
+static inline bool IsAdrp(uint32_t inst) noexcept {
+    // 1 immlo 10000 immhi Rd
+    return (inst & 0x9f000000u) == 0x90000000u;
+}
+
+static inline int64_t SignExtend(uint64_t value, int bits) noexcept {
+    const uint64_t m = uint64_t(1) << (bits - 1);
+    return int64_t((value ^ m) - m);
+}
+
+/**
+ * Whether any of the 4 instructions is a B/BL or an ADRP, most blocks have none.
+ */
+static inline bool HasInterestingInstruction(const uint32_t* p) noexcept {
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    uint32x4_t v = vld1q_u32(p);
+    uint32x4_t branch = vceqq_u32(vandq_u32(v, vdupq_n_u32(0x7c000000u)), vdupq_n_u32(0x14000000u));
+    uint32x4_t adrp = vceqq_u32(vandq_u32(v, vdupq_n_u32(0x9f000000u)), vdupq_n_u32(0x90000000u));
+    return vmaxvq_u32(vorrq_u32(branch, adrp)) != 0;
+#else
+    uint32_t any = 0;
+    for (int i = 0; i < 4; i++) {
+        any |= uint32_t(IsBOrBl(p[i])) | uint32_t(IsAdrp(p[i]));
+    }
+    return any != 0;
+#endif
+}
+
+static inline bool IsBranchRegister(uint32_t inst) noexcept {
+    // BR, BLR, RET and their pointer authentication variants
+    return (inst & 0xfe000000u) == 0xd6000000u;
+}
+
+/**
+ * Whether the instruction may overwrite the general purpose register, erring on the side of yes,
+ * since a missed write pairs an ADRP with an unrelated ADD or LDR. The stores, the SIMD&FP loads and
+ * the branches other than BL and BLR are the instructions known not to write any of them.
+ */
+static bool MayWriteRegister(uint32_t inst, uint32_t reg) noexcept {
+    const uint32_t rt = inst & 0x1f;
+    const uint32_t rn = (inst >> 5) & 0x1f;
+    const uint32_t rt2 = (inst >> 10) & 0x1f;
+    const uint32_t rs = (inst >> 16) & 0x1f;
+    if ((inst & 0x1c000000u) == 0x14000000u) {
+        // branches, exception generation and system instructions
+        if ((inst & 0xfc000000u) == 0x94000000u || (inst & 0xfffffc1fu) == 0xd63f0000u) {
+            // BL and BLR write the link register
+            return reg == 30;
+        }
+        // MRS and SYSL write Rt
+        return (inst & 0xffe00000u) == 0xd5200000u && rt == reg;
+    }
+    if ((inst & 0x0a000000u) != 0x08000000u) {
+        // data processing, Rd is always at bits 0-4
+        return rt == reg;
+    }
+    // loads and stores
+    const bool isSimd = (inst & 0x04000000u) != 0;
+    if ((inst & 0x38000000u) == 0x28000000u) {
+        // register pair, bit 23 is the write back of the pre/post-indexed forms, bit 22 is L
+        if (((inst >> 23) & 1) != 0 && rn == reg) {
+            return true;
+        }
+        return !isSimd && ((inst >> 22) & 1) != 0 && (rt == reg || rt2 == reg);
+    }
+    if ((inst & 0x38000000u) == 0x38000000u) {
+        // single register
+        if ((inst & 0x01200400u) == 0x00000400u && rn == reg) {
+            // pre/post-indexed, written back
+            return true;
+        }
+        if (isSimd) {
+            return false;
+        }
+        if ((inst & 0x01200c00u) == 0x00200000u) {
+            // atomic memory operations load into Rt
+            return rt == reg;
+        }
+        // opc 00 is a store
+        return (inst & 0x00c00000u) != 0 && rt == reg;
+    }
+    if (isSimd) {
+        // SIMD&FP load literal, or load/store structures where only the post-indexed forms write back
+        return (inst & 0xbe800000u) == 0x0c800000u && rn == reg;
+    }
+    if ((inst & 0x3b000000u) == 0x18000000u) {
+        // load literal, the rest of the instruction is the offset
+        return rt == reg;
+    }
+    // exclusives and the rest, the stores among them may write a status to Rs
+    return rt == reg || rt2 == reg || rs == reg;
+}
+
+/**
+ * Pair an ADRP with the ADD/LDR instructions after it which use its destination register as the base.
+ * @param code the instructions of the segment
+ * @param index the index of the ADRP in code
+ * @param count the number of instructions in code
+ * @param codeRva the RVA of code[0]
+ */
+static void DecodeAdrpPairs(const uint32_t* code, size_t index, size_t count, uint64_t codeRva, std::vector<Arm64XrefIndex::Xref>& out) {
+    const uint32_t adrp = code[index];
+    const uint32_t rd = adrp & 0x1f;
+    const uint64_t pc = codeRva + index * 4;
+    const uint64_t immhi = (adrp >> 5) & 0x7ffff;
+    const uint64_t immlo = (adrp >> 29) & 0x3;
+    const uint64_t page = (pc & ~uint64_t(0xfff)) + uint64_t(SignExtend((immhi << 2) | immlo, 21) << 12);
+    const size_t end = std::min(count, index + 1 + kAdrpPairWindow);
+    for (size_t i = index + 1; i < end; i++) {
+        const uint32_t inst = code[i];
+        const uint32_t rn = (inst >> 5) & 0x1f;
+        const uint32_t rt = inst & 0x1f;
+        uint64_t target;
+        if ((inst & 0xff800000u) == 0x91000000u && rn == rd) {
+            // ADD Xd, Xn, #imm12{, LSL #12}
+            const uint64_t imm12 = (inst >> 10) & 0xfff;
+            target = page + (((inst >> 22) & 1) != 0 ? imm12 << 12 : imm12);
+        } else if ((inst & 0xffc00000u) == 0xf9400000u && rn == rd) {
+            // LDR Xt, [Xn, #imm12 * 8]
+            target = page + (((inst >> 10) & 0xfff) << 3);
+        } else if ((inst & 0xffc00000u) == 0xb9400000u && rn == rd) {
+            // LDR Wt, [Xn, #imm12 * 4]
+            target = page + (((inst >> 10) & 0xfff) << 2);
+        } else if (IsBOrBl(inst) || IsBranchRegister(inst)) {
+            // B, BL, BR, BLR or RET, the pair would not be in the same basic block
+            break;
+        } else if (MayWriteRegister(inst, rd)) {
+            // the register is redefined, e.g. by another ADRP, a MOV or a load
+            break;
+        } else {
+            continue;
+        }
+        if (target <= UINT32_MAX) {
+            out.push_back({uint32_t(target), uint32_t(pc)});
+        }
+        if (rt == rd) {
+            // e.g. ldr x8, [x8, #imm], the page is gone
+            break;
+        }
+    }
+}
+
+namespace {
+
+struct XrefChunk {
+    const uint32_t* code; // the whole segment
+    size_t count; // instructions in the segment
+    uint64_t codeRva;
+    size_t begin; // the first instruction of this chunk
+    size_t end;
+};
+
+}
+
+static void DecodeChunk(const XrefChunk& chunk, std::vector<Arm64XrefIndex::Xref>& codeRefs, std::vector<Arm64XrefIndex::Xref>& dataRefs) {
+    const uint32_t* code = chunk.code;
+    size_t i = chunk.begin;
+    while (i < chunk.end) {
+        if (i + 4 <= chunk.end && !HasInterestingInstruction(code + i)) {
+            i += 4;
+            continue;
+        }
+        const size_t blockEnd = std::min(i + 4, chunk.end);
+        for (; i < blockEnd; i++) {
+            const uint32_t inst = code[i];
+            if (IsBOrBl(inst)) {
+                const uint64_t pc = chunk.codeRva + i * 4;
+                const uint64_t target = pc + uint64_t(SignExtend(inst & 0x03ffffffu, 26) * 4);
+                if (target <= UINT32_MAX) {
+                    codeRefs.push_back({uint32_t(target), uint32_t(pc)});
+                }
+            } else if (IsAdrp(inst)) {
+                // the window may cross the end of the chunk, but not the end of the segment
+                DecodeAdrpPairs(code, i, chunk.count, chunk.codeRva, dataRefs);
+            }
+        }
+    }
+}
+
+static inline bool XrefLess(const Arm64XrefIndex::Xref& a, const Arm64XrefIndex::Xref& b) noexcept {
+    return a.target < b.target || (a.target == b.target && a.site < b.site);
+}
+
+/**
+ * Split the instructions of the executable segments within [rvaBegin, rvaEnd) into chunks.
+ * @return empty string on success, or an error message
+ */
+static std::string CollectChunks(const ElfImageLayout& layout, uint64_t rvaBegin, uint64_t rvaEnd, std::vector<XrefChunk>& chunks) {
+    if (!layout.IsValid()) {
+        return "invalid layout";
+    }
+    if (layout.GetMachine() != EM_AARCH64) {
+        return fmt::format("not an arm64 image, e_machine: {}", layout.GetMachine());
+    }
+    for (const auto& seg: layout.GetSegments()) {
+        if ((seg.flags & PF_X) == 0 || seg.vaddr + seg.fileSize <= rvaBegin || seg.vaddr >= rvaEnd) {
+            continue;
+        }
+        if (seg.vaddr + seg.fileSize > UINT32_MAX) {
+            return fmt::format("segment at 0x{:x} is beyond 4 GiB", seg.vaddr);
+        }
+        const uint8_t* p = layout.GetPointer(seg.vaddr, seg.fileSize);
+        if (p == nullptr || seg.vaddr % 4 != 0 || reinterpret_cast<uintptr_t>(p) % 4 != 0) {
+            return fmt::format("segment at 0x{:x} is not readable or not aligned", seg.vaddr);
+        }
+        const auto* code = reinterpret_cast<const uint32_t*>(p);
+        const size_t count = size_t(seg.fileSize / 4);
+        const size_t first = rvaBegin > seg.vaddr ? size_t((rvaBegin - seg.vaddr + 3) / 4) : 0;
+        const size_t last = std::min(count, size_t((std::min(rvaEnd, seg.vaddr + seg.fileSize) - seg.vaddr + 3) / 4));
+        for (size_t begin = first; begin < last; begin += kChunkInstructionCount) {
+            chunks.push_back({code, count, seg.vaddr, begin, std::min(last, begin + kChunkInstructionCount)});
+        }
+    }
+    return {};
+}
+
+std::string Arm64XrefIndex::Build(const ElfImageLayout& layout, unsigned int threadCount) {
+    mCodeRefs.clear();
+    mDataRefs.clear();
+    std::vector<XrefChunk> chunks;
+    if (std::string err = CollectChunks(layout, 0, UINT64_MAX, chunks); !err.empty()) {
+        return err;
+    }
+    if (chunks.empty()) {
+        return "no executable segment";
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min<unsigned int>(threadCount, chunks.size());
+    std::vector<std::vector<Xref>> codeRefsPerWorker(threadCount);
+    std::vector<std::vector<Xref>> dataRefsPerWorker(threadCount);
+    std::atomic<size_t> nextChunk = 0;
+    const auto fnWorker = [&](unsigned int worker) {
+        for (size_t c; (c = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) {
+            DecodeChunk(chunks[c], codeRefsPerWorker[worker], dataRefsPerWorker[worker]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++) {
+        try {
+            threads.emplace_back(fnWorker, i);
+        } catch (const std::system_error& e) {
+            // the remaining workers pick up the chunks
+            LOGW("Arm64XrefIndex: failed to start worker thread: {}", e.what());
+            break;
+        }
+    }
+    fnWorker(0);
+    for (auto& t: threads) {
+        t.join();
+    }
+    const auto fnMerge = [](std::vector<std::vector<Xref>>& parts, std::vector<Xref>& out) {
+        size_t total = 0;
+        for (const auto& part: parts) {
+            total += part.size();
+        }
+        out.reserve(total);
+        for (auto& part: parts) {
+            out.insert(out.end(), part.begin(), part.end());
+            std::vector<Xref>().swap(part);
+        }
+        std::sort(out.begin(), out.end(), XrefLess);
+    };
+    fnMerge(codeRefsPerWorker, mCodeRefs);
+    fnMerge(dataRefsPerWorker, mDataRefs);
+    return {};
+}
+
+std::string Arm64XrefIndex::BuildForRange(const ElfImageLayout& layout, uint64_t rvaBegin, uint64_t rvaEnd) {
+    mCodeRefs.clear();
+    mDataRefs.clear();
+    std::vector<XrefChunk> chunks;
+    if (std::string err = CollectChunks(layout, rvaBegin, rvaEnd, chunks); !err.empty()) {
+        return err;
+    }
+    for (const auto& chunk: chunks) {
+        DecodeChunk(chunk, mCodeRefs, mDataRefs);
+    }
+    std::sort(mCodeRefs.begin(), mCodeRefs.end(), XrefLess);
+    std::sort(mDataRefs.begin(), mDataRefs.end(), XrefLess);
+    return {};
+}
+
+static std::span<const Arm64XrefIndex::Xref> FindByTarget(const std::vector<Arm64XrefIndex::Xref>& table, uint64_t target) noexcept {
+    if (target > UINT32_MAX) {
+        return {};
+    }
+    auto lower = std::lower_bound(table.begin(), table.end(), uint32_t(target), [](const Arm64XrefIndex::Xref& x, uint32_t v) {
+        return x.target < v;
+    });
+    auto upper = std::upper_bound(lower, table.end(), uint32_t(target), [](uint32_t v, const Arm64XrefIndex::Xref& x) {
+        return v < x.target;
+    });
+    return {lower, upper};
+}
+
+std::span<const Arm64XrefIndex::Xref> Arm64XrefIndex::FindCodeReferences(uint64_t target) const noexcept {
+    return FindByTarget(mCodeRefs, target);
+}
+
+std::span<const Arm64XrefIndex::Xref> Arm64XrefIndex::FindDataReferences(uint64_t target) const noexcept {
+    return FindByTarget(mDataRefs, target);
+}
+
+std::vector<uint64_t> Arm64XrefIndex::FindStrings(const ElfImageLayout& layout, std::string_view str) {
+    std::vector<uint64_t> results;
+    if (str.empty()) {
+        return results;
+    }
+    for (const auto& seg: layout.GetSegments()) {
+        if ((seg.flags & PF_X) != 0) {
+            continue;
+        }
+        const auto* p = reinterpret_cast<const char*>(layout.GetPointer(seg.vaddr, seg.fileSize));
+        if (p == nullptr) {
+            continue;
+        }
+        std::string_view haystack(p, size_t(seg.fileSize));
+        for (size_t pos = haystack.find(str); pos != std::string_view::npos; pos = haystack.find(str, pos + 1)) {
+            const size_t end = pos + str.size();
+            if (end < haystack.size() && haystack[end] == '\0' && (pos == 0 || haystack[pos - 1] == '\0')) {
+                results.push_back(seg.vaddr + pos);
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<uint64_t> Arm64XrefIndex::FindStringReferences(const ElfImageLayout& layout, std::string_view str) const {
+    std::vector<uint64_t> sites;
+    for (uint64_t rva: FindStrings(layout, str)) {
+        for (const auto& xref: FindDataReferences(rva)) {
+            sites.push_back(xref.site);
+        }
+    }
+    std::sort(sites.begin(), sites.end());
+    sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+    return sites;
+}
+
+int Arm64XrefIndex::SaveToFile(const std::string& path, uint64_t key) const {
+    return utils::SaveToFile(path, [&](int fd) {
+        XrefFileHeader header = {kFileMagic, kFileVersion, key, mCodeRefs.size(), mDataRefs.size()};
+        int err = WriteFully(fd, &header, sizeof(header));
+        if (err == 0) {
+            err = WriteFully(fd, mCodeRefs.data(), mCodeRefs.size() * sizeof(Xref));
+        }
+        if (err == 0) {
+            err = WriteFully(fd, mDataRefs.data(), mDataRefs.size() * sizeof(Xref));
+        }
+        return err;
+    });
+}
+
+int Arm64XrefIndex::LoadFromFile(const std::string& path, uint64_t key) {
+    mCodeRefs.clear();
+    mDataRefs.clear();
+    return utils::LoadFromFile(path, [&](int fd, uint64_t fileSize) {
+        XrefFileHeader header = {};
+        if (int err = ReadFully(fd, &header, sizeof(header)); err != 0) {
+            return err;
+        }
+        if (header.magic != kFileMagic || header.version != kFileVersion) {
+            return EINVAL;
+        }
+        if (header.key != key) {
+            return ESTALE;
+        }
+        const uint64_t maxCount = fileSize / sizeof(Xref);
+        if (header.codeRefCount > maxCount || header.dataRefCount > maxCount
+                || sizeof(header) + (header.codeRefCount + header.dataRefCount) * sizeof(Xref) != fileSize) {
+            return EINVAL;
+        }
+        std::vector<Xref> codeRefs(size_t(header.codeRefCount));
+        std::vector<Xref> dataRefs(size_t(header.dataRefCount));
+        if (int err = ReadFully(fd, codeRefs.data(), codeRefs.size() * sizeof(Xref)); err != 0) {
+            return err;
+        }
+        if (int err = ReadFully(fd, dataRefs.data(), dataRefs.size() * sizeof(Xref)); err != 0) {
+            return err;
+        }
+        // the lookups rely on the order
+        if (!std::is_sorted(codeRefs.begin(), codeRefs.end(), XrefLess) || !std::is_sorted(dataRefs.begin(), dataRefs.end(), XrefLess)) {
+            return EINVAL;
+        }
+        mCodeRefs = std::move(codeRefs);
+        mDataRefs = std::move(dataRefs);
+        return 0;
+    });
+}
+
+}
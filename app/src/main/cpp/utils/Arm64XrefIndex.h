@@ -0,0 +1,120 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_ARM64XREFINDEX_H
+#define QAUXV_ARM64XREFINDEX_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/ElfImageLayout.h"
+
+namespace utils {
+
+/**
+ * Cross references in the executable segments of an arm64 ELF image, i.e. which instructions refer to which address.
+ * Two kinds of references are decoded:
+ * - code references: the targets of BL and B immediates
+ * - data references: the addresses formed by ADRP followed by ADD or LDR on the same register
+ * Each kind is a table of (target, site) sorted by target, so that all sites referring to a target are one binary search away.
+ * Anchoring on references survives register allocation changes which break raw instruction patterns.
+ * Addresses are 32-bit RVAs, images with segments beyond 4 GiB are rejected.
+ * No AOB target is anchored on references yet, so this is only built by the host bench, add it to qauxv-core0 with the
+ * first user.
+ */
+class Arm64XrefIndex {
+public:
+    struct Xref {
+        uint32_t target;
+        // the address of the BL/B, or of the ADRP
+        uint32_t site;
+    };
+
+    Arm64XrefIndex() = default;
+
+    /**
+     * Decode the executable segments of the image, any previous content is discarded.
+     * The segments are split into chunks which are decoded in parallel.
+     * @param layout the layout of an EM_AARCH64 image
+     * @param threadCount the number of threads, 0 for the number of CPUs
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Build(const ElfImageLayout& layout, unsigned int threadCount = 0);
+
+    /**
+     * Decode only the instructions within [rvaBegin, rvaEnd) on the calling thread, any previous content is discarded.
+     * Only the references made from the range are found, e.g. the branches within a function, not the calls from elsewhere.
+     * @param layout the layout of an EM_AARCH64 image
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string BuildForRange(const ElfImageLayout& layout, uint64_t rvaBegin, uint64_t rvaEnd);
+
+    /**
+     * Get the BL/B instructions whose target is the given address.
+     * @return the references sorted by site
+     */
+    [[nodiscard]] std::span<const Xref> FindCodeReferences(uint64_t target) const noexcept;
+
+    /**
+     * Get the ADRP pairs which form the given address.
+     * @return the references sorted by site
+     */
+    [[nodiscard]] std::span<const Xref> FindDataReferences(uint64_t target) const noexcept;
+
+    /**
+     * Find the RVAs of a NUL terminated string in the non-executable segments of the image.
+     * Only whole strings match, i.e. the byte before the match is NUL, so that suffixes of longer strings are not returned.
+     * @param layout the layout the index was built from
+     * @param str the string, without the NUL terminator
+     */
+    [[nodiscard]] static std::vector<uint64_t> FindStrings(const ElfImageLayout& layout, std::string_view str);
+
+    /**
+     * Get the sites referring to a string, see FindStrings and FindDataReferences.
+     * Pass the sites to FunctionIndex::FindFunction to get the referencing functions.
+     * @return the sites, sorted and without duplicates
+     */
+    [[nodiscard]] std::vector<uint64_t> FindStringReferences(const ElfImageLayout& layout, std::string_view str) const;
+
+    /**
+     * Write the index to a file, atomically replacing any existing file.
+     * @param path the path of the file
+     * @param key identifies the image the index belongs to, e.g. a hash of the host version and the image size
+     * @return 0 on success, or errno
+     */
+    [[nodiscard]] int SaveToFile(const std::string& path, uint64_t key) const;
+
+    /**
+     * Read an index written by SaveToFile.
+     * @param path the path of the file
+     * @param key the expected key
+     * @return 0 on success, ENOENT if the file does not exist, ESTALE if the key does not match, EINVAL if the file is corrupted, or errno
+     */
+    [[nodiscard]] int LoadFromFile(const std::string& path, uint64_t key);
+
+    [[nodiscard]] inline bool IsEmpty() const noexcept {
+        return mCodeRefs.empty() && mDataRefs.empty();
+    }
+
+    // sorted by (target, site)
+    [[nodiscard]] inline const std::vector<Xref>& GetCodeReferences() const noexcept {
+        return mCodeRefs;
+    }
+
+    // sorted by (target, site)
+    [[nodiscard]] inline const std::vector<Xref>& GetDataReferences() const noexcept {
+        return mDataRefs;
+    }
+
+private:
+    std::vector<Xref> mCodeRefs;
+    std::vector<Xref> mDataRefs;
+};
+
+}
+
+#endif //QAUXV_ARM64XREFINDEX_H
@@ -0,0 +1,458 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "AxmlReader.h"
+
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "utils/FileMemMap.h"
+
+namespace utils {
+
+// see frameworks/base/libs/androidfw/include/androidfw/ResourceTypes.h
+static constexpr uint16_t kResStringPoolType = 0x0001;
+static constexpr uint16_t kResXmlType = 0x0003;
+static constexpr uint16_t kResXmlStartNamespaceType = 0x0100;
+static constexpr uint16_t kResXmlEndNamespaceType = 0x0101;
+static constexpr uint16_t kResXmlStartElementType = 0x0102;
+static constexpr uint16_t kResXmlEndElementType = 0x0103;
+static constexpr uint16_t kResXmlCdataType = 0x0104;
+static constexpr uint16_t kResXmlLastChunkType = 0x017f;
+static constexpr uint16_t kResXmlResourceMapType = 0x0180;
+static constexpr uint32_t kStringPoolUtf8Flag = 1u << 8;
+static constexpr size_t kChunkHeaderSize = 8;
+static constexpr size_t kStringPoolHeaderSize = 28;
+static constexpr size_t kXmlNodeHeaderSize = 16;
+static constexpr size_t kXmlAttrExtSize = 20;
+static constexpr size_t kXmlAttributeSize = 20;
+
+namespace {
+
+struct ChunkHeader {
+    uint16_t type = 0;
+    uint16_t headerSize = 0;
+    uint32_t size = 0;
+};
+
+}
+
+/**
+ * Read and validate the chunk header at offset, the chunk must end before end.
+ */
+static bool ReadChunkHeader(BinarySpan data, size_t offset, size_t end, ChunkHeader& header) noexcept {
+    if (!data.ReadLe(offset, header.type) || !data.ReadLe(offset + 2, header.headerSize)
+            || !data.ReadLe(offset + 4, header.size)) {
+        return false;
+    }
+    return header.headerSize >= kChunkHeaderSize && header.headerSize <= header.size && header.size <= end - offset;
+}
+
+/**
+ * Encode a code point as UTF-8.
+ * @return the number of bytes written to out
+ */
+static inline size_t EncodeUtf8(char32_t codePoint, char (& out)[4]) noexcept {
+    if (codePoint < 0x80) {
+        out[0] = char(codePoint);
+        return 1;
+    } else if (codePoint < 0x800) {
+        out[0] = char(0xc0 | (codePoint >> 6));
+        out[1] = char(0x80 | (codePoint & 0x3f));
+        return 2;
+    } else if (codePoint < 0x10000) {
+        out[0] = char(0xe0 | (codePoint >> 12));
+        out[1] = char(0x80 | ((codePoint >> 6) & 0x3f));
+        out[2] = char(0x80 | (codePoint & 0x3f));
+        return 3;
+    } else {
+        out[0] = char(0xf0 | (codePoint >> 18));
+        out[1] = char(0x80 | ((codePoint >> 12) & 0x3f));
+        out[2] = char(0x80 | ((codePoint >> 6) & 0x3f));
+        out[3] = char(0x80 | (codePoint & 0x3f));
+        return 4;
+    }
+}
+
+/**
+ * Decode the code point at units[i] and advance i, unpaired surrogates become U+FFFD.
+ */
+static inline char32_t NextUtf16CodePoint(const uint8_t* units, size_t count, size_t& i) noexcept {
+    const auto unitAt = [units](size_t index) -> char16_t {
+        return char16_t(units[index * 2] | (units[index * 2 + 1] << 8));
+    };
+    const char16_t high = unitAt(i++);
+    if (high < 0xd800 || high > 0xdfff) {
+        return high;
+    }
+    if (high <= 0xdbff && i < count) {
+        const char16_t low = unitAt(i);
+        if (low >= 0xdc00 && low <= 0xdfff) {
+            i++;
+            return 0x10000 + ((char32_t(high - 0xd800) << 10) | char32_t(low - 0xdc00));
+        }
+    }
+    return 0xfffd;
+}
+
+std::string AxmlStringPool::Attach(BinarySpan chunk) {
+    mChunk = chunk;
+    uint16_t headerSize;
+    uint32_t flags;
+    if (chunk.size() < kStringPoolHeaderSize || !chunk.ReadLe(2, headerSize) || !chunk.ReadLe(8, mStringCount)
+            || !chunk.ReadLe(16, flags) || !chunk.ReadLe(20, mStringsStart)) {
+        return "string pool header is truncated";
+    }
+    mOffsetsStart = headerSize;
+    mUtf8 = (flags & kStringPoolUtf8Flag) != 0;
+    if (uint64_t(mOffsetsStart) + uint64_t(mStringCount) * 4 > chunk.size() || mStringsStart > chunk.size()) {
+        mStringCount = 0;
+        return "string pool offsets are out of bounds";
+    }
+    return {};
+}
+
+bool AxmlStringPool::GetRawEntry(uint32_t index, const uint8_t*& data, size_t& length) const noexcept {
+    uint32_t offset;
+    if (index >= mStringCount || !mChunk.ReadLe(mOffsetsStart + size_t(index) * 4, offset)) {
+        return false;
+    }
+    size_t pos = size_t(mStringsStart) + offset;
+    if (pos >= mChunk.size()) {
+        return false;
+    }
+    const auto* base = mChunk.data();
+    if (mUtf8) {
+        // the UTF-16 length then the UTF-8 length, each 1 or 2 bytes with the high bit as the continuation flag
+        size_t byteLength = 0;
+        for (int i = 0; i < 2; i++) {
+            uint8_t first;
+            if (!mChunk.ReadLe(pos, first)) {
+                return false;
+            }
+            pos++;
+            byteLength = first;
+            if ((first & 0x80) != 0) {
+                uint8_t second;
+                if (!mChunk.ReadLe(pos, second)) {
+                    return false;
+                }
+                pos++;
+                byteLength = (size_t(first & 0x7f) << 8) | second;
+            }
+        }
+        if (byteLength > mChunk.size() - pos) {
+            return false;
+        }
+        data = base + pos;
+        length = byteLength;
+    } else {
+        uint16_t first;
+        if (!mChunk.ReadLe(pos, first)) {
+            return false;
+        }
+        pos += 2;
+        size_t unitLength = first;
+        if ((first & 0x8000) != 0) {
+            uint16_t second;
+            if (!mChunk.ReadLe(pos, second)) {
+                return false;
+            }
+            pos += 2;
+            unitLength = (size_t(first & 0x7fff) << 16) | second;
+        }
+        if (unitLength > (mChunk.size() - pos) / 2) {
+            return false;
+        }
+        data = base + pos;
+        length = unitLength;
+    }
+    return true;
+}
+
+bool AxmlStringPool::GetString(uint32_t index, std::string& out) const {
+    const uint8_t* data;
+    size_t length;
+    if (!GetRawEntry(index, data, length)) {
+        return false;
+    }
+    if (mUtf8) {
+        out.assign(reinterpret_cast<const char*>(data), length);
+        return true;
+    }
+    out.clear();
+    out.reserve(length);
+    char encoded[4];
+    for (size_t i = 0; i < length;) {
+        out.append(encoded, EncodeUtf8(NextUtf16CodePoint(data, length, i), encoded));
+    }
+    return true;
+}
+
+std::string AxmlStringPool::GetString(uint32_t index) const {
+    std::string result;
+    if (!GetString(index, result)) {
+        result.clear();
+    }
+    return result;
+}
+
+bool AxmlStringPool::GetStringUtf16(uint32_t index, std::u16string& out) const {
+    const uint8_t* data;
+    size_t length;
+    if (!GetRawEntry(index, data, length)) {
+        return false;
+    }
+    out.clear();
+    if (!mUtf8) {
+        out.resize(length);
+        memcpy(out.data(), data, length * 2);
+        return true;
+    }
+    out.reserve(length);
+    for (size_t i = 0; i < length;) {
+        const uint8_t lead = data[i];
+        const size_t n = lead < 0x80 ? 1 : lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4;
+        if (n > length - i) {
+            out.push_back(u'\ufffd');
+            break;
+        }
+        char32_t codePoint = n == 1 ? lead : n == 2 ? (lead & 0x1f) : n == 3 ? (lead & 0x0f) : (lead & 0x07);
+        for (size_t j = 1; j < n; j++) {
+            codePoint = (codePoint << 6) | (data[i + j] & 0x3f);
+        }
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            out.push_back(char16_t(0xd800 + (codePoint >> 10)));
+            out.push_back(char16_t(0xdc00 + (codePoint & 0x3ff)));
+        } else {
+            out.push_back(char16_t(codePoint));
+        }
+        i += n;
+    }
+    return true;
+}
+
+bool AxmlStringPool::Equals(uint32_t index, std::string_view value) const noexcept {
+    const uint8_t* data;
+    size_t length;
+    if (!GetRawEntry(index, data, length)) {
+        return false;
+    }
+    if (mUtf8) {
+        return length == value.size() && memcmp(data, value.data(), length) == 0;
+    }
+    size_t matched = 0;
+    char encoded[4];
+    for (size_t i = 0; i < length;) {
+        const size_t n = EncodeUtf8(NextUtf16CodePoint(data, length, i), encoded);
+        if (n > value.size() - matched || memcmp(encoded, value.data() + matched, n) != 0) {
+            return false;
+        }
+        matched += n;
+    }
+    return matched == value.size();
+}
+
+AxmlDocument::AxmlDocument() = default;
+
+AxmlDocument::~AxmlDocument() noexcept = default;
+
+std::string AxmlDocument::OpenFile(const char* path) {
+    auto fileMap = std::make_unique<FileMemMap>();
+    if (int err = fileMap->mapFilePath(path); err != 0) {
+        return fmt::format("unable to map {}: {}", path, strerror(err));
+    }
+    if (auto error = OpenMemory(fileMap->getAddress(), fileMap->getLength()); !error.empty()) {
+        return error;
+    }
+    mFileMap = std::move(fileMap);
+    return {};
+}
+
+std::string AxmlDocument::OpenMemory(const void* data, size_t length) {
+    mData = BinarySpan(data, length);
+    mStringPool = AxmlStringPool();
+    mResourceMap = BinarySpan();
+    mNodesStart = 0;
+    mNodesEnd = 0;
+    ChunkHeader xml;
+    if (!ReadChunkHeader(mData, 0, length, xml) || xml.type != kResXmlType) {
+        return "not an Android binary XML";
+    }
+    const auto* base = static_cast<const uint8_t*>(data);
+    bool hasStringPool = false;
+    size_t offset = xml.headerSize;
+    mNodesEnd = xml.size;
+    mNodesStart = mNodesEnd;
+    while (mNodesEnd - offset >= kChunkHeaderSize) {
+        ChunkHeader chunk;
+        if (!ReadChunkHeader(mData, offset, mNodesEnd, chunk)) {
+            return fmt::format("malformed chunk at offset {}", offset);
+        }
+        if (chunk.type == kResStringPoolType && !hasStringPool) {
+            if (auto error = mStringPool.Attach(BinarySpan(base + offset, chunk.size)); !error.empty()) {
+                return error;
+            }
+            hasStringPool = true;
+        } else if (chunk.type == kResXmlResourceMapType) {
+            mResourceMap = BinarySpan(base + offset + chunk.headerSize, chunk.size - chunk.headerSize);
+        } else if (chunk.type >= kResXmlStartNamespaceType && chunk.type <= kResXmlLastChunkType) {
+            mNodesStart = offset;
+            break;
+        }
+        offset += chunk.size;
+    }
+    if (!hasStringPool) {
+        return "no string pool before the first XML node";
+    }
+    return {};
+}
+
+uint32_t AxmlDocument::GetResourceId(uint32_t nameIndex) const noexcept {
+    if (nameIndex >= mResourceMap.size() / 4) {
+        return 0;
+    }
+    return mResourceMap.ReadLeOr<uint32_t>(size_t(nameIndex) * 4, 0);
+}
+
+AxmlCursor::AxmlCursor(const AxmlDocument& document) noexcept: mDocument(document), mOffset(document.mNodesStart) {}
+
+AxmlEvent AxmlCursor::Fail(const char* error) noexcept {
+    mError = error;
+    mEvent = AxmlEvent::kError;
+    mAttributeCount = 0;
+    return mEvent;
+}
+
+AxmlEvent AxmlCursor::Next() noexcept {
+    if (mEvent == AxmlEvent::kEndDocument || mEvent == AxmlEvent::kError) {
+        return mEvent;
+    }
+    if (mPendingEndDepth) {
+        mDepth--;
+        mPendingEndDepth = false;
+    }
+    const BinarySpan data = mDocument.mData;
+    const size_t end = mDocument.mNodesEnd;
+    while (end - mOffset >= kChunkHeaderSize) {
+        ChunkHeader chunk;
+        if (!ReadChunkHeader(data, mOffset, end, chunk)) {
+            return Fail("malformed chunk");
+        }
+        const size_t chunkOffset = mOffset;
+        const size_t chunkEnd = chunkOffset + chunk.size;
+        const size_t ext = chunkOffset + chunk.headerSize;
+        mOffset = chunkEnd;
+        if (chunk.type < kResXmlStartNamespaceType || chunk.type > kResXmlCdataType) {
+            continue;
+        }
+        if (chunk.headerSize < kXmlNodeHeaderSize) {
+            return Fail("XML node header is truncated");
+        }
+        mLineNumber = data.ReadLeOr<uint32_t>(chunkOffset + 8, 0);
+        mComment = data.ReadLeOr<uint32_t>(chunkOffset + 12, kAxmlNoIndex);
+        mAttributeCount = 0;
+        switch (chunk.type) {
+            case kResXmlStartNamespaceType:
+            case kResXmlEndNamespaceType: {
+                if (chunkEnd - ext < 8) {
+                    return Fail("namespace node is truncated");
+                }
+                mNamespace = data.ReadLeOr<uint32_t>(ext, kAxmlNoIndex);
+                mName = data.ReadLeOr<uint32_t>(ext + 4, kAxmlNoIndex);
+                mEvent = chunk.type == kResXmlStartNamespaceType ? AxmlEvent::kStartNamespace : AxmlEvent::kEndNamespace;
+                return mEvent;
+            }
+            case kResXmlStartElementType: {
+                if (chunkEnd - ext < kXmlAttrExtSize) {
+                    return Fail("start element node is truncated");
+                }
+                mNamespace = data.ReadLeOr<uint32_t>(ext, kAxmlNoIndex);
+                mName = data.ReadLeOr<uint32_t>(ext + 4, kAxmlNoIndex);
+                const auto attributeStart = data.ReadLeOr<uint16_t>(ext + 8, 0);
+                const auto attributeSize = data.ReadLeOr<uint16_t>(ext + 10, 0);
+                const auto attributeCount = data.ReadLeOr<uint16_t>(ext + 12, 0);
+                if (attributeCount != 0 && (attributeSize < kXmlAttributeSize
+                        || ext + attributeStart + size_t(attributeCount) * attributeSize > chunkEnd)) {
+                    return Fail("attributes are out of bounds");
+                }
+                mAttributeStart = ext + attributeStart;
+                mAttributeSize = attributeSize;
+                mAttributeCount = attributeCount;
+                mDepth++;
+                mEvent = AxmlEvent::kStartElement;
+                return mEvent;
+            }
+            case kResXmlEndElementType: {
+                if (chunkEnd - ext < 8) {
+                    return Fail("end element node is truncated");
+                }
+                if (mDepth == 0) {
+                    return Fail("end element without start element");
+                }
+                mNamespace = data.ReadLeOr<uint32_t>(ext, kAxmlNoIndex);
+                mName = data.ReadLeOr<uint32_t>(ext + 4, kAxmlNoIndex);
+                mPendingEndDepth = true;
+                mEvent = AxmlEvent::kEndElement;
+                return mEvent;
+            }
+            case kResXmlCdataType: {
+                // the string index, then a Res_value: size, res0, dataType, data
+                if (chunkEnd - ext < 12) {
+                    return Fail("text node is truncated");
+                }
+                mNamespace = kAxmlNoIndex;
+                mName = data.ReadLeOr<uint32_t>(ext, kAxmlNoIndex);
+                mTextValue.rawValue = mName;
+                mTextValue.dataType = data.ReadLeOr<uint8_t>(ext + 7, 0);
+                mTextValue.data = data.ReadLeOr<uint32_t>(ext + 8, 0);
+                mEvent = AxmlEvent::kText;
+                return mEvent;
+            }
+            default:
+                break;
+        }
+    }
+    mEvent = AxmlEvent::kEndDocument;
+    return mEvent;
+}
+
+bool AxmlCursor::GetAttribute(uint32_t index, AxmlAttribute& attribute) const noexcept {
+    if (mEvent != AxmlEvent::kStartElement || index >= mAttributeCount) {
+        return false;
+    }
+    // ns, name, rawValue, then a Res_value: size, res0, dataType, data
+    const size_t offset = mAttributeStart + size_t(index) * mAttributeSize;
+    const BinarySpan data = mDocument.mData;
+    attribute.ns = data.ReadLeOr<uint32_t>(offset, kAxmlNoIndex);
+    attribute.name = data.ReadLeOr<uint32_t>(offset + 4, kAxmlNoIndex);
+    attribute.rawValue = data.ReadLeOr<uint32_t>(offset + 8, kAxmlNoIndex);
+    attribute.dataType = data.ReadLeOr<uint8_t>(offset + 15, 0);
+    attribute.data = data.ReadLeOr<uint32_t>(offset + 16, 0);
+    return true;
+}
+
+int AxmlCursor::FindAttribute(std::string_view name) const noexcept {
+    AxmlAttribute attribute;
+    for (uint32_t i = 0; i < mAttributeCount; i++) {
+        if (GetAttribute(i, attribute) && mDocument.mStringPool.Equals(attribute.name, name)) {
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+int AxmlCursor::FindAttributeByResourceId(uint32_t resourceId) const noexcept {
+    AxmlAttribute attribute;
+    for (uint32_t i = 0; i < mAttributeCount; i++) {
+        if (GetAttribute(i, attribute) && mDocument.GetResourceId(attribute.name) == resourceId) {
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+}
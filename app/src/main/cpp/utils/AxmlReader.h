@@ -0,0 +1,250 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_AXMLREADER_H
+#define QAUXV_AXMLREADER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "utils/BinaryCursor.h"
+
+class FileMemMap;
+
+namespace utils {
+
+// a string or namespace index that is not present
+constexpr uint32_t kAxmlNoIndex = 0xFFFFFFFFu;
+
+// Res_value::dataType values used by callers
+constexpr uint8_t kAxmlTypeString = 0x03;
+
+/**
+ * The string pool of an Android binary XML, parsed in place.
+ * Entries are decoded on demand only, nothing is copied when the pool is opened.
+ */
+class AxmlStringPool {
+public:
+    AxmlStringPool() = default;
+
+    /**
+     * Attach to a RES_STRING_POOL_TYPE chunk.
+     * @param chunk the whole chunk, including the header
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Attach(BinarySpan chunk);
+
+    [[nodiscard]] inline uint32_t GetStringCount() const noexcept {
+        return mStringCount;
+    }
+
+    [[nodiscard]] inline bool IsUtf8() const noexcept {
+        return mUtf8;
+    }
+
+    /**
+     * Decode a string as UTF-8.
+     * @param index the string index
+     * @param out receives the string
+     * @return true on success, false if the index is out of range or the entry is malformed
+     */
+    [[nodiscard]] bool GetString(uint32_t index, std::string& out) const;
+
+    /**
+     * Decode a string as UTF-8, an invalid index gives an empty string.
+     */
+    [[nodiscard]] std::string GetString(uint32_t index) const;
+
+    /**
+     * Decode a string as UTF-16, e.g. for a jstring. Entries of UTF-16 pools are copied without conversion.
+     * @return true on success, false if the index is out of range or the entry is malformed
+     */
+    [[nodiscard]] bool GetStringUtf16(uint32_t index, std::u16string& out) const;
+
+    /**
+     * Compare a string with a UTF-8 string without decoding it into a new buffer.
+     */
+    [[nodiscard]] bool Equals(uint32_t index, std::string_view value) const noexcept;
+
+private:
+    // UTF-8 pools: the encoded bytes, UTF-16 pools: the code units, both without the terminator
+    [[nodiscard]] bool GetRawEntry(uint32_t index, const uint8_t*& data, size_t& length) const noexcept;
+
+    BinarySpan mChunk;
+    uint32_t mStringCount = 0;
+    uint32_t mOffsetsStart = 0;
+    uint32_t mStringsStart = 0;
+    bool mUtf8 = false;
+};
+
+/**
+ * An Android binary XML document, e.g. AndroidManifest.xml in an APK or a compiled layout.
+ * The document only validates the outer chunk and locates the string pool and the resource map,
+ * the XML nodes are read by AxmlCursor.
+ */
+class AxmlDocument {
+public:
+    AxmlDocument();
+
+    ~AxmlDocument() noexcept;
+
+    AxmlDocument(const AxmlDocument&) = delete;
+
+    AxmlDocument& operator=(const AxmlDocument&) = delete;
+
+    /**
+     * Map and open a binary XML file, the mapping lives as long as this object.
+     * @param path the file path
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string OpenFile(const char* path);
+
+    /**
+     * Open a binary XML in memory, the memory must outlive this object.
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string OpenMemory(const void* data, size_t length);
+
+    [[nodiscard]] inline const AxmlStringPool& GetStringPool() const noexcept {
+        return mStringPool;
+    }
+
+    /**
+     * Get the resource id of an attribute name, e.g. 0x01010003 for android:name.
+     * @param nameIndex the string index of the attribute name
+     * @return the resource id, or 0 if there is none
+     */
+    [[nodiscard]] uint32_t GetResourceId(uint32_t nameIndex) const noexcept;
+
+private:
+    friend class AxmlCursor;
+
+    std::unique_ptr<FileMemMap> mFileMap;
+    BinarySpan mData;
+    AxmlStringPool mStringPool;
+    BinarySpan mResourceMap;
+    // the first chunk after the string pool and the resource map, and the end of the RES_XML_TYPE chunk
+    size_t mNodesStart = 0;
+    size_t mNodesEnd = 0;
+};
+
+enum class AxmlEvent {
+    kStartNamespace,
+    kEndNamespace,
+    kStartElement,
+    kEndElement,
+    kText,
+    kEndDocument,
+    kError,
+};
+
+struct AxmlAttribute {
+    uint32_t ns = kAxmlNoIndex;
+    uint32_t name = kAxmlNoIndex;
+    // the original string value, kAxmlNoIndex for values compiled to another type
+    uint32_t rawValue = kAxmlNoIndex;
+    uint8_t dataType = 0;
+    uint32_t data = 0;
+};
+
+/**
+ * A forward-only cursor over the nodes of an AxmlDocument, similar to XmlPullParser.
+ * Nothing is allocated while iterating, callers that only need a few attributes never decode the other strings.
+ */
+class AxmlCursor {
+public:
+    explicit AxmlCursor(const AxmlDocument& document) noexcept;
+
+    /**
+     * Move to the next node.
+     * @return the event, kEndDocument at the end, kError if the document is malformed, see GetError
+     */
+    [[nodiscard]] AxmlEvent Next() noexcept;
+
+    [[nodiscard]] inline AxmlEvent GetEvent() const noexcept {
+        return mEvent;
+    }
+
+    [[nodiscard]] inline const char* GetError() const noexcept {
+        return mError;
+    }
+
+    // the element depth, 1 for the root element, both for its start and end events
+    [[nodiscard]] inline uint32_t GetDepth() const noexcept {
+        return mDepth;
+    }
+
+    [[nodiscard]] inline uint32_t GetLineNumber() const noexcept {
+        return mLineNumber;
+    }
+
+    // the comment attached to the node, usually kAxmlNoIndex since aapt drops comments
+    [[nodiscard]] inline uint32_t GetComment() const noexcept {
+        return mComment;
+    }
+
+    // the element namespace uri, or the namespace prefix for namespace events
+    [[nodiscard]] inline uint32_t GetNamespace() const noexcept {
+        return mNamespace;
+    }
+
+    // the element name, or the namespace uri for namespace events, or the text for text events
+    [[nodiscard]] inline uint32_t GetName() const noexcept {
+        return mName;
+    }
+
+    [[nodiscard]] inline uint32_t GetAttributeCount() const noexcept {
+        return mAttributeCount;
+    }
+
+    /**
+     * Read an attribute of the current start element.
+     * @return false if index is out of range
+     */
+    [[nodiscard]] bool GetAttribute(uint32_t index, AxmlAttribute& attribute) const noexcept;
+
+    /**
+     * Find an attribute of the current start element by name, ignoring the namespace.
+     * @return the attribute index, or -1 if not found
+     */
+    [[nodiscard]] int FindAttribute(std::string_view name) const noexcept;
+
+    /**
+     * Find an attribute of the current start element by resource id, e.g. 0x01010003 for android:name.
+     * @return the attribute index, or -1 if not found
+     */
+    [[nodiscard]] int FindAttributeByResourceId(uint32_t resourceId) const noexcept;
+
+    /**
+     * Get the typed value of the current text node.
+     */
+    [[nodiscard]] inline const AxmlAttribute& GetTextValue() const noexcept {
+        return mTextValue;
+    }
+
+private:
+    AxmlEvent Fail(const char* error) noexcept;
+
+    const AxmlDocument& mDocument;
+    size_t mOffset;
+    AxmlEvent mEvent = AxmlEvent::kStartNamespace;
+    const char* mError = nullptr;
+    uint32_t mDepth = 0;
+    uint32_t mLineNumber = 0;
+    uint32_t mComment = kAxmlNoIndex;
+    uint32_t mNamespace = kAxmlNoIndex;
+    uint32_t mName = kAxmlNoIndex;
+    // the attribute array of the current start element
+    size_t mAttributeStart = 0;
+    uint32_t mAttributeSize = 0;
+    uint32_t mAttributeCount = 0;
+    AxmlAttribute mTextValue;
+    bool mPendingEndDepth = false;
+};
+
+}
+
+#endif //QAUXV_AXMLREADER_H
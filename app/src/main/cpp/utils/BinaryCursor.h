@@ -0,0 +1,308 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_BINARYCURSOR_H
+#define QAUXV_BINARYCURSOR_H
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace utils {
+
+/**
+ * A read-only view of a byte range with bounds-checked reads, for parsing untrusted binary formats,
+ * e.g. zip, ELF and APK signing blocks.
+ *
+ * Every read checks its whole range once and fails without side effects, there is no exception and no UB
+ * for any input, which keeps the parsers built on it fuzzable.
+ * The integer reads are constexpr, at run time they are a plain load plus a byte swap on the other endianness.
+ */
+class BinarySpan {
+public:
+    constexpr BinarySpan() noexcept = default;
+
+    constexpr BinarySpan(const uint8_t* data, size_t size) noexcept: mData(data), mSize(size) {}
+
+    constexpr BinarySpan(std::span<const uint8_t> span) noexcept: mData(span.data()), mSize(span.size()) {}
+
+    BinarySpan(const void* data, size_t size) noexcept: mData(static_cast<const uint8_t*>(data)), mSize(size) {}
+
+    [[nodiscard]] constexpr const uint8_t* data() const noexcept {
+        return mData;
+    }
+
+    [[nodiscard]] constexpr size_t size() const noexcept {
+        return mSize;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept {
+        return mSize == 0;
+    }
+
+    // unchecked, the caller must have checked the range
+    [[nodiscard]] constexpr uint8_t operator[](size_t index) const noexcept {
+        return mData[index];
+    }
+
+    /**
+     * Check whether [offset, offset + length) is inside the span, without overflow.
+     */
+    [[nodiscard]] constexpr bool Contains(size_t offset, size_t length) const noexcept {
+        return offset <= mSize && length <= mSize - offset;
+    }
+
+    /**
+     * Check whether an array of count T starts at offset, without overflow.
+     */
+    template<typename T>
+    [[nodiscard]] constexpr bool ContainsArray(size_t offset, size_t count) const noexcept {
+        return offset <= mSize && count <= (mSize - offset) / sizeof(T);
+    }
+
+    /**
+     * @return the sub-span [offset, offset + length), or nullopt if it is out of bounds
+     */
+    [[nodiscard]] constexpr std::optional<BinarySpan> Slice(size_t offset, size_t length) const noexcept {
+        if (!Contains(offset, length)) {
+            return std::nullopt;
+        }
+        return BinarySpan(mData + offset, length);
+    }
+
+    /**
+     * @return the sub-span from offset to the end, or nullopt if offset is out of bounds
+     */
+    [[nodiscard]] constexpr std::optional<BinarySpan> SliceFrom(size_t offset) const noexcept {
+        if (offset > mSize) {
+            return std::nullopt;
+        }
+        return BinarySpan(mData + offset, mSize - offset);
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] constexpr bool ReadLe(size_t offset, T& value) const noexcept {
+        if (!Contains(offset, sizeof(T))) {
+            return false;
+        }
+        value = LoadLe<T>(mData + offset);
+        return true;
+    }
+
+    /**
+     * Read a little-endian integer, or get the fallback if it is out of bounds, for fields with a natural default.
+     */
+    template<std::unsigned_integral T>
+    [[nodiscard]] constexpr T ReadLeOr(size_t offset, T fallback) const noexcept {
+        T value = 0;
+        return ReadLe(offset, value) ? value : fallback;
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] constexpr bool ReadBe(size_t offset, T& value) const noexcept {
+        if (!Contains(offset, sizeof(T))) {
+            return false;
+        }
+        value = LoadBe<T>(mData + offset);
+        return true;
+    }
+
+    /**
+     * Copy a trivially copyable struct in host byte order, e.g. an Elf64_Ehdr, with one range check.
+     */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] bool Read(size_t offset, T& value) const noexcept {
+        if (!Contains(offset, sizeof(T))) {
+            return false;
+        }
+        memcpy(&value, mData + offset, sizeof(T));
+        return true;
+    }
+
+    /**
+     * Copy an array of count trivially copyable T in host byte order, with one range check.
+     */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] bool ReadArray(size_t offset, T* values, size_t count) const noexcept {
+        if (!ContainsArray<T>(offset, count)) {
+            return false;
+        }
+        memcpy(values, mData + offset, count * sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] std::string_view AsStringView() const noexcept {
+        return {reinterpret_cast<const char*>(mData), mSize};
+    }
+
+    /**
+     * Load a little-endian integer without any check.
+     */
+    template<std::unsigned_integral T>
+    [[nodiscard]] static constexpr T LoadLe(const uint8_t* p) noexcept {
+        if (std::is_constant_evaluated()) {
+            T value = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                value |= T(T(p[i]) << (i * 8));
+            }
+            return value;
+        }
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return std::endian::native == std::endian::little ? value : ByteSwap(value);
+    }
+
+    /**
+     * Load a big-endian integer without any check.
+     */
+    template<std::unsigned_integral T>
+    [[nodiscard]] static constexpr T LoadBe(const uint8_t* p) noexcept {
+        if (std::is_constant_evaluated()) {
+            T value = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                value = T(value << 8) | T(p[i]);
+            }
+            return value;
+        }
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return std::endian::native == std::endian::big ? value : ByteSwap(value);
+    }
+
+private:
+    template<std::unsigned_integral T>
+    [[nodiscard]] static constexpr T ByteSwap(T value) noexcept {
+        if constexpr (sizeof(T) == 1) {
+            return value;
+        } else if constexpr (sizeof(T) == 2) {
+            return T(__builtin_bswap16(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return T(__builtin_bswap32(value));
+        } else {
+            static_assert(sizeof(T) == 8);
+            return T(__builtin_bswap64(value));
+        }
+    }
+
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+};
+
+/**
+ * A sequential reader over a BinarySpan. A failed read leaves the position unchanged.
+ */
+class BinaryCursor {
+public:
+    constexpr BinaryCursor() noexcept = default;
+
+    constexpr explicit BinaryCursor(BinarySpan span) noexcept: mSpan(span) {}
+
+    [[nodiscard]] constexpr size_t Position() const noexcept {
+        return mPosition;
+    }
+
+    [[nodiscard]] constexpr size_t Remaining() const noexcept {
+        return mSpan.size() - mPosition;
+    }
+
+    [[nodiscard]] constexpr bool AtEnd() const noexcept {
+        return mPosition == mSpan.size();
+    }
+
+    // the bytes from the current position to the end
+    [[nodiscard]] constexpr BinarySpan RemainingSpan() const noexcept {
+        return BinarySpan(mSpan.data() + mPosition, Remaining());
+    }
+
+    [[nodiscard]] constexpr bool Seek(size_t position) noexcept {
+        if (position > mSpan.size()) {
+            return false;
+        }
+        mPosition = position;
+        return true;
+    }
+
+    [[nodiscard]] constexpr bool Skip(size_t length) noexcept {
+        if (length > Remaining()) {
+            return false;
+        }
+        mPosition += length;
+        return true;
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] constexpr bool ReadLe(T& value) noexcept {
+        if (!mSpan.ReadLe(mPosition, value)) {
+            return false;
+        }
+        mPosition += sizeof(T);
+        return true;
+    }
+
+    template<std::unsigned_integral T>
+    [[nodiscard]] constexpr bool ReadBe(T& value) noexcept {
+        if (!mSpan.ReadBe(mPosition, value)) {
+            return false;
+        }
+        mPosition += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    [[nodiscard]] bool Read(T& value) noexcept {
+        if (!mSpan.Read(mPosition, value)) {
+            return false;
+        }
+        mPosition += sizeof(T);
+        return true;
+    }
+
+    /**
+     * Take the next length bytes as a sub-span, without copying.
+     */
+    [[nodiscard]] constexpr bool ReadSpan(size_t length, BinarySpan& span) noexcept {
+        if (length > Remaining()) {
+            return false;
+        }
+        span = BinarySpan(mSpan.data() + mPosition, length);
+        mPosition += length;
+        return true;
+    }
+
+    /**
+     * Take a block prefixed by its little-endian length of type L, e.g. uint32_t for the APK signing scheme.
+     * The prefix is not part of the returned span. On failure, neither the prefix nor the block is consumed.
+     */
+    template<std::unsigned_integral L>
+    [[nodiscard]] constexpr bool ReadLengthPrefixedLe(BinarySpan& span) noexcept {
+        L length = 0;
+        if (!mSpan.ReadLe(mPosition, length)) {
+            return false;
+        }
+        const size_t start = mPosition + sizeof(L);
+        if (length > mSpan.size() - start) {
+            return false;
+        }
+        span = BinarySpan(mSpan.data() + start, size_t(length));
+        mPosition = start + size_t(length);
+        return true;
+    }
+
+private:
+    BinarySpan mSpan;
+    size_t mPosition = 0;
+};
+
+}
+
+#endif //QAUXV_BINARYCURSOR_H
@@ -0,0 +1,346 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "Checksum.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+
+#include <zlib.h>
+#include <fmt/format.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+constexpr uint32_t kAdlerBase = 65521;
+// the most bytes which can be summed before s2 may overflow 32 bits, see zlib adler32.c
+constexpr size_t kAdlerNMax = 5552;
+// the bytes summed by one vector step
+constexpr size_t kAdlerStep = 32;
+constexpr size_t kAdlerMaxChunk = kAdlerNMax / kAdlerStep * kAdlerStep;
+// below this the vector setup does not pay off
+constexpr size_t kAdlerSimdMinLength = 64;
+// the PCLMUL folding needs at least 64 bytes, zlib is as fast below that
+constexpr size_t kCrcSimdMinLength = 64;
+
+// zlib takes uInt lengths
+uint32_t ZlibAdler32(uint32_t adler, const uint8_t* p, size_t length) noexcept {
+    while (length > 0) {
+        const auto n = uInt(std::min<size_t>(length, UINT_MAX / 2));
+        adler = uint32_t(adler32(adler, p, n));
+        p += n;
+        length -= n;
+    }
+    return adler;
+}
+
+uint32_t ZlibCrc32(uint32_t crc, const uint8_t* p, size_t length) noexcept {
+    while (length > 0) {
+        const auto n = uInt(std::min<size_t>(length, UINT_MAX / 2));
+        crc = uint32_t(crc32(crc, p, n));
+        p += n;
+        length -= n;
+    }
+    return crc;
+}
+
+/*
+ * The vector Adler-32 keeps one partial sum per lane. For a run of 32-byte steps starting with s1 and s2:
+ *   s1' = s1 + sum(bytes)
+ *   s2' = s2 + length * s1 + 32 * sum(s1 increments before each step) + sum((32 - i) * byte[i]) over every step
+ * The sums are reduced once per run of at most kAdlerMaxChunk bytes, the same bound as zlib keeps s2 below 2^32.
+ */
+
+#if defined(__ARM_NEON)
+
+inline uint32_t HorizontalSum(uint32x4_t v) noexcept {
+#if defined(__aarch64__)
+    return vaddvq_u32(v);
+#else
+    uint32x2_t pair = vadd_u32(vget_low_u32(v), vget_high_u32(v));
+    return vget_lane_u32(vpadd_u32(pair, pair), 0);
+#endif
+}
+
+// length is a non-zero multiple of kAdlerStep, at most kAdlerMaxChunk
+void Adler32Simd(uint32_t& s1, uint32_t& s2, const uint8_t* p, size_t length) noexcept {
+    static constexpr uint16_t kTaps[32] = {32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                           16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+    uint32x4_t vs1 = vdupq_n_u32(0);
+    uint32x4_t vs1Sum = vdupq_n_u32(0);
+    // per byte position sums, at most 173 * 255 which fits 16 bits
+    uint16x8_t column0 = vdupq_n_u16(0);
+    uint16x8_t column1 = vdupq_n_u16(0);
+    uint16x8_t column2 = vdupq_n_u16(0);
+    uint16x8_t column3 = vdupq_n_u16(0);
+    for (size_t i = 0; i < length; i += kAdlerStep) {
+        const uint8x16_t lo = vld1q_u8(p + i);
+        const uint8x16_t hi = vld1q_u8(p + i + 16);
+        vs1Sum = vaddq_u32(vs1Sum, vs1);
+        vs1 = vpadalq_u16(vs1, vpadalq_u8(vpaddlq_u8(lo), hi));
+        column0 = vaddw_u8(column0, vget_low_u8(lo));
+        column1 = vaddw_u8(column1, vget_high_u8(lo));
+        column2 = vaddw_u8(column2, vget_low_u8(hi));
+        column3 = vaddw_u8(column3, vget_high_u8(hi));
+    }
+    uint32x4_t vs2 = vshlq_n_u32(vs1Sum, 5);
+    vs2 = vmlal_u16(vs2, vget_low_u16(column0), vld1_u16(kTaps));
+    vs2 = vmlal_u16(vs2, vget_high_u16(column0), vld1_u16(kTaps + 4));
+    vs2 = vmlal_u16(vs2, vget_low_u16(column1), vld1_u16(kTaps + 8));
+    vs2 = vmlal_u16(vs2, vget_high_u16(column1), vld1_u16(kTaps + 12));
+    vs2 = vmlal_u16(vs2, vget_low_u16(column2), vld1_u16(kTaps + 16));
+    vs2 = vmlal_u16(vs2, vget_high_u16(column2), vld1_u16(kTaps + 20));
+    vs2 = vmlal_u16(vs2, vget_low_u16(column3), vld1_u16(kTaps + 24));
+    vs2 = vmlal_u16(vs2, vget_high_u16(column3), vld1_u16(kTaps + 28));
+    s2 += s1 * uint32_t(length) + HorizontalSum(vs2);
+    s1 += HorizontalSum(vs1);
+}
+
+inline bool HasAdlerSimd() noexcept {
+    return true;
+}
+
+constexpr const char* kAdlerSimdName = "neon";
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("ssse3")))
+inline uint32_t HorizontalSum(__m128i v) noexcept {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4e));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xb1));
+    return uint32_t(_mm_cvtsi128_si32(v));
+}
+
+// length is a non-zero multiple of kAdlerStep, at most kAdlerMaxChunk
+__attribute__((target("ssse3")))
+void Adler32Simd(uint32_t& s1, uint32_t& s2, const uint8_t* p, size_t length) noexcept {
+    const __m128i tapsLo = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tapsHi = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vs1 = zero;
+    __m128i vs1Sum = zero;
+    __m128i vs2 = zero;
+    for (size_t i = 0; i < length; i += kAdlerStep) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16));
+        vs1Sum = _mm_add_epi32(vs1Sum, vs1);
+        // the byte sums land in the low 16 bits of each 64-bit lane
+        vs1 = _mm_add_epi32(vs1, _mm_add_epi32(_mm_sad_epu8(lo, zero), _mm_sad_epu8(hi, zero)));
+        // at most 255 * (32 + 31) per 16-bit pair, no saturation
+        vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(lo, tapsLo), ones));
+        vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(hi, tapsHi), ones));
+    }
+    s2 += s1 * uint32_t(length) + (HorizontalSum(vs1Sum) << 5) + HorizontalSum(vs2);
+    s1 += HorizontalSum(vs1);
+}
+
+inline bool HasAdlerSimd() noexcept {
+    static const bool sHasSsse3 = __builtin_cpu_supports("ssse3");
+    return sHasSsse3;
+}
+
+constexpr const char* kAdlerSimdName = "ssse3";
+
+#else
+
+void Adler32Simd(uint32_t&, uint32_t&, const uint8_t*, size_t) noexcept {
+    __builtin_unreachable();
+}
+
+inline bool HasAdlerSimd() noexcept {
+    return false;
+}
+
+constexpr const char* kAdlerSimdName = "zlib";
+
+#endif
+
+#if defined(__aarch64__)
+
+__attribute__((target("crc")))
+uint32_t Crc32Simd(uint32_t crc, const uint8_t* p, size_t length) noexcept {
+    crc = ~crc;
+    while (length > 0 && (uintptr_t(p) & 7u) != 0) {
+        crc = __crc32b(crc, *p++);
+        length--;
+    }
+    while (length >= 32) {
+        uint64_t words[4];
+        memcpy(words, p, sizeof(words));
+        crc = __crc32d(crc, words[0]);
+        crc = __crc32d(crc, words[1]);
+        crc = __crc32d(crc, words[2]);
+        crc = __crc32d(crc, words[3]);
+        p += 32;
+        length -= 32;
+    }
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32d(crc, word);
+        p += 8;
+        length -= 8;
+    }
+    while (length > 0) {
+        crc = __crc32b(crc, *p++);
+        length--;
+    }
+    return ~crc;
+}
+
+inline bool HasCrcSimd() noexcept {
+    static const bool sHasCrc32 = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+    return sHasCrc32;
+}
+
+constexpr const char* kCrcSimdName = "armv8";
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+/*
+ * Fold 64 bytes at a time with carry-less multiplication, then reduce to 32 bits with Barrett reduction.
+ * See Intel, "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", the constants are
+ * for the bit-reflected polynomial 0xedb88320. Only whole 16-byte blocks are processed, the caller does the rest.
+ */
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i LoadBlock(const uint8_t* p) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// multiply both halves of x by the constants k and add the next block
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i FoldBlock(__m128i x, __m128i k, __m128i next) noexcept {
+    const __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    const __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+// length is a multiple of 16, at least 64, crc is not inverted
+__attribute__((target("pclmul,sse4.1")))
+uint32_t Crc32FoldPclmul(uint32_t crc, const uint8_t* p, size_t length) noexcept {
+    alignas(16) static constexpr uint64_t kK1K2[2] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static constexpr uint64_t kK3K4[2] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static constexpr uint64_t kK5K0[2] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static constexpr uint64_t kPoly[2] = {0x01db710641, 0x01f7011641};
+    __m128i x1 = _mm_xor_si128(LoadBlock(p), _mm_cvtsi32_si128(int(crc)));
+    __m128i x2 = LoadBlock(p + 16);
+    __m128i x3 = LoadBlock(p + 32);
+    __m128i x4 = LoadBlock(p + 48);
+    p += 64;
+    length -= 64;
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(kK1K2));
+    while (length >= 64) {
+        x1 = FoldBlock(x1, k, LoadBlock(p));
+        x2 = FoldBlock(x2, k, LoadBlock(p + 16));
+        x3 = FoldBlock(x3, k, LoadBlock(p + 32));
+        x4 = FoldBlock(x4, k, LoadBlock(p + 48));
+        p += 64;
+        length -= 64;
+    }
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(kK3K4));
+    x1 = FoldBlock(x1, k, x2);
+    x1 = FoldBlock(x1, k, x3);
+    x1 = FoldBlock(x1, k, x4);
+    while (length >= 16) {
+        x1 = FoldBlock(x1, k, LoadBlock(p));
+        p += 16;
+        length -= 16;
+    }
+    // 128 to 64 bits
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x2r = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(kK5K0));
+    x2r = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2r);
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(kPoly));
+    x2r = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10), mask32);
+    x2r = _mm_clmulepi64_si128(x2r, k, 0x00);
+    x1 = _mm_xor_si128(x1, x2r);
+    return uint32_t(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t Crc32Simd(uint32_t crc, const uint8_t* p, size_t length) noexcept {
+    const size_t folded = length & ~size_t(15);
+    crc = ~Crc32FoldPclmul(~crc, p, folded);
+    return ZlibCrc32(crc, p + folded, length - folded);
+}
+
+inline bool HasCrcSimd() noexcept {
+    static const bool sHasPclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    return sHasPclmul;
+}
+
+constexpr const char* kCrcSimdName = "pclmul";
+
+#else
+
+uint32_t Crc32Simd(uint32_t crc, const uint8_t* p, size_t length) noexcept {
+    return ZlibCrc32(crc, p, length);
+}
+
+inline bool HasCrcSimd() noexcept {
+    return false;
+}
+
+constexpr const char* kCrcSimdName = "zlib";
+
+#endif
+
+}
+
+uint32_t UpdateAdler32(uint32_t adler, const void* data, size_t length) noexcept {
+    const auto* p = static_cast<const uint8_t*>(data);
+    if (length < kAdlerSimdMinLength || !HasAdlerSimd()) {
+        return length == 0 ? adler : ZlibAdler32(adler, p, length);
+    }
+    // a caller supplied seed may have unreduced halves, which zlib accepts as well
+    uint32_t s1 = (adler & 0xffffu) % kAdlerBase;
+    uint32_t s2 = (adler >> 16u) % kAdlerBase;
+    while (length >= kAdlerStep) {
+        const size_t n = std::min(length, kAdlerMaxChunk) & ~(kAdlerStep - 1);
+        Adler32Simd(s1, s2, p, n);
+        s1 %= kAdlerBase;
+        s2 %= kAdlerBase;
+        p += n;
+        length -= n;
+    }
+    adler = (s2 << 16u) | s1;
+    return length == 0 ? adler : ZlibAdler32(adler, p, length);
+}
+
+uint32_t UpdateCrc32(uint32_t crc, const void* data, size_t length) noexcept {
+    const auto* p = static_cast<const uint8_t*>(data);
+    if (length < kCrcSimdMinLength || !HasCrcSimd()) {
+        return length == 0 ? crc : ZlibCrc32(crc, p, length);
+    }
+    return Crc32Simd(crc, p, length);
+}
+
+const char* GetChecksumImplementation() noexcept {
+    static const std::string sName = fmt::format("adler32={} crc32={}", HasAdlerSimd() ? kAdlerSimdName : "zlib",
+                                                 HasCrcSimd() ? kCrcSimdName : "zlib");
+    return sName.c_str();
+}
+
+}
@@ -0,0 +1,44 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_CHECKSUM_H
+#define QAUXV_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utils {
+
+// the initial values, the same as zlib adler32(0, nullptr, 0) and crc32(0, nullptr, 0)
+constexpr uint32_t kAdler32Init = 1;
+constexpr uint32_t kCrc32Init = 0;
+
+/**
+ * Continue an Adler-32 checksum, the result is the same as zlib adler32().
+ * Long inputs are summed 32 bytes at a time with NEON or SSSE3, short ones and other CPUs use zlib.
+ * @param adler the checksum of the previous data, or kAdler32Init
+ * @param data the data, may be nullptr if length is 0
+ * @param length the length of data
+ * @return the checksum of the previous data followed by data
+ */
+[[nodiscard]] uint32_t UpdateAdler32(uint32_t adler, const void* data, size_t length) noexcept;
+
+/**
+ * Continue a CRC-32 (ISO-HDLC, as used by zip and gzip), the result is the same as zlib crc32().
+ * Long inputs use the ARMv8 CRC32 instructions or PCLMULQDQ folding if the CPU has them, otherwise zlib.
+ * @param crc the CRC of the previous data, or kCrc32Init
+ * @param data the data, may be nullptr if length is 0
+ * @param length the length of data
+ * @return the CRC of the previous data followed by data
+ */
+[[nodiscard]] uint32_t UpdateCrc32(uint32_t crc, const void* data, size_t length) noexcept;
+
+/**
+ * Get the implementations picked for this CPU, e.g. "adler32=neon crc32=armv8", for logs and benchmarks.
+ */
+[[nodiscard]] const char* GetChecksumImplementation() noexcept;
+
+}
+
+#endif //QAUXV_CHECKSUM_H
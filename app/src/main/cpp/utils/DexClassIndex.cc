@@ -0,0 +1,388 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "DexClassIndex.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <fmt/format.h>
+
+#include "utils/BinaryCursor.h"
+#include "utils/FileIo.h"
+#include "utils/FileMemMap.h"
+#include "utils/ZipArchive.h"
+#include "utils/auto_close_fd.h"
+
+namespace utils {
+
+
+static constexpr uint32_t kFileMagic = 0x49434451; // "QDCI"
+static constexpr uint32_t kFileVersion = 1;
+
+// see https://source.android.com/docs/core/runtime/dex-format
+static constexpr size_t kDexHeaderSize = 0x70;
+static constexpr size_t kDexClassDefSize = 32;
+// the location packs the dex index in the high 8 bits
+static constexpr uint32_t kMaxDexIndex = 0xff;
+static constexpr uint32_t kMaxClassDefIndex = 0xffffff;
+
+struct DexClassIndexFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t classCount;
+    uint64_t slotCount;
+};
+
+namespace {
+
+struct ApkDexEntry {
+    uint32_t dexIndex;
+    ZipEntryInfo entry;
+};
+
+struct ApkDexEntries {
+    uint64_t fileSize = 0;
+    uint64_t key = 0;
+    // sorted by dex index
+    std::vector<ApkDexEntry> dexEntries;
+};
+
+class KeyHasher {
+public:
+    template<typename T>
+    void Update(T value) noexcept {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            mHash = (mHash ^ uint8_t(uint64_t(value) >> (i * 8))) * 0x100000001b3ull;
+        }
+    }
+
+    [[nodiscard]] uint64_t Get() const noexcept {
+        return mHash;
+    }
+
+private:
+    uint64_t mHash = 0xcbf29ce484222325ull;
+};
+
+}
+
+/**
+ * FNV-1a followed by the splitmix64 finalizer, so that the low bits used for the slot index are well mixed.
+ * Never returns 0, which marks an empty slot.
+ */
+static inline uint64_t HashDescriptor(std::string_view descriptor) noexcept {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c: descriptor) {
+        h = (h ^ uint8_t(c)) * 0x100000001b3ull;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h == 0 ? 1 : h;
+}
+
+/**
+ * Get N from "classesN.dex", 1 for "classes.dex", or 0 if the name is not a dex of the APK root.
+ */
+static uint32_t ParseDexIndex(std::string_view name) noexcept {
+    if (!name.starts_with("classes") || !name.ends_with(".dex")) {
+        return 0;
+    }
+    std::string_view digits = name.substr(7, name.size() - 7 - 4);
+    if (digits.empty()) {
+        return 1;
+    }
+    if (digits.size() > 3 || digits[0] == '0') {
+        return 0;
+    }
+    uint32_t index = 0;
+    for (char c: digits) {
+        if (c < '0' || c > '9') {
+            return 0;
+        }
+        index = index * 10 + uint32_t(c - '0');
+    }
+    return index >= 2 ? index : 0;
+}
+
+static int ReadApkDexEntries(int fd, ApkDexEntries& apk) {
+    struct stat64 st = {};
+    if (fstat64(fd, &st) != 0) {
+        return errno;
+    }
+    apk.fileSize = uint64_t(st.st_size);
+    std::vector<ZipEntryInfo> entries;
+    if (int err = ReadZipCentralDirectory(fd, apk.fileSize, entries); err != 0) {
+        return err;
+    }
+    apk.dexEntries.clear();
+    for (auto& entry: entries) {
+        if (uint32_t index = ParseDexIndex(entry.name); index != 0) {
+            apk.dexEntries.push_back(ApkDexEntry{index, std::move(entry)});
+        }
+    }
+    std::sort(apk.dexEntries.begin(), apk.dexEntries.end(), [](const ApkDexEntry& a, const ApkDexEntry& b) {
+        return a.dexIndex < b.dexIndex;
+    });
+    KeyHasher hasher;
+    hasher.Update(apk.fileSize);
+    hasher.Update(uint64_t(st.st_mtim.tv_sec));
+    hasher.Update(uint64_t(st.st_mtim.tv_nsec));
+    for (const auto& dex: apk.dexEntries) {
+        hasher.Update(dex.dexIndex);
+        hasher.Update(dex.entry.crc32);
+        hasher.Update(dex.entry.uncompressedSize);
+    }
+    apk.key = hasher.Get();
+    return 0;
+}
+
+static std::string InflateEntry(const uint8_t* data, size_t compressedSize, std::vector<uint8_t>& out) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return "inflateInit2 failed";
+    }
+    stream.next_in = const_cast<uint8_t*>(data);
+    stream.avail_in = uInt(compressedSize);
+    stream.next_out = out.data();
+    stream.avail_out = uInt(out.size());
+    const int rc = inflate(&stream, Z_FINISH);
+    const auto totalOut = stream.total_out;
+    inflateEnd(&stream);
+    if (rc != Z_STREAM_END || totalOut != out.size()) {
+        return fmt::format("inflate failed: rc={}, {} of {} bytes", rc, totalOut, out.size());
+    }
+    return {};
+}
+
+/**
+ * Collect (descriptor hash, location) of every class_def of a dex file.
+ */
+static std::string IndexDexClasses(BinarySpan dex, uint32_t dexIndex, std::vector<std::pair<uint64_t, uint32_t>>& classes) {
+    uint32_t stringIdsSize = 0;
+    uint32_t stringIdsOff = 0;
+    uint32_t typeIdsSize = 0;
+    uint32_t typeIdsOff = 0;
+    uint32_t classDefsSize = 0;
+    uint32_t classDefsOff = 0;
+    if (dex.size() < kDexHeaderSize || memcmp(dex.data(), "dex\n", 4) != 0
+            || !dex.ReadLe(0x38, stringIdsSize) || !dex.ReadLe(0x3c, stringIdsOff)
+            || !dex.ReadLe(0x40, typeIdsSize) || !dex.ReadLe(0x44, typeIdsOff)
+            || !dex.ReadLe(0x60, classDefsSize) || !dex.ReadLe(0x64, classDefsOff)) {
+        return "bad dex header";
+    }
+    if (!dex.ContainsArray<uint32_t>(stringIdsOff, stringIdsSize) || !dex.ContainsArray<uint32_t>(typeIdsOff, typeIdsSize)
+            || uint64_t(classDefsOff) + uint64_t(classDefsSize) * kDexClassDefSize > dex.size()) {
+        return "dex id tables are out of bounds";
+    }
+    if (classDefsSize > kMaxClassDefIndex + 1) {
+        return fmt::format("too many class_defs: {}", classDefsSize);
+    }
+    for (uint32_t i = 0; i < classDefsSize; i++) {
+        // the tables are in bounds, so only the indices read from them need checks
+        uint32_t classIdx = 0;
+        (void) dex.ReadLe(classDefsOff + size_t(i) * kDexClassDefSize, classIdx);
+        uint32_t descriptorIdx = 0;
+        if (classIdx >= typeIdsSize || !dex.ReadLe(typeIdsOff + size_t(classIdx) * 4, descriptorIdx)) {
+            return fmt::format("class_def {} has bad class_idx {}", i, classIdx);
+        }
+        uint32_t stringDataOff = 0;
+        if (descriptorIdx >= stringIdsSize || !dex.ReadLe(stringIdsOff + size_t(descriptorIdx) * 4, stringDataOff)) {
+            return fmt::format("type_id {} has bad descriptor_idx {}", classIdx, descriptorIdx);
+        }
+        // string_data_item: the UTF-16 length as uleb128, then MUTF-8 bytes terminated by NUL
+        BinaryCursor cursor(dex);
+        if (!cursor.Seek(stringDataOff)) {
+            return fmt::format("string_id {} is out of bounds", descriptorIdx);
+        }
+        uint8_t byte = 0x80;
+        for (int n = 0; n < 5 && (byte & 0x80) != 0 && cursor.ReadLe(byte); n++) {
+        }
+        const BinarySpan rest = cursor.RemainingSpan();
+        const auto* nul = static_cast<const uint8_t*>(memchr(rest.data(), 0, rest.size()));
+        if (nul == nullptr) {
+            return fmt::format("string_id {} is not terminated", descriptorIdx);
+        }
+        std::string_view descriptor(reinterpret_cast<const char*>(rest.data()), size_t(nul - rest.data()));
+        classes.emplace_back(HashDescriptor(descriptor), (dexIndex << 24) | i);
+    }
+    return {};
+}
+
+int DexClassIndex::ComputeApkKey(const char* apkPath, uint64_t& key) {
+    auto_close_fd fd(TEMP_FAILURE_RETRY(open(apkPath, O_RDONLY | O_CLOEXEC)));
+    if (!fd) {
+        return errno;
+    }
+    ApkDexEntries apk;
+    if (int err = ReadApkDexEntries(fd.get(), apk); err != 0) {
+        return err;
+    }
+    key = apk.key;
+    return 0;
+}
+
+std::string DexClassIndex::Build(const char* apkPath) {
+    mKey = 0;
+    mClassCount = 0;
+    mSlots.clear();
+    auto_close_fd fd(TEMP_FAILURE_RETRY(open(apkPath, O_RDONLY | O_CLOEXEC)));
+    if (!fd) {
+        return fmt::format("unable to open {}: {}", apkPath, strerror(errno));
+    }
+    ApkDexEntries apk;
+    if (int err = ReadApkDexEntries(fd.get(), apk); err != 0) {
+        return fmt::format("unable to read {}: {}", apkPath, strerror(err));
+    }
+    if (apk.dexEntries.empty()) {
+        return fmt::format("no dex in {}", apkPath);
+    }
+    // stored entries are used in place, only the pages of the id tables and the descriptors are touched
+    FileMemMap apkMap;
+    if (int err = apkMap.mapFileDescriptor(fd.get()); err != 0) {
+        return fmt::format("unable to map {}: {}", apkPath, strerror(err));
+    }
+    const auto* apkBase = static_cast<const uint8_t*>(apkMap.getAddress());
+    std::vector<uint64_t> dataOffsets;
+    for (const auto& [dexIndex, entry]: apk.dexEntries) {
+        if (dexIndex > kMaxDexIndex) {
+            return fmt::format("too many dex files: {}", entry.name);
+        }
+        uint64_t dataOffset = 0;
+        if (int err = GetZipEntryDataOffset(fd.get(), apk.fileSize, entry, dataOffset); err != 0) {
+            return fmt::format("bad zip entry {}: {}", entry.name, strerror(err));
+        }
+        // deflated entries are read entirely, let the reads of the later ones overlap with inflating the earlier ones
+        if (entry.compression == kZipMethodDeflated && entry.compressedSize != 0) {
+            (void) apkMap.prefetch(size_t(dataOffset), entry.compressedSize);
+        }
+        dataOffsets.push_back(dataOffset);
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> classes;
+    std::vector<uint8_t> inflated;
+    for (size_t i = 0; i < apk.dexEntries.size(); i++) {
+        const auto& [dexIndex, entry] = apk.dexEntries[i];
+        const uint64_t dataOffset = dataOffsets[i];
+        const uint8_t* dex;
+        if (entry.compression == kZipMethodStored && entry.compressedSize == entry.uncompressedSize) {
+            dex = apkBase + dataOffset;
+        } else if (entry.compression == kZipMethodDeflated) {
+            inflated.resize(entry.uncompressedSize);
+            if (auto error = InflateEntry(apkBase + dataOffset, entry.compressedSize, inflated); !error.empty()) {
+                return fmt::format("{}: {}", entry.name, error);
+            }
+            dex = inflated.data();
+        } else {
+            return fmt::format("{}: unsupported compression method {}", entry.name, entry.compression);
+        }
+        if (auto error = IndexDexClasses(BinarySpan(dex, entry.uncompressedSize), dexIndex, classes); !error.empty()) {
+            return fmt::format("{}: {}", entry.name, error);
+        }
+    }
+    // at most 3/4 full so that probe sequences stay short
+    size_t slotCount = 16;
+    while (slotCount * 3 < classes.size() * 4) {
+        slotCount *= 2;
+    }
+    std::vector<Slot> slots(slotCount);
+    const size_t mask = slotCount - 1;
+    size_t classCount = 0;
+    // classes are in dex order, so the first definition wins
+    for (const auto& [hash, location]: classes) {
+        for (size_t i = size_t(hash) & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.hashLow == 0 && slot.hashHigh == 0) {
+                slot = Slot{uint32_t(hash), uint32_t(hash >> 32), location};
+                classCount++;
+                break;
+            }
+            if (slot.hashLow == uint32_t(hash) && slot.hashHigh == uint32_t(hash >> 32)) {
+                break;
+            }
+        }
+    }
+    mKey = apk.key;
+    mClassCount = classCount;
+    mSlots = std::move(slots);
+    return {};
+}
+
+std::optional<DexClassIndex::Location> DexClassIndex::Find(std::string_view descriptor) const noexcept {
+    if (mSlots.empty()) {
+        return std::nullopt;
+    }
+    const uint64_t hash = HashDescriptor(descriptor);
+    const size_t mask = mSlots.size() - 1;
+    for (size_t i = size_t(hash) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = mSlots[i];
+        if (slot.hashLow == uint32_t(hash) && slot.hashHigh == uint32_t(hash >> 32)) {
+            return Location{slot.location >> 24, slot.location & kMaxClassDefIndex};
+        }
+        if (slot.hashLow == 0 && slot.hashHigh == 0) {
+            return std::nullopt;
+        }
+    }
+}
+
+int DexClassIndex::SaveToFile(const std::string& path) const {
+    return utils::SaveToFile(path, [&](int fd) {
+        DexClassIndexFileHeader header = {kFileMagic, kFileVersion, mKey, mClassCount, mSlots.size()};
+        int err = WriteFully(fd, &header, sizeof(header));
+        if (err == 0) {
+            err = WriteFully(fd, mSlots.data(), mSlots.size() * sizeof(Slot));
+        }
+        return err;
+    });
+}
+
+int DexClassIndex::LoadFromFile(const std::string& path, uint64_t key) {
+    mKey = 0;
+    mClassCount = 0;
+    mSlots.clear();
+    return utils::LoadFromFile(path, [&](int fd, uint64_t fileSize) {
+        DexClassIndexFileHeader header = {};
+        if (int err = ReadFully(fd, &header, sizeof(header)); err != 0) {
+            return err;
+        }
+        if (header.magic != kFileMagic || header.version != kFileVersion) {
+            return EINVAL;
+        }
+        if (header.key != key) {
+            return ESTALE;
+        }
+        // a power of two with at least one empty slot, otherwise a lookup for a missing class would not terminate
+        if (header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0 || header.classCount >= header.slotCount
+                || header.slotCount > fileSize / sizeof(Slot)
+                || sizeof(header) + header.slotCount * sizeof(Slot) != fileSize) {
+            return EINVAL;
+        }
+        std::vector<Slot> slots(size_t(header.slotCount));
+        if (int err = ReadFully(fd, slots.data(), slots.size() * sizeof(Slot)); err != 0) {
+            return err;
+        }
+        const auto usedSlots = size_t(std::count_if(slots.begin(), slots.end(), [](const Slot& slot) {
+            return slot.hashLow != 0 || slot.hashHigh != 0;
+        }));
+        if (usedSlots != header.classCount) {
+            return EINVAL;
+        }
+        mKey = key;
+        mClassCount = usedSlots;
+        mSlots = std::move(slots);
+        return 0;
+    });
+}
+
+}
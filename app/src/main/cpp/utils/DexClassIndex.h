@@ -0,0 +1,97 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_DEXCLASSINDEX_H
+#define QAUXV_DEXCLASSINDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+
+/**
+ * Maps class descriptors, e.g. "Lcom/tencent/mobileqq/app/QQAppInterface;", to the dex file of an APK which defines them.
+ *
+ * The index is built from the type_ids and class_defs of every classesN.dex entry: stored entries are read through
+ * a mapping of the APK, deflated entries are inflated once. The result is an open addressing hash table of 64-bit
+ * descriptor hashes, so a lookup is O(1) and never touches the dex files again. Only the hashes are kept,
+ * a false positive needs a 64-bit collision.
+ * When a class is defined by several dex files, the one with the lowest index wins, as it does for the class loader.
+ */
+class DexClassIndex {
+public:
+    struct Location {
+        // 1 for classes.dex, N for classesN.dex
+        uint32_t dexIndex;
+        uint32_t classDefIndex;
+    };
+
+    DexClassIndex() = default;
+
+    /**
+     * Compute the key identifying the dex entries of an APK: the APK size and mtime,
+     * and the CRC-32 and size of every classesN.dex entry. Only the central directory is read.
+     * @param apkPath the APK
+     * @param key receives the key
+     * @return 0 on success, or errno
+     */
+    [[nodiscard]] static int ComputeApkKey(const char* apkPath, uint64_t& key);
+
+    /**
+     * Build the index from the classesN.dex entries of an APK, any previous content is discarded.
+     * @param apkPath the APK
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Build(const char* apkPath);
+
+    /**
+     * Find the dex file defining a class.
+     * @param descriptor the type descriptor, e.g. "Ljava/lang/Object;"
+     * @return the location, or nullopt if no dex defines the class
+     */
+    [[nodiscard]] std::optional<Location> Find(std::string_view descriptor) const noexcept;
+
+    /**
+     * Write the index to a file, atomically replacing any existing file.
+     * @return 0 on success, or errno
+     */
+    [[nodiscard]] int SaveToFile(const std::string& path) const;
+
+    /**
+     * Read an index written by SaveToFile.
+     * @param path the path of the file
+     * @param key the expected key, see ComputeApkKey
+     * @return 0 on success, ENOENT if the file does not exist, ESTALE if the key does not match, EINVAL if the file is corrupted, or errno
+     */
+    [[nodiscard]] int LoadFromFile(const std::string& path, uint64_t key);
+
+    // the key of the APK the index was built from
+    [[nodiscard]] inline uint64_t GetKey() const noexcept {
+        return mKey;
+    }
+
+    [[nodiscard]] inline size_t GetClassCount() const noexcept {
+        return mClassCount;
+    }
+
+private:
+    // location is dexIndex << 24 | classDefIndex, an empty slot is all zero
+    struct Slot {
+        uint32_t hashLow;
+        uint32_t hashHigh;
+        uint32_t location;
+    };
+
+    uint64_t mKey = 0;
+    size_t mClassCount = 0;
+    // the size is a power of two
+    std::vector<Slot> mSlots;
+};
+
+}
+
+#endif //QAUXV_DEXCLASSINDEX_H
@@ -0,0 +1,153 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "ElfImageLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <elf.h>
+
+#include <fmt/format.h>
+
+#include "utils/MemoryUtils.h"
+
+#ifndef PT_ARM_EXIDX
+#define PT_ARM_EXIDX (PT_LOPROC + 1)
+#endif
+
+namespace utils {
+
+template<typename Ehdr, typename Phdr>
+static std::string ParseProgramHeaders(const uint8_t* base, std::vector<ElfImageLayout::Segment>& segments,
+                                       std::optional<ElfImageLayout::Range>& ehFrameHdr,
+                                       std::optional<ElfImageLayout::Range>& armExidx, uint16_t& machine) {
+    Ehdr ehdr;
+    memcpy(&ehdr, base, sizeof(ehdr));
+    machine = ehdr.e_machine;
+    if (ehdr.e_phoff == 0 || ehdr.e_phentsize != sizeof(Phdr)) {
+        return fmt::format("invalid program header, offset: {}, entry size: {}", uint64_t(ehdr.e_phoff), ehdr.e_phentsize);
+    }
+    if (!IsMemoryReadable(base + ehdr.e_phoff, size_t(ehdr.e_phnum) * sizeof(Phdr))) {
+        return "program header is not readable";
+    }
+    for (uint16_t i = 0; i < ehdr.e_phnum; i++) {
+        Phdr phdr;
+        memcpy(&phdr, base + ehdr.e_phoff + i * sizeof(Phdr), sizeof(phdr));
+        switch (phdr.p_type) {
+            case PT_LOAD: {
+                // ignore .bss
+                if (phdr.p_filesz != 0 && phdr.p_memsz != 0) {
+                    segments.push_back({phdr.p_vaddr, phdr.p_memsz, phdr.p_offset, phdr.p_filesz, phdr.p_flags});
+                }
+                break;
+            }
+            case PT_GNU_EH_FRAME: {
+                ehFrameHdr = ElfImageLayout::Range{phdr.p_vaddr, phdr.p_memsz};
+                break;
+            }
+            case PT_ARM_EXIDX: {
+                armExidx = ElfImageLayout::Range{phdr.p_vaddr, phdr.p_memsz};
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return {};
+}
+
+std::string ElfImageLayout::Parse(const void* base, bool isLoaded) {
+    mBase = nullptr;
+    mSegments.clear();
+    mEhFrameHdr.reset();
+    mArmExidx.reset();
+    if (base == nullptr || reinterpret_cast<uintptr_t>(base) % GetPageSize() != 0) {
+        return fmt::format("base address is not aligned, got {}", base);
+    }
+    if (!IsPageReadable(base)) {
+        return fmt::format("base address is not readable, got {}", base);
+    }
+    const auto* p = static_cast<const uint8_t*>(base);
+    if (memcmp(p, ELFMAG, SELFMAG) != 0) {
+        return "magic is not 0x7fELF";
+    }
+    if (p[EI_DATA] != ELFDATA2LSB) {
+        return "only little endian ELF is supported";
+    }
+    std::string err;
+    if (p[EI_CLASS] == ELFCLASS64) {
+        mIs64Bit = true;
+        err = ParseProgramHeaders<Elf64_Ehdr, Elf64_Phdr>(p, mSegments, mEhFrameHdr, mArmExidx, mMachine);
+    } else if (p[EI_CLASS] == ELFCLASS32) {
+        mIs64Bit = false;
+        err = ParseProgramHeaders<Elf32_Ehdr, Elf32_Phdr>(p, mSegments, mEhFrameHdr, mArmExidx, mMachine);
+    } else {
+        return fmt::format("invalid ELF class, got {}", p[EI_CLASS]);
+    }
+    if (!err.empty()) {
+        mSegments.clear();
+        return err;
+    }
+    if (mSegments.empty()) {
+        return "no PT_LOAD segment";
+    }
+    std::sort(mSegments.begin(), mSegments.end(), [](const Segment& a, const Segment& b) {
+        return a.vaddr < b.vaddr;
+    });
+    mBase = p;
+    mIsLoaded = isLoaded;
+    return {};
+}
+
+const ElfImageLayout::Segment* ElfImageLayout::FindSegment(uint64_t rva) const noexcept {
+    auto it = std::upper_bound(mSegments.begin(), mSegments.end(), rva, [](uint64_t v, const Segment& seg) {
+        return v < seg.vaddr;
+    });
+    if (it == mSegments.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (rva - it->vaddr >= it->fileSize) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+const uint8_t* ElfImageLayout::GetPointer(uint64_t rva, size_t size) const noexcept {
+    const Segment* seg = FindSegment(rva);
+    if (seg == nullptr || rva + size > seg->vaddr + seg->fileSize) {
+        return nullptr;
+    }
+    if (mIsLoaded) {
+        return mBase + rva;
+    } else {
+        return mBase + seg->fileOffset + (rva - seg->vaddr);
+    }
+}
+
+std::optional<uint64_t> ElfImageLayout::GetFileOffset(uint64_t rva) const noexcept {
+    const Segment* seg = FindSegment(rva);
+    if (seg == nullptr) {
+        return std::nullopt;
+    }
+    return seg->fileOffset + (rva - seg->vaddr);
+}
+
+std::optional<uint64_t> ElfImageLayout::GetRva(const void* ptr) const noexcept {
+    const auto* p = static_cast<const uint8_t*>(ptr);
+    if (p < mBase) {
+        return std::nullopt;
+    }
+    const auto offsetInSource = uint64_t(p - mBase);
+    for (const auto& seg: mSegments) {
+        const uint64_t start = mIsLoaded ? seg.vaddr : seg.fileOffset;
+        if (offsetInSource >= start && offsetInSource - start < seg.fileSize) {
+            return seg.vaddr + (offsetInSource - start);
+        }
+    }
+    return std::nullopt;
+}
+
+}
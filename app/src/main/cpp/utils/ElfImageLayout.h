@@ -0,0 +1,115 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_ELFIMAGELAYOUT_H
+#define QAUXV_ELFIMAGELAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+/**
+ * The segment layout of an ELF image, either loaded by the linker or mmap-ed from a file,
+ * so that data at an RVA can be read from both kinds of images the same way.
+ * The RVA is the virtual address in the ELF file, the same value FindByteSequenceImpl returns.
+ */
+class ElfImageLayout {
+public:
+    struct Segment {
+        uint64_t vaddr;
+        uint64_t memSize;
+        uint64_t fileOffset;
+        uint64_t fileSize;
+        uint32_t flags; // PF_R/PF_W/PF_X
+    };
+
+    struct Range {
+        uint64_t vaddr;
+        uint64_t size;
+    };
+
+    ElfImageLayout() = default;
+
+    /**
+     * Parse the program headers.
+     * @param base the page aligned base address of the image
+     * @param isLoaded true if the image is loaded in memory by a linker, false if it's a mmap-ed file
+     * @return empty string on success, or an error message
+     */
+    [[nodiscard]] std::string Parse(const void* base, bool isLoaded);
+
+    [[nodiscard]] inline bool IsValid() const noexcept {
+        return mBase != nullptr;
+    }
+
+    [[nodiscard]] inline const uint8_t* GetBase() const noexcept {
+        return mBase;
+    }
+
+    [[nodiscard]] inline bool IsLoaded() const noexcept {
+        return mIsLoaded;
+    }
+
+    [[nodiscard]] inline bool Is64Bit() const noexcept {
+        return mIs64Bit;
+    }
+
+    // EM_AARCH64, EM_ARM, ...
+    [[nodiscard]] inline uint16_t GetMachine() const noexcept {
+        return mMachine;
+    }
+
+    // the PT_LOAD segments, ordered by vaddr
+    [[nodiscard]] inline const std::vector<Segment>& GetSegments() const noexcept {
+        return mSegments;
+    }
+
+    // PT_GNU_EH_FRAME, i.e. .eh_frame_hdr
+    [[nodiscard]] inline const std::optional<Range>& GetEhFrameHdr() const noexcept {
+        return mEhFrameHdr;
+    }
+
+    // PT_ARM_EXIDX, i.e. .ARM.exidx
+    [[nodiscard]] inline const std::optional<Range>& GetArmExidx() const noexcept {
+        return mArmExidx;
+    }
+
+    /**
+     * Get the segment containing the RVA, only the part of the segment which is backed by the file counts.
+     */
+    [[nodiscard]] const Segment* FindSegment(uint64_t rva) const noexcept;
+
+    /**
+     * Get a pointer to the data at the RVA, in the loaded image or in the file.
+     * @return nullptr if [rva, rva + size) is not inside one segment backed by the file
+     */
+    [[nodiscard]] const uint8_t* GetPointer(uint64_t rva, size_t size) const noexcept;
+
+    /**
+     * Get the offset in the ELF file of the data at the RVA.
+     */
+    [[nodiscard]] std::optional<uint64_t> GetFileOffset(uint64_t rva) const noexcept;
+
+    /**
+     * Map a pointer into this image back to its RVA, the inverse of GetPointer.
+     */
+    [[nodiscard]] std::optional<uint64_t> GetRva(const void* ptr) const noexcept;
+
+private:
+    const uint8_t* mBase = nullptr;
+    bool mIsLoaded = false;
+    bool mIs64Bit = false;
+    uint16_t mMachine = 0;
+    std::vector<Segment> mSegments;
+    std::optional<Range> mEhFrameHdr;
+    std::optional<Range> mArmExidx;
+};
+
+}
+
+#endif //QAUXV_ELFIMAGELAYOUT_H
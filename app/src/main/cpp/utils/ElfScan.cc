@@ -4,12 +4,16 @@
 
 #include "ElfScan.h"
 
+#include <algorithm>
+#include <cstring>
 #include <optional>
+#include <utility>
 
 #include <elf.h>
 
 #include "utils/Log.h"
 #include "utils/MemoryUtils.h"
+#include "utils/FileMemMap.h"
 #include "TextUtils.h"
 
 namespace utils {
@@ -28,14 +32,30 @@ static std::vector<uint8_t> bitwise_and(std::span<const uint8_t> a, std::span<co
     return result;
 }
 
-std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
-                                           std::span<const uint8_t> mask, bool execMemOnly, int step, std::optional<uint64_t> hint) {
+// patterns from MakeAobPattern are masked already, so that the copy is only made for hand written sequences
+static bool IsSequenceMasked(std::span<const uint8_t> sequence, std::span<const uint8_t> mask) noexcept {
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        if ((sequence[i] & mask[i]) != sequence[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * The implementation of FindByteSequenceImpl and FindByteSequenceInRange.
+ * @param rvaRange if present, only results in [first, second) are searched for
+ */
+static std::vector<uint64_t> FindByteSequenceInRangeImpl(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                                                         std::span<const uint8_t> mask, bool execMemOnly, int step,
+                                                         std::optional<uint64_t> hint,
+                                                         std::optional<std::pair<uint64_t, uint64_t>> rvaRange) {
     if (!mask.empty() && mask.size() != sequence.size()) {
         LOGE("mask size is not sequence size, abort, mask: {}, sequence: {}", mask.size(), sequence.size());
         return {};
     }
     std::vector<uint8_t> sequence_masked;
-    if (!mask.empty()) {
+    if (!mask.empty() && !IsSequenceMasked(sequence, mask)) {
         // make sure that (sequence & mask) == sequence
         sequence_masked = bitwise_and(sequence, mask);
         sequence = sequence_masked;
@@ -238,10 +258,41 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
         const void* start;
         start = reinterpret_cast<const void*>(base + seg.offsetInSource);
         uint64_t size = seg.sizeInSource;
-        if (!IsMemoryReadable(start, size)) {
-            LOGW("segment is not readable, start: {}, size: {}", start, size);
+        // the part of the segment to scan, relative to start
+        uint64_t scanBegin = 0;
+        uint64_t scanEnd = size;
+        if (rvaRange.has_value()) {
+            auto [rvaBegin, rvaEnd] = rvaRange.value();
+            uint64_t segmentRvaEnd = seg.offsetInMemory + size;
+            if (rvaEnd <= seg.offsetInMemory || rvaBegin >= segmentRvaEnd) {
+                continue;
+            }
+            scanBegin = rvaBegin > seg.offsetInMemory ? rvaBegin - seg.offsetInMemory : 0;
+            scanEnd = std::min(rvaEnd, segmentRvaEnd) - seg.offsetInMemory;
+            if (step > 1) {
+                // candidates are aligned to the step relative to the segment start
+                scanBegin = (scanBegin + uint64_t(step - 1)) & ~uint64_t(step - 1);
+                scanEnd = std::min((scanEnd + uint64_t(step - 1)) & ~uint64_t(step - 1), size);
+            }
+            // a candidate reads the whole sequence, which may go past scanEnd, but not past the segment
+            const uint64_t stride = step > 1 ? uint64_t(step) : 1;
+            scanEnd = std::min(scanEnd, size >= sequence.size() ? size - sequence.size() + stride : 0);
+            if (scanBegin >= scanEnd) {
+                continue;
+            }
+        }
+        const uint8_t* scanStart = reinterpret_cast<const uint8_t*>(start) + scanBegin;
+        const uint64_t scanSize = scanEnd - scanBegin;
+        // the bytes read by the last candidates of a range are not part of the range
+        const uint64_t readSize = rvaRange.has_value() ? std::min(scanEnd + sequence.size(), size) - scanBegin : scanSize;
+        if (!IsMemoryReadable(scanStart, readSize)) {
+            LOGW("segment is not readable, start: {}, size: {}", static_cast<const void*>(scanStart), readSize);
             continue;
         }
+        if (!isLoaded) {
+            // a file image is read front to back once per segment, let the kernel read ahead of the scan
+            (void) FileMemMap::adviseRange(scanStart, scanSize, FileMemMap::AccessHint::kSequential);
+        }
         const auto fnOnFind = [base, isLoaded, start, &results, &seg](const void* ptrInSource) {
             if (isLoaded) {
                 results.push_back(reinterpret_cast<const uint8_t*>(ptrInSource) - base);
@@ -257,8 +308,8 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
         if (mask.empty()) {
             if (step == 8) {
                 std::span<const uint64_t> pattern = {reinterpret_cast<const uint64_t*>(sequence.data()), sequence.size() / 8};
-                const uint64_t* begin = reinterpret_cast<const uint64_t*>(start);
-                const uint64_t* end = reinterpret_cast<const uint64_t*>(start) + size / 8;
+                const uint64_t* begin = reinterpret_cast<const uint64_t*>(scanStart);
+                const uint64_t* end = reinterpret_cast<const uint64_t*>(scanStart) + scanSize / 8;
                 uint64_t first = *pattern.data();
                 for (const uint64_t* it = begin; it < end; ++it) {
                     if (*it == first) [[unlikely]] {
@@ -269,8 +320,8 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
                 }
             } else if (step == 4) {
                 std::span<const uint32_t> pattern = {reinterpret_cast<const uint32_t*>(sequence.data()), sequence.size() / 4};
-                const uint32_t* begin = reinterpret_cast<const uint32_t*>(start);
-                const uint32_t* end = reinterpret_cast<const uint32_t*>(start) + size / 4;
+                const uint32_t* begin = reinterpret_cast<const uint32_t*>(scanStart);
+                const uint32_t* end = reinterpret_cast<const uint32_t*>(scanStart) + scanSize / 4;
                 uint32_t first = *pattern.data();
                 for (const uint32_t* it = begin; it < end; ++it) {
                     if (*it == first) [[unlikely]] {
@@ -281,8 +332,8 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
                 }
             } else if (step == 2) {
                 std::span<const uint16_t> pattern = {reinterpret_cast<const uint16_t*>(sequence.data()), sequence.size() / 2};
-                const uint16_t* begin = reinterpret_cast<const uint16_t*>(start);
-                const uint16_t* end = reinterpret_cast<const uint16_t*>(start) + size / 2;
+                const uint16_t* begin = reinterpret_cast<const uint16_t*>(scanStart);
+                const uint16_t* end = reinterpret_cast<const uint16_t*>(scanStart) + scanSize / 2;
                 uint16_t first = *pattern.data();
                 for (const uint16_t* it = begin; it < end; ++it) {
                     if (*it == first) [[unlikely]] {
@@ -292,21 +343,23 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
                     }
                 }
             } else {
+                // jump between the occurrences of the first byte, memchr is vectorized by libc
                 std::span<const uint8_t> pattern = sequence;
-                const uint8_t* begin = reinterpret_cast<const uint8_t*>(start);
-                const uint8_t* end = reinterpret_cast<const uint8_t*>(start) + size;
-                for (const uint8_t* it = begin; it < end; ++it) {
+                const uint8_t* it = scanStart;
+                const uint8_t* end = scanStart + scanSize;
+                while ((it = static_cast<const uint8_t*>(memchr(it, pattern[0], size_t(end - it)))) != nullptr) {
                     if (memcmp(it, pattern.data(), pattern.size_bytes()) == 0) [[unlikely]] {
                         fnOnFind(it);
                     }
+                    ++it;
                 }
             }
         } else {
             if (step == 8) {
                 std::span<const uint64_t> pattern = {reinterpret_cast<const uint64_t*>(sequence.data()), sequence.size() / 8};
                 std::span<const uint64_t> maskSpan = {reinterpret_cast<const uint64_t*>(mask.data()), mask.size() / 8};
-                const uint64_t* begin = reinterpret_cast<const uint64_t*>(start);
-                const uint64_t* end = reinterpret_cast<const uint64_t*>(start) + size / 8;
+                const uint64_t* begin = reinterpret_cast<const uint64_t*>(scanStart);
+                const uint64_t* end = reinterpret_cast<const uint64_t*>(scanStart) + scanSize / 8;
                 uint64_t first = *pattern.data();
                 for (const uint64_t* it = begin; it < end; ++it) {
                     if ((*it & maskSpan[0]) == first) [[unlikely]] {
@@ -326,8 +379,8 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
             } else if (step == 4) {
                 std::span<const uint32_t> pattern = {reinterpret_cast<const uint32_t*>(sequence.data()), sequence.size() / 4};
                 std::span<const uint32_t> maskSpan = {reinterpret_cast<const uint32_t*>(mask.data()), mask.size() / 4};
-                const uint32_t* begin = reinterpret_cast<const uint32_t*>(start);
-                const uint32_t* end = reinterpret_cast<const uint32_t*>(start) + size / 4;
+                const uint32_t* begin = reinterpret_cast<const uint32_t*>(scanStart);
+                const uint32_t* end = reinterpret_cast<const uint32_t*>(scanStart) + scanSize / 4;
                 uint32_t first = *pattern.data();
                 for (const uint32_t* it = begin; it < end; ++it) {
                     if ((*it & maskSpan[0]) == first) [[unlikely]] {
@@ -347,8 +400,8 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
             } else if (step == 2) {
                 std::span<const uint16_t> pattern = {reinterpret_cast<const uint16_t*>(sequence.data()), sequence.size() / 2};
                 std::span<const uint16_t> maskSpan = {reinterpret_cast<const uint16_t*>(mask.data()), mask.size() / 2};
-                const uint16_t* begin = reinterpret_cast<const uint16_t*>(start);
-                const uint16_t* end = reinterpret_cast<const uint16_t*>(start) + size / 2;
+                const uint16_t* begin = reinterpret_cast<const uint16_t*>(scanStart);
+                const uint16_t* end = reinterpret_cast<const uint16_t*>(scanStart) + scanSize / 2;
                 uint16_t first = *pattern.data();
                 for (const uint16_t* it = begin; it < end; ++it) {
                     if ((*it & maskSpan[0]) == first) [[unlikely]] {
@@ -368,9 +421,17 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
             } else {
                 std::span<const uint8_t> pattern = sequence;
                 std::span<const uint8_t> maskSpan = mask;
-                const uint8_t* begin = reinterpret_cast<const uint8_t*>(start);
-                const uint8_t* end = reinterpret_cast<const uint8_t*>(start) + size;
+                const uint8_t* begin = reinterpret_cast<const uint8_t*>(scanStart);
+                const uint8_t* end = scanStart + scanSize;
+                // the first byte is usually not a wildcard, then only its occurrences need the full comparison
+                const bool hasFixedFirstByte = maskSpan[0] == 0xff;
                 for (const uint8_t* it = begin; it < end; ++it) {
+                    if (hasFixedFirstByte) {
+                        it = static_cast<const uint8_t*>(memchr(it, pattern[0], size_t(end - it)));
+                        if (it == nullptr) {
+                            break;
+                        }
+                    }
                     bool isMatch = true;
                     for (size_t i = 0; i < pattern.size(); ++i) {
                         if (((it[i] & maskSpan[i]) != pattern[i])) {
@@ -388,6 +449,28 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
     return results;
 }
 
+std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                                           std::span<const uint8_t> mask, bool execMemOnly, int step, std::optional<uint64_t> hint) {
+    return FindByteSequenceInRangeImpl(baseAddress, isLoaded, sequence, mask, execMemOnly, step, hint, std::nullopt);
+}
+
+bool IsByteSequenceAt(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                      std::span<const uint8_t> mask, bool execMemOnly, int step, uint64_t rva) {
+    // the range is empty, so nothing is scanned after the hint
+    return !FindByteSequenceInRangeImpl(baseAddress, isLoaded, sequence, mask, execMemOnly, step, rva,
+                                        std::make_pair(rva, rva)).empty();
+}
+
+std::vector<uint64_t> FindByteSequenceInRange(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                                              std::span<const uint8_t> mask, bool execMemOnly, int step,
+                                              uint64_t rvaBegin, uint64_t rvaEnd) {
+    if (rvaBegin >= rvaEnd) {
+        return {};
+    }
+    return FindByteSequenceInRangeImpl(baseAddress, isLoaded, sequence, mask, execMemOnly, step, std::nullopt,
+                                       std::make_pair(rvaBegin, rvaEnd));
+}
+
 std::vector<uint64_t> FindByteSequenceForImageFile(const void* baseAddress, std::span<const uint8_t> sequence,
                                                    std::span<const uint8_t> mask, bool execMemOnly, int step,
                                                    std::optional<uint64_t> hint) {
@@ -25,6 +25,20 @@ std::vector<uint64_t> FindByteSequenceImpl(const void* baseAddress, bool isLoade
                                            std::span<const uint8_t> mask, bool execMemOnly, int step,
                                            std::optional<uint64_t> hint);
 
+/**
+ * Whether the sequence is found at the RVA, i.e. the hint check of FindByteSequenceImpl, without scanning anything else.
+ */
+bool IsByteSequenceAt(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                      std::span<const uint8_t> mask, bool execMemOnly, int step, uint64_t rva);
+
+/**
+ * Same as FindByteSequenceImpl without a hint, but only results whose RVA is in [rvaBegin, rvaEnd) are searched for,
+ * and only that part of the segments is read.
+ */
+std::vector<uint64_t> FindByteSequenceInRange(const void* baseAddress, bool isLoaded, std::span<const uint8_t> sequence,
+                                              std::span<const uint8_t> mask, bool execMemOnly, int step,
+                                              uint64_t rvaBegin, uint64_t rvaEnd);
+
 }
 
 #endif //QAUXV_ELFSCAN_H
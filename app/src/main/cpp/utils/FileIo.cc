@@ -0,0 +1,121 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "FileIo.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/auto_close_fd.h"
+
+namespace utils {
+
+int PreadFully(int fd, void* buf, size_t count, uint64_t offset) noexcept {
+    auto* p = static_cast<uint8_t*>(buf);
+    while (count > 0) {
+        ssize_t n = pread64(fd, p, count, off64_t(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0) {
+            return EIO;
+        }
+        p += n;
+        count -= size_t(n);
+        offset += uint64_t(n);
+    }
+    return 0;
+}
+
+ssize_t PreadUpTo(int fd, void* buf, size_t count, uint64_t offset) noexcept {
+    auto* p = static_cast<uint8_t*>(buf);
+    size_t done = 0;
+    while (done < count) {
+        ssize_t n = pread64(fd, p + done, count - done, off64_t(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += size_t(n);
+    }
+    return ssize_t(done);
+}
+
+int ReadFully(int fd, void* data, size_t size) noexcept {
+    auto* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = TEMP_FAILURE_RETRY(read(fd, p, size));
+        if (n < 0) {
+            return errno;
+        }
+        if (n == 0) {
+            return EIO;
+        }
+        p += n;
+        size -= size_t(n);
+    }
+    return 0;
+}
+
+int WriteFully(int fd, const void* data, size_t size) noexcept {
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = TEMP_FAILURE_RETRY(write(fd, p, size));
+        if (n < 0) {
+            return errno;
+        }
+        if (n == 0) {
+            return EIO;
+        }
+        p += n;
+        size -= size_t(n);
+    }
+    return 0;
+}
+
+int SaveToFile(const std::string& path, const std::function<int(int fd)>& writer) {
+    const std::string tmpPath = path + ".tmp";
+    auto_close_fd fd(TEMP_FAILURE_RETRY(open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)));
+    if (!fd) {
+        return errno;
+    }
+    int err = writer(fd.get());
+    if (err == 0 && fsync(fd.get()) != 0) {
+        err = errno;
+    }
+    fd.close();
+    if (err == 0 && rename(tmpPath.c_str(), path.c_str()) != 0) {
+        err = errno;
+    }
+    if (err != 0) {
+        unlink(tmpPath.c_str());
+    }
+    return err;
+}
+
+int LoadFromFile(const std::string& path, const std::function<int(int fd, uint64_t size)>& reader) {
+    auto_close_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (!fd) {
+        return errno;
+    }
+    struct stat st = {};
+    if (fstat(fd.get(), &st) != 0) {
+        return errno;
+    }
+    return reader(fd.get(), uint64_t(st.st_size));
+}
+
+}
@@ -0,0 +1,60 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_FILEIO_H
+#define QAUXV_FILEIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <sys/types.h>
+
+namespace utils {
+
+/**
+ * Read exactly count bytes at offset, retrying on EINTR and short reads.
+ * @return 0 on success, EIO if the file ends first, or errno
+ */
+[[nodiscard]] int PreadFully(int fd, void* buf, size_t count, uint64_t offset) noexcept;
+
+/**
+ * Read up to count bytes at offset, stopping early at the end of the file.
+ * @return the number of bytes read, or -1 with errno set
+ */
+[[nodiscard]] ssize_t PreadUpTo(int fd, void* buf, size_t count, uint64_t offset) noexcept;
+
+/**
+ * Read exactly size bytes from the current file position.
+ * @return 0 on success, EIO if the file ends first, or errno
+ */
+[[nodiscard]] int ReadFully(int fd, void* data, size_t size) noexcept;
+
+/**
+ * Write all size bytes at the current file position.
+ * @return 0 on success, or errno
+ */
+[[nodiscard]] int WriteFully(int fd, const void* data, size_t size) noexcept;
+
+/**
+ * Replace a file atomically: the content is written to path + ".tmp", synced, then renamed over path,
+ * so that readers see either the old or the new file, never a partial one.
+ * @param path the file path
+ * @param writer writes the content to the given fd, returns 0 or an errno
+ * @return 0 on success, or errno, the temporary file is removed on failure
+ */
+[[nodiscard]] int SaveToFile(const std::string& path, const std::function<int(int fd)>& writer);
+
+/**
+ * Open a file for reading and pass it to reader along with its size.
+ * @param path the file path
+ * @param reader reads the content from the given fd, returns 0 or an errno
+ * @return 0 on success, errno if the file can not be opened, or the result of reader
+ */
+[[nodiscard]] int LoadFromFile(const std::string& path, const std::function<int(int fd, uint64_t size)>& reader);
+
+}
+
+#endif //QAUXV_FILEIO_H
@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <cstdint>
 #include <sys/mman.h>
 #include <sys/user.h>
 #include <sys/stat.h>
@@ -12,13 +13,52 @@
 #include "FileMemMap.h"
 #include "MemoryUtils.h"
 
+static int MadviseForHint(FileMemMap::AccessHint hint) noexcept {
+    switch (hint) {
+        case FileMemMap::AccessHint::kSequential:
+            return MADV_SEQUENTIAL;
+        case FileMemMap::AccessHint::kRandom:
+            return MADV_RANDOM;
+        case FileMemMap::AccessHint::kWillNeed:
+            return MADV_WILLNEED;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+/**
+ * Apply the hint to a new mapping of fd. The fadvise hint sets the readahead state of the open file,
+ * which the mapping shares, the madvise hint sets the fault-around behaviour of the mapping itself.
+ */
+static void ApplyAccessHint(int fd, void* addr, size_t mapLength, FileMemMap::AccessHint hint) noexcept {
+    switch (hint) {
+        case FileMemMap::AccessHint::kSequential:
+            (void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            break;
+        case FileMemMap::AccessHint::kRandom:
+            (void) posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+            break;
+        case FileMemMap::AccessHint::kNormal:
+        case FileMemMap::AccessHint::kPopulate:
+            // kPopulate is done by mmap itself
+            return;
+        default:
+            break;
+    }
+    (void) madvise(addr, mapLength, MadviseForHint(hint));
+}
+
+static inline int MmapFlagsForHint(FileMemMap::AccessHint hint) noexcept {
+    return hint == FileMemMap::AccessHint::kPopulate ? MAP_POPULATE : 0;
+}
+
 FileMemMap::~FileMemMap() noexcept {
     if (mAddress != nullptr) {
         unmap();
     }
 }
 
-int FileMemMap::mapFilePath(const char* path, bool readOnly, size_t length) {
+int FileMemMap::mapFilePath(const char* path, bool readOnly, size_t length, AccessHint hint) {
     int fd = open(path, O_RDONLY);
     if (fd < 0) {
         return errno;
@@ -38,12 +78,14 @@ int FileMemMap::mapFilePath(const char* path, bool readOnly, size_t length) {
     }
     size_t kPageSize = utils::GetPageSize();
     size_t pageAlignedSize = (length + kPageSize - 1u) & ~(kPageSize - 1u);
-    void* addr = mmap(nullptr, pageAlignedSize, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_PRIVATE, fd, 0);
+    void* addr = mmap(nullptr, pageAlignedSize, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE),
+                      MAP_PRIVATE | MmapFlagsForHint(hint), fd, 0);
     if (addr == MAP_FAILED) {
         int err = errno;
         close(fd);
         return err;
     }
+    ApplyAccessHint(fd, addr, pageAlignedSize, hint);
     close(fd);
     mAddress = addr;
     mLength = length;
@@ -51,7 +93,7 @@ int FileMemMap::mapFilePath(const char* path, bool readOnly, size_t length) {
     return 0;
 }
 
-int FileMemMap::mapFileDescriptor(int fd, bool readOnly, size_t length, bool shared) {
+int FileMemMap::mapFileDescriptor(int fd, bool readOnly, size_t length, bool shared, AccessHint hint) {
     if (fd < 0) {
         return EBADFD;
     }
@@ -68,16 +110,45 @@ int FileMemMap::mapFileDescriptor(int fd, bool readOnly, size_t length, bool sha
     size_t kPageSize = utils::GetPageSize();
     size_t pageAlignedSize = (length + kPageSize - 1u) & ~(kPageSize - 1u);
     void* addr = mmap(nullptr, pageAlignedSize, readOnly ? PROT_READ : (PROT_READ | PROT_WRITE),
-                      shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+                      (shared ? MAP_SHARED : MAP_PRIVATE) | MmapFlagsForHint(hint), fd, 0);
     if (addr == MAP_FAILED) {
         return errno;
     }
+    ApplyAccessHint(fd, addr, pageAlignedSize, hint);
     mAddress = addr;
     mLength = length;
     mMapLength = pageAlignedSize;
     return 0;
 }
 
+int FileMemMap::advise(AccessHint hint, size_t offset, size_t length) noexcept {
+    if (mAddress == nullptr || offset >= mMapLength) {
+        return EINVAL;
+    }
+    if (length == 0 || length > mMapLength - offset) {
+        length = mMapLength - offset;
+    }
+    return adviseRange(static_cast<uint8_t*>(mAddress) + offset, length, hint);
+}
+
+int FileMemMap::adviseRange(const void* address, size_t length, AccessHint hint) noexcept {
+    if (hint == AccessHint::kPopulate || address == nullptr || length == 0) {
+        return EINVAL;
+    }
+    size_t kPageSize = utils::GetPageSize();
+    auto start = reinterpret_cast<uintptr_t>(address) & ~uintptr_t(kPageSize - 1u);
+    auto end = (reinterpret_cast<uintptr_t>(address) + length + kPageSize - 1u) & ~uintptr_t(kPageSize - 1u);
+    if (madvise(reinterpret_cast<void*>(start), end - start, MadviseForHint(hint)) != 0) {
+        return errno;
+    }
+    return 0;
+}
+
+int FileMemMap::prefetch(size_t offset, size_t length) noexcept {
+    // for a file mapping, MADV_WILLNEED only queues the readahead and does not wait for it
+    return advise(AccessHint::kWillNeed, offset, length);
+}
+
 void FileMemMap::unmap() noexcept {
     if (mAddress != nullptr && munmap(mAddress, mMapLength) == 0) {
         mAddress = nullptr;
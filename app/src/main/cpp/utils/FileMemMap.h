@@ -8,6 +8,23 @@
 #include <cstddef>
 
 class FileMemMap {
+public:
+    /**
+     * How the mapping is going to be accessed, passed to the kernel as madvise/posix_fadvise hints.
+     */
+    enum class AccessHint {
+        // the default readahead
+        kNormal,
+        // read front to back once, e.g. a scan over a whole segment: read ahead aggressively
+        kSequential,
+        // sparse reads, e.g. symbol lookups in a large ELF: no readahead beyond the faulting page
+        kRandom,
+        // the whole range will be needed soon: start reading it in the background
+        kWillNeed,
+        // fault in the whole mapping before returning, for small files which are read entirely
+        kPopulate,
+    };
+
 private:
     void* mAddress = nullptr;
     size_t mMapLength = 0;
@@ -27,9 +44,11 @@ public:
      * @param path the absolute path to the file to map.
      * @param readOnly whether the file should be mapped read-only.
      * @param length the length of the file to map, may be 0 to map the entire file.
+     * @param hint the expected access pattern, see AccessHint.
      * @return 0 on success, errno on error.
      */
-    [[nodiscard]] int mapFilePath(const char* path, bool readOnly = true, size_t length = 0);
+    [[nodiscard]] int mapFilePath(const char* path, bool readOnly = true, size_t length = 0,
+                                  AccessHint hint = AccessHint::kNormal);
 
     /**
      * Map a file into memory.
@@ -38,9 +57,41 @@ public:
      * @param readOnly whether the file should be mapped read-only.
      * @param length the length of the file to map, may be 0 to map the entire file.
      * @param shared whether the file should be mapped with MAP_SHARED or MAP_PRIVATE.
+     * @param hint the expected access pattern, see AccessHint.
+     * @return 0 on success, errno on error.
+     */
+    [[nodiscard]] int mapFileDescriptor(int fd, bool readOnly = true, size_t length = 0, bool shared = false,
+                                        AccessHint hint = AccessHint::kNormal);
+
+    /**
+     * Change the access hint of a range of the mapping, e.g. kSequential before scanning one segment.
+     * The range is widened to page boundaries. kPopulate is not supported here, use prefetch instead.
+     * @param hint the expected access pattern.
+     * @param offset the start of the range.
+     * @param length the length of the range, may be 0 for the rest of the mapping.
+     * @return 0 on success, errno on error.
+     */
+    [[nodiscard]] int advise(AccessHint hint, size_t offset = 0, size_t length = 0) noexcept;
+
+    /**
+     * Start reading a range of the file in the background and return immediately,
+     * so that a later pass over the range does not stall on page faults.
+     * The range is widened to page boundaries.
+     * @param offset the start of the range.
+     * @param length the length of the range, may be 0 for the rest of the mapping.
+     * @return 0 on success, errno on error.
+     */
+    [[nodiscard]] int prefetch(size_t offset = 0, size_t length = 0) noexcept;
+
+    /**
+     * Change the access hint of a range of any file mapping, e.g. one which is not owned by a FileMemMap.
+     * The range is widened to page boundaries. kPopulate is not supported here.
+     * @param address the start of the range, must be within a mapping.
+     * @param length the length of the range.
+     * @param hint the expected access pattern.
      * @return 0 on success, errno on error.
      */
-    [[nodiscard]] int mapFileDescriptor(int fd, bool readOnly = true, size_t length = 0, bool shared = false);
+    [[nodiscard]] static int adviseRange(const void* address, size_t length, AccessHint hint) noexcept;
 
     /**
      * Get the address of the mapped file.
@@ -0,0 +1,507 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "FunctionIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include <elf.h>
+
+#include <fmt/format.h>
+
+#include "utils/BinaryCursor.h"
+
+namespace utils {
+
+// DWARF exception header pointer encodings, see LSB "DWARF Extensions"
+static constexpr uint8_t kDwEhPeOmit = 0xff;
+static constexpr uint8_t kDwEhPeAbsPtr = 0x00;
+static constexpr uint8_t kDwEhPeULeb128 = 0x01;
+static constexpr uint8_t kDwEhPeUData2 = 0x02;
+static constexpr uint8_t kDwEhPeUData4 = 0x03;
+static constexpr uint8_t kDwEhPeUData8 = 0x04;
+static constexpr uint8_t kDwEhPeSLeb128 = 0x09;
+static constexpr uint8_t kDwEhPeSData2 = 0x0a;
+static constexpr uint8_t kDwEhPeSData4 = 0x0b;
+static constexpr uint8_t kDwEhPeSData8 = 0x0c;
+static constexpr uint8_t kDwEhPePcRel = 0x10;
+static constexpr uint8_t kDwEhPeDataRel = 0x30;
+static constexpr uint8_t kDwEhPeIndirect = 0x80;
+
+/**
+ * A cursor over the file backed part of the segment containing rva, from rva to the end of the segment.
+ * @param limit if not 0, the cursor covers at most this many bytes
+ */
+static std::optional<BinaryCursor> MakeCursor(const ElfImageLayout& layout, uint64_t rva, uint64_t limit = 0) {
+    const auto* seg = layout.FindSegment(rva);
+    if (seg == nullptr) {
+        return std::nullopt;
+    }
+    uint64_t size = seg->vaddr + seg->fileSize - rva;
+    if (limit != 0) {
+        size = std::min(size, limit);
+    }
+    const uint8_t* p = layout.GetPointer(rva, size_t(size));
+    if (p == nullptr) {
+        return std::nullopt;
+    }
+    return BinaryCursor(BinarySpan(p, size_t(size)));
+}
+
+static bool ReadULeb128(BinaryCursor& cursor, uint64_t& value) noexcept {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (!cursor.ReadLe(b)) {
+            return false;
+        }
+        value |= uint64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ReadSLeb128(BinaryCursor& cursor, int64_t& value) noexcept {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (!cursor.ReadLe(b)) {
+            return false;
+        }
+        value |= int64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            if (shift + 7 < 64 && (b & 0x40) != 0) {
+                value |= -(int64_t(1) << (shift + 7));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * The size of a pointer in the given DW_EH_PE_* encoding, 0 for the LEB128 encodings and the unsupported ones.
+ */
+static size_t GetEncodedSize(uint8_t encoding, bool is64Bit) noexcept {
+    switch (encoding & 0x0f) {
+        case kDwEhPeAbsPtr:
+            return is64Bit ? 8 : 4;
+        case kDwEhPeUData2:
+        case kDwEhPeSData2:
+            return 2;
+        case kDwEhPeUData4:
+        case kDwEhPeSData4:
+            return 4;
+        case kDwEhPeUData8:
+        case kDwEhPeSData8:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Read a pointer in the given DW_EH_PE_* encoding, the result is an RVA.
+ * Only the encodings used by compilers for .eh_frame and .eh_frame_hdr are supported.
+ * @param cursorRva the RVA of the start of the cursor, for the pc relative encodings
+ */
+static bool ReadEncoded(BinaryCursor& cursor, uint64_t cursorRva, bool is64Bit, uint8_t encoding, uint64_t dataRelBase,
+                        uint64_t& value) noexcept {
+    const uint64_t fieldRva = cursorRva + cursor.Position();
+    bool ok;
+    switch (encoding & 0x0f) {
+        case kDwEhPeAbsPtr:
+            if (is64Bit) {
+                ok = cursor.ReadLe(value);
+            } else {
+                uint32_t v = 0;
+                ok = cursor.ReadLe(v);
+                value = v;
+            }
+            break;
+        case kDwEhPeULeb128:
+            ok = ReadULeb128(cursor, value);
+            break;
+        case kDwEhPeUData2: {
+            uint16_t v = 0;
+            ok = cursor.ReadLe(v);
+            value = v;
+            break;
+        }
+        case kDwEhPeUData4: {
+            uint32_t v = 0;
+            ok = cursor.ReadLe(v);
+            value = v;
+            break;
+        }
+        case kDwEhPeUData8:
+            ok = cursor.ReadLe(value);
+            break;
+        case kDwEhPeSLeb128: {
+            int64_t v = 0;
+            ok = ReadSLeb128(cursor, v);
+            value = uint64_t(v);
+            break;
+        }
+        case kDwEhPeSData2: {
+            uint16_t v = 0;
+            ok = cursor.ReadLe(v);
+            value = uint64_t(int64_t(int16_t(v)));
+            break;
+        }
+        case kDwEhPeSData4: {
+            uint32_t v = 0;
+            ok = cursor.ReadLe(v);
+            value = uint64_t(int64_t(int32_t(v)));
+            break;
+        }
+        case kDwEhPeSData8:
+            ok = cursor.ReadLe(value);
+            break;
+        default:
+            return false;
+    }
+    if (!ok) {
+        return false;
+    }
+    switch (encoding & 0x70) {
+        case 0:
+            break;
+        case kDwEhPePcRel:
+            value += fieldRva;
+            break;
+        case kDwEhPeDataRel:
+            value += dataRelBase;
+            break;
+        default:
+            return false;
+    }
+    if ((encoding & kDwEhPeIndirect) != 0) {
+        return false;
+    }
+    if (!is64Bit) {
+        value = uint32_t(value);
+    }
+    return true;
+}
+
+/**
+ * Skip a pointer in the given encoding without interpreting it.
+ */
+static bool SkipEncoded(BinaryCursor& cursor, bool is64Bit, uint8_t encoding) noexcept {
+    if (size_t size = GetEncodedSize(encoding, is64Bit); size != 0) {
+        return cursor.Skip(size);
+    }
+    if ((encoding & 0x0f) == kDwEhPeULeb128) {
+        uint64_t v;
+        return ReadULeb128(cursor, v);
+    }
+    if ((encoding & 0x0f) == kDwEhPeSLeb128) {
+        int64_t v;
+        return ReadSLeb128(cursor, v);
+    }
+    return false;
+}
+
+/**
+ * Read the length and the CIE id or pointer at the start of a CIE or an FDE.
+ * @param length receives the length of the record after the length field
+ * @param idPosition receives the position of the CIE id or pointer, which the length counts from
+ * @param id receives the CIE id or pointer
+ */
+static bool ReadRecordHeader(BinaryCursor& cursor, uint64_t& length, size_t& idPosition, uint64_t& id) noexcept {
+    uint32_t length32 = 0;
+    if (!cursor.ReadLe(length32)) {
+        return false;
+    }
+    const bool isDwarf64 = length32 == 0xffffffffu;
+    length = length32;
+    if (isDwarf64 && !cursor.ReadLe(length)) {
+        return false;
+    }
+    idPosition = cursor.Position();
+    if (isDwarf64) {
+        return cursor.ReadLe(id);
+    }
+    uint32_t id32 = 0;
+    if (!cursor.ReadLe(id32)) {
+        return false;
+    }
+    id = id32;
+    return true;
+}
+
+/**
+ * Get the FDE pointer encoding, i.e. the 'R' augmentation, of a CIE.
+ */
+static std::optional<uint8_t> ParseCieFdeEncoding(const ElfImageLayout& layout, uint64_t cieRva) {
+    auto optCursor = MakeCursor(layout, cieRva);
+    if (!optCursor.has_value()) {
+        return std::nullopt;
+    }
+    auto& cursor = optCursor.value();
+    const bool is64Bit = layout.Is64Bit();
+    uint64_t length = 0;
+    size_t idPosition = 0;
+    uint64_t cieId = 0;
+    if (!ReadRecordHeader(cursor, length, idPosition, cieId) || length == 0 || cieId != 0) {
+        return std::nullopt;
+    }
+    uint8_t version = 0;
+    if (!cursor.ReadLe(version)) {
+        return std::nullopt;
+    }
+    std::string augmentation;
+    for (uint8_t c; cursor.ReadLe(c) && c != '\0' && augmentation.size() < 16;) {
+        augmentation.push_back(char(c));
+    }
+    if (augmentation.find("eh") != std::string::npos && !SkipEncoded(cursor, is64Bit, kDwEhPeAbsPtr)) {
+        return std::nullopt;
+    }
+    uint64_t codeAlignmentFactor;
+    int64_t dataAlignmentFactor;
+    uint64_t returnAddressRegister;
+    if (!ReadULeb128(cursor, codeAlignmentFactor) || !ReadSLeb128(cursor, dataAlignmentFactor)) {
+        return std::nullopt;
+    }
+    if (version == 1) {
+        uint8_t reg;
+        if (!cursor.ReadLe(reg)) {
+            return std::nullopt;
+        }
+    } else if (!ReadULeb128(cursor, returnAddressRegister)) {
+        return std::nullopt;
+    }
+    // absolute pointers if there is no 'R'
+    uint8_t fdeEncoding = kDwEhPeAbsPtr;
+    if (!augmentation.empty() && augmentation[0] == 'z') {
+        uint64_t augmentationLength;
+        if (!ReadULeb128(cursor, augmentationLength)) {
+            return std::nullopt;
+        }
+        for (size_t i = 1; i < augmentation.size(); i++) {
+            char c = augmentation[i];
+            if (c == 'L') {
+                uint8_t lsdaEncoding;
+                if (!cursor.ReadLe(lsdaEncoding)) {
+                    return std::nullopt;
+                }
+            } else if (c == 'P') {
+                uint8_t personalityEncoding;
+                if (!cursor.ReadLe(personalityEncoding) || !SkipEncoded(cursor, is64Bit, personalityEncoding)) {
+                    return std::nullopt;
+                }
+            } else if (c == 'R') {
+                if (!cursor.ReadLe(fdeEncoding)) {
+                    return std::nullopt;
+                }
+                break;
+            } else if (c != 'S' && c != 'B' && c != 'G') {
+                // unknown augmentation, the FDE layout is unknown
+                return std::nullopt;
+            }
+        }
+    }
+    return fdeEncoding;
+}
+
+/**
+ * Parse an FDE.
+ * @param fdeRva the RVA of the FDE
+ * @param cieEncodings cache of the CIE FDE pointer encodings
+ * @param nextRva receives the RVA of the next record
+ * @return the function, nullopt if the record is a CIE or malformed
+ */
+static std::optional<FunctionIndex::Function> ParseFde(const ElfImageLayout& layout, uint64_t fdeRva,
+                                                      std::unordered_map<uint64_t, std::optional<uint8_t>>& cieEncodings,
+                                                      uint64_t* nextRva) {
+    auto optCursor = MakeCursor(layout, fdeRva);
+    if (!optCursor.has_value()) {
+        return std::nullopt;
+    }
+    auto& cursor = optCursor.value();
+    uint64_t length = 0;
+    size_t idPosition = 0;
+    uint64_t cieOffset = 0;
+    const bool hasHeader = ReadRecordHeader(cursor, length, idPosition, cieOffset);
+    if (nextRva != nullptr) {
+        // the next record is known once the length is read, even if the id is cut off
+        *nextRva = idPosition != 0 ? fdeRva + idPosition + length : fdeRva;
+    }
+    const uint64_t cieIdRva = fdeRva + idPosition;
+    if (!hasHeader || length == 0 || cieOffset == 0 || cieOffset > cieIdRva) {
+        return std::nullopt;
+    }
+    const uint64_t cieRva = cieIdRva - cieOffset;
+    auto it = cieEncodings.find(cieRva);
+    if (it == cieEncodings.end()) {
+        it = cieEncodings.emplace(cieRva, ParseCieFdeEncoding(layout, cieRva)).first;
+    }
+    if (!it->second.has_value()) {
+        return std::nullopt;
+    }
+    const uint8_t encoding = it->second.value();
+    uint64_t pcBegin = 0;
+    uint64_t pcRange = 0;
+    // the range has the same format, but it is never relative to anything
+    if (!ReadEncoded(cursor, fdeRva, layout.Is64Bit(), encoding, 0, pcBegin)
+            || !ReadEncoded(cursor, fdeRva, layout.Is64Bit(), encoding & 0x0f, 0, pcRange) || pcRange == 0) {
+        return std::nullopt;
+    }
+    return FunctionIndex::Function{pcBegin, pcBegin + pcRange};
+}
+
+std::string FunctionIndex::BuildFromEhFrame(const ElfImageLayout& layout) {
+    if (!layout.GetEhFrameHdr().has_value()) {
+        return "no PT_GNU_EH_FRAME";
+    }
+    const auto [hdrRva, hdrSize] = layout.GetEhFrameHdr().value();
+    auto optCursor = MakeCursor(layout, hdrRva, hdrSize);
+    if (!optCursor.has_value()) {
+        return ".eh_frame_hdr is not readable";
+    }
+    auto& cursor = optCursor.value();
+    const bool is64Bit = layout.Is64Bit();
+    uint8_t version = 0;
+    uint8_t ehFramePtrEncoding = 0;
+    uint8_t fdeCountEncoding = 0;
+    uint8_t tableEncoding = 0;
+    if (!cursor.ReadLe(version) || !cursor.ReadLe(ehFramePtrEncoding) || !cursor.ReadLe(fdeCountEncoding)
+            || !cursor.ReadLe(tableEncoding) || version != 1) {
+        return fmt::format("unsupported .eh_frame_hdr version {}", version);
+    }
+    uint64_t ehFrameRva = 0;
+    if (!ReadEncoded(cursor, hdrRva, is64Bit, ehFramePtrEncoding, hdrRva, ehFrameRva)) {
+        return ".eh_frame_hdr: bad eh_frame_ptr";
+    }
+    std::unordered_map<uint64_t, std::optional<uint8_t>> cieEncodings;
+    if (fdeCountEncoding != kDwEhPeOmit && tableEncoding != kDwEhPeOmit) {
+        // the binary search table, sorted (initial location, FDE address) pairs
+        uint64_t fdeCount = 0;
+        if (!ReadEncoded(cursor, hdrRva, is64Bit, fdeCountEncoding, hdrRva, fdeCount)) {
+            return ".eh_frame_hdr: bad fde_count";
+        }
+        // fde_count is not trusted, the table can not have more entries than it has room for
+        if (size_t entrySize = 2 * GetEncodedSize(tableEncoding, is64Bit); entrySize != 0) {
+            mFunctions.reserve(size_t(std::min<uint64_t>(fdeCount, cursor.Remaining() / entrySize)));
+        }
+        for (uint64_t i = 0; i < fdeCount; i++) {
+            uint64_t initialLocation = 0;
+            uint64_t fdeRva = 0;
+            if (!ReadEncoded(cursor, hdrRva, is64Bit, tableEncoding, hdrRva, initialLocation)
+                    || !ReadEncoded(cursor, hdrRva, is64Bit, tableEncoding, hdrRva, fdeRva)) {
+                break;
+            }
+            if (auto function = ParseFde(layout, fdeRva, cieEncodings, nullptr); function.has_value()) {
+                mFunctions.push_back(function.value());
+            }
+        }
+    } else {
+        // no search table, walk .eh_frame until the zero terminator or the end of the segment
+        uint64_t rva = ehFrameRva;
+        while (true) {
+            auto peek = MakeCursor(layout, rva);
+            uint32_t length = 0;
+            if (!peek.has_value() || !peek->ReadLe(length) || length == 0) {
+                break;
+            }
+            uint64_t next = 0;
+            if (auto function = ParseFde(layout, rva, cieEncodings, &next); function.has_value()) {
+                mFunctions.push_back(function.value());
+            }
+            if (next <= rva) {
+                break;
+            }
+            rva = next;
+        }
+    }
+    return {};
+}
+
+std::string FunctionIndex::BuildFromArmExidx(const ElfImageLayout& layout) {
+    if (!layout.GetArmExidx().has_value()) {
+        return "no PT_ARM_EXIDX";
+    }
+    const auto [exidxRva, exidxSize] = layout.GetArmExidx().value();
+    const size_t entryCount = size_t(exidxSize / 8);
+    const uint8_t* table = layout.GetPointer(exidxRva, entryCount * 8);
+    if (table == nullptr) {
+        return ".ARM.exidx is not readable";
+    }
+    // every entry is (prel31 function start, unwind data), the table is sorted and a function ends where the next one starts,
+    // EXIDX_CANTUNWIND entries still mark a function start
+    std::vector<uint64_t> starts;
+    starts.reserve(entryCount);
+    for (size_t i = 0; i < entryCount; i++) {
+        uint32_t word;
+        memcpy(&word, table + i * 8, 4);
+        // sign extend prel31
+        auto offset = int32_t(word << 1) >> 1;
+        uint64_t start = uint32_t(exidxRva + i * 8 + int64_t(offset)) & ~1u;
+        starts.push_back(start);
+    }
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+    for (size_t i = 0; i < starts.size(); i++) {
+        uint64_t end;
+        if (i + 1 < starts.size()) {
+            end = starts[i + 1];
+        } else {
+            const auto* seg = layout.FindSegment(starts[i]);
+            if (seg == nullptr) {
+                continue;
+            }
+            end = seg->vaddr + seg->fileSize;
+        }
+        mFunctions.push_back({starts[i], end});
+    }
+    return {};
+}
+
+std::string FunctionIndex::Build(const ElfImageLayout& layout) {
+    mFunctions.clear();
+    if (!layout.IsValid()) {
+        return "invalid layout";
+    }
+    std::string err = BuildFromEhFrame(layout);
+    if (mFunctions.empty() && layout.GetMachine() == EM_ARM) {
+        std::string exidxErr = BuildFromArmExidx(layout);
+        if (!exidxErr.empty()) {
+            err = fmt::format("{}, {}", err.empty() ? "no FDE in .eh_frame" : err, exidxErr);
+        } else {
+            err.clear();
+        }
+    }
+    std::sort(mFunctions.begin(), mFunctions.end(), [](const Function& a, const Function& b) {
+        return a.start < b.start || (a.start == b.start && a.end > b.end);
+    });
+    // drop duplicate starts, keeping the largest range
+    mFunctions.erase(std::unique(mFunctions.begin(), mFunctions.end(), [](const Function& a, const Function& b) {
+        return a.start == b.start;
+    }), mFunctions.end());
+    if (mFunctions.empty() && err.empty()) {
+        err = "no function found in the unwind tables";
+    }
+    return err;
+}
+
+std::optional<FunctionIndex::Function> FunctionIndex::FindFunction(uint64_t rva) const noexcept {
+    auto it = std::upper_bound(mFunctions.begin(), mFunctions.end(), rva, [](uint64_t v, const Function& f) {
+        return v < f.start;
+    });
+    if (it == mFunctions.begin()) {
+        return std::nullopt;
+    }
+    --it;
+    if (rva >= it->end) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+}
@@ -0,0 +1,64 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_FUNCTIONINDEX_H
+#define QAUXV_FUNCTIONINDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/ElfImageLayout.h"
+
+namespace utils {
+
+/**
+ * The function boundaries of an ELF image, taken from the unwind tables which are present even in stripped libraries:
+ * the FDEs of .eh_frame (through the .eh_frame_hdr search table when there is one), or .ARM.exidx on armv7.
+ * Lookups are a binary search over a sorted array.
+ */
+class FunctionIndex {
+public:
+    // [start, end) in RVA
+    struct Function {
+        uint64_t start;
+        uint64_t end;
+    };
+
+    FunctionIndex() = default;
+
+    /**
+     * Build the index, any previous content is discarded.
+     * @param layout the layout of the image
+     * @return empty string on success, or an error message, e.g. if the image has no unwind table
+     */
+    [[nodiscard]] std::string Build(const ElfImageLayout& layout);
+
+    /**
+     * Find the function containing the RVA.
+     * @return the function, or nullopt if the RVA is not covered by any unwind table entry, e.g. padding or data
+     */
+    [[nodiscard]] std::optional<Function> FindFunction(uint64_t rva) const noexcept;
+
+    [[nodiscard]] inline bool IsEmpty() const noexcept {
+        return mFunctions.empty();
+    }
+
+    // sorted by start
+    [[nodiscard]] inline const std::vector<Function>& GetFunctions() const noexcept {
+        return mFunctions;
+    }
+
+private:
+    std::string BuildFromEhFrame(const ElfImageLayout& layout);
+
+    std::string BuildFromArmExidx(const ElfImageLayout& layout);
+
+    std::vector<Function> mFunctions;
+};
+
+}
+
+#endif //QAUXV_FUNCTIONINDEX_H
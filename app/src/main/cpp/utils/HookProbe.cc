@@ -0,0 +1,232 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "HookProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <thread>
+
+#include <sched.h>
+#include <sys/sysinfo.h>
+
+#include <fmt/format.h>
+
+namespace utils {
+
+namespace hook_probe_detail {
+
+std::atomic<bool> gHookProbesEnabled = false;
+double gNanosPerTick = 1.0;
+
+}
+
+using namespace hook_probe_detail;
+
+#ifdef QAUXV_ENABLE_HOOK_PROBES
+
+static constexpr uint32_t kMaxHookProbes = 128;
+// one shard per CPU, so that hooks called on several CPUs do not fight for one cache line
+static constexpr uint32_t kMaxHookProbeShards = 64;
+
+namespace {
+
+struct alignas(64) HookProbeShard {
+    std::atomic<uint64_t> calls = 0;
+    std::atomic<uint64_t> totalNanos = 0;
+    std::array<std::atomic<uint32_t>, kHookProbeBucketCount> buckets = {};
+};
+
+struct HookProbeData {
+    std::string name;
+    // sShardCount shards, indexed by CPU
+    std::unique_ptr<HookProbeShard[]> shards;
+};
+
+}
+
+// probes are never freed, RecordHookProbe reads them without a lock
+static std::array<std::atomic<HookProbeData*>, kMaxHookProbes> sHookProbes = {};
+static std::atomic<uint32_t> sHookProbeCount = 0;
+static std::mutex sRegisterMutex;
+static const uint32_t sShardCount = std::clamp<uint32_t>(uint32_t(std::max(1, get_nprocs_conf())), 1, kMaxHookProbeShards);
+static std::once_flag sCalibrateOnce;
+
+static void CalibrateTicks() {
+#if defined(__aarch64__)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    if (frequency != 0) {
+        gNanosPerTick = 1e9 / double(frequency);
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    // the TSC frequency is not exposed, measure it against the monotonic clock
+    const auto startTime = std::chrono::steady_clock::now();
+    const uint64_t startTicks = ReadTicks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const uint64_t endTicks = ReadTicks();
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    if (endTicks > startTicks) {
+        gNanosPerTick = double(nanos) / double(endTicks - startTicks);
+    }
+#else
+    gNanosPerTick = 1.0;
+#endif
+}
+
+uint32_t RegisterHookProbe(std::string_view name) {
+    std::scoped_lock lock(sRegisterMutex);
+    const uint32_t count = sHookProbeCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++) {
+        if (sHookProbes[i].load(std::memory_order_relaxed)->name == name) {
+            return i;
+        }
+    }
+    if (count >= kMaxHookProbes) {
+        static bool sWarned = false;
+        if (!sWarned) {
+            sWarned = true;
+            LOGW("RegisterHookProbe: too many probes, '{}' and later ones are ignored", name);
+        }
+        return kInvalidHookProbeId;
+    }
+    auto* probe = new HookProbeData();
+    probe->name = name;
+    probe->shards = std::make_unique<HookProbeShard[]>(sShardCount);
+    sHookProbes[count].store(probe, std::memory_order_release);
+    sHookProbeCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void RecordHookProbe(uint32_t id, uint64_t nanos) noexcept {
+    if (id >= kMaxHookProbes) {
+        return;
+    }
+    HookProbeData* probe = sHookProbes[id].load(std::memory_order_acquire);
+    if (probe == nullptr) {
+        return;
+    }
+    // the thread may migrate right after, the counters are atomic so that only costs a shared cache line now and then
+    const int cpu = sched_getcpu();
+    auto& shard = probe->shards[cpu >= 0 ? uint32_t(cpu) % sShardCount : 0];
+    shard.calls.fetch_add(1, std::memory_order_relaxed);
+    shard.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    shard.buckets[GetHookProbeBucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void SetHookProbesEnabled(bool enabled) noexcept {
+    if (enabled) {
+        std::call_once(sCalibrateOnce, CalibrateTicks);
+    }
+    gHookProbesEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AreHookProbesCompiledIn() noexcept {
+    return true;
+}
+
+std::vector<HookProbeSnapshot> GetHookProbeSnapshots() {
+    std::vector<HookProbeSnapshot> snapshots;
+    const uint32_t count = sHookProbeCount.load(std::memory_order_acquire);
+    snapshots.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const HookProbeData* probe = sHookProbes[i].load(std::memory_order_acquire);
+        auto& snapshot = snapshots[i];
+        snapshot.name = probe->name;
+        for (uint32_t j = 0; j < sShardCount; j++) {
+            const auto& shard = probe->shards[j];
+            snapshot.calls += shard.calls.load(std::memory_order_relaxed);
+            snapshot.totalNanos += shard.totalNanos.load(std::memory_order_relaxed);
+            for (int b = 0; b < kHookProbeBucketCount; b++) {
+                snapshot.buckets[b] += shard.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return snapshots;
+}
+
+void ResetHookProbes() noexcept {
+    const uint32_t count = sHookProbeCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        HookProbeData* probe = sHookProbes[i].load(std::memory_order_acquire);
+        for (uint32_t j = 0; j < sShardCount; j++) {
+            auto& shard = probe->shards[j];
+            shard.calls.store(0, std::memory_order_relaxed);
+            shard.totalNanos.store(0, std::memory_order_relaxed);
+            for (auto& bucket: shard.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+#else // QAUXV_ENABLE_HOOK_PROBES
+
+uint32_t RegisterHookProbe(std::string_view) {
+    return kInvalidHookProbeId;
+}
+
+void RecordHookProbe(uint32_t, uint64_t) noexcept {}
+
+void SetHookProbesEnabled(bool) noexcept {}
+
+bool AreHookProbesCompiledIn() noexcept {
+    return false;
+}
+
+std::vector<HookProbeSnapshot> GetHookProbeSnapshots() {
+    return {};
+}
+
+void ResetHookProbes() noexcept {}
+
+#endif // QAUXV_ENABLE_HOOK_PROBES
+
+uint64_t HookProbeSnapshot::GetPercentileNanos(uint32_t permille) const noexcept {
+    if (calls == 0) {
+        return 0;
+    }
+    // the rank of the sample, rounded up
+    const uint64_t rank = (calls * std::min<uint32_t>(permille, 1000) + 999) / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i < kHookProbeBucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank && seen != 0) {
+            return i + 1 < kHookProbeBucketCount ? GetHookProbeBucketLowerBound(i + 1) - 1 : UINT64_MAX;
+        }
+    }
+    return UINT64_MAX;
+}
+
+std::string FormatHookProbeReport() {
+    if (!AreHookProbesCompiledIn()) {
+        return "hook probes are compiled out\n";
+    }
+    std::string report = fmt::format("hook probes: {}\n", gHookProbesEnabled.load(std::memory_order_relaxed) ? "enabled" : "disabled");
+    report += "name, calls, mean ns, p50 ns, p90 ns, p99 ns, total ms\n";
+    for (const auto& snapshot: GetHookProbeSnapshots()) {
+        report += fmt::format("{}, {}, {}, {}, {}, {}, {}\n", snapshot.name, snapshot.calls,
+                              snapshot.calls != 0 ? snapshot.totalNanos / snapshot.calls : 0,
+                              snapshot.GetPercentileNanos(500), snapshot.GetPercentileNanos(900),
+                              snapshot.GetPercentileNanos(990), snapshot.totalNanos / 1000000);
+    }
+    return report;
+}
+
+void DumpHookProbesToLogcat(android_LogPriority priority) {
+    std::string report = FormatHookProbeReport();
+    size_t begin = 0;
+    while (begin < report.size()) {
+        size_t end = report.find('\n', begin);
+        if (end == std::string::npos) {
+            end = report.size();
+        }
+        __android_log_write(priority, "QAuxv", report.substr(begin, end - begin).c_str());
+        begin = end + 1;
+    }
+}
+
+}
@@ -0,0 +1,158 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_HOOKPROBE_H
+#define QAUXV_HOOKPROBE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "utils/Log.h"
+
+/*
+ * Per-hook invocation counters and latency histograms.
+ *
+ * A hook replacement function puts QAUXV_HOOK_PROBE("name") at its top, the time until the end of the scope,
+ * including the call to the original function, is recorded. Probes are disabled at runtime by default,
+ * a disabled probe costs one relaxed load. If QAUXV_ENABLE_HOOK_PROBES is not defined, the macro expands to nothing.
+ */
+
+namespace utils {
+
+constexpr uint32_t kInvalidHookProbeId = UINT32_MAX;
+// 4 buckets per power of two, up to 2^63 ns
+constexpr int kHookProbeSubBucketBits = 2;
+constexpr int kHookProbeBucketCount = (64 - kHookProbeSubBucketBits + 1) << kHookProbeSubBucketBits;
+
+struct HookProbeSnapshot {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t totalNanos = 0;
+    // indexed by bucket, see GetHookProbeBucketLowerBound
+    std::array<uint64_t, kHookProbeBucketCount> buckets = {};
+
+    /**
+     * Get an upper estimate of a percentile, i.e. the upper bound of the bucket containing it.
+     * @param permille the percentile in permille, e.g. 990 for p99
+     */
+    [[nodiscard]] uint64_t GetPercentileNanos(uint32_t permille) const noexcept;
+};
+
+/**
+ * Register a probe, or get the id of the probe with the same name.
+ * @return the id, or kInvalidHookProbeId if too many probes are registered or probes are compiled out
+ */
+uint32_t RegisterHookProbe(std::string_view name);
+
+/**
+ * Record one call of a probe.
+ * @param id the probe id, invalid ids are ignored
+ * @param nanos the time spent in the call
+ */
+void RecordHookProbe(uint32_t id, uint64_t nanos) noexcept;
+
+void SetHookProbesEnabled(bool enabled) noexcept;
+
+[[nodiscard]] bool AreHookProbesCompiledIn() noexcept;
+
+[[nodiscard]] std::vector<HookProbeSnapshot> GetHookProbeSnapshots();
+
+/**
+ * Clear the counters and histograms of all probes, the probes stay registered.
+ */
+void ResetHookProbes() noexcept;
+
+/**
+ * Format the snapshots as a human readable table, one line per probe with calls, mean and percentiles.
+ */
+[[nodiscard]] std::string FormatHookProbeReport();
+
+void DumpHookProbesToLogcat(android_LogPriority priority);
+
+[[nodiscard]] constexpr int GetHookProbeBucketIndex(uint64_t nanos) noexcept {
+    constexpr uint64_t kSubBucketCount = 1u << kHookProbeSubBucketBits;
+    if (nanos < kSubBucketCount) {
+        return int(nanos);
+    }
+    const int exponent = 63 - __builtin_clzll(nanos);
+    const auto sub = int((nanos >> (exponent - kHookProbeSubBucketBits)) & (kSubBucketCount - 1));
+    return ((exponent - kHookProbeSubBucketBits + 1) << kHookProbeSubBucketBits) + sub;
+}
+
+[[nodiscard]] constexpr uint64_t GetHookProbeBucketLowerBound(int index) noexcept {
+    constexpr int kSubBucketCount = 1 << kHookProbeSubBucketBits;
+    if (index < kSubBucketCount) {
+        return uint64_t(index);
+    }
+    const int exponent = (index >> kHookProbeSubBucketBits) + kHookProbeSubBucketBits - 1;
+    const auto sub = uint64_t(index & (kSubBucketCount - 1));
+    return (uint64_t(1) << exponent) + (sub << (exponent - kHookProbeSubBucketBits));
+}
+
+namespace hook_probe_detail {
+
+extern std::atomic<bool> gHookProbesEnabled;
+extern double gNanosPerTick;
+
+// a raw cycle counter where it is cheap to read, otherwise CLOCK_MONOTONIC in ns
+inline uint64_t ReadTicks() noexcept {
+#if defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+#endif
+}
+
+class HookProbeScope {
+public:
+    explicit HookProbeScope(uint32_t id) noexcept
+            : mId(gHookProbesEnabled.load(std::memory_order_relaxed) ? id : kInvalidHookProbeId),
+              mStartTicks(mId != kInvalidHookProbeId ? ReadTicks() : 0) {}
+
+    ~HookProbeScope() noexcept {
+        if (mId != kInvalidHookProbeId) {
+            RecordHookProbe(mId, uint64_t(double(ReadTicks() - mStartTicks) * gNanosPerTick));
+        }
+    }
+
+    HookProbeScope(const HookProbeScope&) = delete;
+
+    HookProbeScope& operator=(const HookProbeScope&) = delete;
+
+private:
+    const uint32_t mId;
+    const uint64_t mStartTicks;
+};
+
+}
+
+}
+
+#define QAUXV_HOOK_PROBE_CONCAT_IMPL(a, b) a##b
+#define QAUXV_HOOK_PROBE_CONCAT(a, b) QAUXV_HOOK_PROBE_CONCAT_IMPL(a, b)
+
+#ifdef QAUXV_ENABLE_HOOK_PROBES
+#define QAUXV_HOOK_PROBE(name) \
+    static const uint32_t QAUXV_HOOK_PROBE_CONCAT(qauxvHookProbeId_, __LINE__) = ::utils::RegisterHookProbe(name); \
+    ::utils::hook_probe_detail::HookProbeScope QAUXV_HOOK_PROBE_CONCAT(qauxvHookProbeScope_, __LINE__)(QAUXV_HOOK_PROBE_CONCAT(qauxvHookProbeId_, __LINE__))
+#else
+#define QAUXV_HOOK_PROBE(name) do {} while (false)
+#endif
+
+#endif //QAUXV_HOOKPROBE_H
@@ -0,0 +1,245 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "LibraryFileImage.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "utils/BinaryCursor.h"
+#include "utils/FileIo.h"
+#include "utils/MemoryUtils.h"
+#include "utils/ZipArchive.h"
+#include "utils/auto_close_fd.h"
+
+namespace utils {
+
+#if defined(__aarch64__)
+static constexpr auto kExtractedLibAbiDir = "arm64";
+static constexpr auto kApkLibAbiDir = "arm64-v8a";
+#elif defined(__arm__)
+static constexpr auto kExtractedLibAbiDir = "arm";
+static constexpr auto kApkLibAbiDir = "armeabi-v7a";
+#elif defined(__x86_64__)
+static constexpr auto kExtractedLibAbiDir = "x86_64";
+static constexpr auto kApkLibAbiDir = "x86_64";
+#elif defined(__i386__)
+static constexpr auto kExtractedLibAbiDir = "x86";
+static constexpr auto kApkLibAbiDir = "x86";
+#else
+#error "unsupported architecture"
+#endif
+
+/**
+ * Check that the program header table and the file range of every PT_LOAD segment are inside the file,
+ * the scanners which take the image afterwards only get its base address.
+ */
+template<typename Ehdr, typename Phdr>
+static bool IsElfFileLayoutValid(BinarySpan file) {
+    Ehdr ehdr;
+    if (!file.Read(0, ehdr) || ehdr.e_phoff == 0 || ehdr.e_phentsize != sizeof(Phdr)
+            || !file.ContainsArray<Phdr>(size_t(ehdr.e_phoff), ehdr.e_phnum)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < ehdr.e_phnum; i++) {
+        Phdr phdr;
+        if (!file.Read(size_t(ehdr.e_phoff) + i * sizeof(Phdr), phdr)) {
+            return false;
+        }
+        if (phdr.p_type == PT_LOAD && !file.Contains(size_t(phdr.p_offset), size_t(phdr.p_filesz))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool IsElfFileValid(BinarySpan file) {
+    uint8_t ident[EI_NIDENT];
+    if (!file.ReadArray(0, ident, EI_NIDENT) || memcmp(ident, ELFMAG, SELFMAG) != 0) {
+        return false;
+    }
+    if (ident[EI_CLASS] == ELFCLASS64) {
+        return IsElfFileLayoutValid<Elf64_Ehdr, Elf64_Phdr>(file);
+    } else if (ident[EI_CLASS] == ELFCLASS32) {
+        return IsElfFileLayoutValid<Elf32_Ehdr, Elf32_Phdr>(file);
+    }
+    return false;
+}
+
+LibraryFileImage::~LibraryFileImage() noexcept {
+    Close();
+}
+
+void LibraryFileImage::Close() noexcept {
+    if (mAddress != nullptr) {
+        munmap(mAddress, mMapLength);
+    }
+    mAddress = nullptr;
+    mLength = 0;
+    mMapLength = 0;
+}
+
+int LibraryFileImage::MapRange(int fd, uint64_t offset, size_t length, FileMemMap::AccessHint hint) {
+    if (length == 0) {
+        return EINVAL;
+    }
+    const size_t pageSize = GetPageSize();
+    const size_t mapLength = (length + pageSize - 1u) & ~(pageSize - 1u);
+    void* addr;
+    if (offset % pageSize == 0) {
+        // the readahead state belongs to the open file, which the mapping shares
+        if (hint == FileMemMap::AccessHint::kSequential) {
+            (void) posix_fadvise(fd, off_t(offset), off_t(length), POSIX_FADV_SEQUENTIAL);
+        } else if (hint == FileMemMap::AccessHint::kRandom) {
+            (void) posix_fadvise(fd, off_t(offset), off_t(length), POSIX_FADV_RANDOM);
+        }
+        const int populate = hint == FileMemMap::AccessHint::kPopulate ? MAP_POPULATE : 0;
+        addr = mmap(nullptr, mapLength, PROT_READ, MAP_PRIVATE | populate, fd, off_t(offset));
+        if (addr == MAP_FAILED) {
+            return errno;
+        }
+        if (hint != FileMemMap::AccessHint::kNormal && hint != FileMemMap::AccessHint::kPopulate) {
+            (void) FileMemMap::adviseRange(addr, mapLength, hint);
+        }
+    } else {
+        // mmap requires a page aligned offset, the image itself must start at a page boundary
+        addr = mmap(nullptr, mapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            return errno;
+        }
+        // the copy is resident afterwards whatever the hint is, only the read itself can be sped up
+        (void) posix_fadvise(fd, off_t(offset), off_t(length), POSIX_FADV_SEQUENTIAL);
+        if (int err = PreadFully(fd, addr, length, offset); err != 0) {
+            munmap(addr, mapLength);
+            return err;
+        }
+        mprotect(addr, mapLength, PROT_READ);
+    }
+    if (!IsElfFileValid(BinarySpan(addr, length))) {
+        munmap(addr, mapLength);
+        return ENOEXEC;
+    }
+    Close();
+    mAddress = addr;
+    mLength = length;
+    mMapLength = mapLength;
+    return 0;
+}
+
+int LibraryFileImage::OpenFile(const char* path, FileMemMap::AccessHint hint) {
+    auto_close_fd fd(open(path, O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0) {
+        return errno;
+    }
+    struct stat64 st = {};
+    if (fstat64(fd.get(), &st) < 0) {
+        return errno;
+    }
+    return MapRange(fd.get(), 0, size_t(st.st_size), hint);
+}
+
+int LibraryFileImage::OpenZipEntry(const char* zipPath, std::string_view entryName, FileMemMap::AccessHint hint) {
+    auto_close_fd fd(open(zipPath, O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0) {
+        return errno;
+    }
+    struct stat64 st = {};
+    if (fstat64(fd.get(), &st) < 0) {
+        return errno;
+    }
+    const auto fileSize = uint64_t(st.st_size);
+    std::vector<ZipEntryInfo> entries;
+    if (int err = ReadZipCentralDirectory(fd.get(), fileSize, entries); err != 0) {
+        return err;
+    }
+    auto it = std::find_if(entries.begin(), entries.end(), [entryName](const ZipEntryInfo& entry) {
+        return entry.name == entryName;
+    });
+    if (it == entries.end()) {
+        return ENOENT;
+    }
+    if (it->compression != kZipMethodStored || it->compressedSize != it->uncompressedSize) {
+        return ENOTSUP;
+    }
+    uint64_t dataOffset = 0;
+    if (int err = GetZipEntryDataOffset(fd.get(), fileSize, *it, dataOffset); err != 0) {
+        return err;
+    }
+    return MapRange(fd.get(), dataOffset, it->uncompressedSize, hint);
+}
+
+/**
+ * Find the host APKs among the file mappings of the current process, base.apk first, followed by the
+ * split_config.*.apk of the same directory, e.g. split_config.arm64_v8a.apk which holds the native libraries
+ * when the host is installed as split APKs.
+ */
+static std::vector<std::string> FindHostApkPaths(std::string_view packageName) {
+    // e.g. /data/app/~~random==/com.tencent.mobileqq-random==/base.apk
+    const std::string packageDir = fmt::format("/{}-", packageName);
+    const auto maps = GetProcessMemoryMaps();
+    std::vector<std::string> apkPaths;
+    for (const auto& entry: maps) {
+        const std::string& path = entry.path;
+        if (path.ends_with("/base.apk") && path.find(packageDir) != std::string::npos) {
+            apkPaths.emplace_back(path);
+            break;
+        }
+    }
+    if (apkPaths.empty()) {
+        return apkPaths;
+    }
+    const std::string splitPrefix = apkPaths[0].substr(0, apkPaths[0].rfind('/')) + "/split_config.";
+    for (const auto& entry: maps) {
+        const std::string& path = entry.path;
+        if (path.starts_with(splitPrefix) && path.ends_with(".apk") && path.find('/', splitPrefix.size()) == std::string::npos
+                && std::find(apkPaths.begin(), apkPaths.end(), path) == apkPaths.end()) {
+            apkPaths.emplace_back(path);
+        }
+    }
+    return apkPaths;
+}
+
+int OpenHostNativeLibraryFile(std::string_view packageName, std::string_view soname,
+                              LibraryFileImage& image, std::string& location, FileMemMap::AccessHint hint) {
+    std::vector<std::string> apkPaths = FindHostApkPaths(packageName);
+    if (apkPaths.empty()) {
+        return ENOENT;
+    }
+    std::string apkDir = apkPaths[0].substr(0, apkPaths[0].rfind('/'));
+    // extractNativeLibs=true, the installer extracts the libraries to <apk dir>/lib/<abi>
+    std::string extractedPath = fmt::format("{}/lib/{}/{}", apkDir, kExtractedLibAbiDir, soname);
+    if (access(extractedPath.c_str(), R_OK) == 0) {
+        if (int err = image.OpenFile(extractedPath.c_str(), hint); err != 0) {
+            return err;
+        }
+        location = std::move(extractedPath);
+        return 0;
+    }
+    // extractNativeLibs=false, the library is stored uncompressed and page aligned in base.apk or in the ABI split
+    std::string entryName = fmt::format("lib/{}/{}", kApkLibAbiDir, soname);
+    for (const auto& apkPath: apkPaths) {
+        int err = image.OpenZipEntry(apkPath.c_str(), entryName, hint);
+        if (err == ENOENT) {
+            continue;
+        }
+        if (err != 0) {
+            return err;
+        }
+        location = fmt::format("{}!/{}", apkPath, entryName);
+        return 0;
+    }
+    return ENOENT;
+}
+
+}
@@ -0,0 +1,93 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_LIBRARYFILEIMAGE_H
+#define QAUXV_LIBRARYFILEIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "utils/FileMemMap.h"
+
+namespace utils {
+
+/**
+ * A read-only, page aligned view of an ELF file which is not loaded by the linker,
+ * either a plain file or an uncompressed entry of a zip file, e.g. lib/arm64-v8a/libfoo.so in an APK.
+ * The address can be passed to FindByteSequenceForImageFile.
+ */
+class LibraryFileImage {
+public:
+    LibraryFileImage() = default;
+
+    ~LibraryFileImage() noexcept;
+
+    LibraryFileImage(const LibraryFileImage&) = delete;
+
+    LibraryFileImage& operator=(const LibraryFileImage&) = delete;
+
+    /**
+     * Map a plain file.
+     * @param path the absolute path to the file
+     * @param hint the expected access pattern of the image, see FileMemMap::AccessHint
+     * @return 0 on success, ENOEXEC if the file is not an ELF file whose program headers and segments are inside it,
+     *         or errno
+     */
+    [[nodiscard]] int OpenFile(const char* path, FileMemMap::AccessHint hint = FileMemMap::AccessHint::kNormal);
+
+    /**
+     * Map an entry of a zip file. The entry must be stored without compression, which is what
+     * the platform requires for native libraries loaded directly from an APK.
+     * If the entry data is not page aligned in the zip file, it is copied into anonymous memory.
+     * @param zipPath the absolute path to the zip file
+     * @param entryName the name of the entry, e.g. "lib/arm64-v8a/libkernel.so"
+     * @param hint the expected access pattern of the image, see FileMemMap::AccessHint
+     * @return 0 on success, ENOENT if there is no such entry, ENOTSUP if the entry is compressed,
+     *         ENOEXEC if the entry is not a valid ELF file, see OpenFile, or errno
+     */
+    [[nodiscard]] int OpenZipEntry(const char* zipPath, std::string_view entryName,
+                                   FileMemMap::AccessHint hint = FileMemMap::AccessHint::kNormal);
+
+    void Close() noexcept;
+
+    [[nodiscard]] inline const void* GetAddress() const noexcept {
+        return mAddress;
+    }
+
+    [[nodiscard]] inline size_t GetLength() const noexcept {
+        return mLength;
+    }
+
+    [[nodiscard]] inline bool IsValid() const noexcept {
+        return mAddress != nullptr && mLength != 0;
+    }
+
+private:
+    [[nodiscard]] int MapRange(int fd, uint64_t offset, size_t length, FileMemMap::AccessHint hint);
+
+    void* mAddress = nullptr;
+    size_t mLength = 0;
+    size_t mMapLength = 0;
+};
+
+/**
+ * Find the file of a native library of the host app before the host loads it.
+ * The extracted native library directory next to the host APK is tried first, then base.apk and the split_config.*.apk
+ * of the package mapped into the current process.
+ * @param packageName the host package name
+ * @param soname the library file name, e.g. "libkernel.so"
+ * @param image receives the file image
+ * @param location receives a human readable location of the file, for logging
+ * @param hint the expected access pattern of the image, e.g. kSequential for a pre-scan, see FileMemMap::AccessHint
+ * @return 0 on success, or errno
+ */
+[[nodiscard]] int OpenHostNativeLibraryFile(std::string_view packageName, std::string_view soname,
+                                            LibraryFileImage& image, std::string& location,
+                                            FileMemMap::AccessHint hint = FileMemMap::AccessHint::kNormal);
+
+}
+
+#endif //QAUXV_LIBRARYFILEIMAGE_H
@@ -41,6 +41,8 @@ typedef enum android_LogPriority {
 
 int __android_log_print(int prio, const char* tag, const char* fmt, ...) __attribute__((__format__(printf, 3, 4)));
 
+int __android_log_write(int prio, const char* tag, const char* text);
+
 #endif
 
 #define LOGD(...) ::__android_log_write(ANDROID_LOG_DEBUG, "QAuxv", ::fmt::format(__VA_ARGS__).c_str())
@@ -0,0 +1,229 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "SamplingProfiler.h"
+
+#include <cerrno>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "utils/FileIo.h"
+#include "utils/auto_close_fd.h"
+#include "utils/Log.h"
+#include "utils/ThreadUtils.h"
+
+namespace utils {
+
+static constexpr size_t kMaxFramesPerSample = 64;
+
+SamplingProfiler& SamplingProfiler::GetInstance() {
+    // never destroyed, the sampler thread may outlive static destructors
+    static auto* sInstance = new SamplingProfiler();
+    return *sInstance;
+}
+
+static uint64_t HashFoldedStack(std::string_view stack) noexcept {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c: stack) {
+        hash ^= uint8_t(c);
+        hash *= 0x100000001b3ULL;
+    }
+    // 0 marks a free slot
+    return hash == 0 ? 1 : hash;
+}
+
+static std::vector<uint32_t> ListThreadsOfCurrentProcess() {
+    std::vector<uint32_t> tids;
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return tids;
+    }
+    while (auto* entry = readdir(dir)) {
+        if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
+            tids.push_back(uint32_t(strtoul(entry->d_name, nullptr, 10)));
+        }
+    }
+    closedir(dir);
+    return tids;
+}
+
+static std::string GetThreadName(uint32_t tid) {
+    char buf[32] = {};
+    auto_close_fd fd(open(fmt::format("/proc/self/task/{}/comm", tid).c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd) {
+        return fmt::format("tid-{}", tid);
+    }
+    ssize_t n = read(fd.get(), buf, sizeof(buf) - 1);
+    if (n <= 0) {
+        return fmt::format("tid-{}", tid);
+    }
+    std::string name(buf, size_t(n));
+    while (!name.empty() && (name.back() == '\n' || name.back() == '\0')) {
+        name.pop_back();
+    }
+    return name;
+}
+
+static void AppendFrameName(std::string& out, const unwindstack::FrameData& frame) {
+    const std::string& functionName = frame.function_name;
+    if (!functionName.empty()) {
+        out += functionName;
+        return;
+    }
+    std::string_view mapName;
+    if (frame.map_info != nullptr) {
+        const std::string& name = frame.map_info->name();
+        mapName = name;
+    }
+    if (auto slash = mapName.rfind('/'); slash != std::string_view::npos) {
+        mapName = mapName.substr(slash + 1);
+    }
+    out += fmt::format("{}+0x{:x}", mapName.empty() ? "<anonymous>" : mapName, frame.rel_pc);
+}
+
+std::string SamplingProfiler::Start(std::vector<uint32_t> tids, uint32_t intervalMillis) {
+    std::scoped_lock lock(mControlMutex);
+    if (mSamplerThread.joinable()) {
+        return "the profiler is already running";
+    }
+    if (intervalMillis == 0) {
+        return "interval must be positive";
+    }
+    {
+        std::scoped_lock stopLock(mStopMutex);
+        mStopRequested = false;
+    }
+    try {
+        mSamplerThread = std::thread(&SamplingProfiler::SamplerLoop, this, std::move(tids), intervalMillis);
+    } catch (const std::system_error& e) {
+        return fmt::format("failed to start the sampler thread: {}", e.what());
+    }
+    mIsRunning.store(true, std::memory_order_release);
+    return {};
+}
+
+void SamplingProfiler::Stop() {
+    std::scoped_lock lock(mControlMutex);
+    if (!mSamplerThread.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock stopLock(mStopMutex);
+        mStopRequested = true;
+    }
+    mStopCondition.notify_all();
+    mSamplerThread.join();
+    mIsRunning.store(false, std::memory_order_release);
+}
+
+bool SamplingProfiler::IsRunning() const noexcept {
+    return mIsRunning.load(std::memory_order_acquire);
+}
+
+bool SamplingProfiler::Reset() {
+    std::scoped_lock lock(mControlMutex);
+    if (mSamplerThread.joinable()) {
+        return false;
+    }
+    for (auto& slot: mSlots) {
+        delete slot.stack.exchange(nullptr, std::memory_order_acq_rel);
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.hash.store(0, std::memory_order_release);
+    }
+    mSampleCount.store(0, std::memory_order_relaxed);
+    mDroppedCount.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void SamplingProfiler::RecordSample(const std::string& foldedStack) {
+    const uint64_t hash = HashFoldedStack(foldedStack);
+    for (size_t i = 0; i < kSlotCount; i++) {
+        Slot& slot = mSlots[(hash + i) % kSlotCount];
+        uint64_t current = slot.hash.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (slot.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)) {
+                slot.stack.store(new std::string(foldedStack), std::memory_order_release);
+                current = hash;
+            }
+        }
+        if (current == hash) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            mSampleCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::SamplerLoop(std::vector<uint32_t> tids, uint32_t intervalMillis) {
+    const auto selfTid = uint32_t(gettid());
+    const bool sampleAllThreads = tids.empty();
+    std::unordered_map<uint32_t, std::string> threadNames;
+    std::string folded;
+    LOGD("SamplingProfiler: started, {} thread(s), interval {} ms", sampleAllThreads ? "all" : std::to_string(tids.size()), intervalMillis);
+    while (true) {
+        {
+            std::unique_lock stopLock(mStopMutex);
+            if (mStopCondition.wait_for(stopLock, std::chrono::milliseconds(intervalMillis), [this] { return mStopRequested; })) {
+                break;
+            }
+        }
+        if (sampleAllThreads) {
+            tids = ListThreadsOfCurrentProcess();
+        }
+        for (uint32_t tid: tids) {
+            if (tid == selfTid) {
+                continue;
+            }
+            unwindstack::AndroidUnwinderData data(kMaxFramesPerSample);
+            if (!UnwindLocalThread(tid, data) || data.frames.empty()) {
+                // the thread may have exited
+                mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            auto it = threadNames.find(tid);
+            if (it == threadNames.end()) {
+                it = threadNames.emplace(tid, GetThreadName(tid)).first;
+            }
+            folded = it->second;
+            // folded stacks are root first, the unwinder returns the innermost frame first
+            for (auto frame = data.frames.rbegin(); frame != data.frames.rend(); ++frame) {
+                folded += ';';
+                AppendFrameName(folded, *frame);
+            }
+            RecordSample(folded);
+        }
+    }
+    LOGD("SamplingProfiler: stopped, {} sample(s), {} dropped", GetSampleCount(), GetDroppedCount());
+}
+
+int SamplingProfiler::DumpFoldedStacks(const std::string& path) const {
+    std::string content;
+    {
+        // Reset deletes the strings, the sampler thread only ever adds them
+        std::scoped_lock lock(mControlMutex);
+        for (const auto& slot: mSlots) {
+            const std::string* stack = slot.stack.load(std::memory_order_acquire);
+            if (stack == nullptr) {
+                continue;
+            }
+            content += fmt::format("{} {}\n", *stack, slot.count.load(std::memory_order_relaxed));
+        }
+    }
+    auto_close_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)));
+    if (!fd) {
+        return errno;
+    }
+    return WriteFully(fd.get(), content.data(), content.size());
+}
+
+}
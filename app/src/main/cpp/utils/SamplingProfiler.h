@@ -0,0 +1,106 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_SAMPLINGPROFILER_H
+#define QAUXV_SAMPLINGPROFILER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+/**
+ * An opt-in sampling profiler for the threads of the current process.
+ * A background thread periodically unwinds the selected threads with UnwindLocalThread, which interrupts them with a signal,
+ * no ptrace is involved. The stacks are aggregated into a fixed-size lock-free table of folded stacks,
+ * i.e. "thread;outer;...;inner count", which is the input format of flamegraph.pl.
+ */
+class SamplingProfiler {
+public:
+    SamplingProfiler(const SamplingProfiler&) = delete;
+
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    [[nodiscard]] static SamplingProfiler& GetInstance();
+
+    /**
+     * Start sampling, the samples of the previous run are kept until Reset.
+     * @param tids the threads to sample, empty for all threads of the process, which are listed again in every round
+     * @param intervalMillis the interval between two rounds
+     * @return empty string on success, or an error message, e.g. if the profiler is already running
+     */
+    [[nodiscard]] std::string Start(std::vector<uint32_t> tids, uint32_t intervalMillis);
+
+    /**
+     * Stop sampling and wait for the sampler thread to exit, no-op if it is not running.
+     */
+    void Stop();
+
+    [[nodiscard]] bool IsRunning() const noexcept;
+
+    /**
+     * Discard all samples. Must not be called while the profiler is running.
+     * @return false if the profiler is running
+     */
+    bool Reset();
+
+    /**
+     * Write the folded stacks to a file, may be called while the profiler is running.
+     * @param path the path of the file, it is truncated
+     * @return 0 on success, or errno
+     */
+    [[nodiscard]] int DumpFoldedStacks(const std::string& path) const;
+
+    // the number of stacks recorded
+    [[nodiscard]] uint64_t GetSampleCount() const noexcept {
+        return mSampleCount.load(std::memory_order_relaxed);
+    }
+
+    // the number of stacks lost because the unwind failed or the table is full
+    [[nodiscard]] uint64_t GetDroppedCount() const noexcept {
+        return mDroppedCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    SamplingProfiler() = default;
+
+    ~SamplingProfiler() = default;
+
+    static constexpr size_t kSlotCount = 8192;
+
+    struct Slot {
+        // 0 if the slot is free
+        std::atomic<uint64_t> hash = 0;
+        std::atomic<uint64_t> count = 0;
+        // published after the hash, readers skip the slot until then
+        std::atomic<const std::string*> stack = nullptr;
+    };
+
+    void SamplerLoop(std::vector<uint32_t> tids, uint32_t intervalMillis);
+
+    void RecordSample(const std::string& foldedStack);
+
+    std::array<Slot, kSlotCount> mSlots;
+    std::atomic<uint64_t> mSampleCount = 0;
+    std::atomic<uint64_t> mDroppedCount = 0;
+
+    // serializes Start, Stop and Reset, and keeps Reset from freeing the stacks DumpFoldedStacks is reading
+    mutable std::mutex mControlMutex;
+    // guards mStopRequested
+    std::mutex mStopMutex;
+    std::condition_variable mStopCondition;
+    bool mStopRequested = false;
+    std::atomic<bool> mIsRunning = false;
+    std::thread mSamplerThread;
+};
+
+}
+
+#endif //QAUXV_SAMPLINGPROFILER_H
@@ -0,0 +1,487 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "SqliteSpaceAnalyzer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "utils/BinaryCursor.h"
+#include "utils/FileIo.h"
+#include "utils/auto_close_fd.h"
+
+namespace utils {
+
+// see https://www.sqlite.org/fileformat.html
+static constexpr size_t kDatabaseHeaderSize = 100;
+static constexpr uint8_t kInteriorIndexPage = 2;
+static constexpr uint8_t kInteriorTablePage = 5;
+static constexpr uint8_t kLeafIndexPage = 10;
+static constexpr uint8_t kLeafTablePage = 13;
+static constexpr uint32_t kSchemaRootPage = 1;
+// the sequential pass reads this many bytes of pages per syscall
+static constexpr size_t kSequentialReadSize = 1024 * 1024;
+
+namespace {
+
+// what the sequential pass remembers about a page, about 32 bytes per page
+struct PageInfo {
+    uint64_t payloadBytes = 0;
+    // index into the children array, interior pages only
+    uint32_t childBegin = 0;
+    uint32_t freeBytes = 0;
+    uint32_t overflowPages = 0;
+    uint16_t cellCount = 0;
+    uint16_t overflowChains = 0;
+    // 0 if the page is not a valid b-tree page
+    uint8_t type = 0;
+};
+
+// the database is read with pread, not mapped: the host may truncate or VACUUM it at any time,
+// which would raise SIGBUS on a mapping but only gives a short read here
+struct DatabaseFile {
+    int fd = -1;
+    uint32_t pageSize = 0;
+    uint32_t usableSize = 0;
+    uint32_t pageCount = 0;
+
+    /**
+     * Read one page.
+     * @return the page in buffer, or nullptr if pgno is out of range or the page can not be read completely
+     */
+    [[nodiscard]] const uint8_t* ReadPage(uint32_t pgno, std::vector<uint8_t>& buffer) const noexcept {
+        if (pgno == 0 || pgno > pageCount) {
+            return nullptr;
+        }
+        buffer.resize(pageSize);
+        return PreadUpTo(fd, buffer.data(), pageSize, uint64_t(pgno - 1) * pageSize) == ssize_t(pageSize) ? buffer.data() : nullptr;
+    }
+};
+
+}
+
+/**
+ * Read a SQLite varint, at most 9 bytes.
+ * @return the number of bytes consumed, or 0 if the varint runs past end
+ */
+static size_t ReadVarint(const uint8_t* p, const uint8_t* end, uint64_t& value) noexcept {
+    value = 0;
+    for (size_t i = 0; i < 9; i++) {
+        if (p + i >= end) {
+            return 0;
+        }
+        if (i == 8) {
+            value = (value << 8) | p[i];
+            return 9;
+        }
+        value = (value << 7) | (p[i] & 0x7f);
+        if ((p[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static bool IsTablePage(uint8_t type) noexcept {
+    return type == kInteriorTablePage || type == kLeafTablePage;
+}
+
+static bool IsInteriorPage(uint8_t type) noexcept {
+    return type == kInteriorIndexPage || type == kInteriorTablePage;
+}
+
+/**
+ * Get the number of payload bytes stored on the b-tree page itself, the rest goes to overflow pages.
+ */
+static uint64_t GetLocalPayloadSize(uint64_t payloadSize, uint32_t usableSize, bool isTableLeaf) noexcept {
+    const uint64_t maxLocal = isTableLeaf ? usableSize - 35 : (uint64_t(usableSize - 12) * 64 / 255) - 23;
+    if (payloadSize <= maxLocal) {
+        return payloadSize;
+    }
+    const uint64_t minLocal = (uint64_t(usableSize - 12) * 32 / 255) - 23;
+    const uint64_t local = minLocal + (payloadSize - minLocal) % (usableSize - 4);
+    return local <= maxLocal ? local : minLocal;
+}
+
+/**
+ * Locate the payload of a cell.
+ * @param cell the start of the cell
+ * @param payloadSize receives the declared payload size
+ * @param payload receives the start of the local payload
+ * @param localSize receives the size of the local payload, followed by the first overflow page number if smaller than payloadSize
+ * @return false if the cell is malformed or has no payload, i.e. a table interior cell
+ */
+static bool LocateCellPayload(const DatabaseFile& image, uint8_t type, const uint8_t* cell, const uint8_t* pageEnd,
+                              uint64_t& payloadSize, const uint8_t*& payload, uint64_t& localSize) noexcept {
+    const uint8_t* p = cell;
+    if (type == kInteriorTablePage) {
+        return false;
+    }
+    if (type == kInteriorIndexPage) {
+        // left child pointer
+        p += 4;
+    }
+    size_t n = ReadVarint(p, pageEnd, payloadSize);
+    if (n == 0) {
+        return false;
+    }
+    p += n;
+    if (type == kLeafTablePage) {
+        uint64_t rowid;
+        if ((n = ReadVarint(p, pageEnd, rowid)) == 0) {
+            return false;
+        }
+        p += n;
+    }
+    localSize = GetLocalPayloadSize(payloadSize, image.usableSize, type == kLeafTablePage);
+    const size_t needed = localSize + (localSize < payloadSize ? 4 : 0);
+    if (p > pageEnd || size_t(pageEnd - p) < needed) {
+        return false;
+    }
+    payload = p;
+    return true;
+}
+
+/**
+ * Parse one page for the sequential pass. Pages that are not b-tree pages, or are malformed, get type 0.
+ */
+static void ParsePage(const DatabaseFile& image, uint32_t pgno, const uint8_t* page, PageInfo& info, std::vector<uint32_t>& children) {
+    const size_t headerOffset = pgno == 1 ? kDatabaseHeaderSize : 0;
+    const uint8_t* pageEnd = page + image.usableSize;
+    const uint8_t* header = page + headerOffset;
+    const uint8_t type = header[0];
+    if (type != kInteriorIndexPage && type != kInteriorTablePage && type != kLeafIndexPage && type != kLeafTablePage) {
+        return;
+    }
+    const bool isInterior = IsInteriorPage(type);
+    const size_t headerSize = isInterior ? 12 : 8;
+    const uint16_t cellCount = BinarySpan::LoadBe<uint16_t>(header + 3);
+    const size_t cellPointersEnd = headerOffset + headerSize + size_t(cellCount) * 2;
+    uint32_t contentStart = BinarySpan::LoadBe<uint16_t>(header + 5);
+    if (contentStart == 0) {
+        contentStart = 65536;
+    }
+    if (cellPointersEnd > image.usableSize || contentStart < cellPointersEnd || contentStart > image.usableSize) {
+        return;
+    }
+    uint64_t freeBytes = contentStart - cellPointersEnd + header[7];
+    // the freeblocks are a list sorted by offset, which also bounds the walk
+    uint32_t freeblock = BinarySpan::LoadBe<uint16_t>(header + 1);
+    while (freeblock != 0) {
+        if (freeblock < cellPointersEnd || freeblock + 4 > image.usableSize) {
+            return;
+        }
+        const uint32_t next = BinarySpan::LoadBe<uint16_t>(page + freeblock);
+        freeBytes += BinarySpan::LoadBe<uint16_t>(page + freeblock + 2);
+        if (next != 0 && next <= freeblock) {
+            return;
+        }
+        freeblock = next;
+    }
+    uint64_t payloadBytes = 0;
+    uint32_t overflowPages = 0;
+    uint16_t overflowChains = 0;
+    const auto childBegin = uint32_t(children.size());
+    for (uint16_t i = 0; i < cellCount; i++) {
+        const uint32_t cellOffset = BinarySpan::LoadBe<uint16_t>(header + headerSize + size_t(i) * 2);
+        if (cellOffset < contentStart || cellOffset >= image.usableSize) {
+            children.resize(childBegin);
+            return;
+        }
+        const uint8_t* cell = page + cellOffset;
+        if (isInterior) {
+            if (cellOffset + 4 > image.usableSize) {
+                children.resize(childBegin);
+                return;
+            }
+            children.push_back(BinarySpan::LoadBe<uint32_t>(cell));
+        }
+        uint64_t payloadSize;
+        const uint8_t* payload;
+        uint64_t localSize;
+        if (LocateCellPayload(image, type, cell, pageEnd, payloadSize, payload, localSize)) {
+            payloadBytes += payloadSize;
+            if (localSize < payloadSize) {
+                overflowChains++;
+                overflowPages += uint32_t((payloadSize - localSize + image.usableSize - 5) / (image.usableSize - 4));
+            }
+        }
+    }
+    if (isInterior) {
+        children.push_back(BinarySpan::LoadBe<uint32_t>(header + 8));
+    }
+    info.type = type;
+    info.cellCount = cellCount;
+    info.childBegin = childBegin;
+    info.freeBytes = uint32_t(freeBytes);
+    info.payloadBytes = payloadBytes;
+    info.overflowPages = overflowPages;
+    info.overflowChains = overflowChains;
+}
+
+/**
+ * Copy the whole payload of a cell, following the overflow chain.
+ * @return false if the chain is broken
+ */
+static bool ReadCellPayload(const DatabaseFile& image, uint8_t type, const uint8_t* cell, const uint8_t* pageEnd, std::string& out,
+                            std::vector<uint8_t>& overflowBuffer) {
+    uint64_t payloadSize;
+    const uint8_t* payload;
+    uint64_t localSize;
+    if (!LocateCellPayload(image, type, cell, pageEnd, payloadSize, payload, localSize)) {
+        return false;
+    }
+    // schema records are small, anything huge here is corruption
+    if (payloadSize > 16 * 1024 * 1024) {
+        return false;
+    }
+    out.assign(reinterpret_cast<const char*>(payload), localSize);
+    uint32_t next = localSize < payloadSize ? BinarySpan::LoadBe<uint32_t>(payload + localSize) : 0;
+    for (uint32_t hops = 0; out.size() < payloadSize; hops++) {
+        const uint8_t* overflow = image.ReadPage(next, overflowBuffer);
+        if (overflow == nullptr || hops >= image.pageCount) {
+            return false;
+        }
+        const size_t chunk = std::min<size_t>(payloadSize - out.size(), image.usableSize - 4);
+        out.append(reinterpret_cast<const char*>(overflow + 4), chunk);
+        next = BinarySpan::LoadBe<uint32_t>(overflow);
+    }
+    return true;
+}
+
+struct SchemaEntry {
+    std::string type;
+    std::string name;
+    std::string tableName;
+    uint32_t rootPage = 0;
+};
+
+/**
+ * Decode the first four columns of a sqlite_schema record: type, name, tbl_name and rootpage.
+ */
+static bool DecodeSchemaRecord(std::string_view record, SchemaEntry& entry) {
+    const auto* begin = reinterpret_cast<const uint8_t*>(record.data());
+    const uint8_t* end = begin + record.size();
+    uint64_t headerSize;
+    size_t n = ReadVarint(begin, end, headerSize);
+    if (n == 0 || headerSize > record.size()) {
+        return false;
+    }
+    const uint8_t* typePtr = begin + n;
+    const uint8_t* headerEnd = begin + headerSize;
+    const uint8_t* body = headerEnd;
+    for (int column = 0; column < 4; column++) {
+        uint64_t serialType;
+        if (typePtr >= headerEnd || (n = ReadVarint(typePtr, headerEnd, serialType)) == 0) {
+            return false;
+        }
+        typePtr += n;
+        size_t size;
+        if (serialType >= 12) {
+            size = size_t((serialType - 12) / 2);
+        } else {
+            static constexpr uint8_t kIntegerSizes[] = {0, 1, 2, 3, 4, 6, 8, 8, 0, 0, 0, 0};
+            size = kIntegerSizes[serialType];
+        }
+        if (size_t(end - body) < size) {
+            return false;
+        }
+        if (column < 3) {
+            std::string& text = column == 0 ? entry.type : column == 1 ? entry.name : entry.tableName;
+            text.assign(reinterpret_cast<const char*>(body), serialType >= 13 && serialType % 2 == 1 ? size : 0);
+        } else if (serialType >= 1 && serialType <= 6) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; i++) {
+                value = (value << 8) | body[i];
+            }
+            entry.rootPage = uint32_t(value);
+        } else {
+            // views and triggers have no b-tree, rootpage is 0 or NULL
+            entry.rootPage = serialType == 9 ? 1 : 0;
+        }
+        body += size;
+    }
+    return true;
+}
+
+std::string AnalyzeSqliteSpace(const std::string& path, SqliteSpaceReport& report) {
+    report = {};
+    auto_close_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd) {
+        return fmt::format("failed to open {}: {}", path, strerror(errno));
+    }
+    // the pass below is sequential, let the kernel read ahead aggressively
+    (void) posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    const off64_t fileSize = lseek64(fd.get(), 0, SEEK_END);
+    if (fileSize < 0) {
+        return fmt::format("failed to get the size of {}: {}", path, strerror(errno));
+    }
+    uint8_t header[kDatabaseHeaderSize];
+    if (PreadUpTo(fd.get(), header, sizeof(header), 0) != ssize_t(sizeof(header)) || memcmp(header, "SQLite format 3", 16) != 0) {
+        return "not a SQLite 3 database";
+    }
+    DatabaseFile image;
+    image.fd = fd.get();
+    image.pageSize = BinarySpan::LoadBe<uint16_t>(header + 16) == 1 ? 65536 : BinarySpan::LoadBe<uint16_t>(header + 16);
+    if (image.pageSize < 512 || (image.pageSize & (image.pageSize - 1)) != 0) {
+        return fmt::format("invalid page size {}", image.pageSize);
+    }
+    const uint8_t reservedBytes = header[20];
+    if (image.pageSize - reservedBytes < 480) {
+        return fmt::format("invalid reserved size {}", reservedBytes);
+    }
+    image.usableSize = image.pageSize - reservedBytes;
+    // the in-header page count is only valid if it was written by the same change as the change counter
+    const uint32_t headerPageCount = BinarySpan::LoadBe<uint32_t>(header + 28);
+    const bool headerPageCountValid = headerPageCount != 0 && BinarySpan::LoadBe<uint32_t>(header + 24) == BinarySpan::LoadBe<uint32_t>(header + 92);
+    const auto filePageCount = uint32_t(std::min<uint64_t>(uint64_t(fileSize) / image.pageSize, UINT32_MAX - 1));
+    image.pageCount = headerPageCountValid ? std::min(headerPageCount, filePageCount) : filePageCount;
+    if (image.pageCount == 0) {
+        return "empty database";
+    }
+    if (BinarySpan::LoadBe<uint32_t>(header + 56) != 1) {
+        return "only UTF-8 databases are supported";
+    }
+    report.pageSize = image.pageSize;
+    report.pageCount = image.pageCount;
+
+    // pass 1: every page, in file order, several pages per read
+    std::vector<PageInfo> pages(size_t(image.pageCount) + 1);
+    std::vector<uint32_t> children;
+    const uint32_t pagesPerRead = std::max<uint32_t>(1, uint32_t(kSequentialReadSize / image.pageSize));
+    std::vector<uint8_t> readBuffer(size_t(pagesPerRead) * image.pageSize);
+    for (uint32_t first = 1; first <= image.pageCount; first += pagesPerRead) {
+        const uint32_t count = std::min(pagesPerRead, image.pageCount - first + 1);
+        const ssize_t n = PreadUpTo(fd.get(), readBuffer.data(), size_t(count) * image.pageSize, uint64_t(first - 1) * image.pageSize);
+        if (n < 0) {
+            return fmt::format("failed to read {}: {}", path, strerror(errno));
+        }
+        // the file may have been truncated since its size was taken, the missing pages stay invalid
+        const auto pagesRead = uint32_t(size_t(n) / image.pageSize);
+        for (uint32_t i = 0; i < pagesRead; i++) {
+            ParsePage(image, first + i, readBuffer.data() + size_t(i) * image.pageSize, pages[first + i], children);
+        }
+        if (pagesRead < count) {
+            break;
+        }
+    }
+
+    // pass 2: walk the b-trees in memory, each page is owned by at most one b-tree
+    std::vector<bool> owned(size_t(image.pageCount) + 1, false);
+    std::vector<uint32_t> stack;
+    const auto walkBtree = [&](uint32_t root, SqliteBtreeSpace* space, auto&& onLeafPage) {
+        if (root == 0 || root > image.pageCount) {
+            return;
+        }
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const uint32_t pgno = stack.back();
+            stack.pop_back();
+            if (pgno == 0 || pgno > image.pageCount || owned[pgno] || pages[pgno].type == 0) {
+                continue;
+            }
+            const PageInfo& info = pages[pgno];
+            // a table b-tree only links to table pages, and an index b-tree to index pages
+            if (pgno != root && IsTablePage(info.type) != IsTablePage(pages[root].type)) {
+                continue;
+            }
+            owned[pgno] = true;
+            if (IsInteriorPage(info.type)) {
+                stack.insert(stack.end(), children.begin() + info.childBegin, children.begin() + info.childBegin + info.cellCount + 1);
+            } else {
+                onLeafPage(pgno);
+            }
+            if (space != nullptr) {
+                (IsInteriorPage(info.type) ? space->interiorPages : space->leafPages)++;
+                // index interior cells hold keys too, table interior cells only hold rowids
+                if (info.type != kInteriorTablePage) {
+                    space->entries += info.cellCount;
+                }
+                space->payloadBytes += info.payloadBytes;
+                space->unusedBytes += info.freeBytes;
+                space->overflowPages += info.overflowPages;
+                space->overflowChains += info.overflowChains;
+            }
+        }
+    };
+
+    std::vector<SchemaEntry> schema;
+    std::string record;
+    std::vector<uint8_t> overflowBuffer;
+    walkBtree(kSchemaRootPage, nullptr, [&](uint32_t pgno) {
+        if (pages[pgno].type != kLeafTablePage) {
+            return;
+        }
+        // the page is read again and may have changed since pass 1, so every offset is checked again
+        const uint8_t* page = image.ReadPage(pgno, readBuffer);
+        if (page == nullptr) {
+            return;
+        }
+        const uint8_t* pageHeader = page + (pgno == 1 ? kDatabaseHeaderSize : 0);
+        const uint16_t cellCount = BinarySpan::LoadBe<uint16_t>(pageHeader + 3);
+        if (pageHeader[0] != kLeafTablePage || size_t(pageHeader - page) + 8 + size_t(cellCount) * 2 > image.usableSize) {
+            return;
+        }
+        for (uint16_t i = 0; i < cellCount; i++) {
+            const uint32_t cellOffset = BinarySpan::LoadBe<uint16_t>(pageHeader + 8 + size_t(i) * 2);
+            if (cellOffset >= image.usableSize) {
+                continue;
+            }
+            SchemaEntry entry;
+            if (ReadCellPayload(image, kLeafTablePage, page + cellOffset, page + image.usableSize, record, overflowBuffer)
+                    && DecodeSchemaRecord(record, entry) && entry.rootPage != 0 && (entry.type == "table" || entry.type == "index")) {
+                schema.push_back(std::move(entry));
+            }
+        }
+    });
+    if (pages[kSchemaRootPage].type != kLeafTablePage && pages[kSchemaRootPage].type != kInteriorTablePage) {
+        return "malformed sqlite_schema";
+    }
+    // walk the schema again to account for it like any other table
+    std::fill(owned.begin(), owned.end(), false);
+    const auto noLeafCallback = [](uint32_t) {};
+    auto& schemaSpace = report.btrees.emplace_back();
+    schemaSpace.name = "sqlite_schema";
+    schemaSpace.tableName = schemaSpace.name;
+    schemaSpace.rootPage = kSchemaRootPage;
+    walkBtree(kSchemaRootPage, &schemaSpace, noLeafCallback);
+    for (auto& entry: schema) {
+        auto& space = report.btrees.emplace_back();
+        space.name = std::move(entry.name);
+        space.tableName = std::move(entry.tableName);
+        space.isIndex = entry.type == "index";
+        space.rootPage = entry.rootPage;
+        walkBtree(entry.rootPage, &space, noLeafCallback);
+    }
+
+    // the freelist is a chain of trunk pages, each listing leaf pages
+    uint64_t freelistPages = 0;
+    uint32_t trunk = BinarySpan::LoadBe<uint32_t>(header + 32);
+    for (uint32_t hops = 0; trunk != 0 && hops < image.pageCount; hops++) {
+        const uint8_t* page = image.ReadPage(trunk, readBuffer);
+        if (page == nullptr) {
+            break;
+        }
+        freelistPages += 1 + std::min<uint32_t>(BinarySpan::LoadBe<uint32_t>(page + 4), image.usableSize / 4 - 2);
+        trunk = BinarySpan::LoadBe<uint32_t>(page);
+    }
+    report.freelistPages = std::min<uint64_t>(freelistPages, image.pageCount);
+
+    uint64_t accountedPages = report.freelistPages;
+    for (const auto& space: report.btrees) {
+        accountedPages += space.leafPages + space.interiorPages + space.overflowPages;
+    }
+    report.otherPages = accountedPages < report.pageCount ? report.pageCount - accountedPages : 0;
+    return {};
+}
+
+}
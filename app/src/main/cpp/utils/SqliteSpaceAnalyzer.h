@@ -0,0 +1,61 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_SQLITESPACEANALYZER_H
+#define QAUXV_SQLITESPACEANALYZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+struct SqliteBtreeSpace {
+    // the table or index name, "sqlite_schema" for the schema table
+    std::string name;
+    // the table the b-tree belongs to, the same as name for tables
+    std::string tableName;
+    bool isIndex = false;
+    uint32_t rootPage = 0;
+    uint64_t leafPages = 0;
+    uint64_t interiorPages = 0;
+    uint64_t overflowPages = 0;
+    // the number of cells that spill into overflow pages, i.e. overflow chains
+    uint64_t overflowChains = 0;
+    // rows for tables, keys for indexes
+    uint64_t entries = 0;
+    // the declared payload size of all cells, including the parts in overflow pages
+    uint64_t payloadBytes = 0;
+    // free space on the b-tree pages, i.e. the gap, freeblocks and fragments
+    uint64_t unusedBytes = 0;
+};
+
+struct SqliteSpaceReport {
+    uint32_t pageSize = 0;
+    uint64_t pageCount = 0;
+    uint64_t freelistPages = 0;
+    // pages not reachable from any b-tree or the freelist, e.g. pointer map pages, the lock-byte page or corrupt pages
+    uint64_t otherPages = 0;
+    std::vector<SqliteBtreeSpace> btrees;
+};
+
+/**
+ * Compute the space used by every table and index of a SQLite database, without SQLite and without any lock.
+ *
+ * The file is read with pread, never mapped, so a concurrent truncation or VACUUM can not raise SIGBUS.
+ * Every page is parsed in one sequential pass, remembering the child pointers
+ * of interior pages. The b-trees are then walked from the roots listed in sqlite_schema using what that pass remembered,
+ * so pages that merely look like b-tree pages (overflow or free pages) are never attributed to a b-tree.
+ * Only the main database file is read: changes still in the -wal file are not seen, and a database being written
+ * concurrently may give slightly inconsistent numbers, but never a crash on the parsing side.
+ *
+ * @param path the database file
+ * @param report receives the result
+ * @return empty string on success, or an error message
+ */
+[[nodiscard]] std::string AnalyzeSqliteSpace(const std::string& path, SqliteSpaceReport& report);
+
+}
+
+#endif //QAUXV_SQLITESPACEANALYZER_H
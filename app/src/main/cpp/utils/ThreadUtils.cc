@@ -6,25 +6,63 @@
 
 #include <unistd.h>
 #include <ucontext.h>
+#include <atomic>
 #include <cinttypes>
+#include <mutex>
 #include <sstream>
 #include <android-base/stringprintf.h>
+#include <unwindstack/Elf.h>
+#include <unwindstack/Maps.h>
 
 using namespace unwindstack;
 using namespace android::base;
 
 namespace utils {
 
+static std::mutex sLocalUnwinderMutex;
+static std::atomic<bool> sLocalUnwinderMapsStale = false;
+
+// guarded by sLocalUnwinderMutex
+static AndroidLocalUnwinder& GetLocalUnwinderLocked() {
+    static AndroidLocalUnwinder* sUnwinder = [] {
+        // the ELF objects are shared by the maps of all unwinders instead of being re-created by each one
+        Elf::SetCachingEnabled(true);
+        // never freed, it may be used until the process exits
+        return new AndroidLocalUnwinder();
+    }();
+    return *sUnwinder;
+}
+
+bool UnwindLocalThread(uint32_t tid, AndroidUnwinderData& data) {
+    std::scoped_lock lock(sLocalUnwinderMutex);
+    auto& unwinder = GetLocalUnwinderLocked();
+    if (sLocalUnwinderMapsStale.exchange(false, std::memory_order_acq_rel)) {
+        if (ErrorData error; unwinder.Initialize(error)) {
+            // AndroidLocalUnwinder always uses LocalUpdatableMaps
+            static_cast<LocalUpdatableMaps*>(unwinder.GetMaps())->Reparse();
+        }
+    }
+    return unwinder.Unwind(tid, data);
+}
+
+std::string FormatLocalFrame(const FrameData& frame) {
+    std::scoped_lock lock(sLocalUnwinderMutex);
+    return GetLocalUnwinderLocked().FormatFrame(frame);
+}
+
+void InvalidateLocalUnwinderMaps() noexcept {
+    sLocalUnwinderMapsStale.store(true, std::memory_order_release);
+}
+
 void DumpThreadStackTraceToLogcat(uint32_t tid, android_LogPriority priority) {
     AndroidUnwinderData data;
-    AndroidLocalUnwinder unwinder;
-    bool result = unwinder.Unwind(tid, data);
+    bool result = UnwindLocalThread(tid, data);
     if (!result) {
         LOGE("Unwind failed for tid: {}, error: {}", tid, data.GetErrorString());
         return;
     }
     for (const auto& frame: data.frames) {
-        __android_log_write(priority, "QAuxv", unwinder.FormatFrame(frame).c_str());
+        __android_log_write(priority, "QAuxv", FormatLocalFrame(frame).c_str());
     }
 }
 
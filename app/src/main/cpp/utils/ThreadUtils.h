@@ -6,6 +6,7 @@
 #define QAUXILIARY_THREADUTILS_H
 
 #include <cstdint>
+#include <string>
 #include <unwindstack/AndroidUnwinder.h>
 
 #include "utils/Log.h"
@@ -18,6 +19,26 @@ void DumpThreadStackTraceToLogcat(uint32_t tid, android_LogPriority priority);
 
 void DumpCurrentProcessWithUContext(void* uctx, android_LogPriority priority);
 
+/**
+ * Unwind a thread of the current process with the process-wide unwinder.
+ * The maps and the ELF objects of the unwinder are kept across calls, so only the first call pays for parsing them.
+ * Calls are serialized, this function may be called from any thread.
+ * @param tid the thread id, another thread is interrupted with a signal to get its registers
+ * @param data receives the frames and the error
+ * @return true on success
+ */
+bool UnwindLocalThread(uint32_t tid, unwindstack::AndroidUnwinderData& data);
+
+/**
+ * Format a frame returned by UnwindLocalThread in the same way as the stack dumps.
+ */
+std::string FormatLocalFrame(const unwindstack::FrameData& frame);
+
+/**
+ * Make the process-wide unwinder re-read /proc/self/maps before the next unwind, e.g. after a library is loaded.
+ */
+void InvalidateLocalUnwinderMaps() noexcept;
+
 } // utils
 
 #endif //QAUXILIARY_THREADUTILS_H
@@ -0,0 +1,119 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#include "ZipArchive.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <optional>
+
+#include "utils/BinaryCursor.h"
+#include "utils/FileIo.h"
+
+namespace utils {
+
+static constexpr uint32_t kZipEndOfCentralDirSignature = 0x06054b50u;
+static constexpr uint32_t kZipCentralDirFileHeaderSignature = 0x02014b50u;
+static constexpr uint32_t kZipLocalFileHeaderSignature = 0x04034b50u;
+static constexpr size_t kZipCentralDirFileHeaderSize = 46;
+static constexpr size_t kZipLocalFileHeaderSize = 30;
+
+std::optional<ZipEndOfCentralDirectory> FindZipEndOfCentralDirectory(BinarySpan tail) noexcept {
+    if (tail.size() < kZipEndOfCentralDirSize) {
+        return std::nullopt;
+    }
+    const size_t maxComment = std::min(tail.size() - kZipEndOfCentralDirSize, kZipMaxCommentSize);
+    for (size_t comment = 0; comment <= maxComment; comment++) {
+        const size_t offset = tail.size() - kZipEndOfCentralDirSize - comment;
+        uint32_t signature = 0;
+        uint16_t commentLength = 0;
+        ZipEndOfCentralDirectory eocd;
+        eocd.recordOffset = offset;
+        // a signature whose comment does not fit is part of a comment
+        if (tail.ReadLe(offset, signature) && signature == kZipEndOfCentralDirSignature
+                && tail.ReadLe(offset + 20, commentLength) && commentLength <= comment
+                && tail.ReadLe(offset + 10, eocd.entryCount) && tail.ReadLe(offset + 12, eocd.centralDirSize)
+                && tail.ReadLe(offset + 16, eocd.centralDirOffset)) {
+            return eocd;
+        }
+    }
+    return std::nullopt;
+}
+
+int ReadZipCentralDirectory(int fd, uint64_t fileSize, std::vector<ZipEntryInfo>& entries) {
+    entries.clear();
+    if (fileSize < kZipEndOfCentralDirSize) {
+        return EINVAL;
+    }
+    // the end of central directory record is followed by a comment of at most 64 KiB
+    const size_t tailSize = size_t(std::min<uint64_t>(fileSize, kZipEndOfCentralDirSize + kZipMaxCommentSize));
+    std::vector<uint8_t> tail(tailSize);
+    if (int err = PreadFully(fd, tail.data(), tailSize, fileSize - tailSize); err != 0) {
+        return err;
+    }
+    const auto eocd = FindZipEndOfCentralDirectory(BinarySpan(tail.data(), tail.size()));
+    if (!eocd) {
+        return EINVAL;
+    }
+    const uint16_t entryCount = eocd->entryCount;
+    const uint32_t centralDirSize = eocd->centralDirSize;
+    const uint32_t centralDirOffset = eocd->centralDirOffset;
+    if (uint64_t(centralDirOffset) + centralDirSize > fileSize) {
+        return EINVAL;
+    }
+    std::vector<uint8_t> centralDir(centralDirSize);
+    if (int err = PreadFully(fd, centralDir.data(), centralDirSize, centralDirOffset); err != 0) {
+        return err;
+    }
+    // every entry takes at least a fixed size header, do not trust the count beyond that
+    entries.reserve(std::min<size_t>(entryCount, centralDir.size() / kZipCentralDirFileHeaderSize));
+    BinaryCursor cursor(BinarySpan(centralDir.data(), centralDir.size()));
+    for (uint32_t i = 0; i < entryCount; i++) {
+        ZipEntryInfo entry;
+        uint32_t signature = 0;
+        uint16_t nameLength = 0;
+        uint16_t extraLength = 0;
+        uint16_t commentLength = 0;
+        BinarySpan name;
+        // the central directory file header, with the fields not needed here skipped
+        if (!cursor.ReadLe(signature) || signature != kZipCentralDirFileHeaderSignature
+                || !cursor.Skip(6) || !cursor.ReadLe(entry.compression) || !cursor.Skip(4)
+                || !cursor.ReadLe(entry.crc32) || !cursor.ReadLe(entry.compressedSize) || !cursor.ReadLe(entry.uncompressedSize)
+                || !cursor.ReadLe(nameLength) || !cursor.ReadLe(extraLength) || !cursor.ReadLe(commentLength)
+                || !cursor.Skip(8) || !cursor.ReadLe(entry.localHeaderOffset) || !cursor.ReadSpan(nameLength, name)) {
+            return EINVAL;
+        }
+        entry.name = std::string(name.AsStringView());
+        entries.push_back(std::move(entry));
+        // the extra field and the comment of the last entry may be truncated, they are not needed
+        if (!cursor.Skip(size_t(extraLength) + commentLength) && i + 1 < entryCount) {
+            return EINVAL;
+        }
+    }
+    return 0;
+}
+
+int GetZipEntryDataOffset(int fd, uint64_t fileSize, const ZipEntryInfo& entry, uint64_t& dataOffset) {
+    std::array<uint8_t, kZipLocalFileHeaderSize> localHeader = {};
+    if (int err = PreadFully(fd, localHeader.data(), localHeader.size(), entry.localHeaderOffset); err != 0) {
+        return err;
+    }
+    const BinarySpan header(localHeader.data(), localHeader.size());
+    uint32_t signature = 0;
+    uint16_t nameLength = 0;
+    uint16_t extraLength = 0;
+    if (!header.ReadLe(0, signature) || signature != kZipLocalFileHeaderSignature
+            || !header.ReadLe(26, nameLength) || !header.ReadLe(28, extraLength)) {
+        return EINVAL;
+    }
+    const uint64_t offset = uint64_t(entry.localHeaderOffset) + kZipLocalFileHeaderSize + nameLength + extraLength;
+    if (offset + entry.compressedSize > fileSize) {
+        return EINVAL;
+    }
+    dataOffset = offset;
+    return 0;
+}
+
+}
@@ -0,0 +1,73 @@
+//
+// Created by sulfate on 2026-10-17.
+//
+
+#ifndef QAUXV_ZIPARCHIVE_H
+#define QAUXV_ZIPARCHIVE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/BinaryCursor.h"
+
+namespace utils {
+
+// the compression methods an APK may use
+constexpr uint16_t kZipMethodStored = 0;
+constexpr uint16_t kZipMethodDeflated = 8;
+
+struct ZipEntryInfo {
+    std::string name;
+    uint16_t compression = 0;
+    uint32_t crc32 = 0;
+    uint32_t compressedSize = 0;
+    uint32_t uncompressedSize = 0;
+    uint32_t localHeaderOffset = 0;
+};
+
+// the fields of the end of central directory record which locate the central directory
+struct ZipEndOfCentralDirectory {
+    // the offset of the record in the data it was found in
+    size_t recordOffset = 0;
+    uint16_t entryCount = 0;
+    uint32_t centralDirSize = 0;
+    uint32_t centralDirOffset = 0;
+};
+
+// the fixed part of the end of central directory record, it is followed by a comment of at most 64 KiB
+constexpr size_t kZipEndOfCentralDirSize = 22;
+constexpr size_t kZipMaxCommentSize = 0xffff;
+
+/**
+ * Find the end of central directory record, the last one whose comment fits in the data.
+ * @param tail the end of a zip file, only the last kZipEndOfCentralDirSize + kZipMaxCommentSize bytes are looked at
+ * @return the record, or nullopt if there is none
+ */
+[[nodiscard]] std::optional<ZipEndOfCentralDirectory> FindZipEndOfCentralDirectory(BinarySpan tail) noexcept;
+
+/**
+ * Read the central directory of a zip file. Zip64 is not supported, APKs do not need it.
+ * @param fd the zip file
+ * @param fileSize the size of the zip file
+ * @param entries receives the entries, in central directory order
+ * @return 0 on success, EINVAL if the file is not a valid zip file, or errno
+ */
+[[nodiscard]] int ReadZipCentralDirectory(int fd, uint64_t fileSize, std::vector<ZipEntryInfo>& entries);
+
+/**
+ * Get the offset of the data of an entry, i.e. after its local header.
+ * The extra field of the local header may differ from the central directory one, e.g. alignment padding,
+ * so the local header is read.
+ * @param fd the zip file
+ * @param fileSize the size of the zip file
+ * @param entry the entry
+ * @param dataOffset receives the offset, the compressed data is guaranteed to be inside the file
+ * @return 0 on success, EINVAL if the local header is invalid, or errno
+ */
+[[nodiscard]] int GetZipEntryDataOffset(int fd, uint64_t fileSize, const ZipEntryInfo& entry, uint64_t& dataOffset);
+
+}
+
+#endif //QAUXV_ZIPARCHIVE_H
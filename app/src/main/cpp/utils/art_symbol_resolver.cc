@@ -61,7 +61,8 @@ const ModuleSymbolResolver* GetModuleSymbolResolver(std::string_view module_name
         return nullptr;
     }
     auto data = std::make_unique<ModuleInfoData>();
-    if (data->fileMap.mapFilePath(path.c_str()) != 0) {
+    // the mapping is kept for symbol lookups, which read the symbol tables sparsely
+    if (data->fileMap.mapFilePath(path.c_str(), true, 0, FileMemMap::AccessHint::kRandom) != 0) {
         return nullptr;
     }
     data->elfView.AttachFileMemMapping(data->fileMap.getAddress(), data->fileMap.getLength());
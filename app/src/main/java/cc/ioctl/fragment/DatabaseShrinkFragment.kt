@@ -27,6 +27,7 @@ import android.content.Context
 import android.database.sqlite.SQLiteDatabase
 import android.graphics.Typeface
 import android.os.Bundle
+import android.text.format.Formatter
 import android.text.Spannable
 import android.text.SpannableStringBuilder
 import android.text.method.LinkMovementMethod
@@ -53,6 +54,8 @@ import io.github.qauxv.R
 import io.github.qauxv.bridge.AppRuntimeHelper
 import io.github.qauxv.fragment.BaseRootLayoutFragment
 import io.github.qauxv.util.Log
+import io.github.qauxv.util.Natives
+import io.github.qauxv.util.SqliteSpaceReport
 import io.github.qauxv.util.NonUiThread
 import io.github.qauxv.util.SyncUtils
 import io.github.qauxv.util.SyncUtils.async
@@ -79,6 +82,10 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
     private val mTextItemList = ArrayList<SpannableStringBuilder>()
     private var mDatabase: SQLiteDatabase? = null
     private var mTableSizeLongOrErrorString = HashMap<String, Any>(16)
+    // table and index pages in bytes, from SqliteSpaceReport
+    private var mTableSpaceBytes = HashMap<String, Long>(16)
+    // tables whose count comes from the database file, which does not include the WAL
+    private val mTableCountFromFile = HashSet<String>(16)
 
     private var mTableListCache = ArrayList<String>()
     private var mTableListCacheNeedInvalidate = true
@@ -185,7 +192,8 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
 
     private fun calculateItemCountForeground() {
         val ctx = requireContext()
-        val db = mDatabase ?: return
+        val path = mDatabasePath ?: return
+        val db = mDatabase
         val tableList = getShowingTables()
         mIsCalcSize.set(false)
         if (mIsCalcSize.get()) {
@@ -207,7 +215,7 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
         }
         val dialog = AlertDialog.Builder(ctx)
             .setTitle("COUNT(*)")
-            .setMessage("正在计算表的数据量，请稍候...")
+            .setMessage("正在分析数据库文件，请稍候...")
             .setCancelable(false)
             .setNegativeButton("取消") { _, _ ->
                 mIsCalcSize.set(false)
@@ -215,16 +223,38 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
             .show()
         async {
             try {
-                for (i in 0 until unknownTables.size) {
+                // one sequential pass over the file gives the row count and size of every table, without touching the host's lock
+                val report = try {
+                    SqliteSpaceReport.analyze(path)
+                } catch (e: IOException) {
+                    Log.e("analyzeSqliteSpace failed, fall back to COUNT(*)", e)
+                    null
+                }
+                if (report != null) {
+                    val pagesByTable = report.pagesByTable
+                    for (btree in report.btrees) {
+                        if (!btree.isIndex) {
+                            mTableSizeLongOrErrorString[btree.name] = java.lang.Long.valueOf(btree.entries)
+                            mTableSpaceBytes[btree.name] = (pagesByTable[btree.name] ?: 0L) * report.pageSize
+                            mTableCountFromFile.add(btree.name)
+                        }
+                    }
+                }
+                // tables missing from the file, e.g. created after the last checkpoint and still only in the -wal file, fall back to COUNT(*)
+                val pendingTables = unknownTables.filter { mTableSizeLongOrErrorString[it] == null }
+                if (db == null || pendingTables.isEmpty()) {
+                    return@async
+                }
+                for (i in pendingTables.indices) {
                     if (!mIsCalcSize.get()) {
                         runOnUiThread { dialog.dismiss() }
                         return@async
                     } else {
                         runOnUiThread {
-                            dialog.setMessage("${unknownTables[i]}\n${i + 1}/${unknownTables.size} ${(i + 1) * 100 / unknownTables.size}%")
+                            dialog.setMessage("${pendingTables[i]}\n${i + 1}/${pendingTables.size} ${(i + 1) * 100 / pendingTables.size}%")
                         }
                     }
-                    getTableSize(db, unknownTables[i])
+                    getTableSize(db, pendingTables[i])
                 }
             } catch (e: Exception) {
                 if (isAdded) {
@@ -297,13 +327,14 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
         if (mCurrentUin < 10000) {
             return
         }
+        // uins are collected first and hashed in one native call, there may be thousands of them
+        val uins = ArrayList<String>(256)
         try {
             val troops = TroopManagerHelper.getTroopInfoList()
             troops?.let {
                 for (troop in it) {
                     val uin = troop.troopuin!!
-                    val md5 = uinToMd5(uin)
-                    mMd5ToUinLut[md5] = uin
+                    uins.add(uin)
                     mTroopName[uin] = troop.troopname
                 }
             }
@@ -319,18 +350,31 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
                     if (nick.isNullOrEmpty()) {
                         nick = friend.value.nick
                     }
-                    val md5 = uinToMd5(uin)
-                    mMd5ToUinLut[md5] = uin
+                    uins.add(uin)
                     mFriendName[uin] = nick
                 }
             }
         } catch (e: Exception) {
             Log.e(e)
         }
-        val specialUin = arrayOf("9999", "9987", "9986", "9915")
-        for (uin in specialUin) {
-            val md5 = uinToMd5(uin)
-            mMd5ToUinLut[md5] = uin
+        uins.addAll(arrayOf("9999", "9987", "9986", "9915"))
+        // only canonical decimal strings round trip through long, anything else keeps the per-uin path
+        val numeric = uins.filter { it.toLongOrNull()?.toString() == it }
+        val numericMd5 = try {
+            Natives.uinToMd5HexBatch(LongArray(numeric.size) { numeric[it].toLong() })
+        } catch (e: LinkageError) {
+            Log.e(e)
+            null
+        }
+        if (numericMd5 != null) {
+            for (i in numeric.indices) {
+                mMd5ToUinLut[numericMd5[i]] = numeric[i]
+            }
+        }
+        for (uin in uins) {
+            if (numericMd5 == null || uin.toLongOrNull()?.toString() != uin) {
+                mMd5ToUinLut[uinToMd5(uin)] = uin
+            }
         }
     }
 
@@ -422,11 +466,14 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
                         val sb = SpannableStringBuilder()
                         mTextItemList.add(sb)
                         val v: Any? = mTableSizeLongOrErrorString[table]
-                        val sizeDesc: String = if (v is Long) {
-                            "COUNT(*)=${v}"
+                        var sizeDesc: String = if (v is Long) {
+                            "COUNT(*)${if (table in mTableCountFromFile) "≈" else "="}${v}"
                         } else {
                             v?.toString() ?: "COUNT(*)=???"
                         }
+                        mTableSpaceBytes[table]?.let {
+                            sizeDesc += ", " + Formatter.formatShortFileSize(ctx, it)
+                        }
                         sb.apply {
                             val parts = table.split("_")
                             var shouldShowFriendChatHistory: Long = 0
@@ -565,6 +612,7 @@ class DatabaseShrinkFragment : BaseRootLayoutFragment() {
                 }
             }
             mTableSizeLongOrErrorString[table] = java.lang.Long.valueOf(size)
+            mTableCountFromFile.remove(table)
             size
         } catch (e: Exception) {
             mTableSizeLongOrErrorString[table] = e.toString()
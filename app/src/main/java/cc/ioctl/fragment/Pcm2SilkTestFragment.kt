@@ -35,7 +35,9 @@ import io.github.qauxv.fragment.BaseRootLayoutFragment
 import io.github.qauxv.util.Log
 import io.github.qauxv.util.NonUiThread
 import io.github.qauxv.util.SafUtils
+import io.github.qauxv.util.SyncUtils
 import io.github.qauxv.util.SyncUtils.runOnUiThread
+import io.github.qauxv.util.ptt.SilkBatchTranscodeJob
 import io.github.qauxv.util.ptt.SilkEncodeUtils
 import java.io.File
 
@@ -110,6 +112,10 @@ class Pcm2SilkTestFragment : BaseRootLayoutFragment() {
                     errorDialog("比特率必须是整数")
                     return@setOnClickListener
                 }
+                if (input.startsWith("/") && File(input).isDirectory) {
+                    convertDirectoryToSilk(File(input), output, sampleRate, bitRate, tencentFormat)
+                    return@setOnClickListener
+                }
                 runOnUiThread {
                     if (convertToSilk(input, output, sampleRate, bitRate, tencentFormat)) {
                         runOnUiThread {
@@ -159,4 +165,81 @@ class Pcm2SilkTestFragment : BaseRootLayoutFragment() {
         }
     }
 
+    /**
+     * Convert every file in the directory to a .slk file with the same name in the output directory, in parallel.
+     */
+    private fun convertDirectoryToSilk(inputDir: File, outputPath: String, sampleRate: Int, bitRate: Int, tencentFormat: Boolean) {
+        if (!outputPath.startsWith("/")) {
+            errorDialog("输入为目录时, 输出路径必须是目录的绝对路径")
+            return
+        }
+        val outputDir = File(outputPath)
+        val inputs = inputDir.listFiles()?.filter { it.isFile }?.sortedBy { it.name }.orEmpty()
+        if (inputs.isEmpty()) {
+            errorDialog("目录中没有文件")
+            return
+        }
+        if (!outputDir.isDirectory && !outputDir.mkdirs()) {
+            errorDialog("无法创建输出目录")
+            return
+        }
+        val outputs = inputs.map { File(outputDir, it.nameWithoutExtension + ".slk").path }
+        val options = SilkBatchTranscodeJob.Options().apply {
+            inputFormat = SilkEncodeUtils.INPUT_FORMAT_PCM_16LE
+            inputChannels = 1
+            inputSampleRate = sampleRate
+            this.sampleRate = sampleRate
+            this.bitRate = bitRate
+            packetSize = 320
+            tencent = tencentFormat
+        }
+        val job = try {
+            SilkBatchTranscodeJob.start(inputs.map { it.path }, outputs, options, Runtime.getRuntime().availableProcessors())
+        } catch (e: Exception) {
+            errorDialog("转换失败", e)
+            return
+        }
+        val progressDialog = AlertDialog.Builder(requireContext())
+            .setTitle("批量转换")
+            .setMessage("0 / ${inputs.size}")
+            .setCancelable(false)
+            .setNegativeButton("取消") { _, _ -> job.cancel() }
+            .show()
+        SyncUtils.async {
+            var finished = 0
+            var cancelled = 0
+            val errors = ArrayList<String>()
+            job.use {
+                it.run(object : SilkBatchTranscodeJob.Callback {
+                    override fun onFileStarted(index: Int) = Unit
+
+                    override fun onFileSucceeded(index: Int, outputBytes: Long) {
+                        finished++
+                        runOnUiThread { progressDialog.setMessage("$finished / ${inputs.size}") }
+                    }
+
+                    override fun onFileFailed(index: Int, error: String) {
+                        finished++
+                        errors.add(inputs[index].name + ": " + error)
+                        runOnUiThread { progressDialog.setMessage("$finished / ${inputs.size}") }
+                    }
+
+                    override fun onFileCancelled(index: Int) {
+                        finished++
+                        cancelled++
+                    }
+                })
+            }
+            runOnUiThread {
+                progressDialog.dismiss()
+                if (errors.isEmpty()) {
+                    val msg = if (cancelled == 0) "转换完成" else "已取消, $cancelled 个文件未转换"
+                    binding?.let { Snackbar.make(it.root, msg, Snackbar.LENGTH_SHORT).show() }
+                } else {
+                    errorDialog("${errors.size} 个文件转换失败\n" + errors.joinToString("\n"))
+                }
+            }
+        }
+    }
+
 }
@@ -0,0 +1,277 @@
+/*
+ * QAuxiliary - An Xposed module for QQ/TIM
+ * Copyright (C) 2019-2022 qwq233@qwq2333.top
+ * https://github.com/cinit/QAuxiliary
+ *
+ * This software is non-free but opensource software: you can redistribute it
+ * and/or modify it under the terms of the GNU Affero General Public License
+ * as published by the Free Software Foundation; either
+ * version 3 of the License, or any later version and our eula as published
+ * by QAuxiliary contributors.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * and eula along with this software.  If not, see
+ * <https://www.gnu.org/licenses/>
+ * <https://github.com/cinit/QAuxiliary/blob/master/LICENSE.md>.
+ */
+package cc.ioctl.util;
+
+import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
+import java.io.Closeable;
+import java.io.IOException;
+
+/**
+ * A forward-only cursor over an Android binary XML file, e.g. an extracted AndroidManifest.xml.
+ * <p>
+ * The file is mapped and parsed in place natively, strings are only decoded when they are asked for, so callers that
+ * only need a few attributes do not pay for the whole document. Namespace declarations are not reported.
+ * <p>
+ * This class is not thread safe.
+ */
+public final class BinaryXmlCursor implements Closeable {
+
+    // the same values as XmlPullParser
+    public static final int END_DOCUMENT = 1;
+    public static final int START_TAG = 2;
+    public static final int END_TAG = 3;
+    public static final int TEXT = 4;
+
+    public static final int NO_INDEX = -1;
+
+    // keep in sync with BinaryXmlBridge.cc
+    private static final int STATE_DEPTH = 0;
+    private static final int STATE_LINE_NUMBER = 1;
+    private static final int STATE_COMMENT = 2;
+    private static final int STATE_NAMESPACE = 3;
+    private static final int STATE_NAME = 4;
+    private static final int STATE_TEXT_DATA_TYPE = 5;
+    private static final int STATE_TEXT_DATA = 6;
+    private static final int STATE_SIZE = 7;
+
+    private static final int ATTRIBUTE_NAMESPACE = 0;
+    private static final int ATTRIBUTE_NAME = 1;
+    private static final int ATTRIBUTE_RAW_VALUE = 2;
+    private static final int ATTRIBUTE_DATA_TYPE = 3;
+    private static final int ATTRIBUTE_DATA = 4;
+    private static final int ATTRIBUTE_RESOURCE_ID = 5;
+    private static final int ATTRIBUTE_SIZE = 6;
+
+    private static final int[] EMPTY_ATTRIBUTES = new int[0];
+
+    private long mHandle;
+    private int mEvent = 0;
+    private final int[] mState = new int[STATE_SIZE];
+    // fetched on demand for the current start tag
+    private int[] mAttributes = null;
+
+    private BinaryXmlCursor(long handle) {
+        mHandle = handle;
+    }
+
+    /**
+     * Open a binary XML file.
+     *
+     * @param path the file path
+     * @return the cursor, positioned before the first node
+     * @throws IOException if the file can not be mapped or is not a binary XML
+     */
+    @NonNull
+    public static BinaryXmlCursor open(@NonNull String path) throws IOException {
+        return new BinaryXmlCursor(nativeOpen(path));
+    }
+
+    /**
+     * Move to the next node.
+     *
+     * @return one of {@link #START_TAG}, {@link #END_TAG}, {@link #TEXT} or {@link #END_DOCUMENT}
+     * @throws IOException if the document is malformed
+     */
+    public int next() throws IOException {
+        mAttributes = null;
+        mEvent = nativeNext(mHandle, mState);
+        return mEvent;
+    }
+
+    public int getEventType() {
+        return mEvent;
+    }
+
+    /**
+     * @return the element depth, 1 for the root element, both for its start and end tag
+     */
+    public int getDepth() {
+        return mState[STATE_DEPTH];
+    }
+
+    public int getLineNumber() {
+        return mState[STATE_LINE_NUMBER];
+    }
+
+    @Nullable
+    public String getComment() {
+        return getString(mState[STATE_COMMENT]);
+    }
+
+    /**
+     * @return the namespace uri of the current tag, or null
+     */
+    @Nullable
+    public String getNamespace() {
+        return mEvent == TEXT ? null : getString(mState[STATE_NAMESPACE]);
+    }
+
+    /**
+     * @return the name of the current tag
+     */
+    @Nullable
+    public String getName() {
+        return mEvent == TEXT ? null : getString(mState[STATE_NAME]);
+    }
+
+    /**
+     * @return the text of the current text node
+     */
+    @Nullable
+    public String getText() {
+        return mEvent == TEXT ? getString(mState[STATE_NAME]) : null;
+    }
+
+    public byte getTextDataType() {
+        return (byte) mState[STATE_TEXT_DATA_TYPE];
+    }
+
+    public int getTextData() {
+        return mState[STATE_TEXT_DATA];
+    }
+
+    public int getAttributeCount() {
+        return attributes().length / ATTRIBUTE_SIZE;
+    }
+
+    @Nullable
+    public String getAttributeNamespace(int index) {
+        return getString(attribute(index, ATTRIBUTE_NAMESPACE));
+    }
+
+    @Nullable
+    public String getAttributeName(int index) {
+        return getString(attribute(index, ATTRIBUTE_NAME));
+    }
+
+    /**
+     * @return the resource id of the attribute name, e.g. 0x01010003 for android:name, or 0
+     */
+    public int getAttributeResourceId(int index) {
+        return attribute(index, ATTRIBUTE_RESOURCE_ID);
+    }
+
+    /**
+     * @return the Res_value data type, see {@link BinaryXmlParser.XmlNode.Res}
+     */
+    public byte getAttributeDataType(int index) {
+        return (byte) attribute(index, ATTRIBUTE_DATA_TYPE);
+    }
+
+    public int getAttributeData(int index) {
+        return attribute(index, ATTRIBUTE_DATA);
+    }
+
+    /**
+     * @return the string value of the attribute, either the original text or the string data, or null if the value
+     * was compiled to a non-string type
+     */
+    @Nullable
+    public String getAttributeValue(int index) {
+        int raw = attribute(index, ATTRIBUTE_RAW_VALUE);
+        if (raw != NO_INDEX) {
+            return getString(raw);
+        }
+        if (getAttributeDataType(index) == BinaryXmlParser.XmlNode.Res.TYPE_STRING) {
+            return getString(getAttributeData(index));
+        }
+        return null;
+    }
+
+    /**
+     * Find an attribute of the current start tag by name, ignoring the namespace. No string is decoded.
+     *
+     * @return the attribute index, or -1 if not found
+     */
+    public int findAttribute(@NonNull String name) {
+        if (mEvent != START_TAG) {
+            return -1;
+        }
+        return nativeFindAttribute(mHandle, name);
+    }
+
+    /**
+     * Find an attribute of the current start tag by resource id, e.g. 0x01010003 for android:name.
+     *
+     * @return the attribute index, or -1 if not found
+     */
+    public int findAttributeByResourceId(int resourceId) {
+        int[] attributes = attributes();
+        for (int i = 0; i < attributes.length / ATTRIBUTE_SIZE; i++) {
+            if (attributes[i * ATTRIBUTE_SIZE + ATTRIBUTE_RESOURCE_ID] == resourceId) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Decode a string pool entry.
+     *
+     * @return the string, or null for {@link #NO_INDEX} or an invalid index
+     */
+    @Nullable
+    public String getString(int index) {
+        if (index == NO_INDEX) {
+            return null;
+        }
+        return nativeGetString(mHandle, index);
+    }
+
+    @Override
+    public void close() {
+        if (mHandle != 0) {
+            nativeClose(mHandle);
+            mHandle = 0;
+        }
+    }
+
+    private int[] attributes() {
+        if (mAttributes == null) {
+            mAttributes = mEvent == START_TAG ? nativeGetAttributes(mHandle) : EMPTY_ATTRIBUTES;
+        }
+        return mAttributes;
+    }
+
+    private int attribute(int index, int field) {
+        int[] attributes = attributes();
+        if (index < 0 || index >= attributes.length / ATTRIBUTE_SIZE) {
+            throw new IndexOutOfBoundsException("attribute index " + index + " out of range");
+        }
+        return attributes[index * ATTRIBUTE_SIZE + field];
+    }
+
+    private static native long nativeOpen(@NonNull String path) throws IOException;
+
+    private static native void nativeClose(long handle);
+
+    private static native int nativeNext(long handle, @NonNull int[] state) throws IOException;
+
+    @NonNull
+    private static native int[] nativeGetAttributes(long handle);
+
+    private static native int nativeFindAttribute(long handle, @NonNull String name);
+
+    @Nullable
+    private static native String nativeGetString(long handle, int index);
+}
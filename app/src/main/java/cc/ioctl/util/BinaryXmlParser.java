@@ -24,6 +24,7 @@ package cc.ioctl.util;
 import io.github.qauxv.util.Log;
 import java.io.ByteArrayOutputStream;
 import java.io.FileInputStream;
+import java.io.IOException;
 import java.nio.charset.StandardCharsets;
 import java.util.ArrayList;
 import java.util.HashMap;
@@ -61,6 +62,14 @@ public class BinaryXmlParser {
     public static final int NULL = 0xFFFFFFFF;
 
     public static XmlNode parseXml(String filePath) {
+        try {
+            return parseXmlNative(filePath);
+        } catch (UnsatisfiedLinkError e) {
+            // native library not loaded yet, e.g. in the early startup, fall through
+        } catch (Exception e) {
+            Log.e("parse xml error:" + e);
+            return null;
+        }
         try(FileInputStream fis = new FileInputStream(filePath);
                 ByteArrayOutputStream bos = new ByteArrayOutputStream()) {
             byte[] buffer = new byte[1024];
@@ -75,6 +84,57 @@ public class BinaryXmlParser {
         return null;
     }
 
+    /**
+     * Build the tree with {@link BinaryXmlCursor}, the file is mapped instead of read and only the strings referenced
+     * by the tree are decoded.
+     */
+    private static XmlNode parseXmlNative(String filePath) throws IOException {
+        XmlNode root = new XmlNode();
+        Stack<XmlNode> stack = new Stack<>();
+        try (BinaryXmlCursor cursor = BinaryXmlCursor.open(filePath)) {
+            int event;
+            while ((event = cursor.next()) != BinaryXmlCursor.END_DOCUMENT) {
+                if (event == BinaryXmlCursor.START_TAG) {
+                    XmlNode node = stack.empty() ? root : new XmlNode();
+                    node.lineNumber = cursor.getLineNumber();
+                    node.comment = cursor.getComment();
+                    node.namespace = cursor.getNamespace();
+                    node.name = cursor.getName();
+                    int attributeCount = cursor.getAttributeCount();
+                    if (attributeCount > 0) {
+                        node.attributes = new HashMap<>();
+                    }
+                    for (int i = 0; i < attributeCount; i++) {
+                        XmlNode.Res r = new XmlNode.Res();
+                        r.dataType = cursor.getAttributeDataType(i);
+                        r.data = cursor.getAttributeData(i);
+                        if (r.dataType == XmlNode.Res.TYPE_STRING) {
+                            r.str = cursor.getString(r.data);
+                        }
+                        node.attributes.put(cursor.getAttributeName(i), r);
+                    }
+                    stack.push(node);
+                } else if (event == BinaryXmlCursor.TEXT) {
+                    XmlNode node = stack.isEmpty() ? root : stack.peek();
+                    XmlNode.Res r = node.cdata = new XmlNode.Res();
+                    r.dataType = cursor.getTextDataType();
+                    r.data = cursor.getTextData();
+                    r.str = cursor.getText();
+                } else if (event == BinaryXmlCursor.END_TAG && !stack.empty()) {
+                    XmlNode node = stack.pop();
+                    if (!stack.empty()) {
+                        XmlNode parent = stack.peek();
+                        if (parent.elements == null) {
+                            parent.elements = new ArrayList<>();
+                        }
+                        parent.elements.add(node);
+                    }
+                }
+            }
+        }
+        return root;
+    }
+
     public static XmlNode parseXml(byte[] xml) {
         XmlNode root = new XmlNode();
         int[] pos = {0};
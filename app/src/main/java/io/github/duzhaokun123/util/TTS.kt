@@ -24,6 +24,8 @@ package io.github.duzhaokun123.util
 
 import android.app.Dialog
 import android.content.Context
+import android.media.AudioFormat
+import android.os.ParcelFileDescriptor
 import android.os.Parcelable
 import android.speech.tts.TextToSpeech
 import android.speech.tts.UtteranceProgressListener
@@ -172,6 +174,8 @@ object TTS {
         binding.btnSend.setOnClickListener {
             instance.setOnUtteranceProgressListener(object : UtteranceProgressListener() {
                 var sampleRateInHz = 0
+                var audioFormat = AudioFormat.ENCODING_PCM_16BIT
+                var channelCount = 1
                 val pcm = File(wc.externalCacheDir, "send_tts/pcm")
                 val silk = File(wc.externalCacheDir!!, "../Tencent/MobileQQ/tts/${TimeFormat.format1.format(System.currentTimeMillis())}.silk").apply { parentFile!!.mkdirs() }
 
@@ -191,14 +195,38 @@ object TTS {
                 override fun onDone(utteranceId: String?) {
                     instance.setOnUtteranceProgressListener(null)
                     runCatching {
-                        SilkEncodeUtils.nativePcm16leToSilkSS(
-                            pcm.absolutePath,
-                            silk.absolutePath,
-                            sampleRateInHz,
-                            24000,
-                            (sampleRateInHz * 20) / 1000,
-                            true
-                        )
+                        // the native front-end converts and resamples the TTS output, e.g. 22050Hz, to a rate Silk supports
+                        val inputFormat = when (audioFormat) {
+                            AudioFormat.ENCODING_PCM_8BIT -> SilkEncodeUtils.INPUT_FORMAT_PCM_U8
+                            AudioFormat.ENCODING_PCM_FLOAT -> SilkEncodeUtils.INPUT_FORMAT_PCM_FLOAT
+                            else -> SilkEncodeUtils.INPUT_FORMAT_PCM_16LE
+                        }
+                        val silkSampleRate = if (sampleRateInHz in intArrayOf(8000, 12000, 16000, 24000)) {
+                            sampleRateInHz
+                        } else if (sampleRateInHz > 16000) 24000 else 16000
+                        // closing a detached descriptor is a no-op, use {} only closes the input if the output fails to open
+                        ParcelFileDescriptor.open(pcm, ParcelFileDescriptor.MODE_READ_ONLY).use { inputFd ->
+                            ParcelFileDescriptor.open(
+                                silk,
+                                ParcelFileDescriptor.MODE_READ_WRITE or ParcelFileDescriptor.MODE_CREATE or ParcelFileDescriptor.MODE_TRUNCATE
+                            ).use { outputFd ->
+                                SilkEncodeUtils.nativeAudioToSilk(
+                                    inputFd.detachFd(),
+                                    outputFd.detachFd(),
+                                    inputFormat,
+                                    channelCount,
+                                    sampleRateInHz,
+                                    silkSampleRate,
+                                    24000,
+                                    (silkSampleRate * 20) / 1000,
+                                    true,
+                                    SilkEncodeUtils.COMPLEXITY_HIGH,
+                                    false,
+                                    // TTS engines tend to add long leading and trailing silence
+                                    SilkEncodeUtils.PREPROCESS_TRIM_SILENCE
+                                )
+                            }
+                        }
                     }.onFailure {
                         SyncUtils.runOnUiThread {
                             dialog.dismiss()
@@ -230,6 +258,8 @@ object TTS {
 
                 override fun onBeginSynthesis(utteranceId: String?, sampleRateInHz: Int, audioFormat: Int, channelCount: Int) {
                     this.sampleRateInHz = sampleRateInHz
+                    this.audioFormat = audioFormat
+                    this.channelCount = channelCount
                     pcm.delete()
                 }
 
@@ -32,6 +32,7 @@ import android.graphics.Color
 import android.os.Bundle
 import android.os.Looper
 import android.os.MessageQueue
+import android.os.Process
 import android.text.SpannableStringBuilder
 import android.text.Spanned.SPAN_EXCLUSIVE_EXCLUSIVE
 import android.text.style.ForegroundColorSpan
@@ -74,6 +75,7 @@ import io.github.qauxv.ui.CustomDialog
 import io.github.qauxv.util.Initiator
 import io.github.qauxv.util.LoaderExtensionHelper
 import io.github.qauxv.util.Natives
+import io.github.qauxv.util.SyncUtils
 import io.github.qauxv.util.Toasts
 import io.github.qauxv.util.dexkit.DexKit
 import io.github.qauxv.util.dexkit.DexKitTarget
@@ -83,6 +85,8 @@ import io.github.qauxv.util.hostInfo
 import io.github.qauxv.util.soloader.NativeLoader
 import me.ketal.base.PluginDelayableHook
 import me.singleneuron.hook.decorator.FxxkQQBrowser
+import java.io.File
+import java.io.IOException
 import kotlin.system.exitProcess
 
 
@@ -168,6 +172,14 @@ class TroubleshootFragment : BaseRootLayoutFragment() {
                     Natives.memset(0, 0, 1);
                 })
             },
+            CategoryItem("性能统计") {
+                add(TextSwitchItem(title = "启用 Hook 耗时统计", summary = "(仅供调试) 统计各 Hook 的调用次数与耗时, 需要 debug 构建", switchAgent = mHookProbeSwitch))
+                textItem("输出到 logcat", "输出 Hook 耗时统计到 logcat 并清零", onClick = clickToDumpHookProbes)
+                textItem("特征码搜索统计", "各特征码分别由哪一级搜索找到 (缓存命中/附近搜索/全量扫描)", onClick = clickToShowAobScanStats)
+                textItem("开始采样分析", "(仅供调试) 每 50ms 采样一次主线程与所选线程的 native 调用栈", onClick = clickToStartSamplingProfiler)
+                textItem("停止采样分析", onClick = clickToStopSamplingProfiler)
+                textItem("导出采样结果", "以 flamegraph.pl 可读的 folded stacks 格式写入外部缓存目录", onClick = clickToDumpSamplingProfile)
+            },
             CategoryItem("调试信息") {
                 description(generateStatusText(), isTextSelectable = true)
                 description(generateDebugInfo(), isTextSelectable = true)
@@ -203,6 +215,80 @@ class TroubleshootFragment : BaseRootLayoutFragment() {
             }
     }
 
+    private val mHookProbeSwitch: ISwitchCellAgent = object : ISwitchCellAgent {
+        override val isCheckable = true
+        override var isChecked: Boolean
+            get() = Natives.areHookProbesEnabled()
+            set(value) {
+                Natives.setHookProbesEnabled(value)
+            }
+    }
+
+    private val clickToDumpHookProbes = actionOrShowError {
+        Natives.dumpHookProbesToLogcat()
+        Natives.resetHookProbes()
+        Toasts.info(requireContext(), "已输出到 logcat")
+    }
+
+    private val clickToStartSamplingProfiler = actionOrShowError {
+        if (Natives.isSamplingProfilerRunning()) {
+            Toasts.info(requireContext(), "采样分析已在运行")
+            return@actionOrShowError
+        }
+        // the main thread is always sampled, its tid is the pid
+        val mainTid = Process.myPid()
+        val threads = (File("/proc/self/task").listFiles() ?: emptyArray())
+            .mapNotNull { it.name.toIntOrNull() }
+            .filter { it != mainTid }
+            .sorted()
+            .map { tid -> tid to (runCatching { File("/proc/self/task/$tid/comm").readText().trim() }.getOrNull() ?: "") }
+        AlertDialog.Builder(requireContext())
+            .setTitle("选择要采样的线程 (主线程总是采样)")
+            .setMultiChoiceItems(threads.map { "${it.first} ${it.second}" }.toTypedArray(), null) { _, _, _ -> }
+            .setPositiveButton(android.R.string.ok) { dialog, _ ->
+                val checked = (dialog as AlertDialog).listView.checkedItemPositions
+                val tids = IntArray(1) { mainTid } + threads.indices.filter { checked.get(it) }.map { threads[it].first }
+                runOrShowError {
+                    Natives.startSamplingProfiler(tids, 50)
+                    Toasts.info(requireContext(), "已开始采样 ${tids.size} 个线程")
+                }
+            }
+            .setNegativeButton(android.R.string.cancel, null)
+            .show()
+    }
+
+    private val clickToStopSamplingProfiler = actionOrShowError {
+        val ctx = requireContext()
+        // waits for the sampler thread to finish its round
+        SyncUtils.async {
+            Natives.stopSamplingProfiler()
+            SyncUtils.runOnUiThread { Toasts.info(ctx, "已停止采样") }
+        }
+    }
+
+    private val clickToDumpSamplingProfile = actionOrShowError {
+        val dir = HostInfo.getApplication().externalCacheDir ?: HostInfo.getApplication().cacheDir
+        val file = File(dir, "qauxv_profile_${System.currentTimeMillis()}.folded")
+        val ctx = requireContext()
+        // waits for a stop in progress, which holds the profiler until the sampler thread exits
+        SyncUtils.async {
+            try {
+                Natives.dumpSamplingProfile(file.absolutePath)
+                SyncUtils.runOnUiThread { Toasts.info(ctx, "已写入 ${file.absolutePath}") }
+            } catch (e: IOException) {
+                SyncUtils.runOnUiThread { Toasts.error(ctx, "导出失败: ${e.message}") }
+            }
+        }
+    }
+
+    private val clickToShowAobScanStats = actionOrShowError {
+        CustomDialog.createFailsafe(requireContext())
+            .setTitle("特征码搜索统计")
+            .setCancelable(true)
+            .setMessage(Natives.getAobScanStatsReport())
+            .ok().show()
+    }
+
     private val clickToShowFuncList: (View) -> Unit = {
         SettingsUiFragmentHostActivity.startFragmentWithContext(it.context, FuncStatListFragment::class.java, null)
     }
@@ -31,6 +31,7 @@ import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Member;
 import java.lang.reflect.Method;
 import java.lang.reflect.Modifier;
+import java.nio.ByteBuffer;
 import java.util.Objects;
 
 public class Natives {
@@ -155,6 +156,163 @@ public class Natives {
 
     public static native void setProcessDumpableState(int dumpable) throws IOException;
 
+    /**
+     * Start the native sampling profiler, for debugging only. The samples are kept across runs until the process exits.
+     *
+     * @param tids           the threads to sample, null or empty for all threads of the process
+     * @param intervalMillis the interval between two rounds of sampling, must be positive
+     * @throws IllegalStateException if the profiler is already running or fails to start
+     */
+    public static native void startSamplingProfiler(@Nullable int[] tids, int intervalMillis);
+
+    /**
+     * Stop the native sampling profiler, no-op if it is not running.
+     */
+    public static native void stopSamplingProfiler();
+
+    public static native boolean isSamplingProfilerRunning();
+
+    /**
+     * Write the samples of the native sampling profiler as folded stacks, i.e. the input of flamegraph.pl.
+     *
+     * @param path the output file, it is truncated
+     * @throws IOException if the file can not be written
+     */
+    public static native void dumpSamplingProfile(@NonNull String path) throws IOException;
+
+    /**
+     * Compute the space used by every table and index of a SQLite database by parsing the file directly.
+     * No SQL is executed and no lock is taken, see {@link SqliteSpaceReport#analyze(String)} for a typed result.
+     *
+     * @param path the database file
+     * @return [0] String[] b-tree names, [1] String[] owning table names, [2] long[] numbers: pageSize, pageCount,
+     * freelistPages, otherPages, then for each b-tree: isIndex, rootPage, leafPages, interiorPages, overflowPages,
+     * overflowChains, entries, payloadBytes, unusedBytes
+     * @throws IOException if the file can not be read or is not a SQLite database
+     */
+    @NonNull
+    public static native Object[] analyzeSqliteSpace(@NonNull String path) throws IOException;
+
+    /**
+     * Compute the upper case hex MD5 of the decimal string of every uin, the same as
+     * {@code DatabaseShrinkFragment.uinToMd5(long)}, in one call. Uins are hashed several at a time.
+     *
+     * @param uins the uins
+     * @return the hex digests, in the same order as uins
+     */
+    @NonNull
+    public static native String[] uinToMd5HexBatch(@NonNull long[] uins);
+
+    /**
+     * Continue an Adler-32 checksum, the result is the same as {@link java.util.zip.Adler32}.
+     * Start with 1, the checksum of no data.
+     *
+     * @param adler  the checksum of the previous data
+     * @param buf    the data
+     * @param offset the start of the data in buf
+     * @param len    the length of the data
+     * @return the checksum of the previous data followed by the data
+     */
+    public static native int updateAdler32(int adler, @NonNull byte[] buf, int offset, int len);
+
+    /**
+     * The same as {@link #updateAdler32(int, byte[], int, int)} for a direct buffer, offset is absolute and the
+     * position and limit of buf are neither used nor changed.
+     *
+     * @throws IllegalArgumentException if buf is not a direct buffer
+     */
+    public static native int updateAdler32Direct(int adler, @NonNull ByteBuffer buf, int offset, int len);
+
+    /**
+     * Continue a CRC-32, the result is the same as {@link java.util.zip.CRC32}. Start with 0, the CRC of no data.
+     *
+     * @param crc    the CRC of the previous data
+     * @param buf    the data
+     * @param offset the start of the data in buf
+     * @param len    the length of the data
+     * @return the CRC of the previous data followed by the data
+     */
+    public static native int updateCrc32(int crc, @NonNull byte[] buf, int offset, int len);
+
+    /**
+     * The same as {@link #updateCrc32(int, byte[], int, int)} for a direct buffer, offset is absolute and the
+     * position and limit of buf are neither used nor changed.
+     *
+     * @throws IllegalArgumentException if buf is not a direct buffer
+     */
+    public static native int updateCrc32Direct(int crc, @NonNull ByteBuffer buf, int offset, int len);
+
+    /**
+     * Look up the dex files of an APK defining some classes, using a class index built from every classesN.dex.
+     * The index is loaded from or saved to indexPath and is rebuilt when the dex entries of the APK change.
+     *
+     * @param apkPath     the APK, e.g. the host base.apk
+     * @param indexPath   the file caching the index
+     * @param descriptors the type descriptors, e.g. "Ljava/lang/Object;"
+     * @return for each descriptor: the dex index, 1 for classes.dex, N for classesN.dex, or -1 if not found, and the
+     * class_def index
+     * @throws IOException if the APK can not be read
+     */
+    @NonNull
+    public static native int[] findClassesInDexIndex(@NonNull String apkPath, @NonNull String indexPath,
+            @NonNull String[] descriptors) throws IOException;
+
+    private static volatile boolean sHookProbesEnabled = false;
+
+    /**
+     * Enable or disable the per-hook counters and latency histograms, they are disabled by default.
+     * It has no effect if the probes are compiled out of the native library.
+     */
+    public static void setHookProbesEnabled(boolean enabled) {
+        setHookProbesEnabledImpl(enabled);
+        sHookProbesEnabled = enabled;
+    }
+
+    public static boolean areHookProbesEnabled() {
+        return sHookProbesEnabled;
+    }
+
+    private static native void setHookProbesEnabledImpl(boolean enabled);
+
+    /**
+     * Register a hook probe, or get the id of the probe with the same name.
+     *
+     * @param name the name of the probe, e.g. the hooked method
+     * @return the id, or -1 if the probes are compiled out or too many probes are registered
+     */
+    public static native int registerHookProbe(@NonNull String name);
+
+    /**
+     * Record one call of a hook probe, invalid ids are ignored.
+     *
+     * @param id    the id returned by {@link #registerHookProbe(String)}
+     * @param nanos the time spent in the call
+     */
+    public static native void recordHookProbe(int id, long nanos);
+
+    /**
+     * Get the calls, mean and percentile latencies of all hook probes as a human-readable table.
+     */
+    @NonNull
+    public static native String getHookProbeReport();
+
+    /**
+     * Clear the counters and histograms of all hook probes, the probes stay registered.
+     */
+    public static native void resetHookProbes();
+
+    /**
+     * Write the report of {@link #getHookProbeReport()} to logcat, one line per probe.
+     */
+    public static native void dumpHookProbesToLogcat();
+
+    /**
+     * Get how often each tier of the AOB scan resolved each target, accumulated in the cache across runs,
+     * as a human-readable table.
+     */
+    @NonNull
+    public static native String getAobScanStatsReport();
+
     /**
      * Allocate a object instance of the specified class without calling the constructor.
      * <p>
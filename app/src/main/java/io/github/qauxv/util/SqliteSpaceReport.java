@@ -0,0 +1,130 @@
+/*
+ * QAuxiliary - An Xposed module for QQ/TIM
+ * Copyright (C) 2019-2022 qwq233@qwq2333.top
+ * https://github.com/cinit/QAuxiliary
+ *
+ * This software is non-free but opensource software: you can redistribute it
+ * and/or modify it under the terms of the GNU Affero General Public License
+ * as published by the Free Software Foundation; either
+ * version 3 of the License, or any later version and our eula as published
+ * by QAuxiliary contributors.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * and eula along with this software.  If not, see
+ * <https://www.gnu.org/licenses/>
+ * <https://github.com/cinit/QAuxiliary/blob/master/LICENSE.md>.
+ */
+package io.github.qauxv.util;
+
+import androidx.annotation.NonNull;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Page-level space usage of a SQLite database, computed natively without SQLite.
+ * <p>
+ * Only the main database file is read, so changes still in the -wal file are not included.
+ */
+public final class SqliteSpaceReport {
+
+    public static final class Btree {
+
+        // the table or index name
+        @NonNull
+        public final String name;
+        // the table the b-tree belongs to, the same as name for tables
+        @NonNull
+        public final String tableName;
+        public final boolean isIndex;
+        public final long rootPage;
+        public final long leafPages;
+        public final long interiorPages;
+        public final long overflowPages;
+        public final long overflowChains;
+        // rows for tables, keys for indexes
+        public final long entries;
+        public final long payloadBytes;
+        public final long unusedBytes;
+
+        private Btree(@NonNull String name, @NonNull String tableName, long[] v, int offset) {
+            this.name = name;
+            this.tableName = tableName;
+            this.isIndex = v[offset] != 0;
+            this.rootPage = v[offset + 1];
+            this.leafPages = v[offset + 2];
+            this.interiorPages = v[offset + 3];
+            this.overflowPages = v[offset + 4];
+            this.overflowChains = v[offset + 5];
+            this.entries = v[offset + 6];
+            this.payloadBytes = v[offset + 7];
+            this.unusedBytes = v[offset + 8];
+        }
+
+        public long getTotalPages() {
+            return leafPages + interiorPages + overflowPages;
+        }
+    }
+
+    public final int pageSize;
+    public final long pageCount;
+    public final long freelistPages;
+    // pointer map pages, the lock-byte page, or pages not reachable from any b-tree
+    public final long otherPages;
+    @NonNull
+    public final List<Btree> btrees;
+
+    private SqliteSpaceReport(int pageSize, long pageCount, long freelistPages, long otherPages, @NonNull List<Btree> btrees) {
+        this.pageSize = pageSize;
+        this.pageCount = pageCount;
+        this.freelistPages = freelistPages;
+        this.otherPages = otherPages;
+        this.btrees = btrees;
+    }
+
+    /**
+     * Analyze a database file in a single sequential pass, see {@link Natives#analyzeSqliteSpace(String)}.
+     * This may take a while for large databases, do not call it on the UI thread.
+     *
+     * @param path the database file
+     * @return the report
+     * @throws IOException if the file can not be read or is not a SQLite database
+     */
+    @NonUiThread
+    @NonNull
+    public static SqliteSpaceReport analyze(@NonNull String path) throws IOException {
+        Object[] result = Natives.analyzeSqliteSpace(path);
+        String[] names = (String[]) result[0];
+        String[] tableNames = (String[]) result[1];
+        long[] v = (long[]) result[2];
+        ArrayList<Btree> btrees = new ArrayList<>(names.length);
+        for (int i = 0; i < names.length; i++) {
+            btrees.add(new Btree(names[i], tableNames[i], v, 4 + i * 9));
+        }
+        return new SqliteSpaceReport((int) v[0], v[1], v[2], v[3], Collections.unmodifiableList(btrees));
+    }
+
+    /**
+     * Sum the b-trees of each table, i.e. the table itself and its indexes.
+     *
+     * @return total pages by table name
+     */
+    @NonNull
+    public Map<String, Long> getPagesByTable() {
+        HashMap<String, Long> pages = new HashMap<>(btrees.size());
+        for (Btree btree : btrees) {
+            Long old = pages.get(btree.tableName);
+            pages.put(btree.tableName, (old == null ? 0 : old) + btree.getTotalPages());
+        }
+        return pages;
+    }
+
+}
@@ -25,6 +25,9 @@ import android.app.Application;
 import androidx.annotation.Nullable;
 import io.github.qauxv.util.HostInfo;
 import io.github.qauxv.util.IoUtils;
+import io.github.qauxv.util.Log;
+import io.github.qauxv.util.Natives;
+import java.io.File;
 import java.io.IOException;
 import java.lang.ref.WeakReference;
 import java.util.HashMap;
@@ -145,6 +148,12 @@ public class HostMainDexHelper {
         if (name == null || name.isEmpty()) {
             throw new IllegalArgumentException("name == null || name.isEmpty()");
         }
+        int index = findDexIndexWithClass(name);
+        if (index > 0) {
+            return getHostDexIndex(index);
+        } else if (index == 0) {
+            return null;
+        }
         for (byte[] dex : asIterable()) {
             if (DexFlow.hasClassInDex(dex, name)) {
                 return dex;
@@ -153,6 +162,27 @@ public class HostMainDexHelper {
         return null;
     }
 
+    /**
+     * Find the dex defining a class with the native class index, without extracting any dex.
+     *
+     * @param name the class name, e.g. "com.tencent.mobileqq.app.QQAppInterface", or a type descriptor
+     * @return the dex index, see {@link #getHostDexIndex(int)}, 0 if no dex defines the class, or -1 if the index
+     * is not available
+     */
+    public static int findDexIndexWithClass(String name) {
+        String descriptor = name.endsWith(";") ? name : "L" + name.replace('.', '/') + ";";
+        Application app = HostInfo.getHostInfo().getApplication();
+        String apkPath = app.getApplicationInfo().sourceDir;
+        File indexFile = new File(app.getCacheDir(), "qa_dex_class_index");
+        try {
+            int[] result = Natives.findClassesInDexIndex(apkPath, indexFile.getAbsolutePath(), new String[]{descriptor});
+            return Math.max(result[0], 0);
+        } catch (IOException | UnsatisfiedLinkError e) {
+            Log.w("HostMainDexHelper: dex class index is not available", e);
+            return -1;
+        }
+    }
+
     @Nullable
     public static byte[] findDexWithClass(Class<?> klass) {
         Objects.requireNonNull(klass, "klass == null");
@@ -46,4 +46,26 @@ public class LsplantBridge {
 
     static native boolean nativeDeoptimizeMethod(@NonNull Member target) throws RuntimeException;
 
+    // per-entry status codes of the batch variants, keep in sync with LsplantBridge.cc
+    static final int BATCH_STATUS_SUCCESS = 0;
+    // the target, callback or context is null
+    static final int BATCH_STATUS_INVALID_ARGUMENT = 1;
+    static final int BATCH_STATUS_FAILED = 2;
+    // LSPlant threw, the exception is logged and cleared
+    static final int BATCH_STATUS_EXCEPTION = 3;
+
+    /**
+     * Hook many methods in a single JNI call, see {@link #nativeHookMethod(Member, Member, Object)}.
+     * All arrays must have the same length. A failed entry does not stop the others.
+     *
+     * @param outBackups receives the backup method of every successful entry
+     * @return the status of every entry, one of the BATCH_STATUS_* constants
+     */
+    @NonNull
+    static native int[] nativeHookMethods(@NonNull Member[] targets, @NonNull Member[] callbacks, @NonNull Object[] contexts,
+            @NonNull Method[] outBackups) throws RuntimeException;
+
+    @NonNull
+    static native int[] nativeUnhookMethods(@NonNull Member[] targets) throws RuntimeException;
+
 }
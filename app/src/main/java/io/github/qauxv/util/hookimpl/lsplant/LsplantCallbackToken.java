@@ -24,6 +24,7 @@ package io.github.qauxv.util.hookimpl.lsplant;
 
 import androidx.annotation.Keep;
 import androidx.annotation.NonNull;
+import io.github.qauxv.util.Natives;
 import java.lang.reflect.Member;
 import java.lang.reflect.Method;
 import java.util.Objects;
@@ -59,6 +60,30 @@ public final class LsplantCallbackToken {
         return mMember;
     }
 
+    private static final int HOOK_PROBE_UNREGISTERED = -2;
+
+    // the class of the callback which caused the hook, it names the probe
+    private Class<?> mHookOwnerClass;
+    // -1 if there is no probe, see Natives.registerHookProbe; the probe is registered on the first call with probes enabled
+    private int mHookProbeId = HOOK_PROBE_UNREGISTERED;
+
+    /*package*/ void setHookOwnerClass(@NonNull Class<?> ownerClass) {
+        mHookOwnerClass = ownerClass;
+    }
+
+    private int registerHookProbe() {
+        // one probe per feature and method name, so the names stay the same across runs and overloads share a probe
+        String owner = mHookOwnerClass == null ? "?" : mHookOwnerClass.getName();
+        int nestedIndex = owner.indexOf('$');
+        if (nestedIndex > 0) {
+            owner = owner.substring(0, nestedIndex);
+        }
+        String method = mMember instanceof Method ? mMember.getName() : "<init>";
+        int id = Natives.registerHookProbe("lsplant:" + owner + ":" + method);
+        mHookProbeId = id;
+        return id;
+    }
+
     // called from native
     @Keep
     public Object callback(Object[] args) throws Throwable {
@@ -70,7 +95,22 @@ public final class LsplantCallbackToken {
         if (backupMethod == null) {
             throw new AssertionError("backupMethod is null");
         }
-        return LsplantCallbackDispatcher.handleCallback(this, targetMethod, backupMethod, args);
+        if (!Natives.areHookProbesEnabled()) {
+            return LsplantCallbackDispatcher.handleCallback(this, targetMethod, backupMethod, args);
+        }
+        int probeId = mHookProbeId;
+        if (probeId == HOOK_PROBE_UNREGISTERED) {
+            probeId = registerHookProbe();
+        }
+        if (probeId < 0) {
+            return LsplantCallbackDispatcher.handleCallback(this, targetMethod, backupMethod, args);
+        }
+        long start = System.nanoTime();
+        try {
+            return LsplantCallbackDispatcher.handleCallback(this, targetMethod, backupMethod, args);
+        } finally {
+            Natives.recordHookProbe(probeId, System.nanoTime() - start);
+        }
     }
 
 }
@@ -35,6 +35,8 @@ import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Member;
 import java.lang.reflect.Method;
 import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.HashSet;
 import java.util.Objects;
 import java.util.concurrent.ConcurrentHashMap;
@@ -138,6 +140,15 @@ public class LsplantHookImpl {
 
     private static Member sCallbackMethod;
     private static AtomicLong sHookCounter = new AtomicLong(0);
+    private static final AtomicLong sHolderCounter = new AtomicLong(0);
+
+    /**
+     * Whether the bridge is the one set up by {@link #initializeLsplantHookBridge()},
+     * i.e. whether {@link #hookMethods} and {@link #unhookMethods} may be used instead of the bridge methods.
+     */
+    public static boolean isLsplantHookBridge(@Nullable IHookBridge bridge) {
+        return bridge == LsplantHookBridge.INSTANCE;
+    }
 
     private static synchronized void initializeLsplantInternal() {
         if (isInitialized) {
@@ -282,27 +293,96 @@ public class LsplantHookImpl {
         // token for LSPlant, after method is hooked, this will be set
         @Nullable
         public LsplantCallbackToken token = null;
+        // batch operations lock several holders in ascending id order, so that they can not deadlock
+        private final long id = sHolderCounter.getAndIncrement();
 
     }
 
-    private static IHookBridge.MemberUnhookHandle hookMethodImpl(@NonNull Member member, @NonNull IHookBridge.IMemberHookCallback callback, int priority) {
-        checkHookTarget(member);
-        Objects.requireNonNull(callback);
-        CallbackWrapper wrapper = new CallbackWrapper(callback, member, priority);
+    @NonNull
+    private static CallbackListHolder getOrCreateHolder(@NonNull Member member) {
         Class<?> declaringClass = member.getDeclaringClass();
-        CallbackListHolder holder;
         synchronized (sRegistryWriteLock) {
             ConcurrentHashMap<Member, CallbackListHolder> map = sCallbackRegistry.get(declaringClass);
             if (map == null) {
                 map = new ConcurrentHashMap<>(2);
                 sCallbackRegistry.put(declaringClass, map);
             }
-            holder = map.get(member);
+            CallbackListHolder holder = map.get(member);
             if (holder == null) {
                 holder = new CallbackListHolder();
                 map.put(member, holder);
             }
+            return holder;
+        }
+    }
+
+    @Nullable
+    private static CallbackListHolder getHolder(@NonNull Member member) {
+        // ConcurrentHashMap is thread-safe, so we don't need to synchronize here
+        ConcurrentHashMap<Member, CallbackListHolder> map1 = sCallbackRegistry.get(member.getDeclaringClass());
+        return map1 == null ? null : map1.get(member);
+    }
+
+    private static void runWithHolderLocks(@NonNull CallbackListHolder[] sortedHolders, int index, @NonNull Runnable action) {
+        if (index == sortedHolders.length) {
+            action.run();
+            return;
+        }
+        synchronized (sortedHolders[index].lock) {
+            runWithHolderLocks(sortedHolders, index + 1, action);
         }
+    }
+
+    @NonNull
+    private static CallbackListHolder[] sortHoldersForLocking(@NonNull CallbackListHolder[] holders) {
+        CallbackListHolder[] sorted = new HashSet<>(Arrays.asList(holders)).toArray(new CallbackListHolder[0]);
+        Arrays.sort(sorted, (a, b) -> Long.compare(a.id, b.id));
+        return sorted;
+    }
+
+    // caller must hold holder.lock
+    private static void addCallbackLocked(@NonNull CallbackListHolder holder, @NonNull CallbackWrapper wrapper) {
+        // descending order by priority
+        int newSize = holder.callbacks.length + 1;
+        CallbackWrapper[] newCallbacks = new CallbackWrapper[newSize];
+        int i = 0;
+        for (; i < holder.callbacks.length; i++) {
+            if (holder.callbacks[i].priority > wrapper.priority) {
+                newCallbacks[i] = holder.callbacks[i];
+            } else {
+                break;
+            }
+        }
+        newCallbacks[i] = wrapper;
+        for (; i < holder.callbacks.length; i++) {
+            newCallbacks[i + 1] = holder.callbacks[i];
+        }
+        holder.callbacks = newCallbacks;
+    }
+
+    // caller must hold holder.lock
+    private static void removeCallbackLocked(@NonNull CallbackListHolder holder, @NonNull CallbackWrapper callback) {
+        int index = Arrays.asList(holder.callbacks).indexOf(callback);
+        if (index < 0) {
+            // already removed, e.g. the same handle is passed twice to unhookMethods
+            return;
+        }
+        int newSize = holder.callbacks.length - 1;
+        if (newSize == 0) {
+            holder.callbacks = EMPTY_CALLBACKS;
+        } else {
+            CallbackWrapper[] newCallbacks = new CallbackWrapper[newSize];
+            System.arraycopy(holder.callbacks, 0, newCallbacks, 0, index);
+            System.arraycopy(holder.callbacks, index + 1, newCallbacks, index, newSize - index);
+            holder.callbacks = newCallbacks;
+        }
+    }
+
+    private static IHookBridge.MemberUnhookHandle hookMethodImpl(@NonNull Member member, @NonNull IHookBridge.IMemberHookCallback callback, int priority) {
+        checkHookTarget(member);
+        Objects.requireNonNull(callback);
+        CallbackWrapper wrapper = new CallbackWrapper(callback, member, priority);
+        CallbackListHolder holder = getOrCreateHolder(member);
         synchronized (holder.lock) {
             // step 1. check if the method is already hooked
             if (holder.token == null) {
@@ -316,57 +396,95 @@ public class LsplantHookImpl {
                 backup.setAccessible(true);
                 // hook success, set backup method
                 token.setBackupMember(backup);
+                token.setHookOwnerClass(callback.getClass());
                 // add token to holder
                 holder.token = token;
             }
-            // step 2. add callback to list, descending order by priority
-            int newSize = holder.callbacks.length + 1;
-            CallbackWrapper[] newCallbacks = new CallbackWrapper[newSize];
-            int i = 0;
-            for (; i < holder.callbacks.length; i++) {
-                if (holder.callbacks[i].priority > priority) {
-                    newCallbacks[i] = holder.callbacks[i];
-                } else {
-                    break;
+            // step 2. add callback to list
+            addCallbackLocked(holder, wrapper);
+        }
+        return wrapper;
+    }
+
+    /**
+     * Hook many members with the same callback, e.g. every overload of a method.
+     * The members which are not hooked yet are hooked by LSPlant in a single JNI call.
+     *
+     * @param members  methods or constructors
+     * @param callback the callback for every member
+     * @param priority the priority of the callback
+     * @return the unhook handles, in the same order as members
+     * @throws UnsupportedOperationException if LSPlant failed to hook some of the members, the others stay hooked
+     */
+    @NonNull
+    public static IHookBridge.MemberUnhookHandle[] hookMethods(@NonNull Member[] members,
+            @NonNull IHookBridge.IMemberHookCallback callback, int priority) {
+        Objects.requireNonNull(members, "members");
+        Objects.requireNonNull(callback, "callback");
+        for (Member member : members) {
+            checkHookTarget(member);
+        }
+        CallbackListHolder[] holders = new CallbackListHolder[members.length];
+        for (int i = 0; i < members.length; i++) {
+            holders[i] = getOrCreateHolder(members[i]);
+        }
+        CallbackWrapper[] wrappers = new CallbackWrapper[members.length];
+        ArrayList<Member> failed = new ArrayList<>(0);
+        runWithHolderLocks(sortHoldersForLocking(holders), 0, () -> {
+            // step 1. hook the underlying ArtMethods which are not hooked yet, all at once
+            ArrayList<Integer> pending = new ArrayList<>(members.length);
+            HashSet<CallbackListHolder> pendingHolders = new HashSet<>(members.length);
+            for (int i = 0; i < members.length; i++) {
+                if (holders[i].token == null && pendingHolders.add(holders[i])) {
+                    pending.add(i);
                 }
             }
-            newCallbacks[i] = wrapper;
-            for (; i < holder.callbacks.length; i++) {
-                newCallbacks[i + 1] = holder.callbacks[i];
+            if (!pending.isEmpty()) {
+                int count = pending.size();
+                Member[] targets = new Member[count];
+                Member[] callbackMethods = new Member[count];
+                LsplantCallbackToken[] tokens = new LsplantCallbackToken[count];
+                Method[] backups = new Method[count];
+                for (int j = 0; j < count; j++) {
+                    targets[j] = members[pending.get(j)];
+                    callbackMethods[j] = sCallbackMethod;
+                    tokens[j] = new LsplantCallbackToken(targets[j]);
+                }
+                int[] statuses = LsplantBridge.nativeHookMethods(targets, callbackMethods, tokens, backups);
+                for (int j = 0; j < count; j++) {
+                    if (statuses[j] != LsplantBridge.BATCH_STATUS_SUCCESS || backups[j] == null) {
+                        failed.add(targets[j]);
+                        continue;
+                    }
+                    backups[j].setAccessible(true);
+                    tokens[j].setBackupMember(backups[j]);
+                    tokens[j].setHookOwnerClass(callback.getClass());
+                    holders[pending.get(j)].token = tokens[j];
+                }
             }
-            holder.callbacks = newCallbacks;
+            // step 2. add the callback to every member which is hooked now
+            for (int i = 0; i < members.length; i++) {
+                if (holders[i].token != null) {
+                    wrappers[i] = new CallbackWrapper(callback, members[i], priority);
+                    addCallbackLocked(holders[i], wrappers[i]);
+                }
+            }
+        });
+        if (!failed.isEmpty()) {
+            throw new UnsupportedOperationException("LSPlant failed to hook methods: " + failed);
         }
-        return wrapper;
+        return wrappers;
     }
 
     private static void unhookMethodImpl(@NonNull CallbackWrapper callback) {
         Member target = callback.target;
-        Class<?> declaringClass = target.getDeclaringClass();
-        CallbackListHolder holder;
-        // ConcurrentHashMap is thread-safe, so we don't need to synchronize here
-        ConcurrentHashMap<Member, CallbackListHolder> map1 = sCallbackRegistry.get(declaringClass);
-        if (map1 == null) {
-            return;
-        }
-        holder = map1.get(target);
+        CallbackListHolder holder = getHolder(target);
         if (holder == null) {
             return;
         }
         synchronized (holder.lock) {
             // remove callback from list
-            int newSize = holder.callbacks.length - 1;
-            if (newSize == 0) {
-                holder.callbacks = EMPTY_CALLBACKS;
-            } else {
-                CallbackWrapper[] newCallbacks = new CallbackWrapper[newSize];
-                int j = 0;
-                for (int i = 0; i < holder.callbacks.length; i++) {
-                    if (holder.callbacks[i] != callback) {
-                        newCallbacks[j++] = holder.callbacks[i];
-                    }
-                }
-                holder.callbacks = newCallbacks;
-            }
+            removeCallbackLocked(holder, callback);
             // if no more callbacks, unhook the method
             if (holder.callbacks.length == 0) {
                 LsplantBridge.nativeUnhookMethod(target);
@@ -375,6 +493,44 @@ public class LsplantHookImpl {
         }
     }
 
+    /**
+     * Remove many hooks at once, the members which have no callbacks left are unhooked by LSPlant in a single JNI call.
+     *
+     * @param handles handles returned by {@link #hookMethods} or the LSPlant hook bridge, inactive ones are skipped
+     */
+    public static void unhookMethods(@NonNull IHookBridge.MemberUnhookHandle[] handles) {
+        Objects.requireNonNull(handles, "handles");
+        ArrayList<CallbackWrapper> wrappers = new ArrayList<>(handles.length);
+        ArrayList<CallbackListHolder> holders = new ArrayList<>(handles.length);
+        for (IHookBridge.MemberUnhookHandle handle : handles) {
+            CallbackWrapper wrapper = (CallbackWrapper) handle;
+            CallbackListHolder holder = wrapper.active ? getHolder(wrapper.target) : null;
+            if (holder != null) {
+                wrappers.add(wrapper);
+                holders.add(holder);
+            }
+        }
+        if (wrappers.isEmpty()) {
+            return;
+        }
+        runWithHolderLocks(sortHoldersForLocking(holders.toArray(new CallbackListHolder[0])), 0, () -> {
+            ArrayList<Member> targets = new ArrayList<>(wrappers.size());
+            for (int i = 0; i < wrappers.size(); i++) {
+                CallbackListHolder holder = holders.get(i);
+                removeCallbackLocked(holder, wrappers.get(i));
+                wrappers.get(i).active = false;
+                if (holder.callbacks.length == 0 && holder.token != null) {
+                    targets.add(wrappers.get(i).target);
+                    // the same holder must not be unhooked twice
+                    holder.token = null;
+                }
+            }
+            if (!targets.isEmpty()) {
+                LsplantBridge.nativeUnhookMethods(targets.toArray(new Member[0]));
+            }
+        });
+    }
+
     private static Object invokeOriginalMemberImpl(@NonNull Member method, @Nullable Object thisObject, @NonNull Object[] args)
             throws IllegalAccessException, IllegalArgumentException, InvocationTargetException {
         Objects.requireNonNull(method, "method");
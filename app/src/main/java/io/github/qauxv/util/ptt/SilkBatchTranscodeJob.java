@@ -0,0 +1,179 @@
+/*
+ * QAuxiliary - An Xposed module for QQ/TIM
+ * Copyright (C) 2019-2022 qwq233@qwq2333.top
+ * https://github.com/cinit/QAuxiliary
+ *
+ * This software is non-free but opensource software: you can redistribute it
+ * and/or modify it under the terms of the GNU Affero General Public License
+ * as published by the Free Software Foundation; either
+ * version 3 of the License, or any later version and our eula as published
+ * by QAuxiliary contributors.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * and eula along with this software.  If not, see
+ * <https://www.gnu.org/licenses/>
+ * <https://github.com/cinit/QAuxiliary/blob/master/LICENSE.md>.
+ */
+
+package io.github.qauxv.util.ptt;
+
+import androidx.annotation.NonNull;
+import java.io.Closeable;
+import java.io.IOException;
+import java.util.List;
+
+/**
+ * Converts many audio files to Silk v3 in parallel, on a bounded pool of native worker threads.
+ * <p>
+ * Every worker reuses one encoder for all the files it converts. Progress is reported on the thread which calls
+ * {@link #run(Callback)}, one event at a time, so the callback needs no synchronization.
+ * {@link #cancel()} may be called from any thread, also concurrently with or after {@link #close()},
+ * {@link #close()} must not race with any other method.
+ */
+public final class SilkBatchTranscodeJob implements Closeable {
+
+    // keep in sync with SilkBatchEvent::Type
+    private static final int EVENT_STARTED = 0;
+    private static final int EVENT_SUCCEEDED = 1;
+    private static final int EVENT_FAILED = 2;
+    private static final int EVENT_CANCELLED = 3;
+
+    public interface Callback {
+
+        void onFileStarted(int index);
+
+        void onFileSucceeded(int index, long outputBytes);
+
+        /**
+         * The file could not be converted, the other files are not affected.
+         */
+        void onFileFailed(int index, @NonNull String error);
+
+        /**
+         * The job was cancelled before the file was finished, there is no output for it.
+         */
+        void onFileCancelled(int index);
+    }
+
+    /**
+     * The encoder settings for every file, see {@link SilkEncodeUtils#nativeAudioToSilk}.
+     */
+    public static final class Options {
+
+        public int inputFormat = SilkEncodeUtils.INPUT_FORMAT_PCM_16LE;
+        public int inputChannels = 1;
+        public int inputSampleRate = 24000;
+        public int sampleRate = 24000;
+        public int bitRate = 24000;
+        public int packetSize = 480;
+        public boolean tencent = true;
+        public int complexity = SilkEncodeUtils.COMPLEXITY_HIGH;
+        public boolean useDtx = false;
+        public int preprocessFlags = 0;
+    }
+
+    // guards mHandle between cancel() on other threads and close(), which frees the native job
+    private final Object mLock = new Object();
+    private volatile long mHandle;
+    private final int mFileCount;
+
+    private SilkBatchTranscodeJob(long handle, int fileCount) {
+        mHandle = handle;
+        mFileCount = fileCount;
+    }
+
+    /**
+     * Start converting the files in the background.
+     *
+     * @param inputPaths  the input files
+     * @param outputPaths the output files, in the same order, existing files are replaced
+     * @param options     the encoder settings
+     * @param workerCount the maximum number of threads, it is limited to the number of CPUs and files
+     */
+    @NonNull
+    public static SilkBatchTranscodeJob start(@NonNull List<String> inputPaths, @NonNull List<String> outputPaths,
+            @NonNull Options options, int workerCount) throws IOException {
+        if (inputPaths.size() != outputPaths.size()) {
+            throw new IllegalArgumentException("input and output counts differ");
+        }
+        long handle = SilkEncodeUtils.nativeBatchStart(inputPaths.toArray(new String[0]), outputPaths.toArray(new String[0]),
+                options.inputFormat, options.inputChannels, options.inputSampleRate,
+                options.sampleRate, options.bitRate, options.packetSize, options.tencent,
+                options.complexity, options.useDtx, options.preprocessFlags, workerCount);
+        return new SilkBatchTranscodeJob(handle, inputPaths.size());
+    }
+
+    public int getFileCount() {
+        return mFileCount;
+    }
+
+    /**
+     * Deliver the events to the callback on the calling thread until every file has been reported.
+     * Every file gets one final event, files which are cancelled before they are started get no started event.
+     */
+    public void run(@NonNull Callback callback) {
+        checkOpen();
+        long[] event = new long[3];
+        while (true) {
+            String error = SilkEncodeUtils.nativeBatchWaitEvent(mHandle, -1, event);
+            int type = (int) event[0];
+            int index = (int) event[1];
+            switch (type) {
+                case EVENT_STARTED:
+                    callback.onFileStarted(index);
+                    break;
+                case EVENT_SUCCEEDED:
+                    callback.onFileSucceeded(index, event[2]);
+                    break;
+                case EVENT_FAILED:
+                    callback.onFileFailed(index, error != null ? error : "unknown error");
+                    break;
+                case EVENT_CANCELLED:
+                    callback.onFileCancelled(index);
+                    break;
+                default:
+                    // no more events
+                    return;
+            }
+        }
+    }
+
+    /**
+     * Stop the job as soon as possible, this does not wait. Partial output of running files is deleted.
+     */
+    public void cancel() {
+        synchronized (mLock) {
+            if (mHandle != 0) {
+                SilkEncodeUtils.nativeBatchCancel(mHandle);
+            }
+        }
+    }
+
+    /**
+     * Cancel the job if it is still running and wait for the workers to exit.
+     */
+    @Override
+    public void close() {
+        long handle;
+        synchronized (mLock) {
+            handle = mHandle;
+            mHandle = 0;
+        }
+        // cancel() is a no-op from here on, and any cancel() in progress has returned,
+        // the lock is not held while waiting for the workers so that it does not block cancel()
+        if (handle != 0) {
+            SilkEncodeUtils.nativeBatchClose(handle);
+        }
+    }
+
+    private void checkOpen() {
+        if (mHandle == 0) {
+            throw new IllegalStateException("job is closed");
+        }
+    }
+}
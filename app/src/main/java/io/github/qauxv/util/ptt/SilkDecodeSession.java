@@ -0,0 +1,200 @@
+/*
+ * QAuxiliary - An Xposed module for QQ/TIM
+ * Copyright (C) 2019-2022 qwq233@qwq2333.top
+ * https://github.com/cinit/QAuxiliary
+ *
+ * This software is non-free but opensource software: you can redistribute it
+ * and/or modify it under the terms of the GNU Affero General Public License
+ * as published by the Free Software Foundation; either
+ * version 3 of the License, or any later version and our eula as published
+ * by QAuxiliary contributors.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * and eula along with this software.  If not, see
+ * <https://www.gnu.org/licenses/>
+ * <https://github.com/cinit/QAuxiliary/blob/master/LICENSE.md>.
+ */
+
+package io.github.qauxv.util.ptt;
+
+import androidx.annotation.NonNull;
+import java.io.Closeable;
+import java.io.IOException;
+
+/**
+ * Decodes a Silk v3 stream, with or without the Tencent header byte, to mono PCM16 while it is being received.
+ * <p>
+ * The stream is either read by the session from a file or file descriptor, or fed in chunks with {@link #feed}.
+ * Every 20 ms frame is available to {@link #read} as soon as it is decoded, so playback can start after the first packet.
+ * Empty, corrupt and lost packets (see {@link #markPacketLost()}) are concealed by the SILK decoder, the output keeps its timing.
+ * <p>
+ * The decoded samples are kept in a lock-free ring buffer of a fixed size: one thread may {@link #read} them, e.g. an
+ * AudioTrack writer, while another one calls all the other methods. {@link #close()} must not race with either of them.
+ */
+public final class SilkDecodeSession implements Closeable {
+
+    // keep in sync with SilkDecoderBridge.cc
+    private static final int STATS_DECODED_FRAMES = 0;
+    private static final int STATS_CONCEALED_FRAMES = 1;
+    private static final int STATS_CORRUPT_PACKETS = 2;
+    private static final int STATS_SIZE = 3;
+
+    private long mHandle;
+    private final int mSampleRate;
+
+    private SilkDecodeSession(long handle, int sampleRate) {
+        mHandle = handle;
+        mSampleRate = sampleRate;
+    }
+
+    /**
+     * Create a session which is fed with {@link #feed}.
+     *
+     * @param sampleRate    the output sample rate, 8000 - 48000
+     * @param bufferSamples the size of the output ring buffer, at least one 20 ms frame
+     */
+    @NonNull
+    public static SilkDecodeSession create(int sampleRate, int bufferSamples) throws IOException {
+        return new SilkDecodeSession(nativeOpen(sampleRate, bufferSamples, null, -1), sampleRate);
+    }
+
+    /**
+     * Create a session which reads the stream from a file by itself.
+     */
+    @NonNull
+    public static SilkDecodeSession openFile(@NonNull String path, int sampleRate, int bufferSamples) throws IOException {
+        return new SilkDecodeSession(nativeOpen(sampleRate, bufferSamples, path, -1), sampleRate);
+    }
+
+    /**
+     * Create a session which reads the stream from a file descriptor by itself.
+     * <p>
+     * The file descriptor is owned and closed by the session, also if this method throws.
+     * A pipe or socket is read in blocking mode from {@link #decode}.
+     */
+    @NonNull
+    public static SilkDecodeSession openFd(int fd, int sampleRate, int bufferSamples) throws IOException {
+        return new SilkDecodeSession(nativeOpen(sampleRate, bufferSamples, null, fd), sampleRate);
+    }
+
+    public int getSampleRate() {
+        return mSampleRate;
+    }
+
+    /**
+     * Append stream bytes, they are copied. Nothing is decoded until {@link #decode} is called.
+     */
+    public void feed(@NonNull byte[] data, int offset, int length) {
+        checkBounds(data.length, offset, length);
+        nativeFeed(mHandle, data, offset, length);
+    }
+
+    /**
+     * Report that no more bytes will be fed, a truncated packet at the end is dropped.
+     */
+    public void endOfInput() {
+        nativeEndOfInput(mHandle);
+    }
+
+    /**
+     * Report that the next packet is missing, one packet duration is concealed in its place.
+     */
+    public void markPacketLost() {
+        nativeMarkPacketLost(mHandle);
+    }
+
+    /**
+     * Decode until at least targetSamples samples are available, the buffer is full, the input runs out or the stream ends.
+     *
+     * @param targetSamples the number of samples to stop at, or 0 to fill the buffer
+     * @return the number of samples available to {@link #read}
+     * @throws IOException if the stream is malformed or can not be read
+     */
+    public int decode(int targetSamples) throws IOException {
+        return nativeDecode(mHandle, targetSamples);
+    }
+
+    /**
+     * Take decoded samples, this may be called from another thread than the one which decodes.
+     *
+     * @return the number of samples read, 0 if none is available
+     */
+    public int read(@NonNull short[] buffer, int offset, int length) {
+        checkBounds(buffer.length, offset, length);
+        return nativeRead(mHandle, buffer, offset, length);
+    }
+
+    /**
+     * @return the number of samples available to {@link #read}
+     */
+    public int available() {
+        return nativeAvailable(mHandle);
+    }
+
+    /**
+     * @return true if the whole stream has been decoded, the buffer may still hold samples
+     */
+    public boolean isFinished() {
+        return nativeIsFinished(mHandle);
+    }
+
+    public long getDecodedFrames() {
+        return getStats()[STATS_DECODED_FRAMES];
+    }
+
+    /**
+     * @return the number of frames generated by the packet loss concealment
+     */
+    public long getConcealedFrames() {
+        return getStats()[STATS_CONCEALED_FRAMES];
+    }
+
+    public long getCorruptPackets() {
+        return getStats()[STATS_CORRUPT_PACKETS];
+    }
+
+    @Override
+    public void close() {
+        if (mHandle != 0) {
+            nativeClose(mHandle);
+            mHandle = 0;
+        }
+    }
+
+    private long[] getStats() {
+        long[] stats = new long[STATS_SIZE];
+        nativeGetStats(mHandle, stats);
+        return stats;
+    }
+
+    private static void checkBounds(int arrayLength, int offset, int length) {
+        if (offset < 0 || length < 0 || offset > arrayLength - length) {
+            throw new IndexOutOfBoundsException("offset " + offset + ", length " + length + ", array length " + arrayLength);
+        }
+    }
+
+    private static native long nativeOpen(int sampleRate, int bufferSamples, String path, int fd) throws IOException;
+
+    private static native void nativeClose(long handle);
+
+    private static native void nativeFeed(long handle, @NonNull byte[] data, int offset, int length);
+
+    private static native void nativeEndOfInput(long handle);
+
+    private static native void nativeMarkPacketLost(long handle);
+
+    private static native int nativeDecode(long handle, int targetSamples) throws IOException;
+
+    private static native int nativeRead(long handle, @NonNull short[] buffer, int offset, int length);
+
+    private static native int nativeAvailable(long handle);
+
+    private static native boolean nativeIsFinished(long handle);
+
+    private static native void nativeGetStats(long handle, @NonNull long[] stats);
+}
@@ -26,6 +26,34 @@ import java.io.IOException;
 
 public class SilkEncodeUtils {
 
+    /**
+     * Let the encoder measure its real-time factor on the first frames and lower the complexity if it can not keep up.
+     */
+    public static final int COMPLEXITY_AUTO = -1;
+    public static final int COMPLEXITY_LOW = 0;
+    public static final int COMPLEXITY_MEDIUM = 1;
+    public static final int COMPLEXITY_HIGH = 2;
+
+    /**
+     * The input is a RIFF/WAVE file, the sample format, channel count and sample rate are read from its header.
+     */
+    public static final int INPUT_FORMAT_WAV = 0;
+    public static final int INPUT_FORMAT_PCM_U8 = 1;
+    public static final int INPUT_FORMAT_PCM_16LE = 2;
+    public static final int INPUT_FORMAT_PCM_24LE = 3;
+    public static final int INPUT_FORMAT_PCM_32LE = 4;
+    public static final int INPUT_FORMAT_PCM_FLOAT = 5;
+
+    /**
+     * Drop leading and trailing silence and shorten long pauses, detected with the SILK VAD.
+     * Only available at 8000, 12000, 16000 and 24000 Hz.
+     */
+    public static final int PREPROCESS_TRIM_SILENCE = 1;
+    /**
+     * Scale the samples so that the peak reaches -1 dBFS, the gain is limited to +12 dB.
+     */
+    public static final int PREPROCESS_NORMALIZE = 2;
+
     private SilkEncodeUtils() {
         throw new AssertionError("no instance");
     }
@@ -42,4 +70,53 @@ public class SilkEncodeUtils {
     public static native void nativePcm16leToSilkSI(String inputPath, int outputFd,
             int sampleRate, int bitRate, int packetSize, boolean tencent) throws IOException;
 
+    /**
+     * Encode PCM16LE mono samples to Silk v3 with explicit encoder settings.
+     * <p>
+     * Both file descriptors are owned and closed by the native side.
+     *
+     * @param complexity           0 - 2, or {@link #COMPLEXITY_AUTO}
+     * @param useDtx               discontinuous transmission, silent frames are emitted as empty packets
+     * @param useInBandFec         in-band forward error correction, only effective if packetLossPercentage is greater than 0
+     * @param packetLossPercentage expected packet loss in percent, 0 - 100
+     * @param targetRealTimeFactor encode time divided by audio duration the auto complexity mode aims for, 0 for the default
+     */
+    public static native void nativePcm16leToSilkWithOptions(int inputFd, int outputFd,
+            int sampleRate, int bitRate, int packetSize, boolean tencent,
+            int complexity, boolean useDtx, boolean useInBandFec, int packetLossPercentage,
+            float targetRealTimeFactor) throws IOException;
+
+    /**
+     * Encode WAV or raw PCM in any supported sample format, channel count and sample rate to Silk v3.
+     * <p>
+     * The input is converted natively: multiple channels are averaged, samples are converted to PCM16 and
+     * resampled to sampleRate while streaming into the encoder, no intermediate file is written.
+     * Both file descriptors are owned and closed by the native side.
+     *
+     * @param inputFormat     one of INPUT_FORMAT_*
+     * @param inputChannels   channel count of raw PCM input, ignored for {@link #INPUT_FORMAT_WAV}
+     * @param inputSampleRate sample rate of raw PCM input, ignored for {@link #INPUT_FORMAT_WAV}
+     * @param sampleRate      encoder sample rate, 8000, 12000, 16000 or 24000
+     * @param packetSize      samples per packet at sampleRate
+     * @param complexity      0 - 2, or {@link #COMPLEXITY_AUTO}
+     * @param preprocessFlags a combination of PREPROCESS_* flags, or 0
+     */
+    public static native void nativeAudioToSilk(int inputFd, int outputFd,
+            int inputFormat, int inputChannels, int inputSampleRate,
+            int sampleRate, int bitRate, int packetSize, boolean tencent,
+            int complexity, boolean useDtx, int preprocessFlags) throws IOException;
+
+    // used by SilkBatchTranscodeJob, the encoder parameters are the same as for nativeAudioToSilk
+
+    static native long nativeBatchStart(String[] inputPaths, String[] outputPaths,
+            int inputFormat, int inputChannels, int inputSampleRate,
+            int sampleRate, int bitRate, int packetSize, boolean tencent,
+            int complexity, boolean useDtx, int preprocessFlags, int workerCount) throws IOException;
+
+    static native String nativeBatchWaitEvent(long handle, int timeoutMs, long[] event);
+
+    static native void nativeBatchCancel(long handle);
+
+    static native void nativeBatchClose(long handle);
+
 }
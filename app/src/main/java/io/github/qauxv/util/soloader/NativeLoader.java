@@ -27,6 +27,7 @@ import android.content.Context;
 import android.content.pm.ApplicationInfo;
 import android.os.Build;
 import android.os.Process;
+import android.system.ErrnoException;
 import android.system.Os;
 import android.system.StructUtsname;
 import androidx.annotation.Keep;
@@ -48,13 +49,18 @@ import java.io.FileOutputStream;
 import java.io.IOError;
 import java.io.IOException;
 import java.io.InputStream;
+import java.io.RandomAccessFile;
 import java.lang.reflect.Field;
 import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Method;
+import java.nio.channels.FileLock;
+import java.nio.charset.StandardCharsets;
 import java.util.Arrays;
 import java.util.HashSet;
 import java.util.Objects;
 import java.util.Set;
+import java.util.zip.CRC32;
+import java.util.zip.ZipEntry;
 import java.util.zip.ZipFile;
 
 @Keep
@@ -452,7 +458,7 @@ public class NativeLoader {
             // case 2: extract and load if direct mmap failed
             File filesDir = new File(dataDir, "files");
             IoUtils.mkdirsOrThrow(filesDir);
-            File soFile = extractNativeLibrary(filesDir, soname, getNativeLibraryDirName(runtimeIsa));
+            File soFile = extractNativeLibrary(filesDir, apkPath, soname, getNativeLibraryDirName(runtimeIsa));
             try {
                 invokeLoad.invoke(null, soFile.getAbsolutePath());
                 if (sPrimaryNativeLibraryNativeLoader == null) {
@@ -494,53 +500,103 @@ public class NativeLoader {
     }
 
     /**
-     * Extract or update native library into "qa_dyn_lib" dir
+     * Extract or update native library into "qa_dyn_lib" dir.
+     * <p>
+     * A sidecar manifest records the CRC-32 and size of the zip entry the library was extracted from. Both are read
+     * from the central directory, so an up-to-date library is detected without inflating or hashing anything.
+     * The library is written to a temporary file, verified against the CRC-32, synced and renamed into place,
+     * so an interrupted extraction never leaves a truncated library behind.
+     * <p>
+     * The host starts several processes at once, so the extraction is serialized by a file lock in the directory,
+     * and every process writes its own temporary files, named after its pid.
      *
      * @param filesDir directory to store the extracted native library, get from {@link Context#getFilesDir()}
+     * @param apkPath  the module APK
      * @param soname   the name of the native library, e.g. "libqauxv-core0.so"
      * @param abi      the ABI of the native library, e.g. "arm64-v8a"
      */
-    private static File extractNativeLibrary(@NonNull File filesDir, String soname, String abi) {
+    private static synchronized File extractNativeLibrary(@NonNull File filesDir, @NonNull String apkPath, String soname, String abi) {
         String soName = soname + "." + BuildConfig.VERSION_CODE + "." + abi;
         File dir = new File(filesDir, "qa_dyn_lib");
         IoUtils.mkdirsOrThrow(dir);
-        ClassLoader cl = NativeLoader.class.getClassLoader();
-        assert cl != null;
         File soFile = new File(dir, soName);
-        if (!soFile.exists()) {
-            InputStream in = cl.getResourceAsStream("lib/" + abi + "/" + soname);
-            if (in == null) {
+        File manifestFile = new File(dir, soName + ".manifest");
+        try (ZipFile zipFile = new ZipFile(apkPath)) {
+            ZipEntry entry = zipFile.getEntry("lib/" + abi + "/" + soname);
+            if (entry == null) {
                 throw new UnsatisfiedLinkError("Unsupported ABI: " + abi);
             }
-            // clean up old files
-            for (String name : dir.list()) {
-                if (name.startsWith(soname)) {
-                    new File(dir, name).delete();
-                }
+            String manifest = Long.toHexString(entry.getCrc()) + " " + entry.getSize();
+            if (isExtractedLibraryUpToDate(soFile, manifestFile, entry, manifest)) {
+                return soFile;
             }
-            try {
-                // extract so file
-                soFile.createNewFile();
-                FileOutputStream fout = new FileOutputStream(soFile);
-                byte[] buf = new byte[1024];
-                int i;
-                while ((i = in.read(buf)) > 0) {
-                    fout.write(buf, 0, i);
+            // the lock file name does not start with soname, so it is never cleaned up below
+            try (RandomAccessFile lockFile = new RandomAccessFile(new File(dir, "extract.lock"), "rw")) {
+                // released when the file is closed
+                FileLock ignored = lockFile.getChannel().lock();
+                // another process may have extracted it while we were waiting for the lock
+                if (isExtractedLibraryUpToDate(soFile, manifestFile, entry, manifest)) {
+                    return soFile;
+                }
+                // clean up old files, including the manifest of the current one,
+                // temporary files are only written under the lock, so any left here belong to a dead process
+                String[] names = dir.list();
+                if (names != null) {
+                    for (String name : names) {
+                        if (name.startsWith(soname)) {
+                            new File(dir, name).delete();
+                        }
+                    }
                 }
-                in.close();
-                fout.flush();
-                fout.close();
-            } catch (IOException ioe) {
+                String tmpSuffix = "." + Process.myPid() + ".tmp";
+                File tmpFile = new File(dir, soName + tmpSuffix);
+                File tmpManifestFile = new File(dir, soName + ".manifest" + tmpSuffix);
                 try {
-                    in.close();
-                } catch (IOException ignored) {
+                    CRC32 crc32 = new CRC32();
+                    try (InputStream in = zipFile.getInputStream(entry); FileOutputStream out = new FileOutputStream(tmpFile)) {
+                        byte[] buf = new byte[65536];
+                        int i;
+                        while ((i = in.read(buf)) > 0) {
+                            crc32.update(buf, 0, i);
+                            out.write(buf, 0, i);
+                        }
+                        out.getFD().sync();
+                    }
+                    if (crc32.getValue() != entry.getCrc() || tmpFile.length() != entry.getSize()) {
+                        throw new IOException("CRC or size mismatch while extracting " + entry.getName());
+                    }
+                    Os.rename(tmpFile.getAbsolutePath(), soFile.getAbsolutePath());
+                    // the manifest is written last, it is only present when the library is complete
+                    try (FileOutputStream out = new FileOutputStream(tmpManifestFile)) {
+                        out.write(manifest.getBytes(StandardCharsets.UTF_8));
+                        out.getFD().sync();
+                    }
+                    Os.rename(tmpManifestFile.getAbsolutePath(), manifestFile.getAbsolutePath());
+                } finally {
+                    // only present if something failed
+                    tmpFile.delete();
+                    tmpManifestFile.delete();
                 }
-                throw IoUtils.unsafeThrow(ioe);
             }
+        } catch (IOException | ErrnoException e) {
+            throw IoUtils.unsafeThrow(e);
         }
         return soFile;
     }
 
+    private static boolean isExtractedLibraryUpToDate(@NonNull File soFile, @NonNull File manifestFile,
+            @NonNull ZipEntry entry, @NonNull String manifest) {
+        if (soFile.length() != entry.getSize() || !manifestFile.isFile()) {
+            return false;
+        }
+        try {
+            return manifest.equals(new String(IoUtils.readFile(manifestFile), StandardCharsets.UTF_8));
+        } catch (IOException e) {
+            // e.g. deleted by another process which is extracting it right now
+            return false;
+        }
+    }
+
     // not used
     private static final int NATIVE_LIBRARY_INIT_MODE_NONE = 0;
     // config the native library to function as primary only
@@ -147,6 +147,10 @@ public abstract class XC_MethodHook {
             return callback;
         }
 
+        /*package*/ IHookBridge.MemberUnhookHandle getUnhookHandle() {
+            return unhookHandle;
+        }
+
         public void unhook() {
             unhookHandle.unhook();
         }
@@ -3,12 +3,15 @@ package io.github.qauxv.util.xpcompat;
 import androidx.annotation.NonNull;
 import io.github.qauxv.loader.hookapi.IHookBridge;
 import io.github.qauxv.poststartup.StartupInfo;
+import io.github.qauxv.util.hookimpl.lsplant.LsplantHookImpl;
 import java.lang.reflect.AccessibleObject;
 import java.lang.reflect.Constructor;
 import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Member;
 import java.lang.reflect.Method;
 import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Collection;
 import java.util.HashSet;
 import java.util.Set;
 
@@ -31,13 +34,13 @@ public class XposedBridge {
      */
     @SuppressWarnings("UnusedReturnValue")
     public static Set<XC_MethodHook.Unhook> hookAllMethods(Class<?> hookClass, String methodName, XC_MethodHook callback) {
-        Set<XC_MethodHook.Unhook> unhooks = new HashSet<XC_MethodHook.Unhook>();
+        ArrayList<Member> methods = new ArrayList<>();
         for (Member method : hookClass.getDeclaredMethods()) {
             if (method.getName().equals(methodName)) {
-                unhooks.add(hookMethod(method, callback));
+                methods.add(method);
             }
         }
-        return unhooks;
+        return hookMethods(methods.toArray(new Member[0]), callback);
     }
 
     /**
@@ -49,13 +52,53 @@ public class XposedBridge {
      */
     @SuppressWarnings("UnusedReturnValue")
     public static Set<XC_MethodHook.Unhook> hookAllConstructors(Class<?> hookClass, XC_MethodHook callback) {
+        return hookMethods(hookClass.getDeclaredConstructors(), callback);
+    }
+
+    private static Set<XC_MethodHook.Unhook> hookMethods(Member[] members, XC_MethodHook callback) {
         Set<XC_MethodHook.Unhook> unhooks = new HashSet<XC_MethodHook.Unhook>();
-        for (Member constructor : hookClass.getDeclaredConstructors()) {
-            unhooks.add(hookMethod(constructor, callback));
+        IHookBridge hookBridge = requireHookBridge();
+        if (members.length > 1 && LsplantHookImpl.isLsplantHookBridge(hookBridge)) {
+            // LSPlant hooks all of them in a single JNI call
+            if (callback == null) {
+                throw new IllegalArgumentException("callback must not be null");
+            }
+            IHookBridge.IMemberHookCallback wrappedCallback = new WrappedCallbacks.WrappedHookCallback(callback);
+            for (IHookBridge.MemberUnhookHandle handle : LsplantHookImpl.hookMethods(members, wrappedCallback, callback.getPriority())) {
+                unhooks.add(new XC_MethodHook.Unhook(handle, callback));
+            }
+            return unhooks;
+        }
+        for (Member member : members) {
+            unhooks.add(hookMethod(member, callback));
         }
         return unhooks;
     }
 
+    /**
+     * Remove many hooks, e.g. the ones returned by {@link #hookAllMethods} or {@link #hookAllConstructors}.
+     * <p>
+     * Note: This method is not available in the original XposedBridge.
+     *
+     * @param unhooks the hooks to remove
+     */
+    public static void unhookAll(@NonNull Collection<XC_MethodHook.Unhook> unhooks) {
+        IHookBridge hookBridge = requireHookBridge();
+        if (unhooks.size() > 1 && LsplantHookImpl.isLsplantHookBridge(hookBridge)) {
+            // LSPlant unhooks the members without callbacks left in a single JNI call
+            IHookBridge.MemberUnhookHandle[] handles = new IHookBridge.MemberUnhookHandle[unhooks.size()];
+            int i = 0;
+            for (XC_MethodHook.Unhook unhook : unhooks) {
+                handles[i++] = unhook.getUnhookHandle();
+            }
+            LsplantHookImpl.unhookMethods(handles);
+            return;
+        }
+        for (XC_MethodHook.Unhook unhook : unhooks) {
+            unhook.unhook();
+        }
+    }
+
     private static IHookBridge requireHookBridge() {
         IHookBridge hookBridge = StartupInfo.getHookBridge();
         if (hookBridge == null) {